@@ -116,6 +116,20 @@ if (STD_BARRIER_SUPPORTED)
 	set( AE_COMPILER_DEFINITIONS "${AE_COMPILER_DEFINITIONS}" "AE_STD_BARRIER" )
 endif ()
 
+#------------------------------------------------------------------------------
+check_cxx_source_compiles(
+	"#include <coroutine>
+	int main () {
+		std::coroutine_handle<>  temp;
+		(void)(temp);
+		return 0;
+	}"
+	STD_COROUTINE_SUPPORTED )
+
+if (STD_COROUTINE_SUPPORTED)
+	set( AE_COMPILER_DEFINITIONS "${AE_COMPILER_DEFINITIONS}" "AE_STD_COROUTINE" )
+endif ()
+
 #------------------------------------------------------------------------------
 if (NOT ${COMPILER_MSVC})
 	set( CMAKE_REQUIRED_FLAGS "${AE_DEFAULT_CPPFLAGS} -Werror=unknown-pragmas" )
@@ -48,6 +48,9 @@ namespace AE::ECS
 		static constexpr uint	MaxComponents				= 4 * 64;
 		static constexpr uint	MaxComponentsPerArchetype	= 64;
 		static constexpr uint	InitialtStorageSize			= 16;
+		static constexpr uint	ArchetypeChunkSize			= 16 << 10;	// bytes, see 'ArchetypeStorage'
+		static constexpr uint	ParallelExecChunkSize		= 1 << 10;	// approximate number of entities per task in 'Registry::ExecuteParallel()'
+		static constexpr uint	CommandBufferBlockSize		= 64 << 10;	// bytes, see 'EntityCommandBuffer'
 	};
 
 	class Registry;
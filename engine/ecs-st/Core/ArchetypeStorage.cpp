@@ -12,17 +12,16 @@ namespace AE::ECS
 =================================================
 */
 	ArchetypeStorage::ArchetypeStorage (const Registry &reg, const Archetype &archetype, size_t capacity) :
-		_memory{ null },
 		_count{ 0 },
 		_locks{ 0 },
 		_archetype{ archetype },
-		_capacity{ 0 },
+		_chunkCapacity{ 1 },
 		_owner{ reg }
 	{
 		CHECK( _InitComponents() );
 		Reserve( capacity );
 	}
-	
+
 /*
 =================================================
 	_InitComponents
@@ -32,7 +31,8 @@ namespace AE::ECS
 	{
 		_maxAlign = BytesU{AE_CACHE_LINE};
 
-		auto&	desc = _archetype.Desc().Raw();
+		auto&	desc		= _archetype.Desc().Raw();
+		BytesU	row_size	= SizeOf<EntityID>;
 
 		for (size_t i = 0; i < desc.size(); ++i)
 		{
@@ -54,15 +54,47 @@ namespace AE::ECS
 				_components.at<0>( idx ) = id;
 				_components.at<1>( idx ) = info->size;
 				_components.at<2>( idx ) = info->align;
-				_components.at<3>( idx ) = null;
+				_components.at<3>( idx ) = Bytes<uint>{0};
 				_components.at<4>( idx ) = info->ctor;
 
-				_maxAlign = Max( _maxAlign, BytesU{ info->align });
+				_maxAlign	= Max( _maxAlign, BytesU{ info->align });
+				row_size	+= BytesU{ info->size };
+			}
+		}
 
-				DEBUG_ONLY( _dbgView.emplace_back() );
+		// calculate chunk layout
+		const auto	CalcLayout = [this] (size_t capacity)
+		{
+			BytesU	offset = SizeOf<EntityID> * capacity;
+
+			for (size_t i = 0; i < _components.size(); ++i)
+			{
+				auto	comp_size	= _components.at<1>(i);
+				auto	comp_align	= _components.at<2>(i);
+				auto&	comp_offset	= _components.at<3>(i);
+
+				if ( comp_size > 0 )
+				{
+					offset		= AlignToLarger( offset, BytesU{comp_align} );
+					comp_offset	= Bytes<uint>{ CheckCast<uint>( size_t(offset) )};
+					offset		+= BytesU{comp_size} * capacity;
+				}
 			}
+			return offset;
+		};
+
+		const BytesU	max_size	= BytesU{ECS_Config::ArchetypeChunkSize};
+		size_t			capacity	= Max( size_t(1), size_t(max_size) / size_t(row_size) );
+		BytesU			chunk_size	= CalcLayout( capacity );
+
+		// alignment may increase chunk size
+		for (; (chunk_size > max_size) and (capacity > 1);)
+		{
+			chunk_size = CalcLayout( --capacity );
 		}
 
+		_chunkCapacity	= capacity;
+		_chunkSize		= AlignToLarger( chunk_size, _maxAlign );
 		return true;
 	}
 
@@ -74,11 +106,13 @@ namespace AE::ECS
 	ArchetypeStorage::~ArchetypeStorage ()
 	{
 		CHECK( not IsLocked() );
-
 		ASSERT( _count == 0 );
-		_allocator.Deallocate( _memory, _maxAlign );
+
+		for (auto* chunk : _chunks) {
+			_allocator.Deallocate( chunk, _maxAlign );
+		}
 	}
-	
+
 /*
 =================================================
 	Add
@@ -90,33 +124,30 @@ namespace AE::ECS
 	{
 		CHECK_ERR( not IsLocked() );
 
-		if ( _count < _capacity )
+		if ( _count < Capacity() )
 		{
-			_GetEntities()[_count] = id;
+			_GetEntities( _count / _chunkCapacity )[ _count % _chunkCapacity ] = id;
+			index = Index_t(_count);
+			++_count;
 
 			for (size_t i = 0; i < _components.size(); ++i)
 			{
 				auto	comp_size	= _components.at<1>(i);
-				auto	comp_data	= _components.at<3>(i);
 				auto	comp_ctor	= _components.at<4>(i);
 
 				if ( comp_size > 0 )
 				{
-					void*	data = comp_data + BytesU{comp_size} * _count;
+					void*	data = _GetComponent( i, size_t(index) );
 
 					DEBUG_ONLY( std::memset( OUT data, 0xCD, size_t(comp_size) ));
 					comp_ctor( OUT data );
 				}
 			}
-			
-			index = Index_t(_count);
-			++_count;
-
 			return true;
 		}
 		return false;
 	}
-	
+
 /*
 =================================================
 	AddEntities
@@ -128,70 +159,148 @@ namespace AE::ECS
 	{
 		CHECK_ERR( not IsLocked() );
 
-		if ( _count + ids.size() < _capacity )
+		if ( _count + ids.size() <= Capacity() )
 		{
-			std::memcpy( OUT _GetEntities() + _count, ids.data(), size_t(ArraySizeOf(ids)) );
 			startIndex = Index_t(_count);
 
-			_count += ids.size();
+			for (size_t i = 0; i < ids.size();)
+			{
+				const size_t	chunk_idx	= _count / _chunkCapacity;
+				const size_t	local_idx	= _count % _chunkCapacity;
+				const size_t	n			= Min( ids.size() - i, _chunkCapacity - local_idx );
+
+				std::memcpy( OUT _GetEntities( chunk_idx ) + local_idx, ids.data() + i, sizeof(EntityID) * n );
+
+				_count	+= n;
+				i		+= n;
+			}
 			return true;
 		}
 		return false;
 	}
 
+/*
+=================================================
+	CopyComponents
+----
+	copies components by continuous ranges inside chunks
+=================================================
+*/
+	void  ArchetypeStorage::CopyComponents (Index_t dstIndex, const ArchetypeStorage &src, Index_t srcIndex, size_t count)
+	{
+		ASSERT( size_t(dstIndex) + count <= _count );
+		ASSERT( size_t(srcIndex) + count <= src._count );
+
+		for (size_t i = 0; i < _components.size(); ++i)
+		{
+			const size_t	comp_size	= size_t(_components.at<1>(i));
+			const size_t	src_pos		= src._IndexOf( _components.at<0>(i) );
+
+			if ( (comp_size == 0) or (src_pos >= src._components.size()) )
+				continue;
+
+			ASSERT( size_t(src._components.at<1>(src_pos)) == comp_size );
+
+			for (size_t j = 0; j < count;)
+			{
+				const size_t	dst_idx	= size_t(dstIndex) + j;
+				const size_t	src_idx	= size_t(srcIndex) + j;
+				const size_t	n		= Min( count - j,
+											   _chunkCapacity - (dst_idx % _chunkCapacity),
+											   src._chunkCapacity - (src_idx % src._chunkCapacity) );
+
+				std::memcpy( OUT _GetComponent( i, dst_idx ), src._GetComponent( src_pos, src_idx ), comp_size * n );
+				j += n;
+			}
+		}
+	}
+
+/*
+=================================================
+	SetAddEdge
+=================================================
+*/
+	void  ArchetypeStorage::SetAddEdge (ComponentID id, ArchetypeStorage* dst)
+	{
+		ASSERT( not HasComponent( id ));
+		ASSERT( dst and dst->HasComponent( id ));
+
+		_SetEdge( id, dst );
+	}
+	
+/*
+=================================================
+	SetRemoveEdge
+=================================================
+*/
+	void  ArchetypeStorage::SetRemoveEdge (ComponentID id, ArchetypeStorage* dst)
+	{
+		ASSERT( HasComponent( id ));
+		ASSERT( dst and not dst->HasComponent( id ));
+
+		_SetEdge( id, dst );
+	}
+	
+/*
+=================================================
+	_SetEdge
+=================================================
+*/
+	void  ArchetypeStorage::_SetEdge (ComponentID id, ArchetypeStorage* dst)
+	{
+		if ( not _edges )
+			_edges.reset( new Edges_t::element_type{} );
+
+		CHECK_ERR( id.value < _edges->size(), void());
+		(*_edges)[ id.value ] = dst;
+	}
+
 /*
 =================================================
 	Erase
+----
+	last entity is moved to the erased position
 =================================================
 */
 	bool  ArchetypeStorage::Erase (Index_t index, OUT EntityID &movedEntity)
 	{
 		CHECK_ERR( not IsLocked() );
 
-		const size_t	idx = size_t(index);
+		const size_t	idx		= size_t(index);
+		const size_t	last	= _count - 1;
 		CHECK_ERR( idx < _count );
-		
-		--_count;
 
-		if ( idx != _count )
+		if ( idx != last )
 		{
 			for (size_t i = 0; i < _components.size(); ++i)
 			{
-				const BytesU	comp_size{ _components.at<1>(i) };
+				const size_t	comp_size = size_t(_components.at<1>(i));
 
 				if ( comp_size > 0 )
-				{
-					void*	comp_storage = _components.at<3>(i);
-					std::memcpy( OUT comp_storage + comp_size * idx,
-								 comp_storage + comp_size * _count,
-								 size_t(comp_size) );
-				}
+					std::memcpy( OUT _GetComponent( i, idx ), _GetComponent( i, last ), comp_size );
 			}
 
-			auto*	ent = _GetEntities();
-			movedEntity = ent[idx] = ent[_count];
+			movedEntity = GetEntity( Index_t(last) );
+			_GetEntities( idx / _chunkCapacity )[ idx % _chunkCapacity ] = movedEntity;
 		}
 		else
 		{
 			ASSERT( not movedEntity.IsValid() );
 		}
-		
+
 		DEBUG_ONLY(
 		for (size_t i = 0; i < _components.size(); ++i)
 		{
 			const size_t	comp_size = size_t(_components.at<1>(i));
 
 			if ( comp_size > 0 )
-			{
-				void*	comp_storage = _components.at<3>(i);
-
-				std::memset( OUT comp_storage + BytesU{comp_size} * _count, 0xCD, comp_size );
-			}
+				std::memset( OUT _GetComponent( i, last ), 0xCD, comp_size );
 		})
 
+		--_count;
 		return true;
 	}
-	
+
 /*
 =================================================
 	IsValid
@@ -200,9 +309,9 @@ namespace AE::ECS
 	bool  ArchetypeStorage::IsValid (EntityID id, Index_t index) const
 	{
 		return	size_t(index) < _count and
-				GetEntities()[ size_t(index) ] == id;
+				GetEntity( index ) == id;
 	}
-	
+
 /*
 =================================================
 	Clear
@@ -214,94 +323,57 @@ namespace AE::ECS
 
 		_count = 0;
 	}
-	
+
 /*
 =================================================
 	Reserve
+----
+	allocates or releases chunks, existing entities are never moved
 =================================================
 */
 	void  ArchetypeStorage::Reserve (size_t size)
 	{
-		using ComponentData_t	= FixedArray< void*, ECS_Config::MaxComponentsPerArchetype >;
-
 		CHECK_ERR( not IsLocked(), void() );
 		CHECK_ERR( size >= _count, void());
 
-		if ( size == _capacity )
-			return;
-
-		_capacity = size;
-
-		const ComponentData_t	old_data	{ _components.get<3>() };
-		void *					old_mem		= _memory;
+		const size_t	chunk_count = (size + _chunkCapacity - 1) / _chunkCapacity;
 
-		// allocate
+		for (; _chunks.size() > chunk_count;)
 		{
-			BytesU	offset	= SizeOf<EntityID> * _capacity;
-
-			for (size_t i = 0; i < _components.size(); ++i)
-			{
-				auto	comp_size	= _components.at<1>(i);
-				auto	comp_align	= _components.at<2>(i);
-				auto&	comp_data	= _components.at<3>(i);
-			
-				if ( comp_size > 0 )
-				{
-					offset		= AlignToLarger( offset, BytesU{comp_align} );
-					comp_data	= (void*)(offset);
-					offset		+= BytesU{comp_size} * _capacity;
-				}
-				else
-				{
-					comp_data	= null;	// TODO: ???
-				}
-			}
-
-			_memory = _allocator.Allocate( offset, _maxAlign );
+			_allocator.Deallocate( _chunks.back(), _maxAlign );
+			_chunks.pop_back();
+		}
 
-			if ( not _memory )
-			{
-				CHECK( !"failed to allocate memory" );
-				_count		= 0;
-				_capacity	= 0;
-				_allocator.Deallocate( old_mem, _maxAlign );
-				return;
-			}
-			
-			for (size_t i = 0; i < _components.size(); ++i)
-			{
-				auto&	comp_data = _components.at<3>(i);
-				comp_data = comp_data ? BitCast<void*>( size_t(comp_data) + size_t(_memory) ) : null;
+		_chunks.reserve( chunk_count );
 
-				DEBUG_ONLY(
-				if ( comp_data ) {
-					_dbgView[i] = _owner.GetComponentInfo( _components.at<0>(i) )->dbgView( comp_data, _capacity );
-				})
-			}
+		for (; _chunks.size() < chunk_count;)
+		{
+			void*	chunk = _allocator.Allocate( _chunkSize, _maxAlign );
+			CHECK_ERR( chunk != null, void());
 
-			DEBUG_ONLY( std::memset( OUT _memory, 0xCD, size_t(offset) ));
-			DEBUG_ONLY( _memoryEnd = _memory + offset; )
+			DEBUG_ONLY( std::memset( OUT chunk, 0xCD, size_t(_chunkSize) ));
+			_chunks.push_back( chunk );
 		}
+	}
 
-		// copy
-		if ( _count and old_mem )
+/*
+=================================================
+	EntityDbgView
+=================================================
+*/
+DEBUG_ONLY(
+	ArchetypeStorage::CompDbgView_t  ArchetypeStorage::EntityDbgView (Index_t idx) const
+	{
+		CompDbgView_t	result;
+		for (size_t i = 0; i < _components.size(); ++i)
 		{
-			std::memcpy( OUT _GetEntities(), old_mem, size_t(SizeOf<EntityID> * _count) );
-
-			for (size_t i = 0; i < _components.size(); ++i)
-			{
-				auto&	src			= old_data[i];
-				auto&	dst			= _components.at<3>(i);
-				auto	comp_size	= _components.at<1>(i);
-
-				if ( comp_size > 0 )
-					std::memcpy( OUT dst, src, size_t(comp_size) * _count );
-			}
+			if ( _components.at<1>(i) > 0 )
+				result.emplace_back( _owner.GetComponentInfo( _components.at<0>(i) )->dbgView( _GetComponent( i, size_t(idx) ), 1 ));
+			else
+				result.emplace_back();
 		}
-
-		if ( old_mem )
-			_allocator.Deallocate( old_mem, _maxAlign );
+		return result;
 	}
-
+)
 
 }	// AE::ECS
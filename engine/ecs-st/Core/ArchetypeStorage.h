@@ -31,32 +31,37 @@ namespace AE::ECS
 	private:
 		using Allocator_t	= UntypedAlignedAllocator;
 		using Components_t	= FixedTupleArray< ECS_Config::MaxComponentsPerArchetype,
-									/*0 - id    */ ComponentID,
-									/*1 - size  */ Bytes<uint16_t>,
-									/*2 - align */ Bytes<uint16_t>,
-									/*3 - ptr   */ void*,
-									/*4 - ctor  */ void (*)(void*) >;
+									/*0 - id     */ ComponentID,
+									/*1 - size   */ Bytes<uint16_t>,
+									/*2 - align  */ Bytes<uint16_t>,
+									/*3 - offset */ Bytes<uint>,		// offset in chunk, components are not in chunk if size is zero
+									/*4 - ctor   */ void (*)(void*) >;
+
+		// chunk is a fixed size memory block with SoA layout: [entities][component 0][component 1]...
+		// new chunks are allocated when storage grows, so existing entities are never moved.
+		using Chunks_t		= Array< void* >;
+
+		// cached archetype transitions: storage with added component if component doesn't exist in this archetype,
+		// storage with removed component otherwise. Allocated on first transition.
+		using Edges_t		= UniquePtr< StaticArray< ArchetypeStorage*, ECS_Config::MaxComponents >>;
 
 
 	// variables
 	private:
-		void *				_memory;
+		Chunks_t			_chunks;
 		size_t				_count;
 		Atomic<int>			_locks;
 
 		const Archetype		_archetype;
 		Components_t		_components;
-		size_t				_capacity;
+		size_t				_chunkCapacity;		// number of entities per chunk
+		BytesU				_chunkSize;
 		BytesU				_maxAlign;
 		Allocator_t			_allocator;
+		Edges_t				_edges;
 
 		Registry const&		_owner;
 
-		DEBUG_ONLY(
-			CompDbgView_t	_dbgView;
-			void *			_memoryEnd;
-		)
-
 
 	// methods
 	public:
@@ -71,6 +76,15 @@ namespace AE::ECS
 			void  Reserve (size_t size);
 			void  Reorder (Index_t offset, ArrayView<Index_t> newOrder);
 
+		// copy components that exist in both storages
+			void  CopyComponents (Index_t dstIndex, const ArchetypeStorage &src, Index_t srcIndex, size_t count);
+
+		// returns null if transition is not cached yet
+		ND_ ArchetypeStorage*	GetAddEdge (ComponentID id)		const;
+		ND_ ArchetypeStorage*	GetRemoveEdge (ComponentID id)	const;
+			void				SetAddEdge (ComponentID id, ArchetypeStorage* dst);
+			void				SetRemoveEdge (ComponentID id, ArchetypeStorage* dst);
+
 			void  Lock ();
 			void  Unlock ();
 		ND_ bool  IsLocked () const;
@@ -79,24 +93,30 @@ namespace AE::ECS
 		ND_ T*					GetComponent (Index_t idx)		const;
 		ND_ Pair<void*, BytesU>	GetComponent (Index_t idx, ComponentID id) const;
 
+		// returns components in chunk
 		template <typename T>
-		ND_ T*					GetComponents ()				const;
-		ND_ void*				GetComponents (ComponentID id)	const;
+		ND_ T*					GetComponents (size_t chunkIdx)					const;
+		ND_ void*				GetComponents (size_t chunkIdx, ComponentID id)	const;
 		
 		template <typename T>
 		ND_ bool				HasComponent ()					const	{ return _archetype.Exists<T>(); }
 		ND_ bool				HasComponent (ComponentID id)	const	{ return _archetype.Exists( id ); }
 
-		ND_ EntityID const*		GetEntities ()					const;	// local index to EntityID
-		ND_ size_t				Capacity ()						const	{ return _capacity; }
+		ND_ EntityID const*		GetEntities (size_t chunkIdx)	const;	// local index in chunk to EntityID
+		ND_ EntityID			GetEntity (Index_t idx)			const;
+		ND_ size_t				Capacity ()						const	{ return _chunks.size() * _chunkCapacity; }
 		ND_ size_t				Count ()						const	{ return _count; }
 		ND_ bool				Empty ()						const	{ return _count == 0; }
 		ND_ Archetype const&	GetArchetype ()					const	{ return _archetype; }
 
+		ND_ size_t				ChunkCount ()					const	{ return (_count + _chunkCapacity - 1) / _chunkCapacity; }	// number of non-empty chunks
+		ND_ size_t				ChunkCapacity ()				const	{ return _chunkCapacity; }
+		ND_ size_t				ChunkEntityCount (size_t chunkIdx) const;
+		ND_ BytesU				ChunkSize ()					const	{ return _chunkSize; }
+
 		ND_ ArrayView<ComponentID>		GetComponentIDs ()		const	{ return _components.get<0>(); }
 		ND_ ArrayView<Bytes<uint16_t>>	GetComponentSizes ()	const	{ return _components.get<1>(); }
 		ND_ ArrayView<Bytes<uint16_t>>	GetComponentAligns ()	const	{ return _components.get<2>(); }
-		ND_ ArrayView<void*>			GetComponentData ()				{ return _components.get<3>(); }
 
 		DEBUG_ONLY(
 		 ND_ CompDbgView_t		EntityDbgView (Index_t idx)		const;
@@ -106,10 +126,14 @@ namespace AE::ECS
 
 
 	private:
-		ND_ EntityID *	_GetEntities ();
+		ND_ EntityID *	_GetEntities (size_t chunkIdx);
 
 		ND_ size_t		_IndexOf (ComponentID id) const;
 
+		ND_ void*		_GetComponent (size_t pos, size_t idx) const;
+
+			void		_SetEdge (ComponentID id, ArchetypeStorage* dst);
+
 		bool _InitComponents ();
 	};
 
@@ -121,10 +145,10 @@ namespace AE::ECS
 =================================================
 */
 	template <typename T>
-	inline T*  ArchetypeStorage::GetComponents () const
+	inline T*  ArchetypeStorage::GetComponents (size_t chunkIdx) const
 	{
 		STATIC_ASSERT( not IsEmpty<T> );
-		return Cast<T>( GetComponents( ComponentTypeInfo<T>::id ));
+		return Cast<T>( GetComponents( chunkIdx, ComponentTypeInfo<T>::id ));
 	}
 	
 /*
@@ -132,15 +156,27 @@ namespace AE::ECS
 	GetComponents
 =================================================
 */
-	inline void*  ArchetypeStorage::GetComponents (ComponentID id) const
+	inline void*  ArchetypeStorage::GetComponents (size_t chunkIdx, ComponentID id) const
 	{
-		ASSERT( _memory );
+		ASSERT( chunkIdx < _chunks.size() );
+
 		size_t	pos = _IndexOf( id );
-		return	pos < _components.size() ?
-					_components.at<3>(pos) :
+		return	pos < _components.size() and _components.at<1>(pos) > 0 ?
+					_chunks[chunkIdx] + BytesU{_components.at<3>(pos)} :
 					null;
 	}
 	
+/*
+=================================================
+	_GetComponent
+=================================================
+*/
+	inline void*  ArchetypeStorage::_GetComponent (size_t pos, size_t idx) const
+	{
+		ASSERT( idx < _count );
+		return	_chunks[ idx / _chunkCapacity ] + BytesU{_components.at<3>(pos)} + BytesU{_components.at<1>(pos)} * (idx % _chunkCapacity);
+	}
+
 /*
 =================================================
 	GetComponent
@@ -151,13 +187,11 @@ namespace AE::ECS
 	{
 		STATIC_ASSERT( not IsEmpty<T> );
 		ASSERT( size_t(idx) < Count() );
-		ASSERT( _memory );
 
 		size_t	pos = _IndexOf( ComponentTypeInfo<T>::id );
 		return	pos < _components.size() ?
-					Cast<T>( _components.at<3>(pos) ) + size_t(idx) :
+					Cast<T>( _GetComponent( pos, size_t(idx) )) :
 					null;
-
 	}
 	
 /*
@@ -168,11 +202,10 @@ namespace AE::ECS
 	inline Pair<void*, BytesU>  ArchetypeStorage::GetComponent (Index_t idx, ComponentID id) const
 	{
 		ASSERT( size_t(idx) < Count() );
-		ASSERT( _memory );
 
 		size_t	pos = _IndexOf( id );
-		return	pos < _components.size() ?
-					Pair<void*, BytesU>{ _components.at<3>(pos) + BytesU{_components.at<1>(pos)} * size_t(idx), BytesU{_components.at<1>(pos)} } :
+		return	pos < _components.size() and _components.at<1>(pos) > 0 ?
+					Pair<void*, BytesU>{ _GetComponent( pos, size_t(idx) ), BytesU{_components.at<1>(pos)} } :
 					Pair<void*, BytesU>{ null, 0_b };
 	}
 
@@ -191,10 +224,10 @@ namespace AE::ECS
 	GetEntities
 =================================================
 */
-	inline EntityID const*  ArchetypeStorage::GetEntities () const
+	inline EntityID const*  ArchetypeStorage::GetEntities (size_t chunkIdx) const
 	{
-		ASSERT( _memory );
-		return Cast<EntityID>( _memory );
+		ASSERT( chunkIdx < _chunks.size() );
+		return Cast<EntityID>( _chunks[chunkIdx] );
 	}
 	
 /*
@@ -202,10 +235,54 @@ namespace AE::ECS
 	_GetEntities
 =================================================
 */
-	inline EntityID*  ArchetypeStorage::_GetEntities ()
+	inline EntityID*  ArchetypeStorage::_GetEntities (size_t chunkIdx)
+	{
+		ASSERT( chunkIdx < _chunks.size() );
+		return Cast<EntityID>( _chunks[chunkIdx] );
+	}
+	
+/*
+=================================================
+	GetEntity
+=================================================
+*/
+	inline EntityID  ArchetypeStorage::GetEntity (Index_t idx) const
+	{
+		ASSERT( size_t(idx) < _count );
+		return GetEntities( size_t(idx) / _chunkCapacity )[ size_t(idx) % _chunkCapacity ];
+	}
+	
+/*
+=================================================
+	ChunkEntityCount
+=================================================
+*/
+	inline size_t  ArchetypeStorage::ChunkEntityCount (size_t chunkIdx) const
+	{
+		const size_t	first = chunkIdx * _chunkCapacity;
+		return first < _count ? Min( _count - first, _chunkCapacity ) : 0;
+	}
+	
+/*
+=================================================
+	GetAddEdge
+=================================================
+*/
+	inline ArchetypeStorage*  ArchetypeStorage::GetAddEdge (ComponentID id) const
+	{
+		ASSERT( not HasComponent( id ));
+		return _edges and id.value < _edges->size() ? (*_edges)[ id.value ] : null;
+	}
+	
+/*
+=================================================
+	GetRemoveEdge
+=================================================
+*/
+	inline ArchetypeStorage*  ArchetypeStorage::GetRemoveEdge (ComponentID id) const
 	{
-		ASSERT( _memory );
-		return Cast<EntityID>( _memory );
+		ASSERT( HasComponent( id ));
+		return _edges and id.value < _edges->size() ? (*_edges)[ id.value ] : null;
 	}
 	
 /*
@@ -238,22 +315,6 @@ namespace AE::ECS
 		return _locks.load() > 0;
 	}
 	
-/*
-=================================================
-	EntityDbgView
-=================================================
-*/
-DEBUG_ONLY(
-	inline ArchetypeStorage::CompDbgView_t  ArchetypeStorage::EntityDbgView (Index_t idx) const
-	{
-		CompDbgView_t	result;
-		for (auto& comp : _dbgView) {
-			result.emplace_back( comp ? comp->ElementView( size_t(idx) ) : Default );
-		}
-		return result;
-	}
-)
-
 /*
 =================================================
 	IsInMemoryRange
@@ -262,7 +323,12 @@ DEBUG_ONLY(
 DEBUG_ONLY(
 	inline bool  ArchetypeStorage::IsInMemoryRange (const void* ptr, BytesU size) const
 	{
-		return (ptr >= _memory) and ((ptr + size) <= _memoryEnd);
+		for (auto* chunk : _chunks)
+		{
+			if ( (ptr >= chunk) and ((ptr + size) <= (chunk + _chunkSize)) )
+				return true;
+		}
+		return false;
 	}
 )
 
@@ -0,0 +1,471 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "ecs-st/Core/EntityCommandBuffer.h"
+
+namespace AE::ECS
+{
+
+	//
+	// Entity Move
+	//
+
+	struct EntityCommandBuffer::EntityMove
+	{
+		EntityID			entity;
+		ArchetypeStorage*	src			= null;
+		ArchetypeStorage*	dst			= null;
+		Index_t				srcIndex	= Index_t(~0u);
+		uint				firstCmd	= 0;	// commands for this entity in sorted command list
+		uint				cmdCount	= 0;
+	};
+//-----------------------------------------------------------------------------
+
+
+/*
+=================================================
+	constructor
+=================================================
+*/
+	EntityCommandBuffer::EntityCommandBuffer ()
+	{
+		_allocator.SetBlockSize( BytesU{ECS_Config::CommandBufferBlockSize} );
+	}
+
+/*
+=================================================
+	DestroyEntity
+=================================================
+*/
+	void  EntityCommandBuffer::DestroyEntity (EntityID entId)
+	{
+		EXLOCK( _drCheck );
+
+		auto&	cmd	= _commands.emplace_back();
+		cmd.type	= ECommand::Destroy;
+		cmd.entity	= entId;
+	}
+
+/*
+=================================================
+	RemoveComponent
+=================================================
+*/
+	void  EntityCommandBuffer::RemoveComponent (EntityID entId, ComponentID compId)
+	{
+		EXLOCK( _drCheck );
+
+		auto&	cmd	= _commands.emplace_back();
+		cmd.type	= ECommand::RemoveComponent;
+		cmd.entity	= entId;
+		cmd.compId	= compId;
+	}
+
+/*
+=================================================
+	Apply
+=================================================
+*/
+	void  EntityCommandBuffer::Apply (Registry &reg)
+	{
+		EntityCommandBuffer*	self = this;
+		_Apply( reg, ArrayView<EntityCommandBuffer*>{ &self, 1 });
+
+		Clear();
+	}
+
+/*
+=================================================
+	Clear
+----
+	memory blocks are kept to be reused in the next frame
+=================================================
+*/
+	void  EntityCommandBuffer::Clear ()
+	{
+		EXLOCK( _drCheck );
+
+		_commands.clear();
+		_allocator.Discard();
+	}
+
+/*
+=================================================
+	_Apply
+=================================================
+*/
+	void  EntityCommandBuffer::_Apply (Registry &reg, ArrayView<EntityCommandBuffer*> buffers)
+	{
+		EXLOCK( reg._drCheck );
+
+		Array<Command const*>		commands;
+		Array<CreateInfo const*>	creates;
+		Array<EntityMove>			moves;
+		Array<EntityID>				destroyed;
+
+		// gather commands
+		{
+			size_t	total = 0;
+			for (auto* buf : buffers) {
+				total += buf->_commands.size();
+			}
+			commands.reserve( total );
+
+			for (auto* buf : buffers)
+			{
+				for (auto& cmd : buf->_commands)
+				{
+					if ( cmd.type == ECommand::Create )
+						creates.push_back( Cast<CreateInfo>( cmd.data ));
+					else
+						commands.push_back( &cmd );
+				}
+			}
+		}
+
+		// group commands by entity, order of commands is preserved for each entity
+		std::stable_sort( commands.begin(), commands.end(),
+						  [] (auto* lhs, auto* rhs) { return lhs->entity.Data() < rhs->entity.Data(); });
+
+		// calculate final archetype for each entity
+		for (size_t i = 0; i < commands.size();)
+		{
+			const EntityID	ent_id	= commands[i]->entity;
+			const size_t	first	= i;
+			bool			destroy	= false;
+
+			for (; (i < commands.size()) and (commands[i]->entity == ent_id); ++i)
+			{
+				destroy |= (commands[i]->type == ECommand::Destroy);
+			}
+
+			ArchetypeStorage*	src		= null;
+			Index_t				src_index;
+
+			// entity may be destroyed by previous command buffer or by another thread
+			if ( not reg._entities.GetArchetype( ent_id, OUT src, OUT src_index ))
+				continue;
+
+			if ( destroy )
+			{
+				destroyed.push_back( ent_id );
+				continue;
+			}
+
+			ArchetypeStorage*	dst			= src;
+			bool				has_data	= false;
+
+			for (size_t j = first; j < i; ++j)
+			{
+				auto&	cmd = *commands[j];
+
+				if ( cmd.type == ECommand::AddComponent )
+				{
+					if ( dst == null or not dst->HasComponent( cmd.compId ))
+						dst = reg._GetAddTransition( dst, cmd.compId );
+
+					has_data |= (cmd.data != null);
+				}
+				else
+				if ( cmd.type == ECommand::RemoveComponent )
+				{
+					if ( dst != null and dst->HasComponent( cmd.compId ))
+						dst = reg._GetRemoveTransition( dst, cmd.compId );
+				}
+			}
+
+			if ( (src != dst) or has_data )
+			{
+				auto&	m	= moves.emplace_back();
+				m.entity	= ent_id;
+				m.src		= src;
+				m.dst		= dst;
+				m.firstCmd	= uint(first);
+				m.cmdCount	= uint(i - first);
+			}
+		}
+
+		// destroy entities
+		for (auto& ent_id : destroyed)
+		{
+			CHECK( reg._RemoveEntity( ent_id ));
+			CHECK( reg._entities.Unassign( ent_id ));
+		}
+
+		// move entities, each pair of source and destination archetypes is processed once
+		std::sort( moves.begin(), moves.end(),
+				   [] (auto& lhs, auto& rhs) { return std::tie( lhs.src, lhs.dst ) < std::tie( rhs.src, rhs.dst ); });
+
+		for (size_t i = 0; i < moves.size();)
+		{
+			const size_t	first = i;
+
+			for (; (i < moves.size()) and (moves[i].src == moves[first].src) and (moves[i].dst == moves[first].dst); ++i)
+			{
+				// index may be changed by previous moves
+				ArchetypeStorage*	storage = null;
+				CHECK( reg._entities.GetArchetype( moves[i].entity, OUT storage, OUT moves[i].srcIndex ));
+				ASSERT( storage == moves[i].src );
+			}
+
+			std::sort( moves.begin() + first, moves.begin() + i,
+					   [] (auto& lhs, auto& rhs) { return lhs.srcIndex < rhs.srcIndex; });
+
+			_MoveEntities( reg, commands, ArrayView<EntityMove>{ moves.data() + first, i - first });
+		}
+
+		// create entities, entities with the same archetype are added together
+		std::stable_sort( creates.begin(), creates.end(),
+						  [] (auto* lhs, auto* rhs) { return lhs->hash < rhs->hash; });
+
+		for (size_t i = 0; i < creates.size();)
+		{
+			const size_t	first = i;
+
+			for (; (i < creates.size()) and creates[i]->desc.Equals( creates[first]->desc ); ++i)
+			{}
+
+			_CreateEntities( reg, ArrayView<CreateInfo const*>{ creates.data() + first, i - first });
+		}
+	}
+
+/*
+=================================================
+	_MoveEntities
+----
+	all entities have the same source and destination storages
+	and sorted by index in source storage
+=================================================
+*/
+	void  EntityCommandBuffer::_MoveEntities (Registry &reg, CmdRefs_t commands, ArrayView<EntityMove> moves)
+	{
+		ArchetypeStorage*	src	= moves.front().src;
+		ArchetypeStorage*	dst	= moves.front().dst;
+
+		// archetype is not changed, only component data
+		if ( src == dst )
+		{
+			for (auto& m : moves) {
+				_WriteComponents( dst, m.srcIndex, commands.section( m.firstCmd, m.cmdCount ));
+			}
+			return;
+		}
+
+		ASSERT( dst != null );
+		ASSERT( src == null or not src->IsLocked() );
+		ASSERT( not dst->IsLocked() );
+
+		Index_t		start;
+		{
+			Array<EntityID>		ids;
+			ids.reserve( moves.size() );
+
+			for (auto& m : moves) {
+				ids.push_back( m.entity );
+			}
+
+			Registry::_IncreaseStorageSize( dst, ids.size() );
+			CHECK_ERR( dst->AddEntities( ids, OUT start ), void());
+		}
+
+		// copy components that exist in both storages,
+		// other components are not initialized here, they are written by 'AddComponent' commands
+		if ( src != null )
+		{
+			for (size_t i = 0; i < moves.size();)
+			{
+				const size_t	first = i;
+
+				for (++i; (i < moves.size()) and (size_t(moves[i].srcIndex) == size_t(moves[i-1].srcIndex) + 1); ++i)
+				{}
+
+				dst->CopyComponents( Index_t(size_t(start) + first), *src, moves[first].srcIndex, i - first );
+			}
+		}
+
+		#if AE_ECS_ENABLE_DEFAULT_MESSAGES
+		FixedArray< ComponentID, ECS_Config::MaxComponentsPerArchetype >	added;
+		FixedArray< ComponentID, ECS_Config::MaxComponentsPerArchetype >	removed;
+
+		for (auto& id : dst->GetComponentIDs())
+		{
+			if ( src == null or not src->HasComponent( id ))
+				added.push_back( id );
+		}
+		if ( src != null )
+		{
+			for (auto& id : src->GetComponentIDs())
+			{
+				if ( not dst->HasComponent( id ))
+					removed.push_back( id );
+			}
+		}
+		#endif
+
+		for (size_t i = 0; i < moves.size(); ++i)
+		{
+			auto&			m			= moves[i];
+			const Index_t	dst_index	= Index_t(size_t(start) + i);
+
+			_WriteComponents( dst, dst_index, commands.section( m.firstCmd, m.cmdCount ));
+
+			#if AE_ECS_ENABLE_DEFAULT_MESSAGES
+			for (auto& id : removed)
+			{
+				auto	comp = src->GetComponent( m.srcIndex, id );
+
+				if ( comp.first != null )
+					reg._messages.Add<MsgTag_RemovedComponent>( m.entity, id, comp );
+				else
+					reg._messages.Add<MsgTag_RemovedComponent>( m.entity, id );
+			}
+			for (auto& id : added) {
+				reg._messages.Add<MsgTag_AddedComponent>( m.entity, id );
+			}
+			#endif
+
+			reg._entities.SetArchetype( m.entity, dst, dst_index );
+		}
+
+		if ( src != null )
+		{
+			// erase from last to first, so entities that are moved to erased positions are not in this group
+			for (size_t i = moves.size(); i-- > 0;)
+			{
+				EntityID	moved;
+				CHECK( src->Erase( moves[i].srcIndex, OUT moved ));
+
+				if ( moved )
+					reg._entities.SetArchetype( moved, src, moves[i].srcIndex );
+			}
+
+			Registry::_DecreaseStorageSize( src );
+		}
+	}
+
+/*
+=================================================
+	_CreateEntities
+----
+	all entities have the same archetype
+=================================================
+*/
+	void  EntityCommandBuffer::_CreateEntities (Registry &reg, ArrayView<CreateInfo const*> infos)
+	{
+		ArchetypeStorage*	storage = reg._GetStorage( Archetype{ infos.front()->desc });
+
+		Registry::_IncreaseStorageSize( storage, infos.size() );
+
+		for (auto* info : infos)
+		{
+			EntityID	ent_id;
+			Index_t		index;
+			CHECK_ERR( reg._entities.Assign( OUT ent_id ), void());
+
+			reg._AddEntity( storage, ent_id, OUT index );
+
+			for (uint i = 0; i < info->count; ++i)
+			{
+				auto&	src = info->comps[i];
+				if ( src.data == null )
+					continue;
+
+				auto	dst = storage->GetComponent( index, src.id );
+				ASSERT( dst.first != null );
+
+				std::memcpy( OUT dst.first, src.data, size_t(dst.second) );
+			}
+
+			#if AE_ECS_ENABLE_DEFAULT_MESSAGES
+			for (auto& comp_id : storage->GetComponentIDs()) {
+				reg._messages.Add<MsgTag_AddedComponent>( ent_id, comp_id );
+			}
+			#endif
+		}
+	}
+
+/*
+=================================================
+	_WriteComponents
+----
+	the last value is used if component was added multiple times
+=================================================
+*/
+	void  EntityCommandBuffer::_WriteComponents (ArchetypeStorage* storage, Index_t index, CmdRefs_t commands)
+	{
+		for (auto* cmd : commands)
+		{
+			if ( cmd->type != ECommand::AddComponent or cmd->data == null )
+				continue;
+
+			// component may be removed by next command
+			auto	comp = storage->GetComponent( index, cmd->compId );
+
+			if ( comp.first != null )
+				std::memcpy( OUT comp.first, cmd->data, size_t(comp.second) );
+		}
+	}
+//-----------------------------------------------------------------------------
+
+
+
+/*
+=================================================
+	Local
+=================================================
+*/
+	EntityCommandBuffer&  ParallelCommandBuffer::Local ()
+	{
+		const ThreadID_t	id = std::this_thread::get_id();
+
+		EXLOCK( _guard );
+
+		for (auto& [tid, buf] : _buffers)
+		{
+			if ( tid == id )
+				return *buf;
+		}
+
+		return *_buffers.emplace_back( id, MakeUnique<EntityCommandBuffer>() ).second;
+	}
+
+/*
+=================================================
+	Apply
+=================================================
+*/
+	void  ParallelCommandBuffer::Apply (Registry &reg)
+	{
+		EXLOCK( _guard );
+
+		Array<EntityCommandBuffer*>	buffers;
+		buffers.reserve( _buffers.size() );
+
+		for (auto& item : _buffers) {
+			buffers.push_back( item.second.get() );
+		}
+
+		EntityCommandBuffer::_Apply( reg, buffers );
+
+		for (auto* buf : buffers) {
+			buf->Clear();
+		}
+	}
+
+/*
+=================================================
+	Clear
+----
+	buffers are kept to be reused in the next frame
+=================================================
+*/
+	void  ParallelCommandBuffer::Clear ()
+	{
+		EXLOCK( _guard );
+
+		for (auto& item : _buffers) {
+			item.second->Clear();
+		}
+	}
+
+
+}	// AE::ECS
@@ -0,0 +1,284 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+/*
+	Entity command buffer.
+
+	Records structural changes (create and destroy entities, add and remove components)
+	and applies them to the registry at a sync point, when no queries are executing.
+	Component data is copied into the linear allocator, so recording doesn't allocate memory for each command.
+
+	'Apply()' groups commands by entity and calculates final archetype of each entity,
+	then entities are grouped by source and destination archetype and moved together,
+	components are copied with one 'memcpy' per continuous range of source entities.
+	Only final changes are applied: component that was added and then removed in the same buffer is ignored
+	and messages are sent only for components that are actually added or removed.
+
+	Entities that are created by the command buffer have no ID until buffer is applied,
+	so they can not be used in other commands.
+
+	'ParallelCommandBuffer' contains separate command buffer for each thread,
+	it can be used to record commands inside 'Registry::ExecuteParallel()'.
+
+	Example:
+		ParallelCommandBuffer	cmdbuf;
+
+		reg.ExecuteParallel( query, [&cmdbuf] (ArrayView<Tuple< size_t, ReadAccess<EntityID>, ReadAccess<Health> >> chunks)
+			{
+				auto&	local = cmdbuf.Local();
+				for (auto& chunk : chunks)
+				for (size_t i = 0; i < chunk.Get<0>(); ++i) {
+					if ( chunk.Get<2>()[i].value <= 0 )
+						local.AddComponent<DeadTag>( chunk.Get<1>()[i] );
+				}
+			});
+
+		cmdbuf.Apply( reg );
+*/
+
+#pragma once
+
+#include "ecs-st/Core/Registry.h"
+#include "stl/Memory/LinearAllocator.h"
+
+namespace AE::ECS
+{
+
+	//
+	// Entity Command Buffer
+	//
+
+	class EntityCommandBuffer final : public Noncopyable
+	{
+		friend class ParallelCommandBuffer;
+
+	// types
+	private:
+		enum class ECommand : uint8_t
+		{
+			Create,
+			Destroy,
+			AddComponent,
+			RemoveComponent,
+		};
+
+		struct Command
+		{
+			EntityID		entity;			// invalid for 'Create'
+			ComponentID		compId;			// for 'AddComponent', 'RemoveComponent'
+			ECommand		type;
+			void *			data	= null;	// component data for 'AddComponent', 'CreateInfo' for 'Create'
+		};
+
+		struct CompData
+		{
+			ComponentID		id;
+			void *			data;			// null for tags
+		};
+
+		struct CreateInfo
+		{
+			ArchetypeDesc		desc;
+			HashVal				hash;
+			uint				count	= 0;
+			CompData *			comps	= null;
+		};
+
+		struct EntityMove;
+
+		using Index_t		= ArchetypeStorage::Index_t;
+		using Allocator_t	= LinearAllocator<>;
+		using Commands_t	= Array< Command >;
+		using CmdRefs_t		= ArrayView< Command const* >;
+
+
+	// variables
+	private:
+		Commands_t		_commands;
+		Allocator_t		_allocator;
+
+		DataRaceCheck	_drCheck;
+
+
+	// methods
+	public:
+		EntityCommandBuffer ();
+		~EntityCommandBuffer () {}
+
+			template <typename ...Components>
+			void  CreateEntity (const Components& ...comps);
+			void  DestroyEntity (EntityID entId);
+
+			template <typename T>
+			void  AddComponent (EntityID entId, const T &comp);
+
+			template <typename T>
+			void  AddComponent (EntityID entId);
+
+			template <typename T>
+			void  RemoveComponent (EntityID entId);
+			void  RemoveComponent (EntityID entId, ComponentID compId);
+
+		// applies all commands and clears buffer
+			void  Apply (Registry &reg);
+			void  Clear ();
+
+		ND_ size_t  Count ()	const	{ return _commands.size(); }
+		ND_ bool	Empty ()	const	{ return _commands.empty(); }
+
+
+	private:
+			template <typename T>
+		ND_ void*  _CopyComponent (const T &comp);
+
+			template <typename T>
+			void  _AddCreateComponent (INOUT CreateInfo &info, INOUT CompData* &dst, const T &comp);
+
+		static void  _Apply (Registry &reg, ArrayView<EntityCommandBuffer*> buffers);
+		static void  _MoveEntities (Registry &reg, CmdRefs_t commands, ArrayView<EntityMove> moves);
+		static void  _CreateEntities (Registry &reg, ArrayView<CreateInfo const*> infos);
+		static void  _WriteComponents (ArchetypeStorage* storage, Index_t index, CmdRefs_t commands);
+	};
+
+
+
+	//
+	// Parallel Command Buffer
+	//
+
+	class ParallelCommandBuffer final : public Noncopyable
+	{
+	// types
+	private:
+		using ThreadID_t	= std::thread::id;
+		using Buffers_t		= Array< Pair< ThreadID_t, UniquePtr<EntityCommandBuffer> >>;
+
+
+	// variables
+	private:
+		Threading::Mutex	_guard;
+		Buffers_t			_buffers;
+
+
+	// methods
+	public:
+		ParallelCommandBuffer () {}
+		~ParallelCommandBuffer () {}
+
+		// returns command buffer for current thread, reference is valid until 'Apply()' or 'Clear()'
+		ND_ EntityCommandBuffer&  Local ();
+
+		// applies commands from all threads in the order of buffer creation
+			void  Apply (Registry &reg);
+			void  Clear ();
+	};
+//-----------------------------------------------------------------------------
+
+
+
+/*
+=================================================
+	CreateEntity
+=================================================
+*/
+	template <typename ...Components>
+	inline void  EntityCommandBuffer::CreateEntity (const Components& ...comps)
+	{
+		STATIC_ASSERT( CountOf<Components...>() > 0 );
+		EXLOCK( _drCheck );
+
+		CreateInfo*	info = _allocator.Alloc<CreateInfo>();
+		CHECK_ERR( info != null, void());
+		PlacementNew<CreateInfo>( OUT info );
+
+		info->comps	= _allocator.Alloc<CompData>( CountOf<Components...>() );
+		CHECK_ERR( info->comps != null, void());
+
+		CompData*	dst = info->comps;
+		( _AddCreateComponent( INOUT *info, INOUT dst, comps ), ... );
+
+		info->hash = info->desc.GetHash();
+
+		auto&	cmd	= _commands.emplace_back();
+		cmd.type	= ECommand::Create;
+		cmd.data	= info;
+	}
+
+/*
+=================================================
+	_AddCreateComponent
+=================================================
+*/
+	template <typename T>
+	inline void  EntityCommandBuffer::_AddCreateComponent (INOUT CreateInfo &info, INOUT CompData* &dst, const T &comp)
+	{
+		ASSERT( not info.desc.Exists<T>() );
+
+		info.desc.Add<T>();
+		*dst = CompData{ ComponentTypeInfo<T>::id, _CopyComponent( comp )};
+
+		++dst;
+		++info.count;
+	}
+
+/*
+=================================================
+	AddComponent
+=================================================
+*/
+	template <typename T>
+	inline void  EntityCommandBuffer::AddComponent (EntityID entId, const T &comp)
+	{
+		EXLOCK( _drCheck );
+
+		auto&	cmd	= _commands.emplace_back();
+		cmd.type	= ECommand::AddComponent;
+		cmd.entity	= entId;
+		cmd.compId	= ComponentTypeInfo<T>::id;
+		cmd.data	= _CopyComponent( comp );
+	}
+
+	template <typename T>
+	inline void  EntityCommandBuffer::AddComponent (EntityID entId)
+	{
+		return AddComponent( entId, T{} );
+	}
+
+/*
+=================================================
+	RemoveComponent
+=================================================
+*/
+	template <typename T>
+	inline void  EntityCommandBuffer::RemoveComponent (EntityID entId)
+	{
+		return RemoveComponent( entId, ComponentTypeInfo<T>::id );
+	}
+
+/*
+=================================================
+	_CopyComponent
+----
+	components are copied with 'memcpy' in registry too
+=================================================
+*/
+	template <typename T>
+	inline void*  EntityCommandBuffer::_CopyComponent (const T &comp)
+	{
+		if constexpr( IsEmpty<T> )
+		{
+			Unused( comp );
+			return null;
+		}
+		else
+		{
+			STATIC_ASSERT( std::is_trivially_copyable_v<T> );
+
+			T*	ptr = _allocator.Alloc<T>();
+			CHECK_ERR( ptr != null );
+
+			std::memcpy( OUT ptr, &comp, sizeof(T) );
+			return ptr;
+		}
+	}
+
+
+}	// AE::ECS
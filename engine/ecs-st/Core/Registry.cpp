@@ -119,18 +119,15 @@ namespace AE::ECS
 			#if AE_ECS_ENABLE_DEFAULT_MESSAGES
 			{
 				auto	comp_ids	= storage->GetComponentIDs();
-				auto	comp_sizes	= storage->GetComponentSizes();
-				auto	comp_aligns	= storage->GetComponentAligns();
-				auto	comp_data	= storage->GetComponentData();
 
 				for (size_t i = 0; i < comp_ids.size(); ++i)
 				{
-					size_t	comp_size = size_t(comp_sizes[i]);
+					auto	comp = storage->GetComponent( index, comp_ids[i] );
 
-					if ( comp_size > 0 )
+					if ( comp.first != null )
 					{
-						uint8_t*	comp_ptr = Cast<uint8_t>( comp_data[i] + BytesU{comp_size} * size_t(index) );
-						_messages.Add<MsgTag_RemovedComponent>( entId, comp_ids[i], ArrayView<uint8_t>{ comp_ptr, comp_size });
+						uint8_t*	comp_ptr = Cast<uint8_t>( comp.first );
+						_messages.Add<MsgTag_RemovedComponent>( entId, comp_ids[i], ArrayView<uint8_t>{ comp_ptr, size_t(comp.second) });
 					}
 					else
 						_messages.Add<MsgTag_RemovedComponent>( entId, comp_ids[i] );
@@ -155,10 +152,12 @@ namespace AE::ECS
 
 /*
 =================================================
-	_AddEntity
+	_GetStorage
+----
+	returns existing storage or creates new
 =================================================
 */
-	void  Registry::_AddEntity (const Archetype &arch, EntityID entId, OUT ArchetypeStorage* &outStorage, OUT Index_t &index)
+	ArchetypeStorage*  Registry::_GetStorage (const Archetype &arch)
 	{
 		auto					[iter, inserted] = _archetypes.insert({ arch, ArchetypeStoragePtr{} });
 		Archetype const&		key				 = iter->first;
@@ -170,22 +169,84 @@ namespace AE::ECS
 
 			_OnNewArchetype( &*iter );
 		}
+		return storage.get();
+	}
+	
+/*
+=================================================
+	_GetAddTransition
+----
+	storage pointers are stable until '_archetypes' is cleared,
+	so transitions are cached in both storages
+=================================================
+*/
+	ArchetypeStorage*  Registry::_GetAddTransition (ArchetypeStorage* srcStorage, ComponentID compId)
+	{
+		if ( not srcStorage )
+		{
+			ArchetypeDesc	desc;
+			desc.Add( compId );
+			return _GetStorage( Archetype{desc} );
+		}
+
+		if ( auto* dst = srcStorage->GetAddEdge( compId ); dst )
+			return dst;
 		
+		ArchetypeDesc	desc = srcStorage->GetArchetype().Desc();
+		desc.Add( compId );
+
+		ArchetypeStorage*	dst = _GetStorage( Archetype{desc} );
+
+		srcStorage->SetAddEdge( compId, dst );
+		dst->SetRemoveEdge( compId, srcStorage );
+		return dst;
+	}
+	
+/*
+=================================================
+	_GetRemoveTransition
+=================================================
+*/
+	ArchetypeStorage*  Registry::_GetRemoveTransition (ArchetypeStorage* srcStorage, ComponentID compId)
+	{
+		ASSERT( srcStorage );
+
+		if ( auto* dst = srcStorage->GetRemoveEdge( compId ); dst )
+			return dst;
+		
+		ArchetypeDesc	desc = srcStorage->GetArchetype().Desc();
+		desc.Remove( compId );
+
+		ArchetypeStorage*	dst = _GetStorage( Archetype{desc} );
+
+		srcStorage->SetRemoveEdge( compId, dst );
+		dst->SetAddEdge( compId, srcStorage );
+		return dst;
+	}
+
+/*
+=================================================
+	_AddEntity
+=================================================
+*/
+	void  Registry::_AddEntity (ArchetypeStorage* storage, EntityID entId, OUT Index_t &index)
+	{
 		ASSERT( not storage->IsLocked() );
 
-		if ( storage->Add( entId, OUT index ))
+		if ( not storage->Add( entId, OUT index ))
 		{
-			outStorage = storage.get();
-			_entities.SetArchetype( entId, storage.get(), index );
-			return;
+			_IncreaseStorageSize( storage, 1 );
+		
+			CHECK( storage->Add( entId, OUT index ));
 		}
 
-		_IncreaseStorageSize( storage.get(), 1 );
-		
-		CHECK( storage->Add( entId, OUT index ));
-		_entities.SetArchetype( entId, storage.get(), index );
-		
-		outStorage = storage.get();
+		_entities.SetArchetype( entId, storage, index );
+	}
+
+	void  Registry::_AddEntity (const Archetype &arch, EntityID entId, OUT ArchetypeStorage* &outStorage, OUT Index_t &index)
+	{
+		outStorage = _GetStorage( arch );
+		_AddEntity( outStorage, entId, OUT index );
 	}
 	
 	void  Registry::_AddEntity (const Archetype &arch, EntityID entId)
@@ -200,10 +261,10 @@ namespace AE::ECS
 	_MoveEntity
 =================================================
 */
-	void  Registry::_MoveEntity (const Archetype &arch, EntityID entId, ArchetypeStorage* srcStorage, Index_t srcIndex,
-								 OUT ArchetypeStorage* &dstStorage, OUT Index_t &dstIndex)
+	void  Registry::_MoveEntity (ArchetypeStorage* dstStorage, EntityID entId, ArchetypeStorage* srcStorage, Index_t srcIndex,
+								 OUT Index_t &dstIndex)
 	{
-		_AddEntity( arch, entId, OUT dstStorage, OUT dstIndex );
+		_AddEntity( dstStorage, entId, OUT dstIndex );
 
 		if ( srcStorage )
 		{
@@ -246,22 +307,11 @@ namespace AE::ECS
 
 		ArchetypeStorage*	src_storage		= null;
 		Index_t				src_index;
-		ArchetypeDesc		desc;
 
 		_entities.GetArchetype( entId, OUT src_storage, OUT src_index );
 		
-		if ( not src_storage )
+		if ( not src_storage or not src_storage->HasComponent( compId ))
 			return false;
-		
-		// get new archetype
-		{
-			desc = src_storage->GetArchetype().Desc();
-			
-			if ( not desc.Exists( compId ))
-				return false;
-
-			desc.Remove( compId );
-		}
 
 		ASSERT( not src_storage->IsLocked() );
 
@@ -275,10 +325,10 @@ namespace AE::ECS
 		#endif
 
 		// add entity to new archetype
-		ArchetypeStorage*	dst_storage		= null;
+		ArchetypeStorage*	dst_storage		= _GetRemoveTransition( src_storage, compId );
 		Index_t				dst_index;
 
-		_MoveEntity( Archetype{desc}, entId, src_storage, src_index, OUT dst_storage, OUT dst_index );
+		_MoveEntity( dst_storage, entId, src_storage, src_index, OUT dst_index );
 		return true;
 	}
 	
@@ -325,32 +375,20 @@ namespace AE::ECS
 			{
 				_IncreaseStorageSize( dst_storage.get(), src_storage->Count() );
 
-				auto		comp_ids	= dst_storage->GetComponentIDs();
-				auto		comp_sizes	= dst_storage->GetComponentSizes();
-				auto		comp_data	= dst_storage->GetComponentData();
-				size_t		count		= src_storage->Count();
-
-				Index_t		start;
-				CHECK( dst_storage->AddEntities( ArrayView<EntityID>{ src_storage->GetEntities(), count }, OUT start ));
+				const size_t	count	= src_storage->Count();
+				const Index_t	start	= Index_t(dst_storage->Count());
 
-				for (size_t i = 0; i < comp_ids.size(); ++i)
+				for (size_t c = 0, cnt = src_storage->ChunkCount(); c < cnt; ++c)
 				{
-					ComponentID	comp_id		= comp_ids[i];
-					size_t		comp_size	= size_t(comp_sizes[i]);
-					const auto*	src			= src_storage->GetComponents( comp_id );
-					auto*		dst			= comp_data[i];
-
-					if ( (src != null) & (dst != null) )
-					{
-						dst = dst + BytesU{comp_size * size_t(start)};
-
-						std::memcpy( OUT dst, src, comp_size * count );
-					}
+					Index_t		first;
+					CHECK( dst_storage->AddEntities( ArrayView<EntityID>{ src_storage->GetEntities( c ), src_storage->ChunkEntityCount( c )}, OUT first ));
 				}
 
+				dst_storage->CopyComponents( start, *src_storage, Index_t(0), count );
+
 				for (size_t i = 0; i < count; ++i)
 				{
-					_entities.SetArchetype( src_storage->GetEntities()[i], dst_storage.get(), Index_t(size_t(start) + i) );
+					_entities.SetArchetype( src_storage->GetEntity( Index_t(i) ), dst_storage.get(), Index_t(size_t(start) + i) );
 				}
 			}
 
@@ -359,23 +397,26 @@ namespace AE::ECS
 			{
 				auto	comp_ids	= src_storage->GetComponentIDs();
 				auto	comp_sizes	= src_storage->GetComponentSizes();
-				auto	comp_data	= src_storage->GetComponentData();
-				auto*	ent			= src_storage->GetEntities();
-				size_t	count		= src_storage->Count();
 				
 				for (size_t i = 0; i < comp_ids.size(); ++i)
 				{
 					ComponentID	comp_id		= comp_ids[i];
-					size_t		comp_size	= count * size_t(comp_sizes[i]);
 				
 					if ( removeComps.Exists( comp_id ) and
 						 _messages.HasListener<MsgTag_RemovedComponent>( comp_id ))
 					{
-						if ( comp_size > 0 )
-							_messages.AddMulti<MsgTag_RemovedComponent>( comp_id, ArrayView<EntityID>{ ent, count },
-																		 ArrayView<uint8_t>{ Cast<uint8_t>(comp_data[i]), comp_size });
-						else
-							_messages.AddMulti<MsgTag_RemovedComponent>( comp_id, ArrayView<EntityID>{ ent, count });
+						for (size_t c = 0, cnt = src_storage->ChunkCount(); c < cnt; ++c)
+						{
+							auto*	ent			= src_storage->GetEntities( c );
+							size_t	count		= src_storage->ChunkEntityCount( c );
+							size_t	comp_size	= count * size_t(comp_sizes[i]);
+
+							if ( comp_size > 0 )
+								_messages.AddMulti<MsgTag_RemovedComponent>( comp_id, ArrayView<EntityID>{ ent, count },
+																			 ArrayView<uint8_t>{ Cast<uint8_t>(src_storage->GetComponents( c, comp_id )), comp_size });
+							else
+								_messages.AddMulti<MsgTag_RemovedComponent>( comp_id, ArrayView<EntityID>{ ent, count });
+						}
 					}
 				}
 			}
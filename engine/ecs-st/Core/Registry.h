@@ -6,6 +6,7 @@
 #include "ecs-st/Core/EntityPool.h"
 #include "ecs-st/Core/MessageBuilder.h"
 #include "ecs-st/Core/ComponentAccessTypes.h"
+#include "threading/TaskSystem/ParallelFor.h"
 
 namespace AE::ECS
 {
@@ -28,6 +29,9 @@ namespace AE::ECS
 
 	class Registry final : public std::enable_shared_from_this< Registry >
 	{
+		friend class SystemGraph;			// can call '_Execute()' in worker threads
+		friend class EntityCommandBuffer;	// applies structural changes in batches
+
 	// types
 	public:
 		DEBUG_ONLY(
@@ -193,6 +197,11 @@ namespace AE::ECS
 			template <typename Fn>
 			void  Execute (QueryID query, Fn &&fn);
 
+			// processes chunks of matching storages on worker threads, each task gets about 'ECS_Config::ParallelExecChunkSize' entities,
+			// single components are shared between all threads so only read access is allowed ('T const&' or 'T const*'), 'fn' must not modify registry.
+			template <typename Fn>
+			void  ExecuteParallel (QueryID query, Fn &&fn);
+
 			template <typename Fn>
 			void  Enque (QueryID query, Fn &&fn);
 			
@@ -224,8 +233,13 @@ namespace AE::ECS
 			bool  _RemoveEntity (EntityID entId);
 			void  _AddEntity (const Archetype &arch, EntityID entId, OUT ArchetypeStorage* &storage, OUT Index_t &index);
 			void  _AddEntity (const Archetype &arch, EntityID entId);
-			void  _MoveEntity (const Archetype &arch, EntityID entId, ArchetypeStorage* srcStorage, Index_t srcIndex,
-							   OUT ArchetypeStorage* &dstStorage, OUT Index_t &dstIndex);
+			void  _AddEntity (ArchetypeStorage* storage, EntityID entId, OUT Index_t &index);
+			void  _MoveEntity (ArchetypeStorage* dstStorage, EntityID entId, ArchetypeStorage* srcStorage, Index_t srcIndex,
+							   OUT Index_t &dstIndex);
+
+		ND_ ArchetypeStorage*  _GetStorage (const Archetype &arch);
+		ND_ ArchetypeStorage*  _GetAddTransition (ArchetypeStorage* srcStorage, ComponentID compId);
+		ND_ ArchetypeStorage*  _GetRemoveTransition (ArchetypeStorage* srcStorage, ComponentID compId);
 
 			void  _OnNewArchetype (ArchetypePair_t *);
 			
@@ -236,20 +250,32 @@ namespace AE::ECS
 		ND_ static bool  _IsArchetypeSupported (const Archetype &arch);
 
 			template <typename ...Args>
-		ND_ static Tuple<size_t, Args...>  _GetChunk (ArchetypeStorage* storage, const TypeList<Args...> *);
+		ND_ static Tuple<size_t, Args...>  _GetChunk (ArchetypeStorage* storage, size_t chunkIdx, size_t offset, size_t count, const TypeList<Args...> *);
 
 			template <typename Fn, typename Chunk, typename ...Types>
 			void _WithSingleComponents (Fn &&fn, ArrayView<Chunk> chunks, const Tuple<Types...> *);
 
 			template <typename T>
 		ND_ decltype(auto)  _GetSingleComponent ();
+		
+			template <typename T>
+		ND_ Ptr<T>  _FindSingleComponent () const;
 
 		
+			template <typename Fn>
+			void  _Execute (QueryID query, Fn &&fn);
+
 			template <typename Fn>
 			void  _Execute_v1 (QueryID query, Fn &&fn);
 
 			template <typename Fn, typename ...Args>
 			void  _Execute_v2 (QueryID query, Fn &&fn, const TypeList<Args...>*);
+			
+			template <typename Fn>
+			void  _ExecuteParallel_v1 (QueryID query, Fn &&fn);
+
+			template <typename Fn, typename ...Args>
+			void  _ExecuteParallel_v2 (QueryID query, Fn &&fn, const TypeList<Args...>*);
 	};
 	
 
@@ -420,7 +446,6 @@ DEBUG_ONLY(
 
 		ArchetypeStorage*	src_storage	= null;
 		Index_t				src_index;
-		ArchetypeDesc		desc;
 		
 		_entities.GetArchetype( entId, OUT src_storage, OUT src_index );
 
@@ -428,26 +453,20 @@ DEBUG_ONLY(
 		{
 			ASSERT( not src_storage->IsLocked() );
 
-			if ( auto* comps = src_storage->GetComponents<T>(); comps )
+			if ( auto* comp = src_storage->GetComponent<T>( src_index ); comp )
 			{
 				// already exists
-				return comps[ size_t(src_index) ];
-			}
-			else
-			{
-				desc = src_storage->GetArchetype().Desc();
+				return *comp;
 			}
 		}
 
-		desc.Add<T>();
-
 		#if AE_ECS_ENABLE_DEFAULT_MESSAGES
 			_messages.Add<MsgTag_AddedComponent>( entId, ComponentTypeInfo<T>::id );
 		#endif
 
-		ArchetypeStorage*	dst_storage	= null;
+		ArchetypeStorage*	dst_storage	= _GetAddTransition( src_storage, ComponentTypeInfo<T>::id );
 		Index_t				dst_index;
-		_MoveEntity( Archetype{desc}, entId, src_storage, src_index, OUT dst_storage, OUT dst_index );
+		_MoveEntity( dst_storage, entId, src_storage, src_index, OUT dst_index );
 		
 		T* result = dst_storage->GetComponent<T>( dst_index );
 
@@ -467,7 +486,6 @@ DEBUG_ONLY(
 
 		ArchetypeStorage*	src_storage	= null;
 		Index_t				src_index;
-		ArchetypeDesc		desc;
 		
 		_entities.GetArchetype( entId, OUT src_storage, OUT src_index );
 
@@ -480,21 +498,15 @@ DEBUG_ONLY(
 				// already exists
 				return;
 			}
-			else
-			{
-				desc = src_storage->GetArchetype().Desc();
-			}
 		}
 
-		desc.Add<T>();
-
 		#if AE_ECS_ENABLE_DEFAULT_MESSAGES
 			_messages.Add<MsgTag_AddedComponent>( entId, ComponentTypeInfo<T>::id );
 		#endif
 
-		ArchetypeStorage*	dst_storage	= null;
+		ArchetypeStorage*	dst_storage	= _GetAddTransition( src_storage, ComponentTypeInfo<T>::id );
 		Index_t				dst_index;
-		_MoveEntity( Archetype{desc}, entId, src_storage, src_index, OUT dst_storage, OUT dst_index );
+		_MoveEntity( dst_storage, entId, src_storage, src_index, OUT dst_index );
 	}
 
 /*
@@ -515,9 +527,10 @@ DEBUG_ONLY(
 */
 	inline void  Registry::_DecreaseStorageSize (ArchetypeStorage *storage)
 	{
-		if ( storage->Count()*4 < storage->Capacity() )
+		// keep one empty chunk to avoid allocations when entities are added and removed repeatedly
+		if ( storage->Count() + storage->ChunkCapacity()*2 <= storage->Capacity() )
 		{
-			storage->Reserve( Max( ECS_Config::InitialtStorageSize, storage->Count()*2 ));
+			storage->Reserve( storage->Count() + storage->ChunkCapacity() );
 		}
 	}
 	
@@ -530,9 +543,10 @@ DEBUG_ONLY(
 	{
 		const size_t	new_size = storage->Count() + addCount;
 
+		// only new chunks are allocated
 		if ( new_size > storage->Capacity() )
 		{
-			storage->Reserve( Min( (new_size*3 + new_size-1) / 2, storage->Capacity()*2 ));
+			storage->Reserve( new_size );
 		}
 	}
 
@@ -987,6 +1001,25 @@ DEBUG_ONLY(
 			STATIC_ASSERT( IsSpecializationOf< SCTuple, Tuple >);
 		};
 
+		template <typename T>
+		struct SC_IsReadOnly;
+
+		template <typename T>
+		struct SC_IsReadOnly< T* > {
+			static constexpr bool	value = IsConst<T>;
+		};
+
+		template <typename T>
+		struct SC_IsReadOnly< T& > {
+			static constexpr bool	value = IsConst<T>;
+		};
+
+		template <typename ...Types>
+		static constexpr bool  SC_AllReadOnly (const Tuple<Types...> *) {
+			return (SC_IsReadOnly<Types>::value and ...);
+		}
+
+
 		template <typename Fn>
 		struct SystemFnInfo
 		{
@@ -1037,12 +1070,23 @@ DEBUG_ONLY(
 */
 	template <typename Fn>
 	inline void  Registry::Execute (QueryID query, Fn &&fn)
+	{
+		EXLOCK( _drCheck );
+
+		return _Execute( query, std::forward<Fn>(fn) );
+	}
+	
+/*
+=================================================
+	_Execute
+=================================================
+*/
+	template <typename Fn>
+	inline void  Registry::_Execute (QueryID query, Fn &&fn)
 	{
 		using Args = typename FunctionInfo<Fn>::args;
 		STATIC_ASSERT( Args::Count > 0 );
 
-		EXLOCK( _drCheck );
-
 		if constexpr( IsSpecializationOf< typename Args::template Get<0>, ArrayView >)
 			return _Execute_v1( query, std::forward<Fn>(fn) );
 		else
@@ -1081,7 +1125,11 @@ DEBUG_ONLY(
 			auto&	storage	= ptr->second;
 			storage->Lock();
 			storages.emplace_back( storage.get() );
-			chunks.emplace_back( _GetChunk( storage.get(), (const CompOnly *)null ));
+
+			for (size_t i = 0, cnt = storage->ChunkCount(); i < cnt; ++i)
+			{
+				chunks.emplace_back( _GetChunk( storage.get(), i, 0, storage->ChunkEntityCount(i), (const CompOnly *)null ));
+			}
 		}
 
 		_WithSingleComponents( std::move(fn), ArrayView<Chunk>{chunks.data(), chunks.size()}, (const SCTuple*)null );
@@ -1216,6 +1264,122 @@ DEBUG_ONLY(
 				}
 			});
 	}
+	
+/*
+=================================================
+	ExecuteParallel
+=================================================
+*/
+	template <typename Fn>
+	inline void  Registry::ExecuteParallel (QueryID query, Fn &&fn)
+	{
+		using Args = typename FunctionInfo<Fn>::args;
+		STATIC_ASSERT( Args::Count > 0 );
+
+		EXLOCK( _drCheck );
+
+		if constexpr( IsSpecializationOf< typename Args::template Get<0>, ArrayView >)
+			return _ExecuteParallel_v1( query, std::forward<Fn>(fn) );
+		else
+			return _ExecuteParallel_v2( query, std::forward<Fn>(fn), (const Args*)null );
+	}
+	
+/*
+=================================================
+	_ExecuteParallel_v1
+=================================================
+*/
+	template <typename Fn>
+	inline void  Registry::_ExecuteParallel_v1 (QueryID query, Fn &&fn)
+	{
+		using Info		= _reg_detail_::SystemFnInfo< Fn >;
+		using Chunk		= typename Info::Chunk;
+		using CompOnly	= typename Info::CompOnly;
+		using SCTuple	= typename Info::SCTuple;
+				
+		// single components are shared between all tasks
+		STATIC_ASSERT( _reg_detail_::SC_AllReadOnly( (const SCTuple*)null ), "only read access to single components is allowed in parallel query" );
+
+		#ifdef AE_ECS_VALIDATE_SYSTEM_FN
+			_reg_detail_::CheckForDuplicates< CompOnly >();
+			_reg_detail_::SC_CheckForDuplicates< TypeList<SCTuple> >();
+		#endif
+
+		Array<ArchetypeStorage*>	storages;
+		Array<Chunk>				chunks;
+		const auto&					q_data			= _queries[ query.Index() ];
+		size_t						entity_count	= 0;
+
+		CHECK( not q_data.locked );
+		q_data.locked = true;
+				
+		for (auto* ptr : q_data.archetypes)
+		{
+			ASSERT( _IsArchetypeSupported< CompOnly, 0 >( ptr->first ));
+			
+			auto&	storage	= ptr->second;
+			storage->Lock();
+			storages.emplace_back( storage.get() );
+
+			// storage chunk is split only if it contains more than 'ParallelExecChunkSize' entities
+			const size_t	range_size = Min( storage->ChunkCapacity(), size_t(ECS_Config::ParallelExecChunkSize) );
+
+			for (size_t i = 0, cnt = storage->ChunkCount(); i < cnt; ++i)
+			{
+				const size_t	count = storage->ChunkEntityCount(i);
+				entity_count += count;
+
+				for (size_t offset = 0; offset < count; offset += range_size)
+				{
+					chunks.emplace_back( _GetChunk( storage.get(), i, offset, Min( range_size, count - offset ), (const CompOnly *)null ));
+				}
+			}
+		}
+
+		// chunk capacity depends on component sizes and is usually less than 'ParallelExecChunkSize',
+		// so small chunks are grouped to keep task overhead small
+		const size_t	avg_range	= Max( size_t(1), entity_count / Max( size_t(1), chunks.size() ));
+		const size_t	grain		= Max( size_t(1), ECS_Config::ParallelExecChunkSize / avg_range );
+
+		// single components are acquired in current thread
+		const auto	parallel_fn = [&fn, grain] (ArrayView<Chunk> allChunks, const auto& ...singleComps)
+		{
+			Threading::ParallelFor( 0, allChunks.size(), grain,
+				[&fn, allChunks, &singleComps...] (size_t begin, size_t end)
+				{
+					fn( allChunks.section( begin, end - begin ), singleComps... );
+				});
+		};
+		_WithSingleComponents( parallel_fn, ArrayView<Chunk>{chunks.data(), chunks.size()}, (const SCTuple*)null );
+				
+		for (auto* st : storages)
+		{
+			st->Unlock();
+		}
+		
+		q_data.locked = false;
+	}
+	
+/*
+=================================================
+	_ExecuteParallel_v2
+=================================================
+*/
+	template <typename Fn, typename ...Args>
+	inline void  Registry::_ExecuteParallel_v2 (QueryID query, Fn &&fn, const TypeList<Args...>*)
+	{
+		_ExecuteParallel_v1( query,
+			[&fn] (ArrayView<Tuple< size_t, _reg_detail_::MapCompType<Args>... >> chunks)
+			{
+				for (auto& chunk : chunks)
+				{
+					for (size_t i = 0, cnt = chunk.template Get<0>(); i < cnt; ++i)
+					{
+						fn( _reg_detail_::GetStorageElement<Args>::template Get( chunk, i )... );
+					}
+				}
+			});
+	}
 //-----------------------------------------------------------------------------
 	
 #ifdef AE_DEBUG
@@ -1364,47 +1528,49 @@ DEBUG_ONLY(
 		template <>
 		struct GetStorageComponent< ReadAccess<EntityID> >
 		{
-			static ReadAccess<EntityID>  Get (ArchetypeStorage* storage) {
-				return ReadAccess<EntityID>{ storage->GetEntities() };
+			static ReadAccess<EntityID>  Get (ArchetypeStorage* storage, size_t chunkIdx, size_t offset) {
+				return ReadAccess<EntityID>{ storage->GetEntities( chunkIdx ) + offset };
 			}
 		};
 
 		template <typename T>
 		struct GetStorageComponent< WriteAccess<T> >
 		{
-			static WriteAccess<T>  Get (ArchetypeStorage* storage) {
-				return WriteAccess<T>{ storage->GetComponents<T>() };
+			static WriteAccess<T>  Get (ArchetypeStorage* storage, size_t chunkIdx, size_t offset) {
+				return WriteAccess<T>{ storage->GetComponents<T>( chunkIdx ) + offset };
 			}
 		};
 		
 		template <typename T>
 		struct GetStorageComponent< ReadAccess<T> >
 		{
-			static ReadAccess<T>  Get (ArchetypeStorage* storage) {
-				return ReadAccess<T>{ storage->GetComponents<T>() };
+			static ReadAccess<T>  Get (ArchetypeStorage* storage, size_t chunkIdx, size_t offset) {
+				return ReadAccess<T>{ storage->GetComponents<T>( chunkIdx ) + offset };
 			}
 		};
 
 		template <typename T>
 		struct GetStorageComponent< OptionalWriteAccess<T> >
 		{
-			static OptionalWriteAccess<T>  Get (ArchetypeStorage* storage) {
-				return OptionalWriteAccess<T>{ storage->GetComponents<T>() };
+			static OptionalWriteAccess<T>  Get (ArchetypeStorage* storage, size_t chunkIdx, size_t offset) {
+				T*	ptr = storage->GetComponents<T>( chunkIdx );
+				return OptionalWriteAccess<T>{ ptr ? ptr + offset : null };
 			}
 		};
 		
 		template <typename T>
 		struct GetStorageComponent< OptionalReadAccess<T> >
 		{
-			static OptionalReadAccess<T>  Get (ArchetypeStorage* storage) {
-				return OptionalReadAccess<T>{ storage->GetComponents<T>() };
+			static OptionalReadAccess<T>  Get (ArchetypeStorage* storage, size_t chunkIdx, size_t offset) {
+				T const*	ptr = storage->GetComponents<T>( chunkIdx );
+				return OptionalReadAccess<T>{ ptr ? ptr + offset : null };
 			}
 		};
 		
 		template <typename ...Types>
 		struct GetStorageComponent< Subtractive<Types...> >
 		{
-			static Subtractive<Types...>  Get (ArchetypeStorage*) {
+			static Subtractive<Types...>  Get (ArchetypeStorage*, size_t, size_t) {
 				return {};
 			}
 		};
@@ -1412,7 +1578,7 @@ DEBUG_ONLY(
 		template <typename ...Types>
 		struct GetStorageComponent< Require<Types...> >
 		{
-			static Require<Types...>  Get (ArchetypeStorage*) {
+			static Require<Types...>  Get (ArchetypeStorage*, size_t, size_t) {
 				return {};
 			}
 		};
@@ -1420,7 +1586,7 @@ DEBUG_ONLY(
 		template <typename ...Types>
 		struct GetStorageComponent< RequireAny<Types...> >
 		{
-			static RequireAny<Types...>  Get (ArchetypeStorage*) {
+			static RequireAny<Types...>  Get (ArchetypeStorage*, size_t, size_t) {
 				return {};
 			}
 		};
@@ -1433,10 +1599,11 @@ DEBUG_ONLY(
 =================================================
 */
 	template <typename ...Args>
-	inline Tuple<size_t, Args...>  Registry::_GetChunk (ArchetypeStorage* storage, const TypeList<Args...> *)
+	inline Tuple<size_t, Args...>  Registry::_GetChunk (ArchetypeStorage* storage, size_t chunkIdx, size_t offset, size_t count, const TypeList<Args...> *)
 	{
-		return MakeTuple(	storage->Count(),
-							_reg_detail_::GetStorageComponent<Args>::Get( storage )... );
+		ASSERT( offset + count <= storage->ChunkEntityCount( chunkIdx ));
+		return MakeTuple(	count,
+							_reg_detail_::GetStorageComponent<Args>::Get( storage, chunkIdx, offset )... );
 	}
 	
 /*
@@ -1447,17 +1614,22 @@ DEBUG_ONLY(
 	template <typename T>
 	inline decltype(auto)  Registry::_GetSingleComponent ()
 	{
+		// '_drCheck' is not locked here, function may be called from 'SystemGraph' tasks
+
 		if constexpr( IsPointer<T> )
 		{
 			using A = std::remove_pointer_t<T>;
-			return GetSingleComponent<A>();		// can be null
+			return _FindSingleComponent<A>();	// can be null
 		}
 		else
 		if constexpr( std::is_reference_v<T> )
 		{
 			using A = std::remove_reference_t<T>;
-			ASSERT( GetSingleComponent<A>() );	// TODO: component must be created
-			return AssignSingleComponent<A>();
+			if ( auto ptr = _FindSingleComponent<A>(); ptr )
+				return *ptr;
+
+			ASSERT( !"single component must be created" );
+			return AssignSingleComponent< std::remove_const_t<A> >();
 		}
 		else
 		{
@@ -1466,6 +1638,20 @@ DEBUG_ONLY(
 		}
 	}
 	
+/*
+=================================================
+	_FindSingleComponent
+=================================================
+*/
+	template <typename T>
+	inline Ptr<T>  Registry::_FindSingleComponent () const
+	{
+		auto	iter = _singleComponents.find( TypeIdOf<T>() );
+		return	iter != _singleComponents.end() ?
+					Cast<T>( iter->second.data ) :
+					null;
+	}
+	
 /*
 =================================================
 	_WithSingleComponents
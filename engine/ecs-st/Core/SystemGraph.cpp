@@ -0,0 +1,208 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "ecs-st/Core/SystemGraph.h"
+
+namespace AE::ECS
+{
+	using namespace AE::Threading;
+
+	//
+	// System Task
+	//
+
+	class SystemGraph::SystemTask final : public IAsyncTask
+	{
+	private:
+		SystemGraph &	_owner;
+		const uint		_index;
+
+	public:
+		SystemTask (SystemGraph &owner, uint index) :
+			IAsyncTask{ EThread::Worker }, _owner{ owner }, _index{ index }
+		{}
+
+		void  Run () override
+		{
+			ASSERT( _owner._registry );
+			_owner._systems[_index].execute( *_owner._registry );
+		}
+
+		NtStringView  DbgName () const override	{ return _owner._systems[_index].name; }
+	};
+//-----------------------------------------------------------------------------
+
+
+namespace {
+/*
+=================================================
+	HasAny
+=================================================
+*/
+	ND_ static bool  HasAny (ArrayView<TypeId> lhs, ArrayView<TypeId> rhs)
+	{
+		for (auto& id : lhs)
+		{
+			for (auto& other : rhs)
+			{
+				if ( id == other )
+					return true;
+			}
+		}
+		return false;
+	}
+}
+
+/*
+=================================================
+	SystemAccess::Conflicts
+=================================================
+*/
+	bool  SystemGraph::SystemAccess::Conflicts (const SystemAccess &other) const
+	{
+		return	write.Any( other.read )								or
+				write.Any( other.write )							or
+				other.write.Any( read )								or
+				HasAny( singleWrite, other.singleRead )				or
+				HasAny( singleWrite, other.singleWrite )			or
+				HasAny( other.singleWrite, singleRead );
+	}
+//-----------------------------------------------------------------------------
+
+
+/*
+=================================================
+	destructor
+=================================================
+*/
+	SystemGraph::~SystemGraph ()
+	{
+		Clear();
+	}
+
+/*
+=================================================
+	Build
+=================================================
+*/
+	bool  SystemGraph::Build ()
+	{
+		CHECK_ERR( not _registry );
+
+		_graph.Clear();
+		_built = false;
+
+		for (uint i = 0; i < _systems.size(); ++i)
+		{
+			auto&	sys = _systems[i];
+
+			if ( sys.name.empty() )
+				sys.name = "system "s << ToString( i );
+
+			// systems with the same query can not be executed concurrently, because query is locked during execution
+			sys.dependsOn.clear();
+			for (uint j = 0; j < i; ++j)
+			{
+				auto&	prev = _systems[j];
+
+				if ( prev.query == sys.query or prev.access.Conflicts( sys.access ))
+					sys.dependsOn.push_back( j );
+			}
+
+			// dependencies are used only to keep order, so canceled system doesn't cancel dependent systems
+			const uint	index = _graph.Add( MakeTask<SystemTask>( *this, i ), sys.dependsOn, false );
+			CHECK_ERR( index == i );
+		}
+
+		_built = true;
+		return true;
+	}
+
+/*
+=================================================
+	Execute
+=================================================
+*/
+	bool  SystemGraph::Execute (Registry &reg)
+	{
+		CHECK_ERR( not _registry );
+
+		if ( not _built )
+			CHECK_ERR( Build() );
+
+		if ( _systems.empty() )
+			return true;
+
+		// systems must not change registry, so it is locked by current thread until all systems are complete
+		EXLOCK( reg._drCheck );
+
+		for (auto& sys : _systems) {
+			sys.prepare( reg );
+		}
+
+		_registry = &reg;
+
+		if ( not _graph.Run() )
+		{
+			_registry = null;
+			RETURN_ERR( "failed to run system graph" );
+		}
+
+		// current thread helps to execute systems
+		CHECK_ERR( _graph.Wait() );
+
+		_registry = null;
+		return true;
+	}
+
+/*
+=================================================
+	Clear
+=================================================
+*/
+	void  SystemGraph::Clear ()
+	{
+		CHECK_ERR( not _registry, void() );
+
+		_graph.Clear();
+		_systems.clear();
+		_built = false;
+	}
+
+/*
+=================================================
+	ToGraphviz
+=================================================
+*/
+	String  SystemGraph::ToGraphviz () const
+	{
+		String	str;
+		str << "digraph SystemGraph {\n"
+			<< "\tnode [shape=box];\n";
+
+		for (uint i = 0; i < _systems.size(); ++i)
+		{
+			auto&	sys = _systems[i];
+
+			str << "\ts" << ToString( i ) << " [label=\"";
+			for (char c : sys.name) {
+				if ( c == '"' or c == '\\' )
+					str << '\\';
+				str << c;
+			}
+			str << "\"];\n";
+		}
+
+		for (uint i = 0; i < _systems.size(); ++i)
+		{
+			for (uint dep : _systems[i].dependsOn)
+			{
+				str << "\ts" << ToString( dep ) << " -> s" << ToString( i ) << ";\n";
+			}
+		}
+
+		str << "}\n";
+		return str;
+	}
+
+
+}	// AE::ECS
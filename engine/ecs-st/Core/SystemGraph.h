@@ -0,0 +1,249 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+/*
+	System graph.
+
+	Systems are added in the order in which they would be executed sequentially.
+	Read and write access to components and single components is taken from the system function signature:
+		read	- 'ReadAccess<T>', 'OptionalReadAccess<T>', 'T const&', 'T const*', single component 'T const*' or 'T const&',
+		write	- 'WriteAccess<T>', 'OptionalWriteAccess<T>', 'T&', 'T*', single component 'T*' or 'T&'.
+
+	Two systems conflict if one of them writes a component that the other one reads or writes, or if they use the same query.
+	Conflicting systems are executed in the order in which they were added,
+	other systems are executed concurrently on worker threads.
+
+	Systems must not change registry state: create or destroy entities, add or remove components, add messages.
+	Single components that are accessed by reference are created before graph is launched.
+
+	Example:
+		SystemGraph	graph;
+		graph.Add( q1, [] (ArrayView<Tuple< size_t, WriteAccess<A>, ReadAccess<B> >> chunks) {...}, "SysA" );
+		graph.Add( q2, [] (const B &b, C &c) {...}, "SysB" );
+		CHECK( graph.Build() );
+
+		// every frame
+		CHECK( graph.Execute( reg ));
+*/
+
+#pragma once
+
+#include "ecs-st/Core/Registry.h"
+#include "threading/TaskSystem/TaskGraph.h"
+
+namespace AE::ECS
+{
+
+	//
+	// System Graph
+	//
+
+	class SystemGraph final : public Noncopyable
+	{
+	// types
+	public:
+		struct SystemAccess
+		{
+			ArchetypeDesc		read;
+			ArchetypeDesc		write;
+			Array<TypeId>		singleRead;
+			Array<TypeId>		singleWrite;
+
+			ND_ bool  Conflicts (const SystemAccess &other) const;
+		};
+
+	private:
+		using SystemFn_t	= Function< void (Registry &) >;
+
+		struct SystemInfo
+		{
+			String			name;
+			QueryID			query;
+			SystemAccess	access;
+			SystemFn_t		prepare;		// executed in current thread before graph is launched
+			SystemFn_t		execute;		// executed in worker thread
+			Array<uint>		dependsOn;
+		};
+
+		class SystemTask;
+
+
+	// variables
+	private:
+		Array<SystemInfo>		_systems;
+		Threading::TaskGraph	_graph;
+		Registry *				_registry	= null;		// valid only while graph is executing
+		bool					_built		= false;
+
+
+	// methods
+	public:
+		SystemGraph () {}
+		~SystemGraph ();
+
+		// returns system index
+			template <typename Fn>
+			uint  Add (QueryID query, Fn &&fn, StringView name = Default);
+
+		// calculates dependencies between systems and creates task graph
+			bool  Build ();
+
+		// runs all systems and waits until they are complete
+			bool  Execute (Registry &reg);
+
+			void  Clear ();
+
+		ND_ size_t					Count ()					const	{ return _systems.size(); }
+		ND_ SystemAccess const&		GetAccess (uint system)		const	{ return _systems[system].access; }
+		ND_ ArrayView<uint>			DependsOn (uint system)		const	{ return _systems[system].dependsOn; }
+
+		// returns DAG in graphviz format
+		ND_ String  ToGraphviz () const;
+	};
+
+
+
+/*
+=================================================
+	SystemAccessBuilder
+=================================================
+*/
+	namespace _reg_detail_
+	{
+		template <typename T>
+		struct SystemComponentAccess
+		{
+			// Subtractive, Require, RequireAny
+			static void  Apply (SystemGraph::SystemAccess &) {}
+		};
+
+		template <>
+		struct SystemComponentAccess< ReadAccess<EntityID> >
+		{
+			static void  Apply (SystemGraph::SystemAccess &) {}
+		};
+
+		template <typename T>
+		struct SystemComponentAccess< WriteAccess<T> >
+		{
+			static void  Apply (SystemGraph::SystemAccess &access) {
+				access.write.Add<T>();
+			}
+		};
+
+		template <typename T>
+		struct SystemComponentAccess< OptionalWriteAccess<T> >
+		{
+			static void  Apply (SystemGraph::SystemAccess &access) {
+				access.write.Add<T>();
+			}
+		};
+
+		template <typename T>
+		struct SystemComponentAccess< ReadAccess<T> >
+		{
+			static void  Apply (SystemGraph::SystemAccess &access) {
+				access.read.Add<T>();
+			}
+		};
+
+		template <typename T>
+		struct SystemComponentAccess< OptionalReadAccess<T> >
+		{
+			static void  Apply (SystemGraph::SystemAccess &access) {
+				access.read.Add<T>();
+			}
+		};
+
+
+		template <typename T>
+		struct SystemSingleComponentAccess
+		{
+			using A = std::remove_pointer_t< std::remove_reference_t< T >>;
+
+			static void  Apply (SystemGraph::SystemAccess &access)
+			{
+				if constexpr( IsConst<A> )
+					access.singleRead.push_back( TypeIdOf< std::remove_cv_t<A> >() );
+				else
+					access.singleWrite.push_back( TypeIdOf<A>() );
+			}
+
+			static void  Prepare (Registry &reg)
+			{
+				// component may be created only in current thread
+				if constexpr( std::is_reference_v<T> )
+					Unused( reg.AssignSingleComponent< std::remove_cv_t<A> >() );
+				else
+					Unused( reg );
+			}
+		};
+
+
+		template <typename CompList, typename SCTuple>
+		struct SystemAccessBuilder;
+
+		template <typename ...Comps, typename ...SCs>
+		struct SystemAccessBuilder< TypeList<Comps...>, Tuple<SCs...> >
+		{
+			static void  Apply (SystemGraph::SystemAccess &access)
+			{
+				(SystemComponentAccess< Comps >::Apply( access ), ...);
+				(SystemSingleComponentAccess< SCs >::Apply( access ), ...);
+			}
+
+			static void  Prepare (Registry &reg)
+			{
+				(SystemSingleComponentAccess< SCs >::Prepare( reg ), ...);
+				Unused( reg );
+			}
+		};
+
+		template <typename Fn, bool IsChunkFn>
+		struct SystemFnAccess;
+
+		template <typename Fn>
+		struct SystemFnAccess< Fn, true > :
+			SystemAccessBuilder< typename SystemFnInfo<Fn>::CompOnly, typename SystemFnInfo<Fn>::SCTuple >
+		{};
+
+		template <typename Fn>
+		struct SystemFnAccess< Fn, false >
+		{
+			template <typename ...Args>
+			static auto  _Get (const TypeList<Args...> *) -> SystemAccessBuilder< TypeList< MapCompType<Args>... >, Tuple<> >;
+
+			using Builder = decltype( _Get( (const typename FunctionInfo<Fn>::args *)null ));
+
+			static void  Apply (SystemGraph::SystemAccess &access)	{ Builder::Apply( access ); }
+			static void  Prepare (Registry &reg)					{ Builder::Prepare( reg ); }
+		};
+
+	}	// _reg_detail_
+
+/*
+=================================================
+	Add
+=================================================
+*/
+	template <typename Fn>
+	inline uint  SystemGraph::Add (QueryID query, Fn &&fn, StringView name)
+	{
+		using Args		= typename FunctionInfo<Fn>::args;
+		using Access	= _reg_detail_::SystemFnAccess< Fn, IsSpecializationOf< typename Args::template Get<0>, ArrayView >>;
+
+		STATIC_ASSERT( Args::Count > 0 );
+		CHECK_ERR( not _registry, UMax );
+
+		auto&	info	= _systems.emplace_back();
+		info.name		= String{name};
+		info.query		= query;
+		info.prepare	= &Access::Prepare;
+		info.execute	= [query, fn = std::forward<Fn>(fn)] (Registry &reg) { reg._Execute( query, std::move(fn) ); };
+
+		Access::Apply( INOUT info.access );
+
+		_built = false;
+		return uint(_systems.size() - 1);
+	}
+
+
+}	// AE::ECS
@@ -15,9 +15,8 @@ namespace AE::Graphics
 		{
 			CmdBatchID		batchId;
 			AsyncTask		task;
-			uint			bitIndex;
 
-			Dependency (const CmdBatchID &batchId, const AsyncTask &task, uint index) : batchId{batchId}, task{task}, bitIndex{index} {}
+			Dependency (const CmdBatchID &batchId, const AsyncTask &task) : batchId{batchId}, task{task} {}
 		};
 
 
@@ -31,7 +30,7 @@ namespace AE::Graphics
 	public:
 		void  Update (VRenderGraph &rg);
 
-		bool  Resolve (AnyTypeCRef dep, const AsyncTask &task, INOUT uint &bitIndex) override;
+		bool  Resolve (AnyTypeCRef dep, const AsyncTask &task, INOUT uint &depCount) override;
 	};
 
 	
@@ -48,7 +47,7 @@ namespace AE::Graphics
 		{
 			if ( rg.IsComplete({ iter->batchId }) )
 			{
-				_SetDependencyCompletionStatus( iter->task, iter->bitIndex, false );
+				_SetDependencyCompletionStatus( iter->task, false );
 				iter = _depsList.erase( iter );
 			}
 			else
@@ -61,13 +60,13 @@ namespace AE::Graphics
 	Resolve
 =================================================
 */
-	bool  VCmdBatchDepsManager::Resolve (AnyTypeCRef dep, const AsyncTask &task, INOUT uint &bitIndex)
+	bool  VCmdBatchDepsManager::Resolve (AnyTypeCRef dep, const AsyncTask &task, INOUT uint &depCount)
 	{
 		CHECK_ERR( dep.Is<CmdBatchDep>() );
 		EXLOCK( _depsListGuard );
 
-		_depsList.emplace_back( dep.As<CmdBatchDep>().id, task, bitIndex );
-		++bitIndex;
+		_depsList.emplace_back( dep.As<CmdBatchDep>().id, task );
+		++depCount;
 
 		return true;
 	}
@@ -29,7 +29,7 @@
 # include "graphics/Vulkan/Resources/VVirtualImage.h"
 
 # include "threading/Containers/LfIndexedPool.h"
-# include "threading/Containers/CachedIndexedPool.h"
+# include "threading/Containers/ShardedCachedIndexedPool.h"
 # include "threading/Containers/LfStaticPool.h"
 
 namespace AE::Graphics
@@ -50,7 +50,7 @@ namespace AE::Graphics
 		using PoolTmpl	= Threading::IndexedPool< T, Index_t, ChunkSize, MaxChunks, UntypedAlignedAllocator >;
 		
 		template <typename T, size_t ChunkSize, size_t MaxChunks>
-		using CachedPoolTmpl = Threading::CachedIndexedPool< T, Index_t, ChunkSize, MaxChunks, UntypedAlignedAllocator >;
+		using CachedPoolTmpl = Threading::ShardedCachedIndexedPool< T, Index_t, ChunkSize, MaxChunks, UntypedAlignedAllocator >;
 
 		// chunk size
 		static constexpr uint	MaxDeps			= 1u << 10;
@@ -2,11 +2,25 @@
 
 #include "stl/Platforms/CPUInfo.h"
 #include "stl/Algorithms/EnumUtils.h"
+#include "stl/Algorithms/StringUtils.h"
+#include <thread>
 
 #ifdef COMPILER_MSVC
 #	include <intrin.h>
 #endif
 
+#ifdef PLATFORM_WINDOWS
+#	include "stl/Platforms/WindowsHeader.h"
+#endif
+
+#if defined(PLATFORM_LINUX) or defined(PLATFORM_ANDROID)
+#	include <fstream>
+#endif
+
+#if defined(PLATFORM_LINUX) and (defined(__x86_64__) or defined(__i386__))
+#	include <cpuid.h>
+#endif
+
 #ifdef PLATFORM_ANDROID
 #	include <sys/auxv.h>
 
@@ -17,6 +31,65 @@
 
 namespace AE::STL
 {
+namespace {
+
+#if defined(PLATFORM_LINUX) or defined(PLATFORM_ANDROID)
+/*
+=================================================
+	ReadSysFile
+=================================================
+*/
+	ND_ bool  ReadSysFile (const String &path, OUT String &line)
+	{
+		std::ifstream	file{ path };
+		if ( not file.is_open() )
+			return false;
+
+		return bool(std::getline( file, OUT line ));
+	}
+	
+/*
+=================================================
+	ParseCpuList
+----
+	list format: "0-3,8,10-11"
+=================================================
+*/
+	template <typename FN>
+	void  ParseCpuList (const String &list, FN &&fn)
+	{
+		const char*	str = list.c_str();
+
+		for (;;)
+		{
+			char*	end		= null;
+			uint	first	= uint(std::strtoul( str, OUT &end, 10 ));
+			uint	last	= first;
+
+			if ( end == str )
+				break;
+
+			if ( *end == '-' )
+			{
+				str		= end + 1;
+				last	= uint(std::strtoul( str, OUT &end, 10 ));
+			}
+
+			for (uint i = first; i <= last; ++i) {
+				fn( i );
+			}
+
+			if ( *end != ',' )
+				break;
+
+			str = end + 1;
+		}
+	}
+#endif
+
+}	// namespace
+//-----------------------------------------------------------------------------
+
 
 #ifdef COMPILER_MSVC
 /*
@@ -52,6 +125,8 @@ namespace AE::STL
 		__cpuid( cpui.data(), 0x00000007 );
 		
 		AVX2	= EnumEq( cpui[1], 1u << 5 );
+
+		_InitTopology();
 	}
 #endif	// COMPILER_MSVC
 	
@@ -76,12 +151,179 @@ namespace AE::STL
 	#ifdef __aarch64__
 		NEON = true;
 	#endif
+
+		_InitTopology();
 	}
 #endif	// PLATFORM_ANDROID
 
+
+#ifdef PLATFORM_LINUX
+/*
+=================================================
+	constructor
+=================================================
+*/
+	CPUInfo::CPUInfo ()
+	{
+		std::memset( this, 0, sizeof(*this) );
+
+	#if defined(__x86_64__) or defined(__i386__)
+		__builtin_cpu_init();
+
+		SSE2	= __builtin_cpu_supports( "sse2" );
+		SSE3	= __builtin_cpu_supports( "sse3" );
+		SSE41	= __builtin_cpu_supports( "sse4.1" );
+		SSE42	= __builtin_cpu_supports( "sse4.2" );
+		AVX		= __builtin_cpu_supports( "avx" );
+		AVX2	= __builtin_cpu_supports( "avx2" );
+		POPCNT	= __builtin_cpu_supports( "popcnt" );
+
+		uint	eax = 0, ebx = 0, ecx = 0, edx = 0;
+		if ( __get_cpuid( 1, OUT &eax, OUT &ebx, OUT &ecx, OUT &edx ))
+			CmpXchg16 = EnumEq( ecx, 1u << 13 );
+	#endif
+
+	#if defined(__aarch64__) or defined(__ARM_NEON)
+		NEON = true;
+	#endif
+
+		_InitTopology();
+	}
+#endif	// PLATFORM_LINUX
+
+/*
+=================================================
+	_InitTopology
+----
+	logical cores are sorted by OS index,
+	physical cores and NUMA nodes are renumbered to the continuous ranges
+=================================================
+*/
+	void  CPUInfo::_InitTopology ()
+	{
+		logicalCoreCount	= 0;
+		physicalCoreCount	= 0;
+		numaNodeCount		= 0;
+
+	#if defined(PLATFORM_LINUX) or defined(PLATFORM_ANDROID)
+		String	line;
+
+		if ( ReadSysFile( "/sys/devices/system/cpu/online", OUT line ))
+		{
+			ParseCpuList( line, [this] (uint id)
+			{
+				if ( logicalCoreCount < MaxLogicalCores )
+					logicalCores[ logicalCoreCount++ ].id = uint16_t(id);
+			});
+		}
+
+		// SMT siblings have the same core id in the same package
+		Array<Pair< String, String >>	physical_cores;
+
+		for (uint i = 0; i < logicalCoreCount; ++i)
+		{
+			auto&			core	= logicalCores[i];
+			const String	dir		= "/sys/devices/system/cpu/cpu"s << ToString( core.id ) << "/topology/";
+			Pair< String, String >	key;
+
+			if ( not ReadSysFile( dir + "physical_package_id", OUT key.first ) or
+				 not ReadSysFile( dir + "core_id", OUT key.second ))
+			{
+				key = { "cpu", ToString( core.id )};
+			}
+
+			auto	iter = std::find( physical_cores.begin(), physical_cores.end(), key );
+			core.physicalCore = uint16_t(iter - physical_cores.begin());
+
+			if ( iter == physical_cores.end() )
+				physical_cores.push_back( std::move(key) );
+		}
+		physicalCoreCount = uint(physical_cores.size());
+
+		// node directories may be sparse
+		for (uint n = 0; n < MaxLogicalCores; ++n)
+		{
+			if ( not ReadSysFile( "/sys/devices/system/node/node"s << ToString( n ) << "/cpulist", OUT line ))
+				continue;
+
+			bool	used = false;
+			ParseCpuList( line, [this, &used] (uint id)
+			{
+				for (uint i = 0; i < logicalCoreCount; ++i)
+				{
+					if ( logicalCores[i].id == id )
+					{
+						logicalCores[i].numaNode = uint16_t(numaNodeCount);
+						used = true;
+					}
+				}
+			});
+
+			if ( used )
+				++numaNodeCount;
+		}
+	#endif	// PLATFORM_LINUX or PLATFORM_ANDROID
+
+
+	#ifdef PLATFORM_WINDOWS
+		// only processors in the current processor group are supported
+		DWORD	size = 0;
+		::GetLogicalProcessorInformation( null, OUT &size );
+
+		Array< SYSTEM_LOGICAL_PROCESSOR_INFORMATION >	info;
+		info.resize( size / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION) );
+
+		if ( size > 0 and ::GetLogicalProcessorInformation( OUT info.data(), INOUT &size ))
+		{
+			for (auto& item : info)
+			{
+				if ( item.Relationship != RelationProcessorCore )
+					continue;
+
+				for (uint i = 0; i < sizeof(item.ProcessorMask)*8 and logicalCoreCount < MaxLogicalCores; ++i)
+				{
+					if ( (item.ProcessorMask >> i) & 1 )
+						logicalCores[ logicalCoreCount++ ] = LogicalCore{ uint16_t(i), uint16_t(physicalCoreCount), 0 };
+				}
+				++physicalCoreCount;
+			}
+
+			for (auto& item : info)
+			{
+				if ( item.Relationship != RelationNumaNode )
+					continue;
+
+				for (uint i = 0; i < logicalCoreCount; ++i)
+				{
+					if ( (item.ProcessorMask >> logicalCores[i].id) & 1 )
+						logicalCores[i].numaNode = uint16_t(numaNodeCount);
+				}
+				++numaNodeCount;
+			}
+
+			std::sort( logicalCores.begin(), logicalCores.begin() + logicalCoreCount,
+					   [] (auto& lhs, auto& rhs) { return lhs.id < rhs.id; });
+		}
+	#endif	// PLATFORM_WINDOWS
+
+
+		// topology is unknown, each logical core is a physical core
+		if ( logicalCoreCount == 0 )
+		{
+			logicalCoreCount = Min( Max( 1u, std::thread::hardware_concurrency() ), MaxLogicalCores );
+
+			for (uint i = 0; i < logicalCoreCount; ++i) {
+				logicalCores[i] = LogicalCore{ uint16_t(i), uint16_t(i), 0 };
+			}
+			physicalCoreCount = logicalCoreCount;
+		}
+
+		numaNodeCount = Max( 1u, numaNodeCount );
+	}
+
 /*
 =================================================
-	SetCurrentThreadName
+	Get
 =================================================
 */
 	CPUInfo const&  CPUInfo::Get ()
@@ -13,6 +13,17 @@ namespace AE::STL
 
 	struct CPUInfo
 	{
+	// types
+		struct LogicalCore
+		{
+			uint16_t	id;				// OS processor index, can be used in 'PlatformUtils::SetThreadAffinity()'
+			uint16_t	physicalCore;	// logical cores with the same physical core are SMT siblings
+			uint16_t	numaNode;		// index in range [0, numaNodeCount)
+		};
+
+		static constexpr uint	MaxLogicalCores	= 256;
+
+
 	// x86-x64 features
 		bool	AVX   : 1;
 		bool	AVX2  : 1;
@@ -30,11 +41,19 @@ namespace AE::STL
 	// shared features
 		bool	CmpXchg16 : 1;		// 128 bit atomic compare exchange
 
+	// topology
+		uint	logicalCoreCount;
+		uint	physicalCoreCount;
+		uint	numaNodeCount;
+		StaticArray< LogicalCore, MaxLogicalCores >		logicalCores;
+
 
 	// methods
 	private:
 		CPUInfo ();
 
+		void  _InitTopology ();
+
 	public:
 		ND_ static CPUInfo const&  Get ();
 	};
@@ -55,6 +55,7 @@ namespace AE::Threading
 		static constexpr std::memory_order	Release			= std::memory_order_release;
 		static constexpr std::memory_order	AcquireRelase	= std::memory_order_acq_rel;
 		static constexpr std::memory_order	Relaxed			= std::memory_order_relaxed;
+		static constexpr std::memory_order	SequentiallyConsistent	= std::memory_order_seq_cst;
 	};
 #	else
 	struct EMemoryOrder
@@ -63,6 +64,7 @@ namespace AE::Threading
 		static constexpr std::memory_order	Release			= std::memory_order_seq_cst;
 		static constexpr std::memory_order	AcquireRelase	= std::memory_order_seq_cst;
 		static constexpr std::memory_order	Relaxed			= std::memory_order_seq_cst;
+		static constexpr std::memory_order	SequentiallyConsistent	= std::memory_order_seq_cst;
 	};
 #	endif	// AE_OPTIMAL_MEMORY_ORDER
 
@@ -0,0 +1,445 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+/*
+	Lock-free version of 'CachedIndexedPool'.
+
+	Values are stored in 'LfIndexedPool2', hash table contains indices of cached values.
+	Hash table consists of levels, each next level is two times larger than previous (up to x2 of pool capacity).
+	Value with hash 'h' can be placed only in small window of slots which is started from 'h' in each level.
+	Slot is never become empty again, removed slot is marked as removed and can be reused by any value with the same window,
+	when all slots in window are occupied new values with the same window are added to the next level, new level is allocated when needed.
+	This is why 'Find' is wait-free: it checks a single window per level and stops on the first empty slot.
+	'AddToCache' is not lock-free: search and insertion are protected by one of the striped spin locks which is selected by hash,
+	so threads which add equal values are serialized and value can't be cached twice,
+	threads with different hashes may use the same window, they use CAS to occupy the free slot.
+
+	'Find' and 'AddToCache' read values by indices from the hash table, index may be removed from cache and reused by another thread
+	at the same time, so these methods must be called with slot of registered thread and they are executed inside epoch critical section,
+	'Unassign( index, slot )' returns index to the pool only when all threads have left critical sections in which index may be read.
+
+	This container has some limitations:
+	- thread must be registered by 'RegisterThread()' before accessing the cache.
+	- value must not be changed while it is in cache.
+	- 'Unassign()' must be called after 'RemoveFromCache()',
+	  'Unassign( index )' without slot can be used only if index has never been added to the cache.
+	- 'Release()' must be externally synchronized with all other accesses, all threads must be unregistered.
+	- custom allocator must be thread safe (use mutex or lock-free algorithms).
+*/
+
+#pragma once
+
+#ifndef AE_LFAS_ENABLED
+# include "threading/Containers/LfIndexedPool2.h"
+# include "threading/Memory/EpochReclamation.h"
+#endif
+
+namespace AE::Threading
+{
+
+	//
+	// Lock-Free Cached Indexed Pool
+	//
+
+	template <typename ValueType,
+			  typename IndexType,
+			  size_t ChunkSize_v = 256,
+			  size_t MaxChunks_v = 16,
+			  typename AllocatorType = UntypedAlignedAllocator
+			 >
+	struct LfCachedIndexedPool final
+	{
+		STATIC_ASSERT( sizeof(IndexType) <= sizeof(uint) );
+
+	// types
+	public:
+		using Self			= LfCachedIndexedPool< ValueType, IndexType, ChunkSize_v, MaxChunks_v, AllocatorType >;
+		using Index_t		= IndexType;
+		using Value_t		= ValueType;
+		using Allocator_t	= AllocatorType;
+
+	private:
+		using Pool_t		= LfIndexedPool2< Value_t, Index_t, ChunkSize_v, MaxChunks_v, Allocator_t >;
+		using Slot_t		= Atomic< uint64_t >;	// high 32 bits - hash, low 32 bits - index + 1
+
+		static constexpr uint		WindowSize		= 8;
+		static constexpr uint		MaxLevels		= 16;
+		static constexpr uint		InsertLockCount	= 64;
+		static constexpr size_t		MaxLevelSize	= size_t(1) << (CT_IntLog2< ChunkSize_v * MaxChunks_v * 2 - 1 > + 1);	// x2 of pool capacity
+		static constexpr size_t		FirstLevelSize	= Min( MaxLevelSize, size_t(1) << (CT_IntLog2< ChunkSize_v * 2 - 1 > + 1) );
+		static constexpr uint64_t	EmptySlot		= 0;
+		static constexpr uint64_t	RemovedSlot		= ~uint64_t(0);
+
+		using Levels_t		= StaticArray< Atomic< Slot_t *>, MaxLevels >;
+		using InsertLocks_t	= StaticArray< SpinLock, InsertLockCount >;
+
+		STATIC_ASSERT( Slot_t::is_always_lock_free );
+		STATIC_ASSERT( Levels_t::value_type::is_always_lock_free );
+		STATIC_ASSERT( IsPowerOfTwo( FirstLevelSize ) and IsPowerOfTwo( MaxLevelSize ));
+		STATIC_ASSERT( IsPowerOfTwo( InsertLockCount ));
+
+
+	// variables
+	private:
+		alignas(AE_CACHE_LINE) mutable Levels_t	_levels;
+		mutable Pool_t						_pool;
+		Allocator_t							_allocator;
+
+		mutable EpochReclamation			_epoch;			// protects values which are read by index from hash table
+		InsertLocks_t						_insertLocks;
+
+
+	// methods
+	public:
+		LfCachedIndexedPool (const Self &) = delete;
+		LfCachedIndexedPool (Self &&) = delete;
+
+		Self& operator = (const Self &) = delete;
+		Self& operator = (Self &&) = delete;
+
+		explicit LfCachedIndexedPool (const Allocator_t &alloc = Allocator_t());
+		~LfCachedIndexedPool ()									{ Release(); }
+
+		void  Release ();
+
+		ND_ bool  RegisterThread (OUT uint &slot)				{ return _epoch.RegisterThread( OUT slot ); }
+			void  UnregisterThread (uint slot)					{ _epoch.UnregisterThread( slot ); }
+
+		ND_ Pair<Index_t, bool>  Insert (Index_t index, Value_t&& value, uint slot);
+		ND_ Pair<Index_t, bool>  AddToCache (Index_t index, uint slot);
+			bool  RemoveFromCache (Index_t index);
+
+		ND_ Index_t  Find (const Value_t *value, uint slot) const;
+
+		ND_ bool  Assign (OUT Index_t &index)					{ return _pool.Assign( OUT index ); }
+			void  Unassign (Index_t index, uint slot);
+			void  Unassign (Index_t index)						{ Unused( _pool.Unassign( index )); }	// only for index that has never been cached
+		ND_ bool  IsAssigned (Index_t index)					{ return _pool.IsAssigned( index ); }
+
+		ND_ BytesU  DynamicSize () const;
+
+		ND_ Value_t &			operator [] (Index_t index)				{ return _pool[ index ]; }
+		ND_ Value_t const&		operator [] (Index_t index)		const	{ return _pool[ index ]; }
+
+		ND_ static constexpr size_t	capacity ()							{ return Pool_t::Capacity(); }
+
+
+	private:
+		ND_ static size_t	_LevelSize (uint level)						{ return Min( FirstLevelSize << level, MaxLevelSize ); }
+		ND_ static size_t	_WindowStart (size_t hash, uint level)		{ hash = BitRotateLeft( hash, level * 7 );  return (hash ^ (hash >> 29)) & (_LevelSize( level ) - 1); }
+		ND_ static uint64_t	_MakeSlot (size_t hash, Index_t index)		{ return (uint64_t(uint(uint64_t(hash) >> 32) ^ uint(hash)) << 32) | (uint64_t(index) + 1); }
+		ND_ static bool		_IsSameHash (uint64_t slot, size_t hash)	{ return uint(slot >> 32) == (uint(uint64_t(hash) >> 32) ^ uint(hash)); }
+		ND_ static Index_t	_SlotIndex (uint64_t slot)					{ return Index_t( (slot & 0xFFFFFFFFu) - 1 ); }
+
+		ND_ SpinLock&  _InsertLock (size_t hash)				{ return _insertLocks[ (hash ^ (hash >> 29)) & (InsertLockCount - 1) ]; }
+
+		ND_ Slot_t*  _GetLevel (uint level);
+		ND_ Slot_t*  _CreateLevel (uint level);
+	};
+
+
+
+/*
+=================================================
+	constructor
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A>
+	inline LfCachedIndexedPool<V,I,CS,MC,A>::LfCachedIndexedPool (const Allocator_t &alloc) :
+		_pool{ alloc },
+		_allocator{ alloc }
+	{
+		for (auto& level : _levels) {
+			level.store( null, EMemoryOrder::Relaxed );
+		}
+		ThreadFence( EMemoryOrder::Release );
+	}
+
+/*
+=================================================
+	Release
+----
+	Must be externally synchronized
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A>
+	inline void  LfCachedIndexedPool<V,I,CS,MC,A>::Release ()
+	{
+		ThreadFence( EMemoryOrder::Acquire );
+
+		// return retired indices to the pool
+		_epoch.Release();
+
+		for (uint i = 0; i < MaxLevels; ++i)
+		{
+			Slot_t*	slots = _levels[i].exchange( null, EMemoryOrder::Relaxed );
+			if ( not slots )
+				continue;
+
+			for (size_t j = 0, cnt = _LevelSize(i); j < cnt; ++j) {
+				slots[j].~Slot_t();
+			}
+			_allocator.Deallocate( slots, SizeOf<Slot_t> * _LevelSize(i), AlignOf<Slot_t> );
+		}
+
+		_pool.Release( false );
+
+		ThreadFence( EMemoryOrder::Release );
+	}
+
+/*
+=================================================
+	Insert
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A>
+	inline Pair<I, bool>  LfCachedIndexedPool<V,I,CS,MC,A>::Insert (Index_t index, Value_t&& value, uint slot)
+	{
+		std::swap( _pool[index], value );
+
+		return AddToCache( index, slot );
+	}
+
+/*
+=================================================
+	AddToCache
+----
+	returns index of cached value and 'true' if 'index' was added to the cache,
+	returns 'UMax' if cache is full
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A>
+	inline Pair<I, bool>  LfCachedIndexedPool<V,I,CS,MC,A>::AddToCache (Index_t index, uint slot)
+	{
+		const Value_t&	value	= _pool[index];
+		const size_t	hash	= std::hash<Value_t>{}( value );
+		const uint64_t	new_slot = _MakeSlot( hash, index );
+
+		// equal values have the same hash, so only one of them can be added at a time
+		EXLOCK( _InsertLock( hash ));
+
+		// values of other indices may be read
+		EpochReclamation::Guard		guard{ _epoch, slot };
+
+		for (;;)
+		{
+			Slot_t*		free_slot	= null;
+			uint64_t	expected	= EmptySlot;
+			bool		found_empty	= false;
+
+			// search for the same value in all slots up to the first empty slot,
+			// the first removed or empty slot will be used for new value
+			for (uint lvl = 0; (lvl < MaxLevels) and not found_empty; ++lvl)
+			{
+				Slot_t*	slots = _GetLevel( lvl );
+				if_unlikely( slots == null )
+				{
+					if ( free_slot != null )
+						break;
+
+					slots = _CreateLevel( lvl );
+					CHECK_ERR( slots != null, (Pair<Index_t, bool>{ Index_t(UMax), false }));
+				}
+
+				const size_t	mask	= _LevelSize( lvl ) - 1;
+				const size_t	start	= _WindowStart( hash, lvl );
+
+				for (uint i = 0; i < WindowSize; ++i)
+				{
+					auto&			item	= slots[ (start + i) & mask ];
+					const uint64_t	curr	= item.load( EMemoryOrder::Acquire );
+
+					// value can't be in the next slots
+					if ( curr == EmptySlot )
+					{
+						if ( free_slot == null ) {
+							free_slot	= &item;
+							expected	= EmptySlot;
+						}
+						found_empty = true;
+						break;
+					}
+
+					if ( curr == RemovedSlot )
+					{
+						if ( free_slot == null ) {
+							free_slot	= &item;
+							expected	= RemovedSlot;
+						}
+						continue;
+					}
+
+					// slot is occupied by another thread or was occupied before
+					if ( _IsSameHash( curr, hash ))
+					{
+						const Index_t	idx = _SlotIndex( curr );
+						if ( idx == index or _pool[idx] == value )
+							return { idx, false };
+					}
+				}
+			}
+
+			// cache is full
+			CHECK_ERR( free_slot != null, (Pair<Index_t, bool>{ Index_t(UMax), false }));
+
+			// value must be visible for other threads which will read slot with acquire semantic
+			if ( free_slot->compare_exchange_strong( INOUT expected, new_slot, EMemoryOrder::Release, EMemoryOrder::Relaxed ))
+				return { index, true };
+
+			// slot is occupied by another thread, check all slots again
+		}
+	}
+
+/*
+=================================================
+	Unassign
+----
+	index will be returned to the pool when it can't be accessed in 'Find()' and 'AddToCache()'
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A>
+	inline void  LfCachedIndexedPool<V,I,CS,MC,A>::Unassign (Index_t index, uint slot)
+	{
+		_epoch.Retire( slot, reinterpret_cast<void*>(size_t(index)),
+					   [] (void* ptr, void* self) { Unused( static_cast<Self*>(self)->_pool.Unassign( Index_t(size_t(ptr)) )); },
+					   this );
+	}
+
+/*
+=================================================
+	RemoveFromCache
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A>
+	inline bool  LfCachedIndexedPool<V,I,CS,MC,A>::RemoveFromCache (Index_t index)
+	{
+		const size_t	hash		= std::hash<Value_t>{}( _pool[index] );
+		const uint64_t	expected	= _MakeSlot( hash, index );
+
+		for (uint lvl = 0; lvl < MaxLevels; ++lvl)
+		{
+			Slot_t*	slots = _GetLevel( lvl );
+			if ( slots == null )
+				return false;
+
+			const size_t	mask	= _LevelSize( lvl ) - 1;
+			const size_t	start	= _WindowStart( hash, lvl );
+
+			for (uint i = 0; i < WindowSize; ++i)
+			{
+				auto&		slot	= slots[ (start + i) & mask ];
+				uint64_t	curr	= slot.load( EMemoryOrder::Relaxed );
+
+				if ( curr == EmptySlot )
+					return false;
+
+				if ( curr == expected )
+					return slot.compare_exchange_strong( INOUT curr, RemovedSlot, EMemoryOrder::Relaxed );
+			}
+		}
+		return false;
+	}
+
+/*
+=================================================
+	Find
+----
+	wait-free, only windows in existing levels are checked
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A>
+	inline I  LfCachedIndexedPool<V,I,CS,MC,A>::Find (const Value_t *value, uint slot) const
+	{
+		const size_t	hash = std::hash<Value_t>{}( *value );
+
+		// value by index must not be reused while it is compared
+		EpochReclamation::Guard		guard{ _epoch, slot };
+
+		for (uint lvl = 0; lvl < MaxLevels; ++lvl)
+		{
+			Slot_t*	slots = _levels[lvl].load( EMemoryOrder::Acquire );
+			if ( slots == null )
+				break;
+
+			const size_t	mask	= _LevelSize( lvl ) - 1;
+			const size_t	start	= _WindowStart( hash, lvl );
+
+			for (uint i = 0; i < WindowSize; ++i)
+			{
+				const uint64_t	curr = slots[ (start + i) & mask ].load( EMemoryOrder::Acquire );
+
+				// value can't be in the next levels
+				if ( curr == EmptySlot )
+					return Index_t(UMax);
+
+				if ( curr != RemovedSlot and _IsSameHash( curr, hash ))
+				{
+					const Index_t	idx = _SlotIndex( curr );
+					if ( _pool[idx] == *value )
+						return idx;
+				}
+			}
+		}
+		return Index_t(UMax);
+	}
+
+/*
+=================================================
+	DynamicSize
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A>
+	inline BytesU  LfCachedIndexedPool<V,I,CS,MC,A>::DynamicSize () const
+	{
+		BytesU	size;
+		for (uint i = 0; i < MaxLevels; ++i)
+		{
+			if ( _levels[i].load( EMemoryOrder::Relaxed ) != null )
+				size += SizeOf<Slot_t> * _LevelSize(i);
+		}
+		return size;
+	}
+
+/*
+=================================================
+	_GetLevel
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A>
+	inline typename LfCachedIndexedPool<V,I,CS,MC,A>::Slot_t*
+		LfCachedIndexedPool<V,I,CS,MC,A>::_GetLevel (uint level)
+	{
+		return _levels[level].load( EMemoryOrder::Acquire );
+	}
+
+/*
+=================================================
+	_CreateLevel
+----
+	multiple threads may allocate level at the same time, only one of them will be used
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A>
+	inline typename LfCachedIndexedPool<V,I,CS,MC,A>::Slot_t*
+		LfCachedIndexedPool<V,I,CS,MC,A>::_CreateLevel (uint level)
+	{
+		const size_t	count	= _LevelSize( level );
+		Slot_t*			slots	= Cast<Slot_t>( _allocator.Allocate( SizeOf<Slot_t> * count, AlignOf<Slot_t> ));
+		CHECK_ERR( slots != null );
+
+		for (size_t i = 0; i < count; ++i) {
+			PlacementNew<Slot_t>( slots + i, EmptySlot );
+		}
+
+		Slot_t*	expected = null;
+		if ( _levels[level].compare_exchange_strong( INOUT expected, slots, EMemoryOrder::Release, EMemoryOrder::Acquire ))
+			return slots;
+
+		// another thread has already created level
+		for (size_t i = 0; i < count; ++i) {
+			slots[i].~Slot_t();
+		}
+		_allocator.Deallocate( slots, SizeOf<Slot_t> * count, AlignOf<Slot_t> );
+		return expected;
+	}
+
+
+}	// AE::Threading
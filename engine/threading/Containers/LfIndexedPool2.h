@@ -8,6 +8,10 @@
 	- custom allocator must be thread safe (use mutex or lock-free algorithms).
 
 	This lock-free container designed for large number of elements.
+
+	'Magazine' is an optional per-thread cache of assigned indices, it is refilled and drained in batches,
+	so most of Assign/Unassign calls don't touch shared cache lines.
+	Indices in magazine are still assigned in the pool, so all magazines must be flushed before 'Release()'.
 */
 
 #pragma once
@@ -86,6 +90,40 @@ namespace AE::Threading
 		static constexpr TopLevelBits_t	MaxTopLevel			= ToBitMask<TopLevelBits_t>( MaxChunks );
 		static constexpr TopLevelBits_t	InitialTopLevel		= ~MaxTopLevel;
 
+	public:
+
+		//
+		// Magazine
+		//
+		struct Magazine
+		{
+		// types
+		public:
+			static constexpr uint	MaxIndices	= 32;
+			static constexpr uint	BatchSize	= MaxIndices / 2;
+
+		// variables
+		private:
+			Self &								_pool;
+			FixedArray< Index_t, MaxIndices >	_indices;
+
+		// methods
+		public:
+			explicit Magazine (Self &pool) : _pool{pool} {}
+			~Magazine ()							{ Flush(); }
+
+			Magazine (const Magazine &) = delete;
+			Magazine&  operator = (const Magazine &) = delete;
+
+			ND_ bool  Assign (OUT Index_t &outIndex);
+				void  Unassign (Index_t index);
+
+			// return all indices to the pool
+				void  Flush ()						{ _pool.Unassign( _indices.size(), INOUT _indices ); }
+
+			ND_ size_t  size ()				const	{ return _indices.size(); }
+		};
+
 
 	// variables
 	private:
@@ -118,6 +156,14 @@ namespace AE::Threading
 		ND_ bool  Assign (OUT Index_t &outIndex)						{ return Assign( OUT outIndex, [](Value_t* ptr, Index_t) { PlacementNew<Value_t>( ptr ); }); }
 
 			bool  Unassign (Index_t index);
+
+		// assign up to 'count' indices and append them to 'arr', returns number of assigned indices
+		template <typename ArrayType>
+		ND_ size_t  Assign (size_t count, INOUT ArrayType &arr);
+
+		// unassign the last 'count' indices of 'arr'
+		template <typename ArrayType>
+			void  Unassign (size_t count, INOUT ArrayType &arr);
 	
 		ND_ bool  IsAssigned (Index_t index);
 
@@ -127,13 +173,19 @@ namespace AE::Threading
 
 
 	private:
+		ND_ ValueChunk_t*  _GetChunk (int chunkIndex);
+
 		template <typename FN>
 		bool  _AssignInChunk (OUT Index_t &outIndex, int chunkIndex, const FN &ctor);
 
+		template <typename ArrayType>
+		ND_ size_t  _AssignInLowLevel (size_t count, INOUT ArrayType &arr, int chunkIndex, int hiLevelIndex, ValueChunk_t &data);
+
 		template <typename FN>
 		bool  _AssignInLowLevel (OUT Index_t &outIndex, int chunkIndex, int hiLevelIndex, ValueChunk_t &data, const FN &ctor);
 
 		void _UpdateHiLevel (int chunkIndex, int hiLevelIndex);
+		void _ResetHiLevel (uint chunkIndex, uint hiLevelIndex);
 	};
 	
 
@@ -251,14 +303,14 @@ namespace AE::Threading
 	
 /*
 =================================================
-	_AssignInChunk
+	_GetChunk
+----
+	returns chunk data, allocates chunk if needed
 =================================================
 */
 	template <typename V, typename I, size_t CS, size_t MC, typename A>
-	template <typename FN>
-	inline bool  LfIndexedPool2<V,I,CS,MC,A>::_AssignInChunk (OUT Index_t &outIndex, int chunkIndex, const FN &ctor)
+	inline typename LfIndexedPool2<V,I,CS,MC,A>::ValueChunk_t*  LfIndexedPool2<V,I,CS,MC,A>::_GetChunk (int chunkIndex)
 	{
-		auto&			info = _chunkInfo[ chunkIndex ];
 		ValueChunk_t*	data = _chunkData[ chunkIndex ].load( EMemoryOrder::Relaxed );
 			
 		// allocate
@@ -279,6 +331,20 @@ namespace AE::Threading
 				}
 			}
 		}
+		return data;
+	}
+
+/*
+=================================================
+	_AssignInChunk
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A>
+	template <typename FN>
+	inline bool  LfIndexedPool2<V,I,CS,MC,A>::_AssignInChunk (OUT Index_t &outIndex, int chunkIndex, const FN &ctor)
+	{
+		auto&			info = _chunkInfo[ chunkIndex ];
+		ValueChunk_t*	data = _GetChunk( chunkIndex );
 			
 		// find available index
 		for (uint j = 0; j < HighWaitCount; ++j)
@@ -334,6 +400,107 @@ namespace AE::Threading
 		return false;
 	}
 	
+/*
+=================================================
+	Assign (batch)
+----
+	multiple indices in the same low level are assigned by a single CAS
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A>
+	template <typename ArrayType>
+	inline size_t  LfIndexedPool2<V,I,CS,MC,A>::Assign (size_t count, INOUT ArrayType &arr)
+	{
+		count = Min( count, arr.capacity() - arr.size() );
+
+		size_t	result = 0;
+
+		for (uint j = 0; j < TopWaitCount and result < count; ++j)
+		{
+			TopLevelBits_t	available	= _topLevel.load( EMemoryOrder::Relaxed );
+			int				chunk_idx	= BitScanForward( ~available );
+
+			if ( chunk_idx < 0 )
+				continue;
+
+			ASSERT( size_t(chunk_idx) < _chunkInfo.size() );
+
+			auto&			info = _chunkInfo[ chunk_idx ];
+			ValueChunk_t*	data = _GetChunk( chunk_idx );
+
+			for (uint k = 0; k < HighWaitCount and result < count; ++k)
+			{
+				HiLevelBits_t	hi_available	= info.hiLevel.load( EMemoryOrder::Relaxed );
+				int				hi_idx			= BitScanForward( ~hi_available );
+
+				if ( hi_idx < 0 )
+					break;
+				
+				ASSERT( size_t(hi_idx) < info.lowLevel.size() );
+
+				result += _AssignInLowLevel( count - result, INOUT arr, chunk_idx, hi_idx, *data );
+			}
+		}
+		return result;
+	}
+	
+/*
+=================================================
+	_AssignInLowLevel (batch)
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A>
+	template <typename ArrayType>
+	inline size_t  LfIndexedPool2<V,I,CS,MC,A>::_AssignInLowLevel (size_t count, INOUT ArrayType &arr, int chunkIndex, int hiLevelIndex, ValueChunk_t &data)
+	{
+		auto&			info		= _chunkInfo[ chunkIndex ];
+		auto&			level		= info.lowLevel[ hiLevelIndex ];
+		auto&			created		= info.created[ hiLevelIndex ];
+		LowLevelBits_t	available	= level.load( EMemoryOrder::Relaxed );
+		LowLevelBits_t	mask;
+
+		for (;;)
+		{
+			// take up to 'count' unassigned bits
+			mask = 0;
+			for (LowLevelBits_t bits = ~available; bits != 0 and count > 0; --count)
+			{
+				const LowLevelBits_t	lowest = bits & ~(bits - 1);
+				mask |= lowest;
+				bits &= ~lowest;
+			}
+
+			if ( mask == 0 )
+				return 0;
+
+			if ( level.compare_exchange_weak( INOUT available, available | mask, EMemoryOrder::Acquire, EMemoryOrder::Relaxed ))	// 0 -> 1
+				break;
+
+			count += BitCount( mask );
+		}
+
+		if_unlikely( (available | mask) == UMax )
+			_UpdateHiLevel( chunkIndex, hiLevelIndex );
+
+		const LowLevelBits_t	not_created	= mask & ~created.fetch_or( mask, EMemoryOrder::Relaxed );	// 0 -> 1
+		const Index_t			base_idx	= (Index_t(hiLevelIndex) * LowLevel_Count) | (Index_t(chunkIndex) * ChunkSize);
+		size_t					result		= 0;
+
+		for (int i = BitScanForward( mask ); i >= 0; i = BitScanForward( mask ), ++result)
+		{
+			const LowLevelBits_t	bit = (LowLevelBits_t(1) << i);
+			mask &= ~bit;
+
+			const Index_t	index = base_idx | Index_t(i);
+
+			if ( not_created & bit )
+				PlacementNew<Value_t>( &data[ i + hiLevelIndex * LowLevel_Count ] );
+
+			arr.emplace_back( index );
+		}
+		return result;
+	}
+
 /*
 =================================================
 	_UpdateHiLevel
@@ -377,8 +544,7 @@ namespace AE::Threading
 		const uint		hi_lvl_idx	= (index % ChunkSize) / LowLevel_Count;
 		const uint		low_lvl_idx	= (index % ChunkSize) % LowLevel_Count;
 		LowLevelBits_t	mask		= LowLevelBits_t(1) << low_lvl_idx;
-		auto&			info		= _chunkInfo[ chunk_idx ];
-		auto&			level		= info.lowLevel[ hi_lvl_idx ];
+		auto&			level		= _chunkInfo[ chunk_idx ].lowLevel[ hi_lvl_idx ];
 		LowLevelBits_t	old_bits	= level.fetch_and( ~mask, EMemoryOrder::Relaxed );	// 1 -> 0
 
 		if ( not (old_bits & mask) )
@@ -386,26 +552,129 @@ namespace AE::Threading
 
 		// update high level bits
 		if_unlikely( old_bits == UMax )
+			_ResetHiLevel( chunk_idx, hi_lvl_idx );
+
+		return true;
+	}
+	
+/*
+=================================================
+	Unassign (batch)
+----
+	indices in the same low level are unassigned by a single atomic operation
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A>
+	template <typename ArrayType>
+	inline void  LfIndexedPool2<V,I,CS,MC,A>::Unassign (size_t count, INOUT ArrayType &arr)
+	{
+		count = Min( count, arr.size() );
+
+		const size_t	first	= arr.size() - count;
+		Index_t			base	= UMax;
+		LowLevelBits_t	mask	= 0;
+
+		const auto	Flush = [this, &base, &mask] ()
 		{
-			EXLOCK( info.guard );
+			if ( mask == 0 )
+				return;
 
-			if_unlikely( level.load( EMemoryOrder::Relaxed ) != UMax )
-			{
-				const auto	hi_bit = (HiLevelBits_t(1) << hi_lvl_idx);
+			const uint		chunk_idx	= base / ChunkSize;
+			const uint		hi_lvl_idx	= (base % ChunkSize) / LowLevel_Count;
+			auto&			level		= _chunkInfo[ chunk_idx ].lowLevel[ hi_lvl_idx ];
+			LowLevelBits_t	old_bits	= level.fetch_and( ~mask, EMemoryOrder::Relaxed );	// 1 -> 0
+			ASSERT( (old_bits & mask) == mask );
 
-				EXLOCK( _topLevelGuard );
-				
-				// update top level
-				if_unlikely( info.hiLevel.fetch_and( ~hi_bit, EMemoryOrder::Relaxed ) == (hi_bit | InitialHighLevel) )	// 1 -> 0
-				{
-					_topLevel.fetch_and( ~(TopLevelBits_t(1) << chunk_idx), EMemoryOrder::Relaxed );	// 1 -> 0
-				}
+			if_unlikely( old_bits == UMax )
+				_ResetHiLevel( chunk_idx, hi_lvl_idx );
+
+			mask = 0;
+		};
+
+		for (size_t i = first; i < arr.size(); ++i)
+		{
+			const Index_t	index	= arr[i];
+			ASSERT( index < Capacity() );
+
+			const Index_t	idx_base = index & ~Index_t(LowLevel_Count - 1);
+			if ( idx_base != base )
+			{
+				Flush();
+				base = idx_base;
 			}
+			mask |= LowLevelBits_t(1) << (index % LowLevel_Count);
 		}
+		Flush();
 
+		arr.resize( first );
+	}
+	
+/*
+=================================================
+	Magazine::Assign
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A>
+	inline bool  LfIndexedPool2<V,I,CS,MC,A>::Magazine::Assign (OUT Index_t &outIndex)
+	{
+		if_unlikely( _indices.empty() )
+		{
+			if ( _pool.Assign( BatchSize, INOUT _indices ) == 0 )
+				return false;
+		}
+
+		outIndex = _indices.back();
+		_indices.pop_back();
 		return true;
 	}
 	
+/*
+=================================================
+	Magazine::Unassign
+----
+	index may be assigned by another magazine or by the pool
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A>
+	inline void  LfIndexedPool2<V,I,CS,MC,A>::Magazine::Unassign (Index_t index)
+	{
+		ASSERT( index < Self::Capacity() );
+
+		if_unlikely( _indices.size() == _indices.capacity() )
+			_pool.Unassign( BatchSize, INOUT _indices );
+
+		_indices.push_back( index );
+	}
+	
+/*
+=================================================
+	_ResetHiLevel
+----
+	low level was changed from full to non-full state
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A>
+	inline void  LfIndexedPool2<V,I,CS,MC,A>::_ResetHiLevel (uint chunkIndex, uint hiLevelIndex)
+	{
+		auto&	info	= _chunkInfo[ chunkIndex ];
+		auto&	level	= info.lowLevel[ hiLevelIndex ];
+
+		EXLOCK( info.guard );
+
+		if_unlikely( level.load( EMemoryOrder::Relaxed ) != UMax )
+		{
+			const auto	hi_bit = (HiLevelBits_t(1) << hiLevelIndex);
+
+			EXLOCK( _topLevelGuard );
+				
+			// update top level
+			if_unlikely( info.hiLevel.fetch_and( ~hi_bit, EMemoryOrder::Relaxed ) == (hi_bit | InitialHighLevel) )	// 1 -> 0
+			{
+				_topLevel.fetch_and( ~(TopLevelBits_t(1) << chunkIndex), EMemoryOrder::Relaxed );	// 1 -> 0
+			}
+		}
+	}
+	
 /*
 =================================================
 	IsAssigned
@@ -0,0 +1,562 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+/*
+	Sharded version of 'CachedIndexedPool' with lock-free readers.
+
+	Cache is split into shards, shard is selected by hash of the value.
+	Each shard contains open-addressing hash table with indices of cached values,
+	writers ('AddToCache', 'RemoveFromCache') are serialized by per-shard mutex,
+	readers ('Find') never take a lock, they only register in the current epoch of the shard (RCU-style).
+	Reader counters are split into cache line sized stripes, each thread uses its own stripe (while there are less threads than stripes),
+	so readers on different threads don't modify the same cache line.
+	Writer that removes value from the cache or replaces the table waits until all readers
+	that may observe the old state have left the shard, so value can be safely destroyed after 'RemoveFromCache()'.
+
+	Limitations:
+	- value must not be changed while it is in cache.
+	- 'RemoveFromCache()' must be called before value is destroyed or unassigned.
+	- 'Release()' must be externally synchronized with all other accesses.
+*/
+
+#pragma once
+
+#include "threading/Containers/IndexedPool.h"
+#include "stl/Math/BitMath.h"
+#include "stl/Memory/MemUtils.h"
+
+#if 0
+#	define AE_CACHED_POOL_STATISTIC( ... )	__VA_ARGS__
+#else
+#	define AE_CACHED_POOL_STATISTIC( ... )
+#endif
+
+namespace AE::Threading
+{
+
+	//
+	// Sharded Cached Chunked Indexed Pool
+	//
+
+	template <typename ValueType,
+			  typename IndexType,
+			  size_t ChunkSize,
+			  size_t MaxChunks = 16,
+			  typename AllocatorType = UntypedAlignedAllocator,
+			  size_t ShardCount_v = 16
+			 >
+	struct ShardedCachedIndexedPool final
+	{
+		STATIC_ASSERT( sizeof(IndexType) <= sizeof(uint) );
+		STATIC_ASSERT( IsPowerOfTwo( ShardCount_v ));
+
+	// types
+	public:
+		using Self			= ShardedCachedIndexedPool< ValueType, IndexType, ChunkSize, MaxChunks, AllocatorType, ShardCount_v >;
+		using Index_t		= IndexType;
+		using Value_t		= ValueType;
+		using Allocator_t	= AllocatorType;
+
+		struct Statistic
+		{
+			uint64_t	hits		= 0;	// 'Find' returns cached index, only with 'AE_CACHED_POOL_STATISTIC'
+			uint64_t	misses		= 0;	// 'Find' returns 'UMax', only with 'AE_CACHED_POOL_STATISTIC'
+			uint64_t	contended	= 0;	// writer waits for the shard lock
+		};
+
+	private:
+		using Pool_t		= IndexedPool< Value_t, Index_t, ChunkSize, MaxChunks, Allocator_t >;
+		using Slot_t		= Atomic< uint64_t >;	// high 32 bits - hash, low 32 bits - index + 1
+
+		struct alignas(AE_CACHE_LINE) ReaderStripe
+		{
+			StaticArray< Atomic<uint>, 2 >	count	= {};	// number of readers for even and odd epoch
+		};
+
+		static constexpr uint		ReaderStripes	= 8;
+
+		struct Table
+		{
+			size_t		size;		// power of 2
+			Slot_t		slots [1];
+		};
+
+		struct alignas(AE_CACHE_LINE) Shard
+		{
+			// changed only by writer, 'table' and 'epoch' are read by readers
+			Mutex						writeGuard;
+			Atomic< Table *>			table		{null};
+			Atomic< uint >				epoch		{0};
+			size_t						used		= 0;	// number of non-empty slots (includes removed), protected by 'writeGuard'
+			size_t						count		= 0;	// number of cached values, protected by 'writeGuard'
+			Atomic< uint64_t >			contended	{0};
+
+			// changed by readers, each thread uses its own stripe
+			StaticArray< ReaderStripe, ReaderStripes >	readers;
+
+			AE_CACHED_POOL_STATISTIC(
+				alignas(AE_CACHE_LINE) Atomic< uint64_t >	hits	{0};
+				Atomic< uint64_t >							misses	{0};
+			)
+		};
+
+		static constexpr size_t		ShardCount		= ShardCount_v;
+		static constexpr uint		ShardBits		= CT_IntLog2< ShardCount >;
+		static constexpr size_t		MinTableSize	= 16;
+		static constexpr uint64_t	EmptySlot		= 0;
+		static constexpr uint64_t	RemovedSlot		= ~uint64_t(0);
+
+		using Shards_t		= StaticArray< Shard, ShardCount >;
+
+		STATIC_ASSERT( Slot_t::is_always_lock_free );
+
+
+	// variables
+	private:
+		mutable Shards_t	_shards;
+		Pool_t				_pool;
+		Allocator_t			_allocator;
+
+
+	// methods
+	public:
+		ShardedCachedIndexedPool (const Self &) = delete;
+		ShardedCachedIndexedPool (Self &&) = delete;
+
+		Self& operator = (const Self &) = delete;
+		Self& operator = (Self &&) = delete;
+
+		explicit ShardedCachedIndexedPool (const Allocator_t &alloc = Allocator_t());
+		~ShardedCachedIndexedPool ()							{ Release(); }
+
+		void  Release ();
+
+		ND_ Pair<Index_t, bool>  Insert (Index_t index, Value_t&& value);
+		ND_ Pair<Index_t, bool>  AddToCache (Index_t index);
+			bool  RemoveFromCache (Index_t index);
+
+		ND_ Index_t  Find (const Value_t *value) const;
+
+		ND_ BytesU		DynamicSize () const;
+		ND_ Statistic	GetStatistic () const;
+
+		template <typename ArrayType>
+		ND_ size_t  Assign (size_t count, INOUT ArrayType &arr)			{ return _pool.Assign( count, INOUT arr ); }
+
+		template <typename ArrayType>
+			void  Unassign (size_t count, INOUT ArrayType &arr)			{ return _pool.Unassign( count, INOUT arr ); }
+
+		ND_ bool  Assign (OUT Index_t &index)							{ return _pool.Assign( OUT index ); }
+			void  Unassign (Index_t index)								{ return _pool.Unassign( index ); }
+
+		ND_ Value_t &			operator [] (Index_t index)				{ return _pool[ index ]; }
+		ND_ Value_t const&		operator [] (Index_t index)		const	{ return _pool[ index ]; }
+
+		ND_ bool				empty ()						const	{ return _pool.empty(); }
+		ND_ size_t				size ()							const	{ return _pool.size(); }
+		ND_ constexpr size_t	capacity ()						const	{ return _pool.capacity(); }
+
+
+	private:
+		ND_ static size_t		_Hash (const Value_t &value)				{ return std::hash<Value_t>()( value ); }
+		ND_ static size_t		_ShardIndex (size_t hash)					{ return (hash ^ (hash >> 17)) & (ShardCount - 1); }
+		ND_ static size_t		_SlotStart (size_t hash, size_t size)		{ return (hash >> ShardBits) & (size - 1); }
+		ND_ static uint64_t		_MakeSlot (size_t hash, Index_t index)		{ return (uint64_t(uint(uint64_t(hash) >> 32) ^ uint(hash)) << 32) | (uint64_t(index) + 1); }
+		ND_ static bool			_IsSameHash (uint64_t slot, size_t hash)	{ return uint(slot >> 32) == (uint(uint64_t(hash) >> 32) ^ uint(hash)); }
+		ND_ static Index_t		_SlotIndex (uint64_t slot)					{ return Index_t( (slot & 0xFFFFFFFFu) - 1 ); }
+		ND_ static BytesU		_TableSize (size_t size)					{ return SizeOf<Table> + SizeOf<Slot_t> * (size - 1); }
+		ND_ static uint			_ReaderStripe ();
+
+		void  _LockShard (Shard &) const;
+		void  _Synchronize (Shard &) const;
+
+		ND_ bool	_Rebuild (Shard &, size_t minCount);
+		ND_ Table*	_CreateTable (size_t size);
+			void	_DestroyTable (Table *);
+	};
+
+
+
+/*
+=================================================
+	constructor
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A, size_t SC>
+	inline ShardedCachedIndexedPool<V,I,CS,MC,A,SC>::ShardedCachedIndexedPool (const Allocator_t &alloc) :
+		_pool{ alloc },
+		_allocator{ alloc }
+	{}
+
+/*
+=================================================
+	Release
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A, size_t SC>
+	inline void  ShardedCachedIndexedPool<V,I,CS,MC,A,SC>::Release ()
+	{
+		for (auto& shard : _shards)
+		{
+			EXLOCK( shard.writeGuard );
+
+			_DestroyTable( shard.table.exchange( null, EMemoryOrder::Relaxed ));
+			shard.used	= 0;
+			shard.count	= 0;
+		}
+		_pool.Release();
+	}
+
+/*
+=================================================
+	Insert
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A, size_t SC>
+	inline Pair<I, bool>  ShardedCachedIndexedPool<V,I,CS,MC,A,SC>::Insert (Index_t index, Value_t&& value)
+	{
+		std::swap( _pool[index], value );
+
+		return AddToCache( index );
+	}
+
+/*
+=================================================
+	AddToCache
+----
+	returns index of cached value and 'true' if value is inserted.
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A, size_t SC>
+	inline Pair<I, bool>  ShardedCachedIndexedPool<V,I,CS,MC,A,SC>::AddToCache (Index_t index)
+	{
+		const Value_t&	value	= _pool[index];
+		const size_t	hash	= _Hash( value );
+		Shard&			shard	= _shards[ _ShardIndex( hash )];
+
+		_LockShard( shard );
+		std::unique_lock	lock{ shard.writeGuard, std::adopt_lock };
+
+		// keep load factor less than 1/2
+		Table*	table = shard.table.load( EMemoryOrder::Relaxed );
+		if ( table == null or (shard.used + 1) * 2 > table->size )
+		{
+			CHECK_ERR( _Rebuild( shard, shard.count + 1 ), (Pair<Index_t, bool>{ Index_t(UMax), false }));
+			table = shard.table.load( EMemoryOrder::Relaxed );
+		}
+
+		const size_t	mask		= table->size - 1;
+		size_t			free_pos	= UMax;
+
+		for (size_t i = 0, pos = _SlotStart( hash, table->size); i < table->size; ++i, pos = (pos + 1) & mask)
+		{
+			const uint64_t	slot = table->slots[pos].load( EMemoryOrder::Relaxed );
+
+			if ( slot == EmptySlot )
+			{
+				if ( free_pos == UMax )
+					free_pos = pos;
+				break;
+			}
+
+			if ( slot == RemovedSlot )
+			{
+				if ( free_pos == UMax )
+					free_pos = pos;
+				continue;
+			}
+
+			// all cached values are alive while shard is locked
+			const Index_t	cached = _SlotIndex( slot );
+			if ( _IsSameHash( slot, hash ) and _pool[cached] == value )
+				return { cached, false };
+		}
+
+		ASSERT( free_pos != UMax );
+
+		if ( table->slots[free_pos].load( EMemoryOrder::Relaxed ) == EmptySlot )
+			++shard.used;
+		++shard.count;
+
+		// value must be visible for readers
+		table->slots[free_pos].store( _MakeSlot( hash, index ), EMemoryOrder::Release );
+		return { index, true };
+	}
+
+/*
+=================================================
+	RemoveFromCache
+----
+	when returns, value is not accessible by readers and can be destroyed.
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A, size_t SC>
+	inline bool  ShardedCachedIndexedPool<V,I,CS,MC,A,SC>::RemoveFromCache (Index_t index)
+	{
+		const size_t	hash	= _Hash( _pool[index] );
+		Shard&			shard	= _shards[ _ShardIndex( hash )];
+
+		_LockShard( shard );
+		std::unique_lock	lock{ shard.writeGuard, std::adopt_lock };
+
+		Table*	table = shard.table.load( EMemoryOrder::Relaxed );
+		if ( table == null )
+			return false;
+
+		const size_t	mask	= table->size - 1;
+		const uint64_t	expected= _MakeSlot( hash, index );
+
+		for (size_t i = 0, pos = _SlotStart( hash, table->size); i < table->size; ++i, pos = (pos + 1) & mask)
+		{
+			const uint64_t	slot = table->slots[pos].load( EMemoryOrder::Relaxed );
+
+			if ( slot == EmptySlot )
+				break;
+
+			if ( slot != expected )
+				continue;
+
+			table->slots[pos].store( RemovedSlot, EMemoryOrder::Relaxed );
+			--shard.count;
+
+			// readers that have found this slot must leave the shard before value will be destroyed
+			_Synchronize( shard );
+			return true;
+		}
+		return false;
+	}
+
+/*
+=================================================
+	Find
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A, size_t SC>
+	inline I  ShardedCachedIndexedPool<V,I,CS,MC,A,SC>::Find (const Value_t *value) const
+	{
+		const size_t	hash	= _Hash( *value );
+		Shard&			shard	= _shards[ _ShardIndex( hash )];
+		Index_t			result	= Index_t(UMax);
+
+		// enter read-side critical section, counter in the stripe of the current thread is not shared with readers in other threads
+		Atomic<uint>&	readers	= shard.readers[ _ReaderStripe() ].count[ shard.epoch.load( EMemoryOrder::Relaxed ) & 1 ];
+		readers.fetch_add( 1 );	// seq_cst, pairs with fence in '_Synchronize()'
+
+		if ( Table* table = shard.table.load( EMemoryOrder::Acquire ))
+		{
+			const size_t	mask = table->size - 1;
+
+			for (size_t i = 0, pos = _SlotStart( hash, table->size); i < table->size; ++i, pos = (pos + 1) & mask)
+			{
+				const uint64_t	slot = table->slots[pos].load( EMemoryOrder::Acquire );
+
+				if ( slot == EmptySlot )
+					break;
+
+				if ( slot == RemovedSlot or not _IsSameHash( slot, hash ))
+					continue;
+
+				const Index_t	cached = _SlotIndex( slot );
+				if ( _pool[cached] == *value )
+				{
+					result = cached;
+					break;
+				}
+			}
+		}
+
+		// leave read-side critical section
+		readers.fetch_sub( 1, EMemoryOrder::Release );
+
+		AE_CACHED_POOL_STATISTIC(
+			(result != Index_t(UMax) ? shard.hits : shard.misses).fetch_add( 1, EMemoryOrder::Relaxed );
+		)
+		return result;
+	}
+
+/*
+=================================================
+	DynamicSize
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A, size_t SC>
+	inline BytesU  ShardedCachedIndexedPool<V,I,CS,MC,A,SC>::DynamicSize () const
+	{
+		BytesU	sz = _pool.DynamicSize();
+
+		for (auto& shard : _shards)
+		{
+			EXLOCK( shard.writeGuard );
+
+			if ( Table* table = shard.table.load( EMemoryOrder::Relaxed ))
+				sz += _TableSize( table->size );
+		}
+		return sz;
+	}
+
+/*
+=================================================
+	GetStatistic
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A, size_t SC>
+	inline typename ShardedCachedIndexedPool<V,I,CS,MC,A,SC>::Statistic
+		ShardedCachedIndexedPool<V,I,CS,MC,A,SC>::GetStatistic () const
+	{
+		Statistic	result;
+		for (auto& shard : _shards)
+		{
+			AE_CACHED_POOL_STATISTIC(
+				result.hits		+= shard.hits.load( EMemoryOrder::Relaxed );
+				result.misses	+= shard.misses.load( EMemoryOrder::Relaxed );
+			)
+			result.contended	+= shard.contended.load( EMemoryOrder::Relaxed );
+		}
+		return result;
+	}
+
+/*
+=================================================
+	_LockShard
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A, size_t SC>
+	inline void  ShardedCachedIndexedPool<V,I,CS,MC,A,SC>::_LockShard (Shard &shard) const
+	{
+		if_likely( shard.writeGuard.try_lock() )
+			return;
+
+		shard.contended.fetch_add( 1, EMemoryOrder::Relaxed );
+		shard.writeGuard.lock();
+	}
+
+/*
+=================================================
+	_Synchronize
+----
+	waits until all readers which have entered the shard before this call are left.
+	Reader may use epoch which was read before previous '_Synchronize()',
+	so both reader counters must be drained, epoch is flipped before each wait
+	to prevent starvation by new readers.
+	Shard must be locked by writer.
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A, size_t SC>
+	inline void  ShardedCachedIndexedPool<V,I,CS,MC,A,SC>::_Synchronize (Shard &shard) const
+	{
+		for (uint i = 0; i < 2; ++i)
+		{
+			const uint	epoch = shard.epoch.fetch_add( 1 );	// seq_cst
+
+			// new epoch must be visible before reader counters are checked,
+			// reader which has incremented counter of the previous epoch will be found
+			ThreadFence( EMemoryOrder::SequentiallyConsistent );
+
+			for (auto& stripe : shard.readers)
+			{
+				for (uint p = 0; stripe.count[ epoch & 1 ].load( EMemoryOrder::Acquire ) != 0; ++p)
+				{
+					if ( p > 100 )
+						std::this_thread::yield();
+				}
+			}
+		}
+	}
+
+/*
+=================================================
+	_ReaderStripe
+----
+	stripes are assigned to threads in round-robin order
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A, size_t SC>
+	inline uint  ShardedCachedIndexedPool<V,I,CS,MC,A,SC>::_ReaderStripe ()
+	{
+		static Atomic<uint>		counter {0};
+		static thread_local uint	stripe	= counter.fetch_add( 1, EMemoryOrder::Relaxed ) % ReaderStripes;
+		return stripe;
+	}
+
+/*
+=================================================
+	_Rebuild
+----
+	creates new table without removed slots.
+	Shard must be locked by writer.
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A, size_t SC>
+	inline bool  ShardedCachedIndexedPool<V,I,CS,MC,A,SC>::_Rebuild (Shard &shard, size_t minCount)
+	{
+		const size_t	size		= Max( MinTableSize, size_t(1) << (IntLog2( minCount * 4 - 1 ) + 1) );
+		Table*			new_table	= _CreateTable( size );
+		Table*			old_table	= shard.table.load( EMemoryOrder::Relaxed );
+		CHECK_ERR( new_table != null );
+
+		shard.used = 0;
+
+		if ( old_table != null )
+		{
+			for (size_t i = 0; i < old_table->size; ++i)
+			{
+				const uint64_t	slot = old_table->slots[i].load( EMemoryOrder::Relaxed );
+
+				if ( slot == EmptySlot or slot == RemovedSlot )
+					continue;
+
+				size_t	pos = _SlotStart( _Hash( _pool[ _SlotIndex( slot )]), size );
+				for (; new_table->slots[pos].load( EMemoryOrder::Relaxed ) != EmptySlot; pos = (pos + 1) & (size - 1)) {}
+
+				new_table->slots[pos].store( slot, EMemoryOrder::Relaxed );
+				++shard.used;
+			}
+		}
+		ASSERT( shard.used == shard.count );
+
+		shard.table.store( new_table, EMemoryOrder::Release );
+
+		// old table may be used by readers
+		if ( old_table != null )
+		{
+			_Synchronize( shard );
+			_DestroyTable( old_table );
+		}
+		return true;
+	}
+
+/*
+=================================================
+	_CreateTable
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A, size_t SC>
+	inline typename ShardedCachedIndexedPool<V,I,CS,MC,A,SC>::Table*
+		ShardedCachedIndexedPool<V,I,CS,MC,A,SC>::_CreateTable (size_t size)
+	{
+		ASSERT( IsPowerOfTwo( size ));
+
+		Table*	table = Cast<Table>( _allocator.Allocate( _TableSize( size ), AlignOf<Table> ));
+		CHECK_ERR( table != null );
+
+		table->size = size;
+		for (size_t i = 0; i < size; ++i) {
+			PlacementNew<Slot_t>( &table->slots[i], EmptySlot );
+		}
+		return table;
+	}
+
+/*
+=================================================
+	_DestroyTable
+=================================================
+*/
+	template <typename V, typename I, size_t CS, size_t MC, typename A, size_t SC>
+	inline void  ShardedCachedIndexedPool<V,I,CS,MC,A,SC>::_DestroyTable (Table* table)
+	{
+		if ( table == null )
+			return;
+
+		_allocator.Deallocate( table, _TableSize( table->size ), AlignOf<Table> );
+	}
+
+
+}	// AE::Threading
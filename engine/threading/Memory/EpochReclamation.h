@@ -0,0 +1,353 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+/*
+	Epoch-based memory reclamation for lock-free containers.
+
+	Thread must be registered to get a slot, then all accesses to shared lock-free data
+	must be inside 'Guard' (critical section), thread announces the global epoch while it is in critical section.
+	Memory that is unlinked from the container is retired with the current global epoch 'e'
+	and is released when global epoch reaches 'e + 2'.
+	Global epoch can be advanced only when all threads in critical sections have announced the current epoch,
+	so when epoch reaches 'e + 2' all threads which may have a reference to the retired memory are left their critical sections.
+
+	Limitations:
+	- 'Retire()' must be called only after memory is unlinked and can not be found by new readers.
+	- each slot must be used only by a single thread at a time.
+	- thread must not keep references to the shared data after leaving the critical section.
+	- 'Release()' must be externally synchronized with all other accesses.
+	- deleter may be called in any registered thread.
+*/
+
+#pragma once
+
+#ifndef AE_LFAS_ENABLED
+# include "threading/Common.h"
+# include "threading/Primitives/SpinLock.h"
+# include "stl/Math/BitMath.h"
+#endif
+
+namespace AE::Threading
+{
+
+	//
+	// Epoch Reclamation
+	//
+
+	class EpochReclamation final
+	{
+	// types
+	public:
+		using Deleter_t	= void (*) (void* ptr, void* userData);
+
+		static constexpr uint	MaxThreads			= 64;
+		static constexpr uint	CollectThreshold	= 64;	// try to advance epoch and release memory when this number of pointers is retired
+
+		class Guard;
+
+	private:
+		struct Retired
+		{
+			void*		ptr			= null;
+			Deleter_t	deleter		= null;
+			void*		userData	= null;
+			uint		epoch		= 0;
+		};
+		using RetiredList_t	= Array< Retired >;
+
+		struct alignas(AE_CACHE_LINE) ThreadRecord
+		{
+			Atomic<uint>	state		{0};	// (epoch << 1) | active bit
+
+			// access only by owner
+			uint			nesting		= 0;
+			uint			lastCollect	= 0;
+			RetiredList_t	retired;
+		};
+
+		using Records_t		= StaticArray< ThreadRecord, MaxThreads >;
+		using SlotBits_t	= uint64_t;
+
+		STATIC_ASSERT( MaxThreads <= sizeof(SlotBits_t)*8 );
+		STATIC_ASSERT( Atomic<SlotBits_t>::is_always_lock_free );
+
+
+	// variables
+	private:
+		alignas(AE_CACHE_LINE) Atomic<uint>	_globalEpoch	{0};
+		alignas(AE_CACHE_LINE) Atomic<SlotBits_t>	_usedSlots	{0};
+
+		Records_t		_records;
+
+		SpinLock		_orphanGuard;
+		RetiredList_t	_orphans;			// retired memory from unregistered threads, protected by '_orphanGuard'
+
+
+	// methods
+	public:
+		EpochReclamation () {}
+		~EpochReclamation ()										{ Release(); }
+
+		EpochReclamation (const EpochReclamation &) = delete;
+		EpochReclamation (EpochReclamation &&) = delete;
+
+		EpochReclamation&  operator = (const EpochReclamation &) = delete;
+		EpochReclamation&  operator = (EpochReclamation &&) = delete;
+
+		// release all retired memory, must be externally synchronized
+			void  Release ();
+
+		ND_ bool  RegisterThread (OUT uint &slot);
+			void  UnregisterThread (uint slot);
+
+		// critical section, can be nested
+			void  Enter (uint slot);
+			void  Leave (uint slot);
+
+		// 'ptr' will be released by 'deleter' when it is not used in any critical section
+			void  Retire (uint slot, void* ptr, Deleter_t deleter, void* userData = null);
+
+		template <typename T>
+			void  Retire (uint slot, T* ptr)						{ Retire( slot, ptr, [] (void* p, void*) { delete static_cast<T*>(p); }); }
+
+		// release memory that was retired by this thread and can be safely released
+			void  Collect (uint slot);
+
+		// returns 'true' if global epoch has been advanced
+		ND_ bool  TryAdvance ();
+
+		ND_ uint  CurrentEpoch () const								{ return _globalEpoch.load( EMemoryOrder::Relaxed ); }
+
+	private:
+		ND_ static bool  _IsExpired (const Retired &r, uint epoch)	{ return (epoch - r.epoch) >= 2; }
+
+			static void  _ReleaseExpired (INOUT RetiredList_t &list, uint epoch);
+	};
+
+
+
+	//
+	// Epoch Reclamation Guard
+	//
+
+	class EpochReclamation::Guard final
+	{
+	private:
+		EpochReclamation &	_epoch;
+		const uint			_slot;
+
+	public:
+		Guard (EpochReclamation &epoch, uint slot) : _epoch{epoch}, _slot{slot}	{ _epoch.Enter( _slot ); }
+		~Guard ()																{ _epoch.Leave( _slot ); }
+
+		Guard (const Guard &) = delete;
+		Guard&  operator = (const Guard &) = delete;
+	};
+
+
+
+/*
+=================================================
+	Release
+=================================================
+*/
+	inline void  EpochReclamation::Release ()
+	{
+		ASSERT( _usedSlots.load( EMemoryOrder::Relaxed ) == 0 );	// all threads must be unregistered
+		ThreadFence( EMemoryOrder::Acquire );
+
+		for (auto& rec : _records)
+		{
+			for (auto& r : rec.retired) {
+				r.deleter( r.ptr, r.userData );
+			}
+			rec.retired.clear();
+		}
+
+		EXLOCK( _orphanGuard );
+		for (auto& r : _orphans) {
+			r.deleter( r.ptr, r.userData );
+		}
+		_orphans.clear();
+	}
+
+/*
+=================================================
+	RegisterThread
+=================================================
+*/
+	inline bool  EpochReclamation::RegisterThread (OUT uint &slot)
+	{
+		SlotBits_t	used = _usedSlots.load( EMemoryOrder::Relaxed );
+
+		for (int idx = BitScanForward( ~used ); idx >= 0 and idx < int(MaxThreads); idx = BitScanForward( ~used ))
+		{
+			// record may be used by another thread before, so acquire is needed
+			if ( _usedSlots.compare_exchange_weak( INOUT used, used | (SlotBits_t(1) << idx), EMemoryOrder::Acquire, EMemoryOrder::Relaxed ))
+			{
+				slot = uint(idx);
+				ASSERT( _records[slot].nesting == 0 );
+				return true;
+			}
+		}
+		return false;
+	}
+
+/*
+=================================================
+	UnregisterThread
+----
+	memory that can not be released now is moved to the orphan list
+=================================================
+*/
+	inline void  EpochReclamation::UnregisterThread (uint slot)
+	{
+		ASSERT( slot < MaxThreads );
+		auto&	rec = _records[slot];
+
+		ASSERT( rec.nesting == 0 );
+		Collect( slot );
+
+		if ( not rec.retired.empty() )
+		{
+			EXLOCK( _orphanGuard );
+			_orphans.insert( _orphans.end(), rec.retired.begin(), rec.retired.end() );
+			rec.retired.clear();
+		}
+
+		_usedSlots.fetch_and( ~(SlotBits_t(1) << slot), EMemoryOrder::Release );
+	}
+
+/*
+=================================================
+	Enter
+=================================================
+*/
+	inline void  EpochReclamation::Enter (uint slot)
+	{
+		ASSERT( slot < MaxThreads );
+		auto&	rec = _records[slot];
+
+		if ( rec.nesting++ > 0 )
+			return;
+
+		const uint	epoch = _globalEpoch.load( EMemoryOrder::Relaxed );
+		rec.state.store( (epoch << 1) | 1, EMemoryOrder::Relaxed );
+
+		// epoch must be announced before any access to the shared data
+		ThreadFence( EMemoryOrder::SequentiallyConsistent );
+	}
+
+/*
+=================================================
+	Leave
+=================================================
+*/
+	inline void  EpochReclamation::Leave (uint slot)
+	{
+		ASSERT( slot < MaxThreads );
+		auto&	rec = _records[slot];
+
+		ASSERT( rec.nesting > 0 );
+		if ( --rec.nesting > 0 )
+			return;
+
+		// all accesses to the shared data must be completed before leaving
+		rec.state.store( rec.state.load( EMemoryOrder::Relaxed ) & ~1u, EMemoryOrder::Release );
+	}
+
+/*
+=================================================
+	Retire
+=================================================
+*/
+	inline void  EpochReclamation::Retire (uint slot, void* ptr, Deleter_t deleter, void* userData)
+	{
+		ASSERT( slot < MaxThreads );
+		ASSERT( deleter != null );
+
+		auto&	rec = _records[slot];
+
+		// 'ptr' must be unlinked before reading the epoch
+		ThreadFence( EMemoryOrder::SequentiallyConsistent );
+
+		rec.retired.push_back( Retired{ ptr, deleter, userData, _globalEpoch.load( EMemoryOrder::Relaxed )});
+
+		if ( rec.retired.size() - rec.lastCollect >= CollectThreshold )
+		{
+			Unused( TryAdvance() );
+			Collect( slot );
+		}
+	}
+
+/*
+=================================================
+	Collect
+=================================================
+*/
+	inline void  EpochReclamation::Collect (uint slot)
+	{
+		ASSERT( slot < MaxThreads );
+		auto&	rec = _records[slot];
+
+		// synchronize with 'Leave()' in other threads
+		const uint	epoch = _globalEpoch.load( EMemoryOrder::Acquire );
+
+		_ReleaseExpired( INOUT rec.retired, epoch );
+		rec.lastCollect = uint(rec.retired.size());
+
+		if ( _orphanGuard.try_lock() )
+		{
+			_ReleaseExpired( INOUT _orphans, epoch );
+			_orphanGuard.unlock();
+		}
+	}
+
+/*
+=================================================
+	_ReleaseExpired
+----
+	epochs in the list are in ascending order (except orphans),
+	stops on the first pointer that can not be released yet
+=================================================
+*/
+	inline void  EpochReclamation::_ReleaseExpired (INOUT RetiredList_t &list, uint epoch)
+	{
+		size_t	count = 0;
+		for (; count < list.size() and _IsExpired( list[count], epoch ); ++count)
+		{
+			auto&	r = list[count];
+			r.deleter( r.ptr, r.userData );
+		}
+
+		list.erase( list.begin(), list.begin() + count );
+	}
+
+/*
+=================================================
+	TryAdvance
+=================================================
+*/
+	inline bool  EpochReclamation::TryAdvance ()
+	{
+		// announced epochs must be visible
+		ThreadFence( EMemoryOrder::SequentiallyConsistent );
+
+		uint		epoch	= _globalEpoch.load( EMemoryOrder::Relaxed );
+		SlotBits_t	used	= _usedSlots.load( EMemoryOrder::Relaxed );
+
+		for (int idx = BitScanForward( used ); idx >= 0; idx = BitScanForward( used ))
+		{
+			used &= ~(SlotBits_t(1) << idx);
+
+			// synchronize with 'Leave()'
+			const uint	state = _records[idx].state.load( EMemoryOrder::Acquire );
+
+			// thread is in critical section with previous epoch
+			if ( (state & 1) and (state & ~1u) != (epoch << 1) )
+				return false;
+		}
+
+		return _globalEpoch.compare_exchange_strong( INOUT epoch, epoch + 1, EMemoryOrder::Release, EMemoryOrder::Relaxed );
+	}
+
+
+}	// AE::Threading
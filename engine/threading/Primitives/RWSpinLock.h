@@ -7,6 +7,8 @@
 # include "stl/Types/Noncopyable.h"
 #endif
 
+#include "threading/Primitives/SpinWait.h"
+
 namespace AE::Threading
 {
 
@@ -20,6 +22,13 @@ namespace AE::Threading
 	private:
 		Atomic<int>		_flag { 0 };	// 0 -- unlocked, -1 -- write lock, >0 -- read lock
 
+	#if AE_SPINLOCK_MODE == 1
+		Atomic<uint>	_parked		{0};	// number of parked threads
+		Atomic<uint>	_wakeSeq	{0};	// changed on each wakeup, used as futex
+	#endif
+
+		AE_SPINLOCK_STAT( SpinLockCounters	_stat; )
+
 
 	// methods
 	public:
@@ -37,7 +46,25 @@ namespace AE::Threading
 			return _flag.compare_exchange_strong( INOUT exp, -1, EMemoryOrder::Acquire, EMemoryOrder::Relaxed );
 		}
 
+		ND_ forceinline bool  try_lock_shared ()
+		{
+			int	exp = 0;
+			for (; not _flag.compare_exchange_weak( INOUT exp, exp + 1, EMemoryOrder::Acquire, EMemoryOrder::Relaxed );)
+			{
+				if ( exp < 0 )
+					return false;
+			}
+			return true;
+		}
 
+		ND_ forceinline bool  try_shared_to_exclusive ()
+		{
+			int	exp = 1;
+			return _flag.compare_exchange_strong( INOUT exp, -1, EMemoryOrder::Acquire, EMemoryOrder::Relaxed );
+		}
+
+
+	#if AE_SPINLOCK_MODE == 0
 		// for std::lock_guard / std::unique_lock
 		forceinline void  lock ()
 		{
@@ -62,18 +89,6 @@ namespace AE::Threading
 		}
 
 
-		ND_ forceinline bool  try_lock_shared ()
-		{
-			int	exp = 0;
-			for (; not _flag.compare_exchange_weak( INOUT exp, exp + 1, EMemoryOrder::Acquire, EMemoryOrder::Relaxed );)
-			{
-				if ( exp < 0 )
-					return false;
-			}
-			return true;
-		}
-
-
 		// for std::shared_lock
 		forceinline void  lock_shared ()
 		{
@@ -88,7 +103,6 @@ namespace AE::Threading
 			}
 		}
 
-
 		forceinline void  unlock_shared ()
 		{
 			int	old = _flag.fetch_sub( 1, EMemoryOrder::Release );
@@ -97,19 +111,146 @@ namespace AE::Threading
 		}
 
 
-		ND_ forceinline bool  try_shared_to_exclusive ()
+		forceinline void  exclusive_to_shared ()
 		{
-			int	exp = 1;
-			return _flag.compare_exchange_strong( INOUT exp, -1, EMemoryOrder::Acquire, EMemoryOrder::Relaxed );
+			int	exp = -1;
+			_flag.compare_exchange_strong( INOUT exp, 1, EMemoryOrder::Acquire, EMemoryOrder::Relaxed );
+			ASSERT( exp == -1 );
+		}
+
+	#elif AE_SPINLOCK_MODE == 1
+		// for std::lock_guard / std::unique_lock
+		forceinline void  lock ()
+		{
+			if_unlikely( not try_lock() )
+				_LockSlow();
+		}
+
+		forceinline void  unlock ()
+		{
+			// seq_cst is required to check '_parked' after unlocking
+			const int	old = _flag.exchange( 0, EMemoryOrder::SequentiallyConsistent );
+			ASSERT( old == -1 );
+			Unused( old );
+
+			_WakeParked();
+		}
+
+
+		// for std::shared_lock
+		forceinline void  lock_shared ()
+		{
+			if_unlikely( not try_lock_shared() )
+				_LockSharedSlow();
+		}
+
+		forceinline void  unlock_shared ()
+		{
+			const int	old = _flag.fetch_sub( 1, EMemoryOrder::SequentiallyConsistent );
+			ASSERT( old > 0 );
+
+			// only writers can wait for readers
+			if ( old == 1 )
+				_WakeParked();
 		}
 
 
 		forceinline void  exclusive_to_shared ()
 		{
 			int	exp = -1;
-			_flag.compare_exchange_strong( INOUT exp, 1, EMemoryOrder::Acquire, EMemoryOrder::Relaxed );
+			_flag.compare_exchange_strong( INOUT exp, 1, EMemoryOrder::SequentiallyConsistent, EMemoryOrder::Relaxed );
 			ASSERT( exp == -1 );
+
+			// parked readers can continue
+			_WakeParked();
+		}
+	#endif
+
+		ND_ SpinLockStatistic  GetStatistic () const
+		{
+		#if AE_SPINLOCK_STATISTIC
+			return _stat.Get();
+		#else
+			return {};
+		#endif
+		}
+
+
+	private:
+	#if AE_SPINLOCK_MODE == 1
+		void  _LockSlow ()
+		{
+			const auto	TryLock = [this] ()
+			{
+				int	exp = _flag.load( EMemoryOrder::SequentiallyConsistent );
+				return exp == 0 and _flag.compare_exchange_weak( INOUT exp, -1, EMemoryOrder::SequentiallyConsistent, EMemoryOrder::SequentiallyConsistent );
+			};
+			_WaitFor( TryLock );
+		}
+
+		void  _LockSharedSlow ()
+		{
+			const auto	TryLockShared = [this] ()
+			{
+				int	exp = _flag.load( EMemoryOrder::SequentiallyConsistent );
+				for (; exp >= 0;)
+				{
+					if ( _flag.compare_exchange_weak( INOUT exp, exp + 1, EMemoryOrder::SequentiallyConsistent, EMemoryOrder::SequentiallyConsistent ))
+						return true;
+				}
+				return false;
+			};
+			_WaitFor( TryLockShared );
+		}
+
+		template <typename FN>
+		void  _WaitFor (const FN &tryLock)
+		{
+			SpinWait	spin;
+			for (;;)
+			{
+				if ( tryLock() )
+				{
+					AE_SPINLOCK_STAT( _stat.Add( 1, spin.YieldCount(), 0 ); )
+					return;
+				}
+
+				if ( not spin.Wait() )
+					break;
+			}
+
+			// lock holder may be preempted, park thread until 'unlock()' or 'unlock_shared()'
+			uint	parks = 0;
+			for (;; ++parks)
+			{
+				const uint	seq = _wakeSeq.load( EMemoryOrder::Acquire );
+
+				// '_parked' must be incremented before 'tryLock()' to avoid lost wakeup
+				_parked.fetch_add( 1, EMemoryOrder::SequentiallyConsistent );
+
+				if ( tryLock() )
+				{
+					_parked.fetch_sub( 1, EMemoryOrder::Relaxed );
+					break;
+				}
+
+				AtomicWait::Wait( _wakeSeq, seq );
+				_parked.fetch_sub( 1, EMemoryOrder::Relaxed );
+			}
+
+			AE_SPINLOCK_STAT( _stat.Add( 1, spin.YieldCount(), parks ); )
+			Unused( parks );
+		}
+
+		forceinline void  _WakeParked ()
+		{
+			if_unlikely( _parked.load( EMemoryOrder::SequentiallyConsistent ) > 0 )
+			{
+				_wakeSeq.fetch_add( 1, EMemoryOrder::Release );
+				AtomicWait::WakeAll( _wakeSeq );
+			}
 		}
+	#endif
 	};
 
 
@@ -7,6 +7,8 @@
 # include "stl/Types/Noncopyable.h"
 #endif
 
+#include "threading/Primitives/SpinWait.h"
+
 namespace AE::Threading
 {
 
@@ -18,7 +20,9 @@ namespace AE::Threading
 	{
 	// variables
 	private:
-		Atomic<uint>	_flag { 0 };
+		Atomic<uint>	_flag { 0 };	// 0 -- unlocked, 1 -- locked, 2 -- locked and has parked threads
+
+		AE_SPINLOCK_STAT( SpinLockCounters	_stat; )
 
 
 	// methods
@@ -38,6 +42,7 @@ namespace AE::Threading
 		}
 
 
+	#if AE_SPINLOCK_MODE == 0
 		// for std::lock_guard
 		forceinline void lock ()
 		{
@@ -60,6 +65,65 @@ namespace AE::Threading
 			_flag.store( 0, EMemoryOrder::Release );
 		#endif
 		}
+
+	#elif AE_SPINLOCK_MODE == 1
+		// for std::lock_guard
+		forceinline void lock ()
+		{
+			if_unlikely( not try_lock() )
+				_LockSlow();
+		}
+
+		forceinline void unlock ()
+		{
+			const uint	old = _flag.exchange( 0, EMemoryOrder::Release );
+			ASSERT( old != 0 );
+
+			if_unlikely( old == 2 )
+				AtomicWait::WakeOne( _flag );
+		}
+	#endif
+
+		ND_ SpinLockStatistic  GetStatistic () const
+		{
+		#if AE_SPINLOCK_STATISTIC
+			return _stat.Get();
+		#else
+			return {};
+		#endif
+		}
+
+
+	private:
+	#if AE_SPINLOCK_MODE == 1
+		void _LockSlow ()
+		{
+			SpinWait	spin;
+			for (;;)
+			{
+				// test and test-and-set
+				uint	exp = _flag.load( EMemoryOrder::Relaxed );
+				if ( exp == 0 and _flag.compare_exchange_weak( INOUT exp, 1, EMemoryOrder::Acquire, EMemoryOrder::Relaxed ))
+				{
+					AE_SPINLOCK_STAT( _stat.Add( 1, spin.YieldCount(), 0 ); )
+					return;
+				}
+
+				if ( not spin.Wait() )
+					break;
+			}
+
+			// lock holder may be preempted, park thread until 'unlock()'
+			uint	parks = 0;
+			for (; _flag.exchange( 2, EMemoryOrder::Acquire ) != 0; ++parks)
+			{
+				AtomicWait::Wait( _flag, 2 );
+			}
+
+			AE_SPINLOCK_STAT( _stat.Add( 1, spin.YieldCount(), parks ); )
+			Unused( parks );
+		}
+	#endif
 	};
 
 	
@@ -0,0 +1,155 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "threading/Primitives/SpinWait.h"
+
+#if AE_SPINLOCK_MODE == 1
+# if defined(PLATFORM_LINUX) or defined(PLATFORM_ANDROID)
+#	include <linux/futex.h>
+#	include <sys/syscall.h>
+#	include <unistd.h>
+#	include <climits>
+#	define AE_FUTEX_LINUX
+
+# elif defined(PLATFORM_WINDOWS) and defined(WINDOWS_TARGET_VERSION) and (WINDOWS_TARGET_VERSION >= 8)
+#	include "stl/Platforms/WindowsHeader.h"
+#	define AE_FUTEX_WINDOWS
+#	ifdef COMPILER_MSVC
+#	  pragma comment( lib, "Synchronization.lib" )
+#	endif
+# endif
+#endif	// AE_SPINLOCK_MODE == 1
+
+
+namespace AE::Threading
+{
+#if AE_SPINLOCK_STATISTIC
+namespace {
+	static Atomic<uint64_t>		s_Contended	{0};
+	static Atomic<uint64_t>		s_Yields	{0};
+	static Atomic<uint64_t>		s_Parks		{0};
+}
+/*
+=================================================
+	Add
+=================================================
+*/
+	void  SpinLockCounters::Add (uint contended, uint yields, uint parks)
+	{
+		_contended.fetch_add( contended, EMemoryOrder::Relaxed );
+		s_Contended.fetch_add( contended, EMemoryOrder::Relaxed );
+
+		if ( yields > 0 )
+		{
+			_yields.fetch_add( yields, EMemoryOrder::Relaxed );
+			s_Yields.fetch_add( yields, EMemoryOrder::Relaxed );
+		}
+		if ( parks > 0 )
+		{
+			_parks.fetch_add( parks, EMemoryOrder::Relaxed );
+			s_Parks.fetch_add( parks, EMemoryOrder::Relaxed );
+		}
+	}
+
+/*
+=================================================
+	Get
+=================================================
+*/
+	SpinLockStatistic  SpinLockCounters::Get () const
+	{
+		SpinLockStatistic	result;
+		result.contended	= _contended.load( EMemoryOrder::Relaxed );
+		result.yields		= _yields.load( EMemoryOrder::Relaxed );
+		result.parks		= _parks.load( EMemoryOrder::Relaxed );
+		return result;
+	}
+
+/*
+=================================================
+	GetGlobal
+=================================================
+*/
+	SpinLockStatistic  SpinLockCounters::GetGlobal ()
+	{
+		SpinLockStatistic	result;
+		result.contended	= s_Contended.load( EMemoryOrder::Relaxed );
+		result.yields		= s_Yields.load( EMemoryOrder::Relaxed );
+		result.parks		= s_Parks.load( EMemoryOrder::Relaxed );
+		return result;
+	}
+
+/*
+=================================================
+	ResetGlobal
+=================================================
+*/
+	void  SpinLockCounters::ResetGlobal ()
+	{
+		s_Contended.store( 0, EMemoryOrder::Relaxed );
+		s_Yields.store( 0, EMemoryOrder::Relaxed );
+		s_Parks.store( 0, EMemoryOrder::Relaxed );
+	}
+#endif	// AE_SPINLOCK_STATISTIC
+
+
+#if AE_SPINLOCK_MODE == 1
+/*
+=================================================
+	Wait
+=================================================
+*/
+	void  AtomicWait::Wait (const Atomic<uint> &value, uint expected)
+	{
+		STATIC_ASSERT( sizeof(value) == sizeof(uint) );
+
+	#if defined(AE_FUTEX_LINUX)
+		::syscall( SYS_futex, reinterpret_cast<const uint *>(&value), FUTEX_WAIT_PRIVATE, expected, null, null, 0 );
+
+	#elif defined(AE_FUTEX_WINDOWS)
+		::WaitOnAddress( const_cast<Atomic<uint> *>(&value), &expected, sizeof(expected), INFINITE );
+
+	#else
+		// fallback, caller checks condition after wakeup
+		if ( value.load( EMemoryOrder::Relaxed ) == expected )
+			std::this_thread::sleep_for( std::chrono::microseconds{50} );
+	#endif
+	}
+
+/*
+=================================================
+	WakeOne
+=================================================
+*/
+	void  AtomicWait::WakeOne (Atomic<uint> &value)
+	{
+	#if defined(AE_FUTEX_LINUX)
+		::syscall( SYS_futex, reinterpret_cast<uint *>(&value), FUTEX_WAKE_PRIVATE, 1, null, null, 0 );
+
+	#elif defined(AE_FUTEX_WINDOWS)
+		::WakeByAddressSingle( &value );
+
+	#else
+		Unused( value );
+	#endif
+	}
+
+/*
+=================================================
+	WakeAll
+=================================================
+*/
+	void  AtomicWait::WakeAll (Atomic<uint> &value)
+	{
+	#if defined(AE_FUTEX_LINUX)
+		::syscall( SYS_futex, reinterpret_cast<uint *>(&value), FUTEX_WAKE_PRIVATE, INT_MAX, null, null, 0 );
+
+	#elif defined(AE_FUTEX_WINDOWS)
+		::WakeByAddressAll( &value );
+
+	#else
+		Unused( value );
+	#endif
+	}
+#endif	// AE_SPINLOCK_MODE == 1
+
+}	// AE::Threading
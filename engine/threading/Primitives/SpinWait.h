@@ -0,0 +1,179 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+/*
+	AE_SPINLOCK_MODE:
+		0 - pure spinning with 'yield' after 1000 attempts.
+		1 - adaptive: spinning with exponential backoff and 'pause' instruction,
+			then 'yield', then thread is parked (futex on Linux/Android, WaitOnAddress on Windows 8+).
+			Protects against burning whole time slices when lock holder is preempted (oversubscription).
+
+	AE_SPINLOCK_STATISTIC:
+		0 - disabled.
+		1 - in adaptive mode each lock counts contentions, yields and parks, global statistic is printed by TaskScheduler.
+			Increases size of lock types and adds global atomic counters to the slow path.
+*/
+
+#pragma once
+
+#ifndef AE_LFAS_ENABLED
+# include "threading/Common.h"
+#endif
+
+#ifndef AE_SPINLOCK_MODE
+# ifdef AE_LFAS_ENABLED
+#	define AE_SPINLOCK_MODE		0
+# else
+#	define AE_SPINLOCK_MODE		1
+# endif
+#endif
+
+#ifndef AE_SPINLOCK_STATISTIC
+#	define AE_SPINLOCK_STATISTIC	0
+#endif
+
+#if AE_SPINLOCK_STATISTIC
+#	define AE_SPINLOCK_STAT( ... )	__VA_ARGS__
+#else
+#	define AE_SPINLOCK_STAT( ... )
+#endif
+
+#if (AE_SPINLOCK_MODE == 1) and (defined(__x86_64__) or defined(__i386__) or defined(_M_X64) or defined(_M_IX86))
+#	include <immintrin.h>
+#endif
+
+namespace AE::Threading
+{
+
+	//
+	// Spin Lock Statistic
+	//
+
+	struct SpinLockStatistic
+	{
+		uint64_t	contended	= 0;	// lock was not acquired on first attempt
+		uint64_t	yields		= 0;
+		uint64_t	parks		= 0;	// thread was parked by OS
+	};
+
+
+#if AE_SPINLOCK_STATISTIC
+	//
+	// Spin Lock Counters
+	//
+
+	struct SpinLockCounters
+	{
+	// variables
+	private:
+		Atomic<uint>	_contended	{0};
+		Atomic<uint>	_yields		{0};
+		Atomic<uint>	_parks		{0};
+
+
+	// methods
+	public:
+		// also updates global statistic
+			void  Add (uint contended, uint yields, uint parks);
+
+		ND_ SpinLockStatistic  Get () const;
+
+		ND_ static SpinLockStatistic  GetGlobal ();
+			static void  ResetGlobal ();
+	};
+#endif	// AE_SPINLOCK_STATISTIC
+
+
+#if AE_SPINLOCK_MODE == 1
+	//
+	// Spin Wait
+	//
+
+	struct SpinWait
+	{
+	// variables
+	public:
+		static constexpr uint	MaxSpinStep		= 10;	// 2^10 pauses on last step
+		static constexpr uint	MaxYieldCount	= 16;
+
+	private:
+		uint	_step	= 0;
+
+
+	// methods
+	public:
+		SpinWait () {}
+
+		// returns 'false' if thread should be parked
+		ND_ forceinline bool  Wait ()
+		{
+			if_likely( _step < MaxSpinStep )
+			{
+				for (uint i = 0, cnt = (1u << _step); i < cnt; ++i) {
+					Pause();
+				}
+				++_step;
+				return true;
+			}
+
+			if ( _step < MaxSpinStep + MaxYieldCount )
+			{
+				std::this_thread::yield();
+				++_step;
+				return true;
+			}
+			return false;
+		}
+
+		ND_ uint  YieldCount () const	{ return _step > MaxSpinStep ? _step - MaxSpinStep : 0; }
+
+		static forceinline void  Pause ()
+		{
+		#if defined(__x86_64__) or defined(__i386__) or defined(_M_X64) or defined(_M_IX86)
+			_mm_pause();
+		#elif defined(__aarch64__) or defined(__arm__)
+			asm volatile( "yield" );
+		#else
+			CompilerFence( EMemoryOrder::Acquire );
+		#endif
+		}
+	};
+
+
+
+	//
+	// Atomic Wait (futex)
+	//
+
+	struct AtomicWait final
+	{
+		AtomicWait () = delete;
+
+		// blocks thread while 'value' equals to 'expected', may return spuriously
+		static void  Wait (const Atomic<uint> &value, uint expected);
+
+		static void  WakeOne (Atomic<uint> &value);
+		static void  WakeAll (Atomic<uint> &value);
+	};
+#endif	// AE_SPINLOCK_MODE == 1
+
+
+}	// AE::Threading
+
+
+// check definitions
+#ifdef AE_CPP_DETECT_MISSMATCH
+
+#  if AE_SPINLOCK_MODE == 0
+#	pragma detect_mismatch( "AE_SPINLOCK_MODE", "0" )
+#  elif AE_SPINLOCK_MODE == 1
+#	pragma detect_mismatch( "AE_SPINLOCK_MODE", "1" )
+#  else
+#	error fix me!
+#  endif
+
+#  if AE_SPINLOCK_STATISTIC
+#	pragma detect_mismatch( "AE_SPINLOCK_STATISTIC", "1" )
+#  else
+#	pragma detect_mismatch( "AE_SPINLOCK_STATISTIC", "0" )
+#  endif
+
+#endif	// AE_CPP_DETECT_MISSMATCH
@@ -0,0 +1,63 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+/*
+	Auto-reset event, used to park idle threads.
+	Signal before Wait is not lost, Wait returns immediately and resets the event.
+*/
+
+#pragma once
+
+#include "threading/Common.h"
+#include <chrono>
+#include <condition_variable>
+
+namespace AE::Threading
+{
+
+	//
+	// Wakeup Event
+	//
+
+	class WakeupEvent final
+	{
+	// variables
+	private:
+		Mutex					_guard;
+		std::condition_variable	_cv;
+		bool					_signaled	= false;
+
+
+	// methods
+	public:
+		WakeupEvent () {}
+
+		WakeupEvent (const WakeupEvent &) = delete;
+		WakeupEvent (WakeupEvent &&) = delete;
+
+		WakeupEvent&  operator = (const WakeupEvent &) = delete;
+		WakeupEvent&  operator = (WakeupEvent &&) = delete;
+
+
+		void  Signal ()
+		{
+			{
+				EXLOCK( _guard );
+				_signaled = true;
+			}
+			_cv.notify_one();
+		}
+
+
+		// returns 'false' on timeout
+		bool  Wait (std::chrono::nanoseconds timeout)
+		{
+			std::unique_lock	lock{ _guard };
+
+			const bool	res = _cv.wait_for( lock, timeout, [this] () { return _signaled; });
+
+			_signaled = false;
+			return res;
+		}
+	};
+
+
+}	// AE::Threading
@@ -0,0 +1,144 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+/*
+	Chase-Lev work-stealing deque.
+	based on "Correct and Efficient Work-Stealing for Weak Memory Models" (Le, Pop, Cohen, Nardelli).
+
+	This lock-free container has some limitations:
+	- 'Push' and 'Pop' must be called only by owner thread.
+	- 'Steal' can be called from any thread.
+	- capacity is fixed, 'Push' returns 'false' when deque is full.
+	- value type must be trivially copyable and lock-free atomic (for example: pointer).
+*/
+
+#pragma once
+
+#ifndef AE_LFAS_ENABLED
+# include "threading/Common.h"
+# include "stl/Math/BitMath.h"
+#endif
+
+namespace AE::Threading
+{
+
+	//
+	// Lock-free Work Stealing Deque
+	//
+
+	template <typename T, size_t Capacity_v = 1u << 12>
+	struct LfWorkStealingDeque final
+	{
+		STATIC_ASSERT( IsPowerOfTwo( Capacity_v ));
+		STATIC_ASSERT( Atomic<T>::is_always_lock_free );
+		STATIC_ASSERT( std::is_trivially_copyable_v<T> );
+
+	// types
+	public:
+		using Self		= LfWorkStealingDeque< T, Capacity_v >;
+		using Value_t	= T;
+
+	private:
+		static constexpr int64_t	Capacity	= int64_t(Capacity_v);
+		static constexpr int64_t	Mask		= Capacity - 1;
+
+
+	// variables
+	private:
+		alignas(AE_CACHE_LINE) Atomic<int64_t>	_top		{0};	// steal from top
+		alignas(AE_CACHE_LINE) Atomic<int64_t>	_bottom		{0};	// push/pop to bottom
+		alignas(AE_CACHE_LINE) Atomic<T>		_buffer [Capacity_v];
+
+
+	// methods
+	public:
+		LfWorkStealingDeque ()
+		{
+			for (auto& item : _buffer) {
+				item.store( T{}, EMemoryOrder::Relaxed );
+			}
+		}
+
+		LfWorkStealingDeque (const Self &) = delete;
+		LfWorkStealingDeque (Self &&) = delete;
+
+		Self&  operator = (const Self &) = delete;
+		Self&  operator = (Self &&) = delete;
+
+
+		// owner thread only
+		ND_ bool  Push (const T &value)
+		{
+			const int64_t	b = _bottom.load( EMemoryOrder::Relaxed );
+			const int64_t	t = _top.load( EMemoryOrder::Acquire );
+
+			if_unlikely( b - t >= Capacity )
+				return false;
+
+			_buffer[ b & Mask ].store( value, EMemoryOrder::Relaxed );
+
+			ThreadFence( EMemoryOrder::Release );
+			_bottom.store( b + 1, EMemoryOrder::Relaxed );
+			return true;
+		}
+
+
+		// owner thread only, LIFO order
+		ND_ bool  Pop (OUT T &value)
+		{
+			const int64_t	b = _bottom.load( EMemoryOrder::Relaxed ) - 1;
+			_bottom.store( b, EMemoryOrder::Relaxed );
+
+			ThreadFence( std::memory_order_seq_cst );
+			int64_t			t = _top.load( EMemoryOrder::Relaxed );
+
+			if ( t > b )
+			{
+				// empty
+				_bottom.store( b + 1, EMemoryOrder::Relaxed );
+				return false;
+			}
+
+			value = _buffer[ b & Mask ].load( EMemoryOrder::Relaxed );
+
+			if ( t == b )
+			{
+				// last element, race with 'Steal'
+				const bool	won = _top.compare_exchange_strong( INOUT t, t + 1, std::memory_order_seq_cst, EMemoryOrder::Relaxed );
+				_bottom.store( b + 1, EMemoryOrder::Relaxed );
+				return won;
+			}
+			return true;
+		}
+
+
+		// any thread, FIFO order
+		ND_ bool  Steal (OUT T &value)
+		{
+			int64_t			t = _top.load( EMemoryOrder::Acquire );
+			ThreadFence( std::memory_order_seq_cst );
+			const int64_t	b = _bottom.load( EMemoryOrder::Acquire );
+
+			if ( t >= b )
+				return false;	// empty
+
+			value = _buffer[ t & Mask ].load( EMemoryOrder::Relaxed );
+
+			// another thread has stolen or owner has popped this value
+			return _top.compare_exchange_strong( INOUT t, t + 1, std::memory_order_seq_cst, EMemoryOrder::Relaxed );
+		}
+
+
+		// approximate value
+		ND_ size_t  Size () const
+		{
+			const int64_t	b = _bottom.load( EMemoryOrder::Relaxed );
+			const int64_t	t = _top.load( EMemoryOrder::Relaxed );
+			return b > t ? size_t(b - t) : 0;
+		}
+
+		ND_ bool  Empty ()							const	{ return Size() == 0; }
+
+		ND_ static constexpr size_t  capacity ()			{ return Capacity_v; }
+	};
+
+
+}	// AE::Threading
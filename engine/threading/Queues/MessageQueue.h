@@ -1,19 +1,270 @@
 // Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+/*
+	Bounded lock-free message queue.
+	based on Dmitry Vyukov's bounded MPMC queue.
+
+	Each cell has sequence number that shows which operation is allowed for the cell:
+	- 'seq == pos'		- cell is empty and can be used by producer with position 'pos',
+	- 'seq == pos + 1'	- cell contains message that can be consumed by consumer with position 'pos'.
+	Producers and consumers reserve range of cells with single CAS, so batched operations are cheaper than single operations.
+
+	This lock-free container has some limitations:
+	- capacity is fixed, 'Produce' returns 'false' when queue is full.
+	- messages are consumed in FIFO order, but with multiple consumers messages may be processed out of order.
+	- in MPSC mode 'Consume' and 'ConsumeAll' must be called only by one thread at a time.
+	- message type must be nothrow move constructible.
+*/
 
 #pragma once
 
-#include "stl/Common.h"
+#ifndef AE_LFAS_ENABLED
+# include "threading/Common.h"
+# include "stl/Containers/ArrayView.h"
+# include "stl/Math/BitMath.h"
+# include "stl/Memory/MemUtils.h"
+#endif
 
 namespace AE::Threading
 {
 
 	//
-	// Message Queue
+	// Lock-free Message Queue
 	//
 
+	template <typename T, size_t Capacity_v = 1u << 10, bool MultiConsumer_v = true>
 	class MessageQueue final
 	{
-		// TODO
+		STATIC_ASSERT( IsPowerOfTwo( Capacity_v ));
+		STATIC_ASSERT( std::is_nothrow_move_constructible_v<T> );
+
+	// types
+	public:
+		using Self		= MessageQueue< T, Capacity_v, MultiConsumer_v >;
+		using Value_t	= T;
+
+		static constexpr bool	MultiConsumer	= MultiConsumer_v;
+
+	private:
+		static constexpr size_t	Capacity	= Capacity_v;
+		static constexpr size_t	Mask		= Capacity - 1;
+
+		struct Cell
+		{
+			Atomic<size_t>				seq;
+			alignas(T) uint8_t			data [sizeof(T)];
+
+			ND_ T&  Value ()	{ return *Cast<T>( &data[0] ); }
+		};
+
+
+	// variables
+	private:
+		alignas(AE_CACHE_LINE) Atomic<size_t>	_enqueuePos	{0};
+		alignas(AE_CACHE_LINE) Atomic<size_t>	_dequeuePos	{0};
+		alignas(AE_CACHE_LINE) Cell				_cells [Capacity_v];
+
+
+	// methods
+	public:
+		MessageQueue ()
+		{
+			for (size_t i = 0; i < Capacity; ++i) {
+				_cells[i].seq.store( i, EMemoryOrder::Relaxed );
+			}
+		}
+
+		~MessageQueue ()
+		{
+			Clear();
+		}
+
+		MessageQueue (const Self &) = delete;
+		MessageQueue (Self &&) = delete;
+
+		Self&  operator = (const Self &) = delete;
+		Self&  operator = (Self &&) = delete;
+
+
+		// any thread
+		template <typename ...Args>
+		ND_ bool  Emplace (Args&& ...args)
+		{
+			size_t	pos;
+			if_unlikely( _Reserve( 1, OUT pos ) == 0 )
+				return false;
+
+			auto&	cell = _cells[ pos & Mask ];
+			PlacementNew<T>( &cell.data[0], std::forward<Args>(args)... );
+			cell.seq.store( pos + 1, EMemoryOrder::Release );
+			return true;
+		}
+
+		ND_ bool  Produce (T &&msg)			{ return Emplace( std::move(msg) ); }
+		ND_ bool  Produce (const T &msg)	{ return Emplace( msg ); }
+
+
+		// any thread, returns number of messages that are added to the queue, messages are added in the same order
+		ND_ size_t  Produce (ArrayView<T> msgs)
+		{
+			size_t			pos;
+			const size_t	count = _Reserve( msgs.size(), OUT pos );
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				auto&	cell = _cells[ (pos + i) & Mask ];
+				PlacementNew<T>( &cell.data[0], msgs[i] );
+				cell.seq.store( pos + i + 1, EMemoryOrder::Release );
+			}
+			return count;
+		}
+
+
+		// any thread if 'MultiConsumer' is true, otherwise single consumer thread
+		ND_ bool  Consume (OUT T &msg)
+		{
+			return ConsumeAll( [&msg] (T &&value) { msg = std::move(value); }, 1 ) == 1;
+		}
+
+
+		// any thread if 'MultiConsumer' is true, otherwise single consumer thread.
+		// 'fn' is called with 'T &&' for each message, messages that are added during call are not consumed.
+		template <typename Fn>
+		size_t  ConsumeAll (Fn &&fn, size_t maxCount = UMax)
+		{
+			size_t			pos;
+			const size_t	count = _Acquire( Min( maxCount, Capacity ), OUT pos );
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				auto&	cell	= _cells[ (pos + i) & Mask ];
+				T&		value	= cell.Value();
+
+				fn( std::move(value) );
+				value.~T();
+
+				// cell can be used by producer in the next round
+				cell.seq.store( pos + i + Capacity, EMemoryOrder::Release );
+			}
+			return count;
+		}
+
+
+		// same as 'ConsumeAll' but messages are destroyed
+		void  Clear ()
+		{
+			while ( ConsumeAll( [] (T &&) {} ) > 0 )
+			{}
+		}
+
+
+		// returns 'true' if there are no messages which can be consumed
+		ND_ bool  Empty () const
+		{
+			const size_t	pos	= _dequeuePos.load( EMemoryOrder::Relaxed );
+			const size_t	seq	= _cells[ pos & Mask ].seq.load( EMemoryOrder::Acquire );
+			return ptrdiff_t(seq - (pos + 1)) < 0;
+		}
+
+
+		// approximate value
+		ND_ size_t  Size () const
+		{
+			const size_t	e = _enqueuePos.load( EMemoryOrder::Relaxed );
+			const size_t	d = _dequeuePos.load( EMemoryOrder::Relaxed );
+			return ptrdiff_t(e - d) > 0 ? e - d : 0;
+		}
+
+		ND_ static constexpr size_t  capacity ()	{ return Capacity_v; }
+
+
+	private:
+
+		// reserve up to 'maxCount' empty cells for producer
+		ND_ size_t  _Reserve (size_t maxCount, OUT size_t &pos)
+		{
+			pos = _enqueuePos.load( EMemoryOrder::Relaxed );
+
+			for (;;)
+			{
+				size_t	count = 0;
+				for (; count < maxCount; ++count)
+				{
+					if ( _cells[ (pos + count) & Mask ].seq.load( EMemoryOrder::Acquire ) != pos + count )
+						break;
+				}
+
+				if_unlikely( count == 0 )
+				{
+					if ( maxCount == 0 )
+						return 0;
+
+					const size_t	seq = _cells[ pos & Mask ].seq.load( EMemoryOrder::Relaxed );
+
+					// queue is full
+					if ( ptrdiff_t(seq - pos) < 0 )
+						return 0;
+
+					// cell is used by another producer
+					pos = _enqueuePos.load( EMemoryOrder::Relaxed );
+					continue;
+				}
+
+				if ( _enqueuePos.compare_exchange_weak( INOUT pos, pos + count, EMemoryOrder::Relaxed ))
+					return count;
+			}
+		}
+
+
+		// acquire up to 'maxCount' cells with messages for consumer
+		ND_ size_t  _Acquire (size_t maxCount, OUT size_t &pos)
+		{
+			pos = _dequeuePos.load( EMemoryOrder::Relaxed );
+
+			for (;;)
+			{
+				size_t	count = 0;
+				for (; count < maxCount; ++count)
+				{
+					if ( _cells[ (pos + count) & Mask ].seq.load( EMemoryOrder::Acquire ) != pos + count + 1 )
+						break;
+				}
+
+				if_unlikely( count == 0 )
+				{
+					if ( maxCount == 0 )
+						return 0;
+
+					const size_t	seq = _cells[ pos & Mask ].seq.load( EMemoryOrder::Relaxed );
+
+					// queue is empty
+					if ( ptrdiff_t(seq - (pos + 1)) < 0 )
+						return 0;
+
+					// cell is used by another consumer
+					pos = _dequeuePos.load( EMemoryOrder::Relaxed );
+					continue;
+				}
+
+				if constexpr( MultiConsumer )
+				{
+					if ( _dequeuePos.compare_exchange_weak( INOUT pos, pos + count, EMemoryOrder::Relaxed ))
+						return count;
+				}
+				else
+				{
+					_dequeuePos.store( pos + count, EMemoryOrder::Relaxed );
+					return count;
+				}
+			}
+		}
 	};
 
+
+	template <typename T, size_t Capacity_v = 1u << 10>
+	using MPMCMessageQueue = MessageQueue< T, Capacity_v, true >;
+
+	template <typename T, size_t Capacity_v = 1u << 10>
+	using MPSCMessageQueue = MessageQueue< T, Capacity_v, false >;
+
+
 }	// AE::Threading
@@ -0,0 +1,281 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+/*
+	Coroutine task.
+
+	Coroutine is a single async task, coroutine frame is resumed inside 'IAsyncTask::Run()'.
+	'co_await' suspends coroutine and calls 'IAsyncTask::Continue()', so same task will be added to the queue again
+	when awaited task completes, there are no allocations per step.
+
+	Supported awaitables:
+		co_await AsyncTask		- resume when task completes, coroutine will be canceled if task is canceled or failed.
+		co_await Promise<T>		- same as above, returns promise result.
+		co_await CoroTask		- run nested coroutine and wait until it completes.
+		co_await EThread		- resume coroutine in another thread.
+
+	Coroutine arguments are copied to the coroutine frame, don't pass arguments by reference if they may be destroyed
+	before coroutine completes.
+
+	Example:
+		CoroTask  LoadImage (Path path)
+		{
+			Array<uint8_t>	data = co_await ReadFile( path );	// ReadFile returns Promise<Array<uint8_t>>
+			co_await EThread::Renderer;
+			...
+		}
+
+		AsyncTask	task = Scheduler().Run( LoadImage( "image.png" ));
+*/
+
+#pragma once
+
+#ifdef AE_STD_COROUTINE
+
+#include "threading/TaskSystem/Promise.h"
+#include <coroutine>
+
+namespace AE::Threading
+{
+
+	//
+	// Coroutine Task
+	//
+
+	class CoroTask final
+	{
+	// types
+	public:
+		class promise_type;
+		using Handle_t	= std::coroutine_handle< promise_type >;
+		using EThread	= IAsyncTask::EThread;
+		using EStatus	= IAsyncTask::EStatus;
+
+		class _InternalImpl;
+		using _InternalImplPtr = SharedPtr< _InternalImpl >;
+
+	private:
+		class _TaskAwaiter;
+		class _ThreadAwaiter;
+		template <typename T> class _PromiseAwaiter;
+
+
+	// variables
+	private:
+		_InternalImplPtr	_impl;
+
+
+	// methods
+	public:
+		CoroTask () {}
+		explicit CoroTask (_InternalImplPtr impl) : _impl{std::move(impl)} {}
+
+		CoroTask (CoroTask &&) = default;
+		CoroTask (const CoroTask &) = default;
+
+		CoroTask&  operator = (CoroTask &&) = default;
+		CoroTask&  operator = (const CoroTask &) = default;
+
+		operator AsyncTask () const;
+	};
+
+
+
+	//
+	// Coroutine Task implementation
+	//
+
+	class CoroTask::_InternalImpl final : public IAsyncTask
+	{
+	// variables
+	private:
+		Handle_t	_handle;
+
+
+	// methods
+	public:
+		_InternalImpl (Handle_t handle, EThread type) : IAsyncTask{ type }, _handle{ handle } {}
+
+		~_InternalImpl () override
+		{
+			// coroutine is completed or canceled, destroy frame with all local variables
+			if ( _handle )
+				_handle.destroy();
+		}
+
+		void  Await (const AsyncTask &dep, EThread type)	{ Continue( dep, type ); }
+		void  Fail ()										{ Unused( OnFailure() ); }
+
+	private:
+		void  Run () override
+		{
+			ASSERT( not _handle.done() );
+			_handle.resume();
+		}
+
+		NtStringView  DbgName () const override		{ return "Coroutine"; }
+	};
+
+
+
+	//
+	// Coroutine Promise
+	//
+
+	class CoroTask::promise_type
+	{
+	// variables
+	private:
+		_InternalImpl *		_task	= null;		// task owns coroutine frame
+
+
+	// methods
+	public:
+		ND_ CoroTask  get_return_object ()
+		{
+			auto	task = MakeTask<_InternalImpl>( Handle_t::from_promise( *this ), EThread::Worker );
+			_task = task.get();
+			return CoroTask{ std::move(task) };
+		}
+
+		// coroutine will be started by scheduler
+		ND_ std::suspend_always  initial_suspend () noexcept	{ return {}; }
+
+		// frame will be destroyed by the task
+		ND_ std::suspend_always  final_suspend () noexcept		{ return {}; }
+
+		void  return_void ()			{}
+		void  unhandled_exception ()	{ _task->Fail(); }
+
+		ND_ _TaskAwaiter	await_transform (const AsyncTask &dep);
+		ND_ _TaskAwaiter	await_transform (const CoroTask &coro);
+		ND_ _ThreadAwaiter	await_transform (EThread type);
+
+		template <typename T>
+		ND_ _PromiseAwaiter<T>  await_transform (const Promise<T> &promise);
+	};
+
+
+
+	//
+	// Task Awaiter
+	//
+
+	class CoroTask::_TaskAwaiter
+	{
+	// variables
+	private:
+		_InternalImpl &		_task;
+		AsyncTask			_dep;
+
+	// methods
+	public:
+		_TaskAwaiter (_InternalImpl &task, AsyncTask dep) : _task{task}, _dep{std::move(dep)} {}
+
+		ND_ bool  await_ready () const		{ return not _dep or _dep->Status() == EStatus::Completed; }
+			void  await_suspend (Handle_t)	{ _task.Await( _dep, _task.Type() ); }
+			void  await_resume () const		{ ThreadFence( EMemoryOrder::Acquire ); }
+	};
+
+
+
+	//
+	// Promise Awaiter
+	//
+
+	template <typename T>
+	class CoroTask::_PromiseAwaiter
+	{
+	// variables
+	private:
+		_InternalImpl &		_task;
+		Promise<T>			_promise;
+
+	// methods
+	public:
+		_PromiseAwaiter (_InternalImpl &task, const Promise<T> &promise) : _task{task}, _promise{promise} {}
+
+		ND_ bool  await_ready () const
+		{
+			AsyncTask	dep{ _promise };
+			return not dep or dep->Status() == EStatus::Completed;
+		}
+
+		void  await_suspend (Handle_t)
+		{
+			_task.Await( AsyncTask{_promise}, _task.Type() );
+		}
+
+		ND_ T  await_resume () const
+		{
+			if constexpr( not IsVoid<T> )
+				return _promise._Result();
+		}
+	};
+
+
+
+	//
+	// Thread Awaiter
+	//
+
+	class CoroTask::_ThreadAwaiter
+	{
+	// variables
+	private:
+		_InternalImpl &		_task;
+		const EThread		_type;
+
+	// methods
+	public:
+		_ThreadAwaiter (_InternalImpl &task, EThread type) : _task{task}, _type{type} {}
+
+		ND_ bool  await_ready () const		{ return _task.Type() == _type; }
+			void  await_suspend (Handle_t)	{ _task.Await( null, _type ); }
+			void  await_resume () const		{}
+	};
+//-----------------------------------------------------------------------------
+
+
+/*
+=================================================
+	operator AsyncTask
+=================================================
+*/
+	inline CoroTask::operator AsyncTask () const
+	{
+		return _impl;
+	}
+
+/*
+=================================================
+	await_transform
+=================================================
+*/
+	inline CoroTask::_TaskAwaiter  CoroTask::promise_type::await_transform (const AsyncTask &dep)
+	{
+		return _TaskAwaiter{ *_task, dep };
+	}
+
+	inline CoroTask::_TaskAwaiter  CoroTask::promise_type::await_transform (const CoroTask &coro)
+	{
+		// nested coroutine has not been started yet
+		if ( coro._impl and coro._impl->Status() == EStatus::Initial )
+			CHECK( Scheduler().Run( AsyncTask{coro} ));
+
+		return _TaskAwaiter{ *_task, coro };
+	}
+
+	inline CoroTask::_ThreadAwaiter  CoroTask::promise_type::await_transform (EThread type)
+	{
+		return _ThreadAwaiter{ *_task, type };
+	}
+
+	template <typename T>
+	inline CoroTask::_PromiseAwaiter<T>  CoroTask::promise_type::await_transform (const Promise<T> &promise)
+	{
+		return _PromiseAwaiter<T>{ *_task, promise };
+	}
+
+
+}	// AE::Threading
+
+#endif	// AE_STD_COROUTINE
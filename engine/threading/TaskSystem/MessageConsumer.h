@@ -0,0 +1,181 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+/*
+	Message consumer.
+
+	Connects message queue with task scheduler: when message is added to the queue
+	consumer task is scheduled if it is not scheduled yet, task consumes all messages.
+	Only one consumer task is active at a time, so it is safe to use MPSC queue.
+
+	Example:
+		MPSCMessageQueue< InputEvent >		queue;
+		MessageConsumer< decltype(queue) >	consumer{ queue, [] (InputEvent &&ev) { ... }, EThread::Main };
+
+		// any thread
+		CHECK( consumer.Produce( InputEvent{...} ));
+*/
+
+#pragma once
+
+#include "threading/TaskSystem/TaskScheduler.h"
+#include "threading/Queues/MessageQueue.h"
+
+namespace AE::Threading
+{
+
+	//
+	// Message Consumer
+	//
+
+	template <typename QueueType>
+	class MessageConsumer final : public Noncopyable
+	{
+	// types
+	public:
+		using Queue_t	= QueueType;
+		using Message_t	= typename QueueType::Value_t;
+		using Func_t	= Function< void (Message_t &&) >;
+		using EThread	= IAsyncTask::EThread;
+
+	private:
+		class ConsumerTask final : public IAsyncTask
+		{
+		private:
+			MessageConsumer&	_owner;
+
+		public:
+			ConsumerTask (MessageConsumer &owner, EThread type) : IAsyncTask{ type }, _owner{ owner } {}
+
+			void  Run () override			{ _owner._Consume(); }
+			void  OnCancel () override		{ _owner._OnCanceled(); }
+
+			NtStringView  DbgName () const override	{ return "MessageConsumer"; }
+		};
+
+
+	// variables
+	private:
+		Queue_t &			_queue;
+		const Func_t		_fn;
+		const EThread		_threadType;
+		Atomic<bool>		_scheduled	{false};	// 'true' if consumer task is scheduled or running
+		Atomic<uint>		_taskCount	{0};		// number of tasks that are referenced to this object
+
+		SpinLock			_lastTaskGuard;
+		AsyncTask			_lastTask;				// last scheduled consumer task, used only to wait for completion
+
+
+	// methods
+	public:
+		MessageConsumer (Queue_t &queue, Func_t &&fn, EThread type = EThread::Worker) :
+			_queue{ queue }, _fn{ std::move(fn) }, _threadType{ type }
+		{}
+
+		~MessageConsumer ()
+		{
+			// wait until all tasks are finished,
+			// current thread processes only queues that it serves, so if it is the only thread that can run consumer task
+			// (for example 'EThread::Main') then task will be executed here, otherwise thread is parked until task completes
+			const auto	help_mask = Scheduler().CurrentThreadMask();
+
+			while ( _taskCount.load( EMemoryOrder::Acquire ) > 0 )
+			{
+				AsyncTask	task;
+				{
+					EXLOCK( _lastTaskGuard );
+					task = _lastTask;
+				}
+
+				if ( task and not task->IsFinished() )
+				{
+					CHECK( Scheduler().Wait( {task}, Nanoseconds{30'000'000'000}, help_mask ));
+					continue;
+				}
+
+				// previous task has cleared '_scheduled' flag but has not yet decremented counter, it takes a few instructions
+				std::this_thread::yield();
+			}
+		}
+
+		ND_ bool  Produce (Message_t &&msg)
+		{
+			if ( not _queue.Produce( std::move(msg) ))
+				return false;	// queue is full
+
+			Notify();
+			return true;
+		}
+
+		ND_ bool  Produce (const Message_t &msg)
+		{
+			if ( not _queue.Produce( msg ))
+				return false;	// queue is full
+
+			Notify();
+			return true;
+		}
+
+		ND_ size_t  Produce (ArrayView<Message_t> msgs)
+		{
+			const size_t	count = _queue.Produce( msgs );
+			if ( count > 0 )
+				Notify();
+			return count;
+		}
+
+
+		// call this after adding messages directly to the queue
+		void  Notify ()
+		{
+			// pairs with fence in '_Consume', message must be visible before checking the flag
+			ThreadFence( std::memory_order_seq_cst );
+
+			if ( _scheduled.exchange( true, std::memory_order_seq_cst ))
+				return;
+
+			_taskCount.fetch_add( 1, EMemoryOrder::Relaxed );
+
+			AsyncTask	task = Scheduler().Run<ConsumerTask>( Tuple{ std::ref(*this), _threadType });
+			if_unlikely( not task )
+			{
+				_OnCanceled();
+				return;
+			}
+
+			EXLOCK( _lastTaskGuard );
+			_lastTask = std::move(task);
+		}
+
+		ND_ Queue_t&  GetQueue ()	{ return _queue; }
+
+
+	private:
+		void  _Consume ()
+		{
+			for (;;)
+			{
+				_queue.ConsumeAll( [this] (Message_t &&msg) { _fn( std::move(msg) ); });
+
+				_scheduled.store( false, std::memory_order_seq_cst );
+
+				// pairs with fence in 'Notify', producer that adds message after this check will schedule new task
+				ThreadFence( std::memory_order_seq_cst );
+
+				if ( _queue.Empty() )
+					break;
+
+				// another producer has already scheduled new task
+				if ( _scheduled.exchange( true, std::memory_order_seq_cst ))
+					break;
+			}
+			_taskCount.fetch_sub( 1, EMemoryOrder::Release );
+		}
+
+		void  _OnCanceled ()
+		{
+			_scheduled.store( false, EMemoryOrder::Relaxed );
+			_taskCount.fetch_sub( 1, EMemoryOrder::Release );
+		}
+	};
+
+
+}	// AE::Threading
@@ -0,0 +1,257 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+/*
+	Data-parallel helpers.
+
+	Range is split by lazy binary splitting:
+	thread processes range by 'grain' elements and before each step checks
+	if all previously added parts of this range have been started by other threads,
+	in this case remaining range is split in half and the second half is added to the scheduler as new task.
+	So at most one part of the range is waiting in queue, and number of tasks depends on the number of threads
+	that have taken parts of the range, not on the range size or on unrelated tasks in the queue.
+
+	Calling thread processes the first part of the range and then helps to execute other tasks
+	until the whole range is processed, so it is safe to call from worker thread.
+	When there are no tasks to process, calling thread is parked until the last part is processed
+	or new worker task is added.
+*/
+
+#pragma once
+
+#include "threading/TaskSystem/TaskScheduler.h"
+
+namespace AE::Threading
+{
+namespace _ae_threading_hidden_
+{
+
+	//
+	// Parallel Range State
+	//
+
+	template <typename Body>
+	class ParallelRangeState final
+	{
+	// types
+	public:
+		using Self	= ParallelRangeState< Body >;
+
+		class RangeTask final : public IAsyncTask
+		{
+		private:
+			Self &			_state;
+			const size_t	_begin;
+			const size_t	_end;
+			bool			_processed	= false;
+
+		public:
+			RangeTask (Self* state, size_t begin, size_t end) :
+				IAsyncTask{ EThread::Worker }, _state{ *state }, _begin{ begin }, _end{ end }
+			{}
+
+			void  Run () override
+			{
+				_processed = true;
+				_state._queued.fetch_sub( 1, EMemoryOrder::Relaxed );
+				_state.Process( _begin, _end, true );
+			}
+
+			// task may be canceled by the scheduler, range must be processed anyway, otherwise 'Run()' of the state will never return
+			void  OnCancel () override
+			{
+				if ( not _processed )
+				{
+					_state._queued.fetch_sub( 1, EMemoryOrder::Relaxed );
+					_state.Process( _begin, _end, false );
+				}
+			}
+
+			NtStringView  DbgName () const override	{ return "ParallelRange"; }
+		};
+
+
+	// variables
+	private:
+		Body &						_body;
+		const size_t				_grain;
+		Atomic<size_t>				_remaining;		// number of unprocessed elements
+		Atomic<uint>				_queued		{0};	// number of range tasks that are not started yet
+		const SharedPtr<WakeupEvent>	_finished;		// signaled when all elements are processed, may be used after state is destroyed
+
+
+	// methods
+	public:
+		ParallelRangeState (Body &body, size_t count, size_t grain) :
+			_body{ body }, _grain{ grain > 0 ? grain : 1 }, _remaining{ count }, _finished{ MakeShared<WakeupEvent>() }
+		{}
+
+		void  Process (size_t begin, size_t end, bool allowSplit)
+		{
+			auto	acc			= _body.Init();
+			size_t	processed	= 0;
+
+			while ( begin < end )
+			{
+				// split only if previous part has been taken by another thread
+				if ( allowSplit and (end - begin >= _grain * 2) and (_queued.load( EMemoryOrder::Relaxed ) == 0) )
+				{
+					const size_t	mid = begin + ((end - begin) / 2 + _grain - 1) / _grain * _grain;
+
+					_queued.fetch_add( 1, EMemoryOrder::Relaxed );
+
+					if ( Scheduler().Run<RangeTask>( Tuple{ this, mid, end }))
+					{
+						end = mid;
+						continue;
+					}
+					_queued.fetch_sub( 1, EMemoryOrder::Relaxed );
+				}
+
+				const size_t	step_end = Min( begin + _grain, end );
+
+				_body.Accumulate( INOUT acc, begin, step_end );
+				processed	+= step_end - begin;
+				begin		 = step_end;
+			}
+
+			_body.Merge( std::move(acc) );
+
+			// state may be destroyed after this
+			const SharedPtr<WakeupEvent>	finished = _finished;
+
+			if ( _remaining.fetch_sub( processed, EMemoryOrder::AcqRel ) == processed )
+				finished->Signal();
+		}
+
+		// process range in current thread and help other threads until all tasks are complete
+		void  Run (size_t begin, size_t end)
+		{
+			using EThread = IAsyncTask::EThread;
+
+			Process( begin, end, true );
+
+			for (uint seed = 0; _remaining.load( EMemoryOrder::Acquire ) > 0; ++seed)
+			{
+				if ( Scheduler().ProcessTask( EThread::Worker, seed ))
+					continue;
+
+				// event is signaled by the last part, timeout is used only as fallback
+				Unused( Scheduler().ParkThread( *_finished, IThread::ThreadMask{}.set( uint(EThread::Worker) ), Nanoseconds{std::chrono::milliseconds{10}} ));
+			}
+		}
+	};
+
+
+	//
+	// Parallel For Body
+	//
+
+	template <typename Fn>
+	struct ParallelForBody
+	{
+		struct Empty {};
+
+		Fn &	fn;
+
+		ND_ Empty  Init ()	const	{ return {}; }
+
+		void  Accumulate (Empty &, size_t begin, size_t end) const
+		{
+			if constexpr( std::is_invocable_v< Fn, size_t, size_t >)
+				fn( begin, end );
+			else
+			{
+				for (size_t i = begin; i < end; ++i) {
+					fn( i );
+				}
+			}
+		}
+
+		void  Merge (Empty &&) const {}
+	};
+
+
+	//
+	// Parallel Reduce Body
+	//
+
+	template <typename T, typename MapFn, typename ReduceFn>
+	struct ParallelReduceBody
+	{
+		const T		identity;
+		MapFn &		map;
+		ReduceFn &	reduce;
+		SpinLock	guard;
+		T			result;
+
+		ND_ T  Init () const	{ return identity; }
+
+		void  Accumulate (T &acc, size_t begin, size_t end) const
+		{
+			if constexpr( std::is_invocable_v< MapFn, size_t, size_t >)
+				acc = reduce( std::move(acc), map( begin, end ));
+			else
+			{
+				for (size_t i = begin; i < end; ++i) {
+					acc = reduce( std::move(acc), map( i ));
+				}
+			}
+		}
+
+		void  Merge (T &&acc)
+		{
+			EXLOCK( guard );
+			result = reduce( std::move(result), std::move(acc) );
+		}
+	};
+
+}	// _ae_threading_hidden_
+
+
+/*
+=================================================
+	ParallelFor
+----
+	'fn' is 'void (size_t index)' or 'void (size_t begin, size_t end)'.
+	Blocks current thread until all elements are processed.
+=================================================
+*/
+	template <typename Fn>
+	void  ParallelFor (size_t begin, size_t end, size_t grain, Fn &&fn)
+	{
+		if ( begin >= end )
+			return;
+
+		using Body_t = _ae_threading_hidden_::ParallelForBody< std::remove_reference_t< Fn > >;
+
+		Body_t										body{ fn };
+		_ae_threading_hidden_::ParallelRangeState< Body_t >		state{ body, end - begin, grain };
+
+		state.Run( begin, end );
+	}
+
+/*
+=================================================
+	ParallelReduce
+----
+	'map' is 'T (size_t index)' or 'T (size_t begin, size_t end)',
+	'reduce' is 'T (T, T)', it must be associative and commutative,
+	because partial results are combined in arbitrary order.
+=================================================
+*/
+	template <typename T, typename MapFn, typename ReduceFn>
+	ND_ T  ParallelReduce (size_t begin, size_t end, size_t grain, const T &identity, MapFn &&map, ReduceFn &&reduce)
+	{
+		if ( begin >= end )
+			return identity;
+
+		using Body_t = _ae_threading_hidden_::ParallelReduceBody< T, std::remove_reference_t< MapFn >, std::remove_reference_t< ReduceFn > >;
+
+		Body_t										body{ identity, map, reduce, {}, identity };
+		_ae_threading_hidden_::ParallelRangeState< Body_t >		state{ body, end - begin, grain };
+
+		state.Run( begin, end );
+		return std::move( body.result );
+	}
+
+
+}	// AE::Threading
@@ -13,6 +13,8 @@ namespace AE::Threading
 
 	static constexpr PromiseNullResult  CancelPromise = {};
 
+	class CoroTask;
+
 
 
 	//
@@ -143,6 +145,8 @@ namespace AE::Threading
 
 		template <typename B>
 		friend class Promise;
+
+		friend class CoroTask;	// to get result in 'co_await'
 	};
 
 
@@ -0,0 +1,347 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "threading/TaskSystem/TaskAllocator.h"
+#include "threading/Primitives/SpinLock.h"
+#include "stl/Memory/UntypedAllocator.h"
+
+namespace AE::Threading
+{
+namespace {
+
+	static constexpr uint	MaxCachedBlocks	= 256;	// per size class in thread cache
+	static constexpr uint	BatchSize		= 64;	// number of blocks moved between thread cache and global pool
+
+	struct FreeBlock
+	{
+		FreeBlock*	next;
+	};
+
+	struct FreeList
+	{
+		FreeBlock*	head	= null;
+		uint		count	= 0;
+
+		void  Push (void *ptr)
+		{
+			auto*	block	= static_cast<FreeBlock*>( ptr );
+			block->next		= head;
+			head			= block;
+			++count;
+		}
+
+		ND_ void*  Pop ()
+		{
+			FreeBlock*	block = head;
+			if ( block )
+			{
+				head = block->next;
+				--count;
+			}
+			return block;
+		}
+	};
+
+
+	struct ThreadCache;
+
+
+	//
+	// Global Pool
+	//
+	struct GlobalPool
+	{
+		struct alignas(AE_CACHE_LINE) Bin
+		{
+			SpinLock	guard;
+			FreeList	list;
+		};
+
+		StaticArray< Bin, TaskAllocator::SizeClassCount >	bins;
+
+		// statistic of exited threads and of allocations without thread cache
+		alignas(AE_CACHE_LINE) Atomic<uint64_t>		hits	{0};
+		Atomic<uint64_t>							misses	{0};
+
+		// live thread caches, used only to calculate statistic
+		SpinLock									cachesGuard;
+		Array< ThreadCache *>						caches;
+
+		~GlobalPool ()
+		{
+			for (auto& bin : bins)
+			{
+				EXLOCK( bin.guard );
+				while ( void* ptr = bin.list.Pop() ) {
+					UntypedAlignedAllocator::Deallocate( ptr, BytesU{TaskAllocator::BlockAlign} );
+				}
+			}
+		}
+
+		ND_ static GlobalPool&  Instance ()
+		{
+			static GlobalPool	pool;
+			return pool;
+		}
+	};
+
+
+	//
+	// Thread Cache
+	//
+	static thread_local ThreadCache*	t_threadCache			= null;
+	static thread_local bool			t_threadCacheDestroyed	= false;
+
+	struct ThreadCache
+	{
+		StaticArray< FreeList, TaskAllocator::SizeClassCount >	bins;
+
+		// changed only by owner thread, so RMW operation is not needed, other threads only read counters
+		Atomic<uint64_t>	hits	{0};
+		Atomic<uint64_t>	misses	{0};
+
+		ThreadCache ()
+		{
+			t_threadCache = this;
+
+			auto&	pool = GlobalPool::Instance();
+			EXLOCK( pool.cachesGuard );
+			pool.caches.push_back( this );
+		}
+
+		// return all blocks to the global pool
+		~ThreadCache ()
+		{
+			t_threadCache			= null;
+			t_threadCacheDestroyed	= true;
+
+			auto&	pool = GlobalPool::Instance();
+			{
+				EXLOCK( pool.cachesGuard );
+
+				auto	iter = std::find( pool.caches.begin(), pool.caches.end(), this );
+				if ( iter != pool.caches.end() )
+					pool.caches.erase( iter );
+
+				pool.hits.fetch_add( hits.load( EMemoryOrder::Relaxed ), EMemoryOrder::Relaxed );
+				pool.misses.fetch_add( misses.load( EMemoryOrder::Relaxed ), EMemoryOrder::Relaxed );
+			}
+
+			for (uint i = 0; i < bins.size(); ++i)
+			{
+				auto&	gbin = pool.bins[i];
+				EXLOCK( gbin.guard );
+
+				while ( void* ptr = bins[i].Pop() ) {
+					gbin.list.Push( ptr );
+				}
+			}
+		}
+
+		ND_ static ThreadCache*  Get ()
+		{
+			if_likely( t_threadCache != null )
+				return t_threadCache;
+
+			// thread is exiting, use global pool
+			if ( t_threadCacheDestroyed )
+				return null;
+
+			static thread_local ThreadCache		cache;
+			return &cache;
+		}
+	};
+
+
+/*
+=================================================
+	IncCounter
+=================================================
+*/
+	inline void  IncCounter (Atomic<uint64_t> &counter)
+	{
+		counter.store( counter.load( EMemoryOrder::Relaxed ) + 1, EMemoryOrder::Relaxed );
+	}
+
+/*
+=================================================
+	SizeClass
+=================================================
+*/
+	ND_ inline uint  SizeClass (size_t size)
+	{
+		uint	idx = 0;
+		for (size_t bs = TaskAllocator::MinBlockSize; bs < size; bs <<= 1) {
+			++idx;
+		}
+		return idx;
+	}
+
+	ND_ inline bool  IsPooled (BytesU size, BytesU align)
+	{
+		return (size_t(size) <= TaskAllocator::MaxBlockSize) & (size_t(align) <= TaskAllocator::BlockAlign);
+	}
+
+/*
+=================================================
+	AllocateFromHeap
+=================================================
+*/
+	ND_ inline void*  AllocateFromHeap (ThreadCache* cache, BytesU size, BytesU align)
+	{
+		if_likely( cache != null )
+			IncCounter( cache->misses );
+		else
+			GlobalPool::Instance().misses.fetch_add( 1, EMemoryOrder::Relaxed );
+
+		return UntypedAlignedAllocator::Allocate( size, align );
+	}
+
+}	// namespace
+//-----------------------------------------------------------------------------
+
+
+/*
+=================================================
+	Allocate
+=================================================
+*/
+	void*  TaskAllocator::Allocate (BytesU size, BytesU align)
+	{
+		ThreadCache*	cache	= ThreadCache::Get();
+
+		if_unlikely( not IsPooled( size, align ))
+			return AllocateFromHeap( cache, size, align );
+
+		const uint	cls		= SizeClass( size_t(size) );
+		auto&		pool	= GlobalPool::Instance();
+		auto&		gbin	= pool.bins[cls];
+
+		if_likely( cache != null )
+		{
+			auto&	bin = cache->bins[cls];
+
+			// refill thread cache
+			if_unlikely( bin.head == null )
+			{
+				EXLOCK( gbin.guard );
+				for (uint i = 0; i < BatchSize; ++i)
+				{
+					void*	ptr = gbin.list.Pop();
+					if ( not ptr )
+						break;
+					bin.Push( ptr );
+				}
+			}
+
+			if ( void* ptr = bin.Pop() )
+			{
+				IncCounter( cache->hits );
+				return ptr;
+			}
+		}
+		else
+		{
+			EXLOCK( gbin.guard );
+			if ( void* ptr = gbin.list.Pop() )
+			{
+				pool.hits.fetch_add( 1, EMemoryOrder::Relaxed );
+				return ptr;
+			}
+		}
+
+		return AllocateFromHeap( cache, BytesU{MinBlockSize << cls}, BytesU{BlockAlign} );
+	}
+
+/*
+=================================================
+	Deallocate
+=================================================
+*/
+	void  TaskAllocator::Deallocate (void *ptr, BytesU size, BytesU align)
+	{
+		if ( ptr == null )
+			return;
+
+		if_unlikely( not IsPooled( size, align ))
+			return UntypedAlignedAllocator::Deallocate( ptr, align );
+
+		const uint	cls		= SizeClass( size_t(size) );
+		auto&		gbin	= GlobalPool::Instance().bins[cls];
+		ThreadCache*	cache	= ThreadCache::Get();
+
+		if_likely( cache != null )
+		{
+			auto&	bin = cache->bins[cls];
+			bin.Push( ptr );
+
+			// move part of blocks to the global pool, so they can be reused by another threads
+			if_unlikely( bin.count > MaxCachedBlocks )
+			{
+				EXLOCK( gbin.guard );
+				for (uint i = 0; i < BatchSize; ++i) {
+					gbin.list.Push( bin.Pop() );
+				}
+			}
+		}
+		else
+		{
+			EXLOCK( gbin.guard );
+			gbin.list.Push( ptr );
+		}
+	}
+
+/*
+=================================================
+	GetStatistic
+=================================================
+*/
+	TaskAllocator::Statistic  TaskAllocator::GetStatistic ()
+	{
+		auto&		pool = GlobalPool::Instance();
+		Statistic	result;
+		EXLOCK( pool.cachesGuard );
+
+		result.hits		= pool.hits.load( EMemoryOrder::Relaxed );
+		result.misses	= pool.misses.load( EMemoryOrder::Relaxed );
+
+		for (auto* cache : pool.caches)
+		{
+			result.hits		+= cache->hits.load( EMemoryOrder::Relaxed );
+			result.misses	+= cache->misses.load( EMemoryOrder::Relaxed );
+		}
+		return result;
+	}
+
+/*
+=================================================
+	ResetStatistic
+=================================================
+*/
+	void  TaskAllocator::ResetStatistic ()
+	{
+		auto&	pool = GlobalPool::Instance();
+		EXLOCK( pool.cachesGuard );
+
+		pool.hits.store( 0, EMemoryOrder::Relaxed );
+		pool.misses.store( 0, EMemoryOrder::Relaxed );
+
+		// increment in another thread may be lost, it is acceptable for statistic
+		for (auto* cache : pool.caches)
+		{
+			cache->hits.store( 0, EMemoryOrder::Relaxed );
+			cache->misses.store( 0, EMemoryOrder::Relaxed );
+		}
+	}
+
+/*
+=================================================
+	Initialize
+=================================================
+*/
+	void  TaskAllocator::Initialize ()
+	{
+		Unused( GlobalPool::Instance() );
+	}
+
+
+}	// AE::Threading
@@ -0,0 +1,106 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+/*
+	Pooled allocator for async tasks.
+
+	Task object and shared pointer control block are allocated as a single block (see 'std::allocate_shared').
+	Blocks are grouped by size classes, each thread has own free lists, so allocation and deallocation
+	don't require synchronization. When thread cache is empty or overflowed blocks are moved
+	to/from the global free lists with a single lock per batch.
+	Block may be deallocated in another thread, in this case it will be added to the cache of that thread.
+*/
+
+#pragma once
+
+#include "threading/Common.h"
+#include "stl/Math/Bytes.h"
+
+namespace AE::Threading
+{
+
+	//
+	// Task Allocator
+	//
+
+	class TaskAllocator final
+	{
+	// types
+	public:
+		struct Statistic
+		{
+			uint64_t	hits		= 0;	// block was taken from the pool
+			uint64_t	misses		= 0;	// block was allocated in the heap
+		};
+
+		static constexpr size_t		MinBlockSize	= AE_CACHE_LINE;
+		static constexpr uint		SizeClassCount	= 5;
+		static constexpr size_t		MaxBlockSize	= MinBlockSize << (SizeClassCount - 1);
+		static constexpr size_t		BlockAlign		= AE_CACHE_LINE;
+
+
+	// methods
+	public:
+		TaskAllocator () = delete;
+
+		ND_ AE_ALLOCATOR static void*  Allocate (BytesU size, BytesU align);
+			static void  Deallocate (void *ptr, BytesU size, BytesU align);
+
+		ND_ static Statistic  GetStatistic ();
+			static void  ResetStatistic ();
+
+		// create global pool, pool must be destroyed after all tasks
+			static void  Initialize ();
+	};
+
+
+
+	//
+	// Task STD Allocator
+	//
+
+	template <typename T>
+	struct TaskStdAllocator
+	{
+	// types
+		using value_type = T;
+
+	// methods
+		TaskStdAllocator () {}
+
+		template <typename B>
+		TaskStdAllocator (const TaskStdAllocator<B> &) {}
+
+		ND_ T*  allocate (size_t n)
+		{
+			void*	ptr = TaskAllocator::Allocate( BytesU::SizeOf<T>() * n, BytesU::AlignOf<T>() );
+			CHECK_FATAL( ptr != null );
+			return static_cast<T*>( ptr );
+		}
+
+		void  deallocate (T* ptr, size_t n)
+		{
+			TaskAllocator::Deallocate( ptr, BytesU::SizeOf<T>() * n, BytesU::AlignOf<T>() );
+		}
+
+		template <typename B>
+		ND_ bool  operator == (const TaskStdAllocator<B> &) const	{ return true; }
+
+		template <typename B>
+		ND_ bool  operator != (const TaskStdAllocator<B> &) const	{ return false; }
+	};
+
+
+/*
+=================================================
+	MakeTask
+----
+	task and control block are allocated in task pool
+=================================================
+*/
+	template <typename T, typename ...Types>
+	ND_ forceinline SharedPtr<T>  MakeTask (Types&&... args)
+	{
+		return std::allocate_shared<T>( TaskStdAllocator<T>{}, std::forward<Types>( args )... );
+	}
+
+
+}	// AE::Threading
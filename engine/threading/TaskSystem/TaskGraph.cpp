@@ -0,0 +1,293 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "threading/TaskSystem/TaskGraph.h"
+
+namespace AE::Threading
+{
+
+/*
+=================================================
+	destructor
+=================================================
+*/
+	TaskGraph::~TaskGraph ()
+	{
+		Clear();
+	}
+
+/*
+=================================================
+	Add
+=================================================
+*/
+	uint  TaskGraph::Add (const AsyncTask &task)
+	{
+		CHECK_ERR( task, UMax );
+		CHECK_ERR( task->_graph == null, UMax );
+		CHECK_ERR( task->Status() == IAsyncTask::EStatus::Initial or task->IsFinished(), UMax );
+
+		const uint	index = uint(_tasks.size());
+
+		task->_graph		= this;
+		task->_graphIndex	= index;
+
+		_tasks.push_back( task );
+		_compiled = false;
+
+		return index;
+	}
+
+	uint  TaskGraph::Add (const AsyncTask &task, ArrayView<uint> dependsOn, bool isStrong)
+	{
+		const uint	index = Add( task );
+		CHECK_ERR( index != UMax, UMax );
+
+		for (uint dep : dependsOn) {
+			CHECK_ERR( AddDependency( index, dep, isStrong ), UMax );
+		}
+		return index;
+	}
+
+/*
+=================================================
+	AddDependency
+=================================================
+*/
+	bool  TaskGraph::AddDependency (uint task, uint dependsOn, bool isStrong)
+	{
+		CHECK_ERR( task < _tasks.size() );
+		CHECK_ERR( dependsOn < _tasks.size() );
+		CHECK_ERR( task != dependsOn );
+
+		_edges.push_back({ dependsOn, task, isStrong });
+		_compiled = false;
+
+		return true;
+	}
+
+/*
+=================================================
+	Wait
+=================================================
+*/
+	bool  TaskGraph::Wait (Nanoseconds timeout)
+	{
+		return Scheduler().Wait( _tasks, timeout ) and _WaitNotifications();
+	}
+
+/*
+=================================================
+	IsFinished
+=================================================
+*/
+	bool  TaskGraph::IsFinished () const
+	{
+		// counter is decremented after task has been finished
+		return _notifying.load( EMemoryOrder::Acquire ) == 0;
+	}
+
+/*
+=================================================
+	_WaitNotifications
+----
+	returns 'false' if graph is still running
+=================================================
+*/
+	bool  TaskGraph::_WaitNotifications () const
+	{
+		for (auto& task : _tasks)
+		{
+			if ( task->IsInQueue() and task->Status() != IAsyncTask::EStatus::Initial )
+				return false;
+		}
+
+		// all tasks are finished, only notifications may be in progress, it should not take long
+	#if AE_SPINLOCK_MODE == 1
+		SpinWait	spin;
+		for (uint cnt; (cnt = _notifying.load( EMemoryOrder::Acquire )) > 0;)
+		{
+			// notifying thread may be preempted, park thread until last notification
+			if ( not spin.Wait() )
+				AtomicWait::Wait( _notifying, cnt );
+		}
+	#else
+		for (; _notifying.load( EMemoryOrder::Acquire ) > 0;) {
+			std::this_thread::yield();
+		}
+	#endif
+		return true;
+	}
+
+/*
+=================================================
+	Clear
+=================================================
+*/
+	void  TaskGraph::Clear ()
+	{
+		CHECK( _WaitNotifications() );
+
+		for (auto& task : _tasks) {
+			task->_graph = null;
+		}
+
+		_tasks.clear();
+		_edges.clear();
+		_edgeOffsets.clear();
+		_inputCount.clear();
+		_roots.clear();
+		_compiled = false;
+	}
+
+/*
+=================================================
+	_Compile
+----
+	sort edges by source task, count input dependencies, find root tasks
+=================================================
+*/
+	bool  TaskGraph::_Compile ()
+	{
+		const uint	count = uint(_tasks.size());
+
+		std::stable_sort( _edges.begin(), _edges.end(), [] (auto& lhs, auto& rhs) { return lhs.from < rhs.from; });
+
+		_edgeOffsets.assign( count + 1, 0 );
+		_inputCount.assign( count, 0 );
+		_roots.clear();
+
+		for (auto& e : _edges)
+		{
+			++_edgeOffsets[ e.from + 1 ];
+			++_inputCount[ e.to ];
+		}
+
+		for (uint i = 0; i < count; ++i)
+		{
+			_edgeOffsets[i+1] += _edgeOffsets[i];
+
+			if ( _inputCount[i] == 0 )
+				_roots.push_back( _tasks[i] );
+		}
+
+		// check for cycles, graph without cycles can be sorted topologically
+		{
+			Array<uint>	input_count	= _inputCount;
+			Array<uint>	stack;
+
+			for (uint i = 0; i < count; ++i) {
+				if ( input_count[i] == 0 )
+					stack.push_back( i );
+			}
+
+			uint	visited = 0;
+			for (; not stack.empty(); ++visited)
+			{
+				const uint	i = stack.back();
+				stack.pop_back();
+
+				for (uint e = _edgeOffsets[i]; e < _edgeOffsets[i+1]; ++e)
+				{
+					if ( --input_count[ _edges[e].to ] == 0 )
+						stack.push_back( _edges[e].to );
+				}
+			}
+			CHECK_ERR( visited == count );
+		}
+
+		_compiled = true;
+		return true;
+	}
+
+/*
+=================================================
+	_Prepare
+----
+	reset all tasks and set dependency counters,
+	root tasks will be added to the queues by the scheduler
+=================================================
+*/
+	bool  TaskGraph::_Prepare ()
+	{
+		CHECK_ERR( not _tasks.empty() );
+
+		if ( not _compiled )
+			CHECK_ERR( _Compile() );
+
+		// previous launch must be complete
+		CHECK_ERR( _WaitNotifications() );
+
+		for (auto& task : _tasks)
+		{
+			if ( task->Status() != IAsyncTask::EStatus::Initial )
+				CHECK_ERR( task->_ResetState() );
+		}
+
+		_notifying.store( uint(_tasks.size()), EMemoryOrder::Release );
+
+		// tasks with input dependencies must be in pending state before root tasks are started
+		for (size_t i = 0; i < _tasks.size(); ++i)
+		{
+			if ( _inputCount[i] == 0 )
+				continue;
+
+			bool	is_ready;
+			CHECK_ERR( Scheduler()._SetPendingState( _tasks[i], _inputCount[i], OUT is_ready ));
+			ASSERT( not is_ready );
+		}
+		return true;
+	}
+
+/*
+=================================================
+	_CancelPending
+----
+	tasks with input dependencies will be canceled when the last dependency notifies them,
+	root tasks must be already canceled
+=================================================
+*/
+	void  TaskGraph::_CancelPending ()
+	{
+		for (size_t i = 0; i < _tasks.size(); ++i)
+		{
+			if ( _inputCount[i] > 0 )
+				Unused( Scheduler().Cancel( _tasks[i] ));
+		}
+	}
+
+/*
+=================================================
+	_OnTaskFinished
+----
+	same as 'IAsyncTask::_NotifyOutputs()' but uses graph edges
+=================================================
+*/
+	void  TaskGraph::_OnTaskFinished (uint index, bool isCanceled)
+	{
+		ASSERT( _compiled );
+
+		for (uint e = _edgeOffsets[index], end = _edgeOffsets[index+1]; e < end; ++e)
+		{
+			auto&	edge	= _edges[e];
+			auto&	dep		= _tasks[ edge.to ];
+
+			if ( isCanceled and edge.isStrong )
+				dep->_canceledDepsCount.fetch_add( 1, EMemoryOrder::Relaxed );
+
+			// last input dependency has been completed
+			if ( dep->_waitCount.fetch_sub( 1, EMemoryOrder::AcquireRelase ) == 1 )
+				Scheduler()._EnqueueReadyTask( dep );
+		}
+
+		// graph may be destroyed after this,
+		// wakeup doesn't access the memory, address is used only as a key to find parked threads
+		if ( _notifying.fetch_sub( 1, EMemoryOrder::Release ) == 1 )
+		{
+		#if AE_SPINLOCK_MODE == 1
+			AtomicWait::WakeAll( _notifying );
+		#endif
+		}
+	}
+
+
+}	// AE::Threading
@@ -0,0 +1,118 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+/*
+	Task graph.
+
+	Tasks and dependencies between them are recorded once and then graph can be launched many times.
+	Dependencies inside the graph don't use output lists of the tasks, so there are no allocations per launch:
+		- all tasks are reset and dependency counters are set in bulk,
+		- root tasks (without input dependencies) are added to the queues in a single batch,
+		- when task finishes it notifies dependent tasks using precompiled edge list.
+
+	Tasks outside of the graph may depend on graph tasks as usual.
+	Graph must not be changed or destroyed while it is running.
+	Task status is set before it notifies dependent tasks, so 'Wait()', 'Clear()' and 'Run()'
+	additionally wait until all tasks of the previous launch have finished notifications.
+
+	Example:
+		TaskGraph	graph;
+		uint		a = graph.Add( task_a );
+		uint		b = graph.Add( task_b, {a} );
+		uint		c = graph.Add( task_c, {a, b} );
+
+		// every frame
+		CHECK( graph.Run() );
+		CHECK( graph.Wait() );
+*/
+
+#pragma once
+
+#include "threading/TaskSystem/TaskScheduler.h"
+
+namespace AE::Threading
+{
+
+	//
+	// Task Graph
+	//
+
+	class TaskGraph final : public Noncopyable
+	{
+		friend class IAsyncTask;
+
+	// types
+	private:
+		struct Edge
+		{
+			uint	from;
+			uint	to;
+			bool	isStrong;
+		};
+
+
+	// variables
+	private:
+		Array<AsyncTask>	_tasks;
+		Array<Edge>			_edges;			// sorted by 'from' after compilation
+		Array<uint>			_edgeOffsets;	// edges of task 'i' are in range [_edgeOffsets[i], _edgeOffsets[i+1])
+		Array<uint>			_inputCount;	// number of input dependencies for each task
+		Array<AsyncTask>	_roots;
+		bool				_compiled	= false;
+		Atomic<uint>		_notifying	{0};	// number of tasks that have not yet notified dependent tasks in the current launch
+
+
+	// methods
+	public:
+		TaskGraph () {}
+		~TaskGraph ();
+
+		// returns task index in graph or 'UMax' on error
+		ND_ uint  Add (const AsyncTask &task);
+		ND_ uint  Add (const AsyncTask &task, ArrayView<uint> dependsOn, bool isStrong = true);
+
+		// 'task' will be started after 'dependsOn' is completed, if 'isStrong' then 'task' will be canceled when 'dependsOn' is canceled
+			bool  AddDependency (uint task, uint dependsOn, bool isStrong = true);
+
+		// external dependencies are added to the root tasks
+		template <typename ...Deps>
+			bool  Run (const Tuple<Deps...> &deps = Default);
+
+		ND_ bool  Wait (Nanoseconds timeout = Nanoseconds{30'000'000'000});
+
+		ND_ bool  IsFinished () const;
+
+			void  Clear ();
+
+		ND_ ArrayView<AsyncTask>	Tasks ()			const	{ return _tasks; }
+		ND_ AsyncTask const&		operator [] (uint i)	const	{ return _tasks[i]; }
+
+	private:
+		bool  _Compile ();
+		bool  _Prepare ();
+		void  _CancelPending ();
+		bool  _WaitNotifications () const;
+		void  _OnTaskFinished (uint index, bool isCanceled);
+	};
+
+
+/*
+=================================================
+	Run
+=================================================
+*/
+	template <typename ...Deps>
+	inline bool  TaskGraph::Run (const Tuple<Deps...> &deps)
+	{
+		CHECK_ERR( _Prepare() );
+
+		if_likely( Scheduler().RunBatch( _roots, deps ))
+			return true;
+
+		// root tasks are canceled by scheduler, other tasks must be canceled too,
+		// graph is finished when this method returns
+		_CancelPending();
+		Unused( Wait() );
+		return false;
+	}
+
+
+}	// AE::Threading
@@ -1,8 +1,9 @@
 // Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
 
 #include "threading/TaskSystem/TaskScheduler.h"
+#include "threading/TaskSystem/TaskGraph.h"
 #include "stl/Algorithms/StringUtils.h"
-#include "threading/Containers/LfIndexedPool2.h"
+#include "stl/Platforms/CPUInfo.h"
 
 namespace AE::Threading
 {
@@ -10,27 +11,38 @@ DEBUG_ONLY(
 	Atomic<int64_t>	asyncTaskCounter {0};
 )
 
+	thread_local TaskScheduler::_LocalQueue*  TaskScheduler::_currentLocalQueue = null;
+	thread_local uint                         TaskScheduler::_currentNumaNode   = 0;
+	thread_local TaskScheduler::ThreadMask    TaskScheduler::_currentThreadMask;
+
 /*
 =================================================
-	OutputChunk::Init
+	OutputNode::New
+----
+	nodes are allocated in task pool, it is faster than separate pool
+	because nodes are allocated and released by the same threads as tasks
 =================================================
 */
-	void  IAsyncTask::OutputChunk::Init (uint idx)
+	IAsyncTask::OutputNode*  IAsyncTask::OutputNode::New (const AsyncTask &task, bool isStrong)
 	{
-		next		= null;
-		selfIndex	= idx;
-		tasks.clear();
+		void*	ptr = TaskAllocator::Allocate( BytesU::SizeOf<OutputNode>(), BytesU::AlignOf<OutputNode>() );
+		CHECK_ERR( ptr != null );
+
+		auto*	node	= PlacementNew<OutputNode>( ptr );
+		node->task		= task;
+		node->isStrong	= isStrong;
+		return node;
 	}
 	
 /*
 =================================================
-	OutputChunk::_GetPool
+	OutputNode::Delete
 =================================================
 */
-	inline auto&  IAsyncTask::OutputChunk::_GetPool ()
+	void  IAsyncTask::OutputNode::Delete (OutputNode* node)
 	{
-		static LfIndexedPool2< OutputChunk, uint, (1u<<12), 64 >  pool;
-		return pool;
+		node->~OutputNode();
+		TaskAllocator::Deallocate( node, BytesU::SizeOf<OutputNode>(), BytesU::AlignOf<OutputNode>() );
 	}
 //-----------------------------------------------------------------------------
 
@@ -40,8 +52,8 @@ DEBUG_ONLY(
 	constructor
 =================================================
 */
-	IAsyncTask::IAsyncTask (EThread type) :
-		_threadType{type}
+	IAsyncTask::IAsyncTask (EThread type, EPriority priority) :
+		_threadType{type}, _priority{priority}
 	{
 		DEBUG_ONLY( ++asyncTaskCounter );
 	}
@@ -53,7 +65,7 @@ DEBUG_ONLY(
 */
 	IAsyncTask::~IAsyncTask ()
 	{
-		ASSERT( _output == null );
+		ASSERT( _output.load() == null or _output.load() == OutputNode::Closed() );
 		DEBUG_ONLY( --asyncTaskCounter );
 	}
 
@@ -91,8 +103,55 @@ DEBUG_ONLY(
 			ASSERT( expected != EStatus::Cancellation );	// TODO: Failed or Canceled ?
 		}
 		
-		EXLOCK( _outputGuard );
-		_FreeOutputChunks( true );
+		_NotifyOutputs( true );
+		return true;
+	}
+
+/*
+=================================================
+	Continue
+=================================================
+*/
+	void  IAsyncTask::Continue (const AsyncTask &dep, EThread type)
+	{
+		ASSERT( Status() == EStatus::InProgress );
+		ASSERT( dep.get() != this );
+
+		_continueAfter	= dep;
+		_threadType		= type;
+		_isContinued	= true;
+	}
+
+/*
+=================================================
+	_Restart
+----
+	returns 'false' if task was canceled or failed inside 'Run()',
+	returns 'true' if task has been added to the scheduler, task must not be used after that
+=================================================
+*/
+	bool  IAsyncTask::_Restart ()
+	{
+		AsyncTask	dep = std::move( _continueAfter );
+		_isContinued = false;
+
+		EStatus	expected = EStatus::InProgress;
+		if ( not _status.compare_exchange_strong( INOUT expected, EStatus::Initial, EMemoryOrder::Relaxed ))
+			return false;
+
+		// interlock is released by the first run, caller doesn't unlock restarted task
+		CHECK( _interlockDep.Unlock() );
+
+		// output dependencies are not changed, they are still waiting for this task
+		_waitCount.store( WaitBias, EMemoryOrder::Relaxed );
+		_canceledDepsCount.store( 0, EMemoryOrder::Relaxed );
+
+		// keep reference, task may be executed and released in another thread during this call
+		AsyncTask	self = shared_from_this();
+
+		if ( not Scheduler()._ContinueTask( self, dep ))
+			self->_Cancel();
+
 		return true;
 	}
 
@@ -101,18 +160,23 @@ DEBUG_ONLY(
 	_OnFinish
 =================================================
 */
-	void  IAsyncTask::_OnFinish ()
+	bool  IAsyncTask::_OnFinish ()
 	{
+		if_unlikely( _throttleState )
+			Scheduler()._ReleaseThrottle( *this );
+
+		if_unlikely( _isContinued and _Restart() )
+			return false;
+
 		EStatus	expected = EStatus::InProgress;
 	
-		EXLOCK( _outputGuard );
-		ASSERT( _waitBits.load() == 0 );
+		ASSERT( _waitCount.load() == 0 );
 		
 		// try to set completed state	
 		if ( _status.compare_exchange_strong( INOUT expected, EStatus::Completed, EMemoryOrder::Relaxed ) or expected == EStatus::Failed )
 		{
-			_FreeOutputChunks( false );
-			return;
+			_NotifyOutputs( false );
+			return true;
 		}
 
 		// cancel
@@ -122,11 +186,12 @@ DEBUG_ONLY(
 
 			_status.store( EStatus::Canceled, EMemoryOrder::Relaxed );
 
-			_FreeOutputChunks( true );
-			return;
+			_NotifyOutputs( true );
+			return true;
 		}
 
 		ASSERT(!"unknown state");
+		return true;
 	}
 	
 /*
@@ -136,47 +201,65 @@ DEBUG_ONLY(
 */
 	void  IAsyncTask::_Cancel ()
 	{
-		EXLOCK( _outputGuard );
+		if_unlikely( _throttleState )
+			Scheduler()._ReleaseThrottle( *this );
 
 		// Pending/InProgress -> Cancellation
 		_SetCancellationState();
 
+		AE_TASK_TRACE( TaskTracer::Record( TaskTracer::EEvent::Cancel, *this ));
 		OnCancel();
 
 		// set canceled state
 		CHECK( _status.exchange( EStatus::Canceled, EMemoryOrder::Relaxed ) == EStatus::Cancellation );
 
-		_FreeOutputChunks( true );
+		_NotifyOutputs( true );
 	}
 	
 /*
 =================================================
-	_FreeOutputChunks
+	_NotifyOutputs
+----
+	status must be set before this call,
+	output list will be closed so new dependencies will see final status and will not be added
 =================================================
 */
-	void  IAsyncTask::_FreeOutputChunks (bool isCanceled)
+	void  IAsyncTask::_NotifyOutputs (bool isCanceled)
 	{
-		auto&	chunk_pool = OutputChunk::_GetPool();
+		OutputNode*	list = _output.exchange( OutputNode::Closed(), EMemoryOrder::AcquireRelase );
+
+		// already notified, for example in 'OnFailure()'
+		if ( list == OutputNode::Closed() )
+			return;
 
-		for (OutputChunk* chunk = _output; chunk;)
+		// nodes are added to the head, restore insertion order
+		OutputNode*	first = null;
+		while ( list )
 		{
-			for (auto&[dep, idx, is_strong] : chunk->tasks)
-			{
-				if ( isCanceled and is_strong )
-					dep->_canceledDepsCount.fetch_add( 1, EMemoryOrder::Relaxed );
+			OutputNode*	next = list->next;
+			list->next	= first;
+			first		= list;
+			list		= next;
+		}
 
-				dep->_waitBits.fetch_and( ~(1ull << idx), EMemoryOrder::Relaxed );
-			}
-			chunk->tasks.clear();
+		for (OutputNode* node = first; node;)
+		{
+			auto&	dep = node->task;
 
-			OutputChunk*	old_chunk = chunk;
+			if ( isCanceled and node->isStrong )
+				dep->_canceledDepsCount.fetch_add( 1, EMemoryOrder::Relaxed );
 
-			chunk			= old_chunk->next;
-			old_chunk->next = null;
-			chunk_pool.Unassign( old_chunk->selfIndex );
+			// last input dependency has been completed
+			if ( dep->_waitCount.fetch_sub( 1, EMemoryOrder::AcquireRelase ) == 1 )
+				Scheduler()._EnqueueReadyTask( dep );
+
+			OutputNode*	next = node->next;
+			OutputNode::Delete( node );
+			node = next;
 		}
 
-		_output = null;
+		if ( _graph )
+			_graph->_OnTaskFinished( _graphIndex, isCanceled );
 	}
 	
 /*
@@ -186,8 +269,6 @@ DEBUG_ONLY(
 */
 	bool  IAsyncTask::_ResetState ()
 	{
-		EXLOCK( _outputGuard );
-
 		for (EStatus expected = EStatus::Completed;
 			 not _status.compare_exchange_weak( INOUT expected, EStatus::Initial, EMemoryOrder::Relaxed );)
 		{
@@ -199,9 +280,11 @@ DEBUG_ONLY(
 			RETURN_ERR( "can't reset task that is not finished" );
 		}
 
-		_waitBits.store( UMax, EMemoryOrder::Relaxed );
+		_waitCount.store( WaitBias, EMemoryOrder::Relaxed );
 		_canceledDepsCount.store( 0, EMemoryOrder::Relaxed );
-		ASSERT( _output == null );
+
+		// open output list
+		CHECK( _output.exchange( null, EMemoryOrder::Relaxed ) == OutputNode::Closed() );
 
 		ASSERT( not _interlockDep );
 		_interlockDep.Clear();
@@ -211,6 +294,21 @@ DEBUG_ONLY(
 //-----------------------------------------------------------------------------
 	
 
+/*
+=================================================
+	SetThrottleTag
+=================================================
+*/
+	void  IAsyncTask::SetThrottleTag (uint tag)
+	{
+		ASSERT( Status() == EStatus::Initial );
+		ASSERT( tag < TaskScheduler::MaxThrottleTags );
+
+		_throttleTag = uint8_t(tag);
+	}
+//-----------------------------------------------------------------------------
+	
+
 /*
 =================================================
 	_RunTask
@@ -221,11 +319,16 @@ DEBUG_ONLY(
 		using EStatus = IAsyncTask::EStatus;
 
 		AE_VTUNE( __itt_task_begin( Scheduler().GetVTuneDomain(), __itt_null, __itt_null, __itt_string_handle_createA( task->DbgName().c_str() )));
+		AE_TASK_TRACE( TaskTracer::Record( TaskTracer::EEvent::Start, *task ));
 		task->Run();
-		task->_OnFinish();
+		AE_TASK_TRACE( TaskTracer::Record( TaskTracer::EEvent::Finish, *task ));
+
+		const bool	finished = task->_OnFinish();
 		AE_VTUNE( __itt_task_end( Scheduler().GetVTuneDomain() ));
 		
-		CHECK( task->_interlockDep.Unlock() );
+		// restarted task may be already executed in another thread
+		if ( finished )
+			CHECK( task->_interlockDep.Unlock() );
 	}
 	
 /*
@@ -235,9 +338,8 @@ DEBUG_ONLY(
 */
 	void  IThread::_OnTaskFinish (const AsyncTask &task)
 	{
-		task->_OnFinish();
-
-		CHECK( task->_interlockDep.Unlock() );
+		if ( task->_OnFinish() )
+			CHECK( task->_interlockDep.Unlock() );
 	}
 //-----------------------------------------------------------------------------
 	
@@ -247,12 +349,14 @@ DEBUG_ONLY(
 	_SetDependencyCompletionStatus
 =================================================
 */
-	void  ITaskDependencyManager::_SetDependencyCompletionStatus (const AsyncTask &task, uint depIndex, bool cancel)
+	void  ITaskDependencyManager::_SetDependencyCompletionStatus (const AsyncTask &task, bool cancel)
 	{
 		if ( cancel )
 			task->_canceledDepsCount.fetch_add( 1, EMemoryOrder::Relaxed );
 
-		task->_waitBits.fetch_and( ~(1ull << depIndex), EMemoryOrder::Relaxed );
+		// last input dependency has been completed
+		if ( task->_waitCount.fetch_sub( 1, EMemoryOrder::AcquireRelase ) == 1 )
+			Scheduler()._EnqueueReadyTask( task );
 	}
 //-----------------------------------------------------------------------------
 
@@ -267,6 +371,17 @@ DEBUG_ONLY(
 	{
 		STATIC_ASSERT( N >= 2 );
 		queues.resize( 2 );
+
+		for (uint p = 0; p < PriorityCount; ++p)
+		{
+			depth[p].store( 0, EMemoryOrder::Relaxed );
+
+			AE_SCHEDULER_PROFILING(
+				_waitTime[p].store( 0, EMemoryOrder::Relaxed );
+				_taskCount[p].store( 0, EMemoryOrder::Relaxed );
+				_maxDepth[p].store( 0, EMemoryOrder::Relaxed );
+			)
+		}
 	}
 	
 /*
@@ -275,10 +390,114 @@ DEBUG_ONLY(
 =================================================
 */
 	template <size_t N>
-	void  TaskScheduler::_TaskQueue<N>::Resize (size_t count)
+	void  TaskScheduler::_TaskQueue<N>::Resize (size_t count, size_t group)
 	{
 		ASSERT( count >= 2 );
+		ASSERT( group == 0 or count % group == 0 );
+
 		queues.resize( count );
+		groupSize = uint(group ? group : count);
+	}
+//-----------------------------------------------------------------------------
+
+
+/*
+=================================================
+	_Throttle::Setup
+=================================================
+*/
+	void  TaskScheduler::_Throttle::Setup (const ThrottleSettings &settings)
+	{
+		maxInFlight	= settings.maxInFlight ? settings.maxInFlight : UMax;
+		interval	= settings.tasksPerSecond > 0.0f ? int64_t(1.0e+9 / double(settings.tasksPerSecond)) : 0;
+		burstTime	= interval * Max( 1u, settings.burst );
+
+		inFlight.store( 0, EMemoryOrder::Relaxed );
+		tat.store( 0, EMemoryOrder::Relaxed );
+
+		AE_SCHEDULER_PROFILING(
+			_rejected.store( 0, EMemoryOrder::Relaxed );
+			_peakInFlight.store( 0, EMemoryOrder::Relaxed );
+		)
+	}
+
+/*
+=================================================
+	_Throttle::IsExhausted
+=================================================
+*/
+	bool  TaskScheduler::_Throttle::IsExhausted (int64_t now) const
+	{
+		return	(inFlight.load( EMemoryOrder::Relaxed ) >= maxInFlight) or
+				(TokenWaitTime( now ) > 0);
+	}
+
+/*
+=================================================
+	_Throttle::TokenWaitTime
+----
+	returns time in nanoseconds until the next token will be available,
+	zero or negative value if token is available now
+=================================================
+*/
+	int64_t  TaskScheduler::_Throttle::TokenWaitTime (int64_t now) const
+	{
+		if ( interval == 0 )
+			return 0;
+
+		return Max( tat.load( EMemoryOrder::Relaxed ), now ) + interval - now - burstTime;
+	}
+
+/*
+=================================================
+	_Throttle::TryAcquireSlot
+=================================================
+*/
+	bool  TaskScheduler::_Throttle::TryAcquireSlot ()
+	{
+		if ( maxInFlight == UMax )
+			return true;
+
+		for (uint count = inFlight.load( EMemoryOrder::Relaxed );;)
+		{
+			if ( count >= maxInFlight )
+				return false;
+
+			if ( inFlight.compare_exchange_weak( INOUT count, count + 1, EMemoryOrder::Relaxed ))
+			{
+				AE_SCHEDULER_PROFILING(
+					for (uint peak = _peakInFlight.load( EMemoryOrder::Relaxed );
+						 peak < count + 1 and not _peakInFlight.compare_exchange_weak( INOUT peak, count + 1, EMemoryOrder::Relaxed );)
+					{}
+				)
+				return true;
+			}
+		}
+	}
+
+/*
+=================================================
+	_Throttle::TryAcquireToken
+----
+	token bucket implemented as generic cell rate algorithm,
+	single atomic contains time when bucket will be full again
+=================================================
+*/
+	bool  TaskScheduler::_Throttle::TryAcquireToken (int64_t now)
+	{
+		if ( interval == 0 )
+			return true;
+
+		for (int64_t curr = tat.load( EMemoryOrder::Relaxed );;)
+		{
+			const int64_t	next = Max( curr, now ) + interval;
+
+			if ( next - now > burstTime )
+				return false;
+
+			if ( tat.compare_exchange_weak( INOUT curr, next, EMemoryOrder::Relaxed ))
+				return true;
+		}
 	}
 //-----------------------------------------------------------------------------
 
@@ -299,8 +518,13 @@ DEBUG_ONLY(
 	constructor
 =================================================
 */
-	TaskScheduler::TaskScheduler ()
+	TaskScheduler::TaskScheduler () :
+		_priorityAging{ Settings{}.priorityAging },
+		_deadlineMargin{ Settings{}.deadlineMargin }
 	{
+		// task pool must be destroyed after scheduler
+		TaskAllocator::Initialize();
+
 		AE_VTUNE( _vtuneDomain = __itt_domain_create( "AE.TaskScheduler" ));
 	}
 	
@@ -323,21 +547,146 @@ DEBUG_ONLY(
 =================================================
 */
 	bool  TaskScheduler::Setup (size_t maxWorkerThreads)
+	{
+		Settings	settings;
+		settings.maxWorkerThreads = uint(maxWorkerThreads);
+		return Setup( settings );
+	}
+
+	bool  TaskScheduler::Setup (const Settings &settings)
 	{
 		{
 			EXLOCK( _threadGuard );
 			CHECK_ERR( _threads.empty() );
 		}
 
+		SetCurrentThreadMask( ThreadMask{}.set( uint(EThread::Main) ));
+
 		_mainQueue.Resize( 2 );
-		_workerQueue.Resize( Max( 2u, (maxWorkerThreads + 2) / 3 ));
 		_renderQueue.Resize( 2 );
 		_fileQueue.Resize( 2 );
 		_networkQueue.Resize( 2 );
 
+		// one queue per worker thread and one for main thread
+		_workStealing = settings.workStealing;
+		_localQueues.clear();
+
+		_priorityAging	= settings.priorityAging;
+		_deadlineMargin	= settings.deadlineMargin;
+
+		for (uint t = 0; t < uint(EThread::_Count); ++t) {
+			_GetThrottle( EThread(t) ).Setup( settings.threadLimits[t] );
+		}
+
+		// tag 0 is not limited
+		_tagThrottles[0].Setup( ThrottleSettings{} );
+		for (uint i = 1; i < MaxThrottleTags; ++i) {
+			_tagThrottles[i].Setup( settings.tagLimits[i] );
+		}
+
+		_traceFile = settings.traceFile;
+		if ( not _traceFile.empty() )
+			TaskTracer::Enable( true );
+
+		_threadPlacement.clear();
+
+		if ( settings.topologyAware )
+			_SetupTopology( settings.maxWorkerThreads );
+		else
+			_workerQueue.Resize( Max( 2u, (settings.maxWorkerThreads + 2) / 3 ));
+
+		if ( _workStealing )
+		{
+			_localQueues.resize( settings.maxWorkerThreads + 1 );
+
+			for (auto& lq : _localQueues) {
+				lq = MakeUnique<_LocalQueue>();
+			}
+		}
+
 		return true;
 	}
 	
+/*
+=================================================
+	_SetupTopology
+----
+	threads are placed on different physical cores first, SMT siblings are used when all physical cores are busy.
+	NUMA nodes are interleaved, so any number of threads is evenly distributed between nodes.
+=================================================
+*/
+	void  TaskScheduler::_SetupTopology (uint maxWorkerThreads)
+	{
+		struct Key
+		{
+			uint	smtIndex;		// index of logical core in physical core
+			uint	nodeIndex;		// index of logical core with the same 'smtIndex' in NUMA node
+			uint	node;
+			uint	core;
+		};
+
+		const auto&	cpu = CPUInfo::Get();
+		Array<Key>	keys;
+
+		for (uint i = 0; i < cpu.logicalCoreCount; ++i)
+		{
+			const auto&	lc	= cpu.logicalCores[i];
+			Key			key	{ 0, 0, lc.numaNode, lc.id };
+
+			for (uint j = 0; j < i; ++j) {
+				key.smtIndex += (cpu.logicalCores[j].physicalCore == lc.physicalCore);
+			}
+			for (auto& other : keys) {
+				key.nodeIndex += (other.node == key.node and other.smtIndex == key.smtIndex);
+			}
+			keys.push_back( key );
+		}
+
+		std::sort( keys.begin(), keys.end(), [] (auto& lhs, auto& rhs) {
+				return	lhs.smtIndex  != rhs.smtIndex  ? lhs.smtIndex  < rhs.smtIndex  :
+						lhs.nodeIndex != rhs.nodeIndex ? lhs.nodeIndex < rhs.nodeIndex :
+														 lhs.node      < rhs.node;
+			});
+
+		// one queue group per NUMA node that has at least one worker thread
+		uint	node_count = 1;
+		for (size_t i = 0; i < keys.size(); ++i)
+		{
+			_threadPlacement.push_back({ uint16_t(keys[i].core), uint16_t(keys[i].node) });
+
+			if ( i < maxWorkerThreads )
+				node_count = Max( node_count, keys[i].node + 1 );
+		}
+
+		const uint	max_queues	= uint(_workerQueue.queues.capacity());
+		const uint	total		= Max( 2u, (maxWorkerThreads + 2) / 3 );
+
+		node_count = Min( node_count, max_queues );
+
+		uint	per_node = Min( Max( 1u, (total + node_count - 1) / node_count ), max_queues / node_count );
+		if ( per_node * node_count < 2 )
+			per_node = 2;
+
+		_workerQueue.Resize( per_node * node_count, per_node );
+	}
+
+/*
+=================================================
+	GetThreadPlacement
+=================================================
+*/
+	bool  TaskScheduler::GetThreadPlacement (uint uid, OUT uint &cpuCore, OUT uint &numaNode) const
+	{
+		if ( _threadPlacement.empty() )
+			return false;
+
+		const auto&	tp = _threadPlacement[ uid % _threadPlacement.size() ];
+
+		cpuCore		= tp.cpuCore;
+		numaNode	= tp.numaNode;
+		return true;
+	}
+
 /*
 =================================================
 	Release
@@ -355,11 +704,55 @@ DEBUG_ONLY(
 			_threads.clear();
 		}
 
+		// cancel tasks that are still in work-stealing queues
+		for (auto& lq : _localQueues)
+		{
+			ASSERT( not lq->inUse.load() );
+
+			for (IAsyncTask* ptr; lq->deque.Pop( OUT ptr );)
+			{
+				AsyncTask	task = std::move( ptr->_localQueueRef );
+				task->_Cancel();
+			}
+		}
+		_localQueues.clear();
+		_workStealing = false;
+
+		if ( not _traceFile.empty() )
+		{
+			TaskTracer::Enable( false );
+			CHECK( TaskTracer::Flush( _traceFile ));
+			_traceFile.clear();
+		}
+
 		_WriteProfilerStat( "main",    _mainQueue    );
 		_WriteProfilerStat( "worker",  _workerQueue  );
 		_WriteProfilerStat( "render",  _renderQueue  );
 		_WriteProfilerStat( "file",    _fileQueue    );
-		//_WriteProfilerStat( "network", _networkQueue );
+		_WriteProfilerStat( "network", _networkQueue );
+
+		for (uint i = 1; i < MaxThrottleTags; ++i) {
+			_WriteThrottleStat( "tag "s << ToString( i ), _tagThrottles[i] );
+		}
+
+		AE_SCHEDULER_PROFILING(
+			const auto	alloc_stat = TaskAllocator::GetStatistic();
+			if ( alloc_stat.hits + alloc_stat.misses > 0 )
+			{
+				AE_LOGI( "task allocator hits: "s << ToString( alloc_stat.hits )
+					<< ", misses: " << ToString( alloc_stat.misses ));
+			}
+		)
+
+		AE_SPINLOCK_STAT(
+			const auto	lock_stat = SpinLockCounters::GetGlobal();
+			if ( lock_stat.contended > 0 )
+			{
+				AE_LOGI( "spin lock contended: "s << ToString( lock_stat.contended )
+					<< ", yields: " << ToString( lock_stat.yields )
+					<< ", parks: " << ToString( lock_stat.parks ));
+			}
+		)
 		
 		AE_VTUNE(
 			if ( _vtuneDomain )
@@ -398,14 +791,17 @@ DEBUG_ONLY(
 */
 	bool  TaskScheduler::ProcessTask (EThread type, uint seed)
 	{
+		// time is sampled once per pull and is used for throttling, aging and profiling
+		const auto	now = TimePoint_t::clock::now();
+
 		BEGIN_ENUM_CHECKS();
 		switch ( type )
 		{
-			case EThread::Main :		return _ProcessTask( _mainQueue, seed );
-			case EThread::Worker :		return _ProcessTask( _workerQueue, seed );
-			case EThread::Renderer :	return _ProcessTask( _renderQueue, seed );
-			case EThread::FileIO :		return _ProcessTask( _fileQueue, seed );
-			case EThread::Network :		return _ProcessTask( _networkQueue, seed );
+			case EThread::Main :		return _ProcessTask( _mainQueue,    _PullTask( _mainQueue, seed, now ));
+			case EThread::Worker :		return _ProcessTask( _workerQueue,  _PullWorkerTask( seed, now ));
+			case EThread::Renderer :	return _ProcessTask( _renderQueue,  _PullTask( _renderQueue, seed, now ));
+			case EThread::FileIO :		return _ProcessTask( _fileQueue,    _PullTask( _fileQueue, seed, now ));
+			case EThread::Network :		return _ProcessTask( _networkQueue, _PullTask( _networkQueue, seed, now ));
 			case EThread::_Count :		break;
 		}
 		END_ENUM_CHECKS();
@@ -419,287 +815,1107 @@ DEBUG_ONLY(
 */
 	AsyncTask  TaskScheduler::PullTask (EThread type, uint seed)
 	{
+		const auto	now = TimePoint_t::clock::now();
+
 		BEGIN_ENUM_CHECKS();
 		switch ( type )
 		{
-			case EThread::Main :		return _PullTask( _mainQueue, seed );
-			case EThread::Worker :		return _PullTask( _workerQueue, seed );
-			case EThread::Renderer :	return _PullTask( _renderQueue, seed );
-			case EThread::FileIO :		return _PullTask( _fileQueue, seed );
-			case EThread::Network :		return _PullTask( _networkQueue, seed );
+			case EThread::Main :		return _PullTask( _mainQueue, seed, now );
+			case EThread::Worker :		return _PullWorkerTask( seed, now );
+			case EThread::Renderer :	return _PullTask( _renderQueue, seed, now );
+			case EThread::FileIO :		return _PullTask( _fileQueue, seed, now );
+			case EThread::Network :		return _PullTask( _networkQueue, seed, now );
 			case EThread::_Count :		break;
 		}
 		END_ENUM_CHECKS();
 		RETURN_ERR( "not supported" );
 	}
 
+/*
+=================================================
+	ReadyTaskCount
+=================================================
+*/
+	size_t  TaskScheduler::ReadyTaskCount (EThread type) const
+	{
+		const auto	Count = [] (const auto &tq)
+		{
+			size_t	count = 0;
+			for (auto& depth : tq.depth) {
+				count += depth.load( EMemoryOrder::Relaxed );
+			}
+			return count;
+		};
+
+		BEGIN_ENUM_CHECKS();
+		switch ( type )
+		{
+			case EThread::Main :		return Count( _mainQueue );
+			case EThread::Worker :		return Count( _workerQueue ) + (_currentLocalQueue ? _currentLocalQueue->deque.Size() : 0);
+			case EThread::Renderer :	return Count( _renderQueue );
+			case EThread::FileIO :		return Count( _fileQueue );
+			case EThread::Network :		return Count( _networkQueue );
+			case EThread::_Count :		break;
+		}
+		END_ENUM_CHECKS();
+		return 0;
+	}
+
 /*
 =================================================
 	_PullTask
 =================================================
 */
 	template <size_t N>
-	AsyncTask  TaskScheduler::_PullTask (_TaskQueue<N> &tq, uint seed) const
+	AsyncTask  TaskScheduler::_PullTask (_TaskQueue<N> &tq, uint seed, TimePoint_t start_time)
 	{
-		AE_SCHEDULER_PROFILING(
-			const auto	start_time = TimePoint_t::clock::now();
-		)
+		const int64_t	now			= start_time.time_since_epoch().count();
+
+		// all tasks in queue have the same thread type, so none of them can be started
+		if_unlikely( tq.throttle.IsEnabled() and tq.throttle.IsExhausted( now ))
+		{
+			AE_SCHEDULER_PROFILING(
+				for (auto& d : tq.depth) {
+					if ( d.load( EMemoryOrder::Relaxed ) > 0 ) {
+						tq.throttle._rejected.fetch_add( 1, EMemoryOrder::Relaxed );
+						break;
+					}
+				}
+			)
+			return null;
+		}
 
 		for (size_t j = 0; j < tq.queues.size(); ++j)
 		{
-			auto&	q = tq.queues[ (j + seed) % tq.queues.size() ];
+			auto&	q = tq.queues[ _QueueIndex( tq, j, seed )];
 
 			if ( not q.guard.try_lock() )
 				continue;
 
 			AsyncTask	task;
-
-			// find task
-			for (auto iter = q.tasks.begin(); iter != q.tasks.end();)
+			uint		exhausted_tags		= 0;		// bit mask
+			bool		thread_exhausted	= false;
+			EThread		wakeup				= EThread::_Count;
+
+			// first pass - high priority tasks and levels where the first task was promoted by aging or deadline,
+			// second pass - other levels in priority order.
+			// Tasks in level are sorted by '_urgentTime', so only the first task must be checked,
+			// and 'urgentTime' of the queue is checked to skip all levels when nothing was promoted.
+			const bool	has_urgent	= q.urgentTime.load( EMemoryOrder::Relaxed ) <= now;
+			const auto	IsUrgent	= [&q, has_urgent, start_time] (uint p) {
+				return (p == uint(EPriority::High)) or (has_urgent and q.tasks[p].front()->_urgentTime <= start_time);
+			};
+
+			// all tasks in queue are ready, so in most cases the first task will be taken,
+			// skip only tasks that are locked by interlock dependency or limited by throttle tag
+			for (uint i = 0; (i < PriorityCount*2) and not thread_exhausted; ++i)
 			{
-				auto&	curr  = *iter;
-				bool	ready = false;
+				const uint	p		= i % PriorityCount;
+				auto&		tasks	= q.tasks[p];
 
-				// check input dependencies
-				if ( curr->_canceledDepsCount.load( EMemoryOrder::Relaxed ) > 0 or
-					 curr->_waitBits.load( EMemoryOrder::Relaxed ) == 0 )
-				{
-					ready = true;
-				}
+				if ( tasks.empty() or (IsUrgent( p ) != (i < PriorityCount)) )
+					continue;
 
-				// input dependencies is not complete
-				if ( not ready )
+				for (auto iter = tasks.begin(); iter != tasks.end(); ++iter)
 				{
-					++iter;
-					continue;
+					auto&	curr = *iter;
+
+					// tag limits are checked once per pull
+					if ( exhausted_tags & (1u << curr->_throttleTag) )
+						continue;
+
+					const auto	throttle_status = _TryAcquireThrottle( tq.throttle, *curr, now );
+
+					if_unlikely( throttle_status == _EThrottleStatus::ThreadExhausted )
+					{
+						thread_exhausted = true;
+						break;
+					}
+
+					if_unlikely( throttle_status == _EThrottleStatus::TagExhausted )
+					{
+						exhausted_tags |= (1u << curr->_throttleTag);
+						continue;
+					}
+
+					if ( curr->_interlockDep and not curr->_interlockDep.TryLock() )
+					{
+						// task is not started, so slots and tokens are returned
+						if_unlikely( curr->_throttleState and _RollbackThrottle( *curr ))
+							wakeup = EThread(curr->_throttleType);
+						continue;
+					}
+
+					task = std::move( curr );
+
+					if ( iter == tasks.begin() )
+						tasks.pop_front();
+					else
+						tasks.erase( iter );
+					break;
 				}
 
-				// try lock
-				if ( curr->_interlockDep and not curr->_interlockDep.TryLock() )
+				if ( task )
 				{
-					// failed to lock
-					continue;
+					_UpdateUrgentTime( q );
+					break;
 				}
-
-				// remove task
-				task = curr;
-				q.tasks.erase( iter );
-				break;
 			}
 
 			// additionaly this operation flushes and invalidates cache,
 			// so you don't need to invalidate cache in 'IAsyncTask::Run()' method
 			q.guard.unlock();
 
+			// another thread may be parked while slot was acquired
+			if_unlikely( wakeup != EThread::_Count )
+				_WakeupThread( wakeup );
+
+			if ( thread_exhausted )
+				break;
+
 			if ( not task )
 				continue;
-			
-			// cancel task if one of dependencies has been canceled
-			if ( (task->Status() == EStatus::Cancellation) or
-				 (task->_canceledDepsCount.load( EMemoryOrder::Relaxed ) > 0) )
-			{
-				task->_Cancel();
-				--j; // try same queue
-				continue;
-			}
 
-			// try to start task
-			EStatus	expected = EStatus::Pending;
+			tq.depth[ uint(task->Priority()) ].fetch_sub( 1, EMemoryOrder::Relaxed );
+			_OnTaskDequeued( tq, *task, start_time );
 			
-			if ( task->_status.compare_exchange_strong( INOUT expected, EStatus::InProgress, EMemoryOrder::Relaxed ))
+			if ( _TryStartTask( task ))
 			{
 				AE_SCHEDULER_PROFILING(
 					tq._stallTime += (TimePoint_t::clock::now() - start_time).count();
 				)
 				return task;
 			}
-			else
-			{
-				ASSERT( expected == EStatus::Cancellation );
-				
-				CHECK( task->_interlockDep.Unlock() );
-				task->_Cancel();
+
+			--j; // task was canceled, try same queue
+		}
+
+		AE_SCHEDULER_PROFILING(
+			tq._stallTime += (TimePoint_t::clock::now() - start_time).count();
+		)
+		return null;
+	}
+	
+/*
+=================================================
+	_SetEnqueueTime
+----
+	urgent time is the time when task will be processed as high priority task
+=================================================
+*/
+	void  TaskScheduler::_SetEnqueueTime (IAsyncTask &task, TimePoint_t now) const
+	{
+		const uint	prio = uint(task._priority);
+
+		task._enqueueTime	= now;
+		task._urgentTime	= TimePoint_t::max();
+
+		if ( task._deadline != TimePoint_t::max() )
+			task._urgentTime = task._deadline - _deadlineMargin;
+
+		if ( _priorityAging.count() > 0 and prio > 0 )
+			task._urgentTime = Min( task._urgentTime, TimePoint_t{ now + _priorityAging * prio });
+	}
+
+/*
+=================================================
+	_UpdateUrgentTime
+----
+	queue must be locked.
+	High priority tasks are not checked, they are counted in '_TaskQueue::depth'.
+=================================================
+*/
+	void  TaskScheduler::_UpdateUrgentTime (_PerQueue &q)
+	{
+		int64_t	time = NeverUrgent;
+
+		for (uint p = uint(EPriority::Normal); p < PriorityCount; ++p)
+		{
+			if ( not q.tasks[p].empty() )
+				time = Min( time, int64_t(q.tasks[p].front()->_urgentTime.time_since_epoch().count()) );
+		}
+		q.urgentTime.store( time, EMemoryOrder::Relaxed );
+	}
+
+/*
+=================================================
+	_HasUrgentTask
+----
+	returns 'true' if one of normal or background tasks in shared queues has been promoted to high priority
+=================================================
+*/
+	template <size_t N>
+	bool  TaskScheduler::_HasUrgentTask (const _TaskQueue<N> &tq, int64_t now)
+	{
+		for (auto& q : tq.queues)
+		{
+			if ( q.urgentTime.load( EMemoryOrder::Relaxed ) <= now )
+				return true;
+		}
+		return false;
+	}
+
+/*
+=================================================
+	_OnTaskDequeued
+=================================================
+*/
+	template <size_t N>
+	void  TaskScheduler::_OnTaskDequeued (_TaskQueue<N> &tq, const IAsyncTask &task, TimePoint_t now)
+	{
+		AE_SCHEDULER_PROFILING(
+			const uint	prio = uint(task._priority);
+
+			tq._waitTime[prio].fetch_add( Max( 0, (now - task._enqueueTime).count() ), EMemoryOrder::Relaxed );
+			tq._taskCount[prio].fetch_add( 1, EMemoryOrder::Relaxed );
+		)
+		Unused( tq, task, now );
+	}
+
+/*
+=================================================
+	_TryAcquireThrottle
+----
+	acquire slot and token for thread type and for task tag,
+	'_throttleState' bits: 1 - thread type throttle is acquired, 2 - tag throttle is acquired
+=================================================
+*/
+	TaskScheduler::_EThrottleStatus  TaskScheduler::_TryAcquireThrottle (_Throttle &throttle, IAsyncTask &task, int64_t now)
+	{
+		_Throttle*	tag_throttle	= task._throttleTag ? &_tagThrottles[ task._throttleTag ] : null;
+		const bool	thread_limited	= throttle.IsEnabled();
+		const bool	tag_limited		= tag_throttle and tag_throttle->IsEnabled();
+
+		if_likely( not (thread_limited or tag_limited) )
+			return _EThrottleStatus::Acquired;
+
+		ASSERT( task._throttleState == 0 );
+
+		if ( thread_limited and not throttle.TryAcquireSlot() )
+			return _EThrottleStatus::ThreadExhausted;
+
+		if ( tag_limited and not tag_throttle->TryAcquireSlot() )
+		{
+			if ( thread_limited ) throttle.ReleaseSlot();
+
+			AE_SCHEDULER_PROFILING( tag_throttle->_rejected.fetch_add( 1, EMemoryOrder::Relaxed ); )
+			return _EThrottleStatus::TagExhausted;
+		}
+
+		if ( thread_limited and not throttle.TryAcquireToken( now ))
+		{
+			throttle.ReleaseSlot();
+			if ( tag_limited ) tag_throttle->ReleaseSlot();
+			return _EThrottleStatus::ThreadExhausted;
+		}
+
+		if ( tag_limited and not tag_throttle->TryAcquireToken( now ))
+		{
+			if ( thread_limited )	{ throttle.ReleaseSlot();  throttle.ReturnToken(); }
+			tag_throttle->ReleaseSlot();
+
+			AE_SCHEDULER_PROFILING( tag_throttle->_rejected.fetch_add( 1, EMemoryOrder::Relaxed ); )
+			return _EThrottleStatus::TagExhausted;
+		}
+
+		task._throttleType	= uint8_t(task.Type());
+		task._throttleState	= uint8_t((thread_limited ? 1 : 0) | (tag_limited ? 2 : 0));
+		return _EThrottleStatus::Acquired;
+	}
+
+/*
+=================================================
+	_RollbackThrottle
+----
+	task was not started, so slots and tokens are returned,
+	returns 'true' if slot was released
+=================================================
+*/
+	bool  TaskScheduler::_RollbackThrottle (IAsyncTask &task)
+	{
+		bool	released = false;
+
+		if ( task._throttleState & 1 )
+		{
+			auto&	throttle = _GetThrottle( EThread(task._throttleType) );
+			throttle.ReleaseSlot();
+			throttle.ReturnToken();
+			released |= (throttle.maxInFlight != UMax);
+		}
+
+		if ( task._throttleState & 2 )
+		{
+			auto&	throttle = _tagThrottles[ task._throttleTag ];
+			throttle.ReleaseSlot();
+			throttle.ReturnToken();
+			released |= (throttle.maxInFlight != UMax);
+		}
+
+		task._throttleState = 0;
+		return released;
+	}
+
+/*
+=================================================
+	_ReleaseThrottle
+----
+	only slots are released, tokens are restored with time
+=================================================
+*/
+	void  TaskScheduler::_ReleaseThrottle (IAsyncTask &task)
+	{
+		if ( task._throttleState & 1 )
+			_GetThrottle( EThread(task._throttleType) ).ReleaseSlot();
+
+		if ( task._throttleState & 2 )
+			_tagThrottles[ task._throttleTag ].ReleaseSlot();
+
+		task._throttleState = 0;
+
+		// thread may be parked while throttled task is in queue
+		_WakeupThread( EThread(task._throttleType) );
+	}
+
+/*
+=================================================
+	_GetThrottle
+=================================================
+*/
+	TaskScheduler::_Throttle&  TaskScheduler::_GetThrottle (EThread type)
+	{
+		BEGIN_ENUM_CHECKS();
+		switch ( type )
+		{
+			case EThread::Main :		return _mainQueue.throttle;
+			case EThread::Worker :		return _workerQueue.throttle;
+			case EThread::Renderer :	return _renderQueue.throttle;
+			case EThread::FileIO :		return _fileQueue.throttle;
+			case EThread::Network :		return _networkQueue.throttle;
+			case EThread::_Count :		break;
+		}
+		END_ENUM_CHECKS();
+		CHECK_FATAL( !"unknown thread type" );
+	}
+
+/*
+=================================================
+	_TryStartTask
+----
+	returns 'false' if task has been canceled
+=================================================
+*/
+	bool  TaskScheduler::_TryStartTask (const AsyncTask &task)
+	{
+		// cancel task if one of dependencies has been canceled
+		if ( (task->Status() == EStatus::Cancellation) or
+			 (task->_canceledDepsCount.load( EMemoryOrder::Relaxed ) > 0) )
+		{
+			CHECK( task->_interlockDep.Unlock() );
+			task->_Cancel();
+			return false;
+		}
+
+		// try to start task
+		EStatus	expected = EStatus::Pending;
+			
+		if ( task->_status.compare_exchange_strong( INOUT expected, EStatus::InProgress, EMemoryOrder::Relaxed ))
+			return true;
+		
+		ASSERT( expected == EStatus::Cancellation );
+				
+		CHECK( task->_interlockDep.Unlock() );
+		task->_Cancel();
+		return false;
+	}
+
+/*
+=================================================
+	_PullWorkerTask
+----
+	local queue -> shared queue -> steal from another thread
+=================================================
+*/
+	AsyncTask  TaskScheduler::_PullWorkerTask (uint seed, TimePoint_t start_time)
+	{
+		if ( not _workStealing )
+			return _PullTask( _workerQueue, seed, start_time );
+
+		const int64_t	now			= start_time.time_since_epoch().count();
+
+		// high priority tasks are not added to the local queues,
+		// tasks in the shared queue that were promoted by aging or deadline must not wait for local tasks
+		if ( (_workerQueue.depth[ uint(EPriority::High) ].load( EMemoryOrder::Relaxed ) > 0) or
+			 _HasUrgentTask( _workerQueue, now ))
+		{
+			if ( AsyncTask task = _PullTask( _workerQueue, seed, start_time ))
+				return task;
+		}
+
+		// pop from local queue in LIFO order, last task has better cache locality
+		if ( _currentLocalQueue )
+		{
+			for (IAsyncTask* ptr; _currentLocalQueue->deque.Pop( OUT ptr );)
+			{
+				AsyncTask	task = std::move( ptr->_localQueueRef );
+				_OnTaskDequeued( _workerQueue, *task, start_time );
+
+				if ( _TryStartTask( task ))
+				{
+					AE_SCHEDULER_PROFILING(
+						_workerQueue._stallTime += (TimePoint_t::clock::now() - start_time).count();
+					)
+					return task;
+				}
+			}
+		}
+
+		// shared queue contains tasks with dependencies and tasks from non-worker threads
+		if ( AsyncTask task = _PullTask( _workerQueue, seed, start_time ))
+			return task;
+
+		AsyncTask	task = _StealTask( seed, start_time );
+
+		AE_SCHEDULER_PROFILING(
+			_workerQueue._stallTime += (TimePoint_t::clock::now() - start_time).count();
+		)
+		return task;
+	}
+	
+/*
+=================================================
+	_StealTask
+=================================================
+*/
+	AsyncTask  TaskScheduler::_StealTask (uint seed, TimePoint_t now)
+	{
+		const size_t	count	= _localQueues.size();
+		const size_t	first	= count ? size_t(seed * 2654435761u) % count : 0;
+		const bool		by_node	= not _threadPlacement.empty();
+
+		// steal from threads on the same NUMA node first, then from other nodes
+		for (uint pass = (by_node ? 0 : 1); pass < 2; ++pass)
+		{
+			for (size_t j = 0; j < count; ++j)
+			{
+				auto&	lq = *_localQueues[ (j + first) % count ];
+
+				if ( &lq == _currentLocalQueue or (by_node and (lq.numaNode == _currentNumaNode) != (pass == 0)) )
+					continue;
+
+				for (IAsyncTask* ptr; lq.deque.Steal( OUT ptr );)
+				{
+					AsyncTask	task = std::move( ptr->_localQueueRef );
+					_OnTaskDequeued( _workerQueue, *task, now );
+
+					if ( _TryStartTask( task ))
+						return task;
+				}
+			}
+		}
+		return null;
+	}
+
+/*
+=================================================
+	_PushToLocalQueue
+----
+	only ready tasks with normal priority can be added to the work-stealing queue,
+	high and background tasks use shared queue where they are sorted by priority
+=================================================
+*/
+	bool  TaskScheduler::_PushToLocalQueue (const AsyncTask &task)
+	{
+		ASSERT( task->_waitCount.load( EMemoryOrder::Relaxed ) == 0 );
+
+		if ( not _currentLocalQueue or task->_interlockDep or task->Priority() != EPriority::Normal )
+			return false;
+
+		// throttled tasks must be added to the shared queue where limits are checked
+		if ( _workerQueue.throttle.IsEnabled() or (task->_throttleTag and _tagThrottles[ task->_throttleTag ].IsEnabled()) )
+			return false;
+
+		task->_localQueueRef = task;
+
+		if_likely( _currentLocalQueue->deque.Push( task.get() ))
+			return true;
+
+		task->_localQueueRef = null;
+		return false;
+	}
+
+/*
+=================================================
+	AttachLocalQueue
+=================================================
+*/
+	bool  TaskScheduler::AttachLocalQueue ()
+	{
+		if ( not _workStealing )
+			return false;
+
+		CHECK_ERR( _currentLocalQueue == null );
+
+		for (auto& lq : _localQueues)
+		{
+			bool	expected = false;
+			if ( lq->inUse.compare_exchange_strong( INOUT expected, true ))
+			{
+				lq->numaNode		= _currentNumaNode;
+				_currentLocalQueue	= lq.get();
+				return true;
+			}
+		}
+		RETURN_ERR( "too many threads, increase 'Settings::maxWorkerThreads'" );
+	}
+	
+/*
+=================================================
+	DetachLocalQueue
+----
+	remaining tasks will be stolen by another threads
+=================================================
+*/
+	void  TaskScheduler::DetachLocalQueue ()
+	{
+		if ( _currentLocalQueue )
+		{
+			_currentLocalQueue->inUse.store( false );
+			_currentLocalQueue = null;
+		}
+	}
+
+/*
+=================================================
+	_ProcessTask
+=================================================
+*/
+	template <size_t N>
+	bool  TaskScheduler::_ProcessTask (_TaskQueue<N> &tq, const AsyncTask &task) const
+	{
+		if ( task )
+		{
+			AE_SCHEDULER_PROFILING(
+				const auto	start_time = TimePoint_t::clock::now();
+			)
+
+			AE_VTUNE( __itt_task_begin( _vtuneDomain, __itt_null, __itt_null, __itt_string_handle_createA( task->DbgName().c_str() )));
+			AE_TASK_TRACE( TaskTracer::Record( TaskTracer::EEvent::Start, *task ));
+			task->Run();
+			AE_TASK_TRACE( TaskTracer::Record( TaskTracer::EEvent::Finish, *task ));
+
+			const bool	finished = task->_OnFinish();
+			AE_VTUNE( __itt_task_end( _vtuneDomain ));
+				
+			// restarted task may be already executed in another thread
+			if ( finished )
+				CHECK( task->_interlockDep.Unlock() );
+
+			AE_SCHEDULER_PROFILING(
+				tq._workTime += (TimePoint_t::clock::now() - start_time).count();
+			)
+			return true;
+		}
+		return false;
+	}
+
+/*
+=================================================
+	WaitSignalTask
+----
+	executed inline when dependency is finished, wakes up waiting thread
+=================================================
+*/
+namespace {
+	class WaitSignalTask final : public IAsyncTask
+	{
+	public:
+		WakeupEvent		event;
+
+		WaitSignalTask () : IAsyncTask{ EThread::Worker } {}
+
+		void  Run () override					{ event.Signal(); }
+
+		NtStringView  DbgName () const override	{ return "WaitSignal"; }
+	};
+}
+
+/*
+=================================================
+	Wait
+----
+	Current thread processes tasks from allowed queues while waiting,
+	so deadlock is not possible if awaited tasks can be processed by this thread.
+	When there are no tasks to process, thread is parked until awaited task is finished
+	or new task is added to the allowed queues.
+=================================================
+*/
+	bool  TaskScheduler::Wait (ArrayView<AsyncTask> tasks, Nanoseconds timeout, const ThreadMask &helpMask)
+	{
+		const auto	start_time	= TimePoint_t::clock::now();
+		uint		seed		= uint(size_t(HashOf( std::this_thread::get_id() )));
+
+		for (auto& task : tasks)
+		{
+			SharedPtr<WaitSignalTask>	signal;
+
+			while ( task->Status() < EStatus::_Finished )
+			{
+				bool	processed = false;
+
+				for (uint t = 0; t < helpMask.size(); ++t)
+				{
+					if ( helpMask[t] )
+						processed |= ProcessTask( EThread(t), ++seed );
+				}
+
+				if ( processed )
+					continue;
+
+				const Nanoseconds	dt = TimePoint_t::clock::now() - start_time;
+				if ( dt >= timeout )
+					return false;	// time out
+
+				// signal will be executed when task is finished
+				if ( not signal )
+				{
+					signal = MakeTask<WaitSignalTask>();
+					signal->_runInline = true;
+					CHECK_ERR( Run( signal, Tuple{ WeakDep{task} }));
+					continue;
+				}
+
+				Unused( ParkThread( signal->event, helpMask, timeout - dt ));
+			}
+		}
+		return true;
+	}
+	
+/*
+=================================================
+	Cancel
+=================================================
+*/
+	bool  TaskScheduler::Cancel (const AsyncTask &task)
+	{
+		if ( not task )
+			return false;
+
+		return task->_SetCancellationState();
+	}
+	
+/*
+=================================================
+	_AddTaskDependencies
+=================================================
+*/
+	bool  TaskScheduler::_AddTaskDependencies (const AsyncTask &task, const AsyncTask &dep, bool isStrong, INOUT uint &depCount)
+	{
+		if ( not dep )
+			return true;
+
+		CHECK_ERR( depCount + 1 < IAsyncTask::WaitBias );
+
+		OutputNode_t*	node = OutputNode_t::New( task, isStrong );
+		CHECK_ERR( node != null );
+
+		for (OutputNode_t* head = dep->_output.load( EMemoryOrder::Acquire );;)
+		{
+			// dependency is finished, status can't be changed
+			if ( head == OutputNode_t::Closed() )
+			{
+				OutputNode_t::Delete( node );
+
+				// cancel current task
+				if ( isStrong and dep->Status() > EStatus::_Interropted )
+					task->_Cancel();
+
+				return true;
+			}
+
+			// add to output
+			node->next = head;
+			if ( dep->_output.compare_exchange_weak( INOUT head, node, EMemoryOrder::Release, EMemoryOrder::Acquire ))
+			{
+				++depCount;
+				return true;
+			}
+		}
+	}
+	
+/*
+=================================================
+	_SetInterlockDependency
+=================================================
+*/
+	bool  TaskScheduler::_SetInterlockDependency (const AsyncTask &task, const InterlockDependency &dep)
+	{
+		CHECK_ERR( not task->_interlockDep );
+
+		task->_interlockDep = dep;
+		return true;
+	}
+
+/*
+=================================================
+	_InsertTask
+=================================================
+*/
+	AsyncTask  TaskScheduler::_InsertTask (const AsyncTask &task, uint depCount)
+	{
+		bool	is_ready;
+		CHECK_ERR( _SetPendingState( task, depCount, OUT is_ready ));
+
+		if ( is_ready )
+			_EnqueueReadyTask( task );
+
+		return task;
+	}
+
+/*
+=================================================
+	_InsertTasks
+----
+	tasks are grouped by thread type and added to the queues with single lock per queue
+=================================================
+*/
+	bool  TaskScheduler::_InsertTasks (ArrayView<AsyncTask> tasks, ArrayView<uint> depCounts)
+	{
+		ASSERT( tasks.size() == depCounts.size() );
+
+		StaticArray< Array<AsyncTask>, uint(EThread::_Count) >	ready;
+		bool													result	= true;
+
+		for (size_t i = 0; i < tasks.size(); ++i)
+		{
+			bool	is_ready;
+			if ( not _SetPendingState( tasks[i], depCounts[i], OUT is_ready ))
+			{
+				result = false;
+				continue;
 			}
+
+			if ( is_ready )
+				ready[ uint(tasks[i]->Type()) ].push_back( tasks[i] );
 		}
 
-		AE_SCHEDULER_PROFILING(
-			tq._stallTime += (TimePoint_t::clock::now() - start_time).count();
-		)
-		return null;
+		for (uint t = 0; t < ready.size(); ++t)
+		{
+			if ( not ready[t].empty() )
+				_EnqueueReadyTasks( EThread(t), ready[t] );
+		}
+		return result;
 	}
-	
+
 /*
 =================================================
-	_ProcessTask
+	_CancelTasks
+----
+	cancel tasks that are not added to the queue,
+	dependent tasks will be notified, input dependencies will find canceled task in the output list
 =================================================
 */
-	template <size_t N>
-	bool  TaskScheduler::_ProcessTask (_TaskQueue<N> &tq, uint seed) const
+	void  TaskScheduler::_CancelTasks (ArrayView<AsyncTask> tasks)
 	{
-		if ( AsyncTask task = _PullTask( tq, seed ))
+		for (auto& task : tasks)
 		{
-			AE_SCHEDULER_PROFILING(
-				const auto	start_time = TimePoint_t::clock::now();
-			)
+			// task may be already canceled by canceled strong dependency
+			if ( not task or task->IsFinished() )
+				continue;
 
-			AE_VTUNE( __itt_task_begin( _vtuneDomain, __itt_null, __itt_null, __itt_string_handle_createA( task->DbgName().c_str() )));
-			task->Run();
-			task->_OnFinish();
-			AE_VTUNE( __itt_task_end( _vtuneDomain ));
-				
-			CHECK( task->_interlockDep.Unlock() );
+			// interlock is not locked yet
+			task->_interlockDep.Clear();
+			task->_Cancel();
+		}
+	}
 
-			AE_SCHEDULER_PROFILING(
-				tq._workTime += (TimePoint_t::clock::now() - start_time).count();
-			)
-			return true;
+/*
+=================================================
+	_SetPendingState
+----
+	'isReady' will be 'true' if all input dependencies are complete
+=================================================
+*/
+	bool  TaskScheduler::_SetPendingState (const AsyncTask &task, uint depCount, OUT bool &isReady)
+	{
+		isReady = false;
+
+		for (EStatus expected = EStatus::Initial;
+			 not task->_status.compare_exchange_weak( INOUT expected, EStatus::Pending, EMemoryOrder::Relaxed );)
+		{
+			// task was canceled before it has been added to the queue, it will be canceled when it becomes ready
+			if ( expected == EStatus::Cancellation )
+				break;
+
+			CHECK_ERR( expected == EStatus::Initial );
 		}
-		return false;
+
+		// some dependencies may complete so remove bias and keep number of incomplete dependencies,
+		// if dependencies is not complete then task will be added to the queue by the last completed dependency
+		const uint	bias = IAsyncTask::WaitBias - depCount;
+
+		// recorded before task may be enqueued by the last completed dependency
+		if ( depCount > 0 )
+			AE_TASK_TRACE( TaskTracer::Record( TaskTracer::EEvent::Wait, *task ));
+
+		isReady = (task->_waitCount.fetch_sub( bias, EMemoryOrder::AcquireRelase ) == bias);
+		return true;
 	}
 
 /*
 =================================================
-	Wait
+	_ContinueTask
 ----
-	Warning: deadlock may occur if wait() called in all threads,
-	use it only for debugging and testing
+	task is in initial state after 'Run()' has been called,
+	it will be added to the ready queue again when 'dep' completes
 =================================================
 */
-	bool  TaskScheduler::Wait (ArrayView<AsyncTask> tasks, Nanoseconds timeout)
+	bool  TaskScheduler::_ContinueTask (const AsyncTask &task, const AsyncTask &dep)
 	{
-		const auto	start_time	= TimePoint_t::clock::now();
+		uint	dep_count = 0;
+		CHECK_ERR( _AddTaskDependencies( task, dep, true, INOUT dep_count ));
 
-		for (auto& task : tasks)
+		// task has been canceled because 'dep' is canceled or failed
+		if ( task->IsFinished() )
+			return true;
+
+		return _InsertTask( task, dep_count ) != null;
+	}
+
+/*
+=================================================
+	_EnqueueReadyTask
+=================================================
+*/
+	void  TaskScheduler::_EnqueueReadyTask (const AsyncTask &task)
+	{
+		if_unlikely( task->_runInline )
 		{
-			for (uint i = 0; task->Status() < EStatus::_Finished; ++i)
+			if ( _TryStartTask( task ))
 			{
-				if ( i > 2000 )
-				{
-					std::this_thread::sleep_for( std::chrono::microseconds{100} );
-					i = 0;
+				task->Run();
+				Unused( task->_OnFinish() );	// internal tasks are never restarted
+			}
+			return;
+		}
 
-					const Nanoseconds	dt = TimePoint_t::clock::now() - start_time;
+		_SetEnqueueTime( *task, TimePoint_t::clock::now() );
+		AE_TASK_TRACE( TaskTracer::Record( TaskTracer::EEvent::Enqueue, *task ));
 
-					if ( dt >= timeout )
-						return false;	// time out
-				}
-			}
+		BEGIN_ENUM_CHECKS();
+		switch ( task->Type() )
+		{
+			case EThread::Main :		_AddTask( _mainQueue,    task );	break;
+			case EThread::Worker :		if ( not _PushToLocalQueue( task )) _AddTask( _workerQueue, task );	break;
+			case EThread::Renderer :	_AddTask( _renderQueue,  task );	break;
+			case EThread::FileIO :		_AddTask( _fileQueue,    task );	break;
+			case EThread::Network :		_AddTask( _networkQueue, task );	break;
+			case EThread::_Count :
+			default :					ASSERT( !"not supported" );	return;
 		}
-		return true;
+		END_ENUM_CHECKS();
+
+		_WakeupThread( task->Type() );
 	}
-	
+
 /*
 =================================================
-	Cancel
+	_EnqueueReadyTasks
+----
+	batch is not added to the work-stealing queue,
+	it is distributed between shared queues so all worker threads can start without stealing
 =================================================
 */
-	bool  TaskScheduler::Cancel (const AsyncTask &task)
+	void  TaskScheduler::_EnqueueReadyTasks (EThread type, ArrayView<AsyncTask> tasks)
 	{
-		if ( not task )
-			return false;
+		const auto	now = TimePoint_t::clock::now();
 
-		return task->_SetCancellationState();
+		for (auto& task : tasks) {
+			ASSERT( task->Type() == type );
+			_SetEnqueueTime( *task, now );
+			AE_TASK_TRACE( TaskTracer::Record( TaskTracer::EEvent::Enqueue, *task ));
+		}
+
+		BEGIN_ENUM_CHECKS();
+		switch ( type )
+		{
+			case EThread::Main :		_AddTasks( _mainQueue,    tasks );	break;
+			case EThread::Worker :		_AddTasks( _workerQueue,  tasks );	break;
+			case EThread::Renderer :	_AddTasks( _renderQueue,  tasks );	break;
+			case EThread::FileIO :		_AddTasks( _fileQueue,    tasks );	break;
+			case EThread::Network :		_AddTasks( _networkQueue, tasks );	break;
+			case EThread::_Count :
+			default :					ASSERT( !"not supported" );	return;
+		}
+		END_ENUM_CHECKS();
+
+		_WakeupThread( type, tasks.size() );
 	}
-	
+
 /*
 =================================================
-	_AddTaskDependencies
+	_WakeupThread
+----
+	wake up parked threads that can process task with this type
 =================================================
 */
-	bool  TaskScheduler::_AddTaskDependencies (const AsyncTask &task, const AsyncTask &dep, bool isStrong, INOUT uint &bitIndex)
+	void  TaskScheduler::_WakeupThread (EThread type, size_t count)
 	{
-		if ( not dep )
-			return true;
+		auto&	lot = _parkingLots[ uint(type) ];
 
-		CHECK_ERR( bitIndex + 1 < sizeof(IAsyncTask::WaitBits_t)*8 );
+		// pairs with fence in 'ParkThread', task must be visible before checking for parked threads
+		ThreadFence( std::memory_order_seq_cst );
 
-		EXLOCK( dep->_outputGuard );	// TODO: optimize
+		if ( lot.count.load( EMemoryOrder::Relaxed ) == 0 )
+			return;
 
-		// if we have lock and task is not finished then we can add output dependency
-		// even if status has been changed in another thread
-		const EStatus	status	= dep->Status();
+		EXLOCK( lot.guard );
 
-		// add to output
-		if ( status < EStatus::_Finished )
+		for (; count > 0 and not lot.events.empty(); --count)
 		{
-			for (OutputChunk_t** chunk_ref = &dep->_output;;)
-			{
-				if ( not *chunk_ref )
-				{
-					auto&	chunk_pool = OutputChunk_t::_GetPool();
+			WakeupEvent*	ev = lot.events.back();
+			lot.events.pop_back();
+			lot.count.fetch_sub( 1, EMemoryOrder::Relaxed );
 
-					uint	idx;
-					CHECK_ERR( chunk_pool.Assign( OUT idx ));
+			// thread can't unregister event until lock is released
+			ev->Signal();
+		}
+	}
 
-					*chunk_ref = &chunk_pool[ idx ];
-					(*chunk_ref)->Init( idx );
-				}
+/*
+=================================================
+	ParkThread
+=================================================
+*/
+	bool  TaskScheduler::ParkThread (WakeupEvent &event, const ThreadMask &mask, Nanoseconds timeout)
+	{
+		for (uint t = 0; t < mask.size(); ++t)
+		{
+			if ( not mask[t] )
+				continue;
 
-				if ( (*chunk_ref)->next )
-				{
-					chunk_ref = &(*chunk_ref)->next;
-					continue;
-				}
+			auto&	lot = _parkingLots[t];
+			EXLOCK( lot.guard );
 
-				if ( (*chunk_ref)->tasks.try_push_back({ task, bitIndex, uint(isStrong) }))
-				{
-					++bitIndex;
-					break;
-				}
+			lot.events.push_back( &event );
+			lot.count.fetch_add( 1, EMemoryOrder::Relaxed );
+		}
+
+		// pairs with fence in '_WakeupThread', if task was added before registration then it must be visible here
+		ThreadFence( std::memory_order_seq_cst );
+
+		const int64_t	now		= TimePoint_t::clock::now().time_since_epoch().count();
+		bool			parked	= true;
+
+		for (uint t = 0; parked and (t < mask.size()); ++t)
+		{
+			if ( not mask[t] )
+				continue;
 
-				chunk_ref = &(*chunk_ref)->next;
+			// throttled tasks can't be started until slot is released (see '_ReleaseThrottle') or token is restored
+			auto&	throttle = _GetThrottle( EThread(t) );
+			if_unlikely( throttle.IsEnabled() and throttle.IsExhausted( now ))
+			{
+				const int64_t	wait = throttle.TokenWaitTime( now );
+				if ( wait > 0 )
+					timeout = Min( timeout, Nanoseconds{wait} );
+				continue;
 			}
+
+			if ( _HasReadyTasks( EThread(t) ))
+				parked = false;
 		}
 
-		// cancel current task
-		if ( isStrong and status > EStatus::_Interropted )
+		if ( parked )
+			Unused( event.Wait( timeout ));
+
+		// unregister, event may be already removed by '_WakeupThread'
+		for (uint t = 0; t < mask.size(); ++t)
 		{
-			task->_Cancel();
-			return true;
-		}
+			if ( not mask[t] )
+				continue;
 
-		return true;
+			auto&	lot = _parkingLots[t];
+			EXLOCK( lot.guard );
+
+			for (auto iter = lot.events.begin(); iter != lot.events.end(); ++iter)
+			{
+				if ( *iter == &event )
+				{
+					lot.events.erase( iter );
+					lot.count.fetch_sub( 1, EMemoryOrder::Relaxed );
+					break;
+				}
+			}
+		}
+		return parked;
 	}
-	
+
 /*
 =================================================
-	_SetInterlockDependency
+	_HasReadyTasks
 =================================================
 */
-	bool  TaskScheduler::_SetInterlockDependency (const AsyncTask &task, const InterlockDependency &dep)
+	bool  TaskScheduler::_HasReadyTasks (EThread type)
 	{
-		CHECK_ERR( not task->_interlockDep );
+		BEGIN_ENUM_CHECKS();
+		switch ( type )
+		{
+			case EThread::Main :		return _HasReadyTasks( _mainQueue );
+			case EThread::Renderer :	return _HasReadyTasks( _renderQueue );
+			case EThread::FileIO :		return _HasReadyTasks( _fileQueue );
+			case EThread::Network :		return _HasReadyTasks( _networkQueue );
+			case EThread::Worker :
+			{
+				for (auto& lq : _localQueues) {
+					if ( not lq->deque.Empty() )
+						return true;
+				}
+				return _HasReadyTasks( _workerQueue );
+			}
+			case EThread::_Count :		break;
+		}
+		END_ENUM_CHECKS();
+		return false;
+	}
 
-		task->_interlockDep = dep;
-		return true;
+	template <size_t N>
+	bool  TaskScheduler::_HasReadyTasks (_TaskQueue<N> &tq)
+	{
+		for (auto& q : tq.queues)
+		{
+			EXLOCK( q.guard );
+			for (auto& tasks : q.tasks)
+			{
+				if ( not tasks.empty() )
+					return true;
+			}
+		}
+		return false;
 	}
 
 /*
 =================================================
-	_InsertTask
+	_QueueIndex
+----
+	returns index of the 'j'-th queue to check,
+	queues of the current NUMA node are checked first, then queues of other nodes
 =================================================
 */
-	AsyncTask  TaskScheduler::_InsertTask (const AsyncTask &task, uint bitIndex)
+	template <size_t N>
+	size_t  TaskScheduler::_QueueIndex (const _TaskQueue<N> &tq, size_t j, size_t seed)
 	{
-		// some dependencies may complete so merge bit mask with current
-		task->_waitBits.fetch_and( ToBitMask<uint64_t>( bitIndex ), EMemoryOrder::Relaxed );
+		const size_t	count	= tq.queues.size();
+		const size_t	group	= tq.groupSize;
 
-		EStatus  old_status = task->_status.exchange( EStatus::Pending, EMemoryOrder::Relaxed );
-		CHECK_ERR( old_status == EStatus::Initial );
+		if_likely( group == count )
+			return (j + seed) % count;
 
-		BEGIN_ENUM_CHECKS();
-		switch ( task->Type() )
-		{
-			case EThread::Main :		_AddTask( _mainQueue,    task );	break;
-			case EThread::Worker :		_AddTask( _workerQueue,  task );	break;
-			case EThread::Renderer :	_AddTask( _renderQueue,  task );	break;
-			case EThread::FileIO :		_AddTask( _fileQueue,    task );	break;
-			case EThread::Network :		_AddTask( _networkQueue, task );	break;
-			case EThread::_Count :
-			default :					RETURN_ERR( "not supported" );
-		}
-		END_ENUM_CHECKS();
-		return task;
+		const size_t	first	= (_currentNumaNode % (count / group)) * group;
+
+		if ( j < group )
+			return first + (j + seed) % group;
+
+		return (first + j) % count;
 	}
 
 /*
@@ -720,11 +1936,13 @@ DEBUG_ONLY(
 		{
 			for (size_t j = 0; j < tq.queues.size(); ++j)
 			{
-				auto&	q = tq.queues[ (j + seed) % tq.queues.size() ];
+				auto&	q = tq.queues[ _QueueIndex( tq, j, seed )];
 			
 				if ( q.guard.try_lock() )
 				{
-					q.tasks.push_back( task );
+					_PushToPriorityQueue( q.tasks[ uint(task->Priority()) ], task );
+					_UpdateUrgentTime( q );
+					_IncDepth( tq, uint(task->Priority()), 1 );
 					q.guard.unlock();
 					
 					AE_SCHEDULER_PROFILING(
@@ -736,6 +1954,95 @@ DEBUG_ONLY(
 		}
 	}
 	
+/*
+=================================================
+	_AddTasks
+----
+	split tasks into equal parts, one part per queue of the current NUMA node,
+	threads from other nodes will take tasks from these queues when their own queues are empty
+=================================================
+*/
+	template <size_t N>
+	void  TaskScheduler::_AddTasks (_TaskQueue<N> &tq, ArrayView<AsyncTask> tasks) const
+	{
+		AE_SCHEDULER_PROFILING(
+			const auto	start_time = TimePoint_t::clock::now();
+		)
+
+		const size_t	seed		= size_t(HashOf( std::this_thread::get_id() ));
+		const size_t	q_count		= tq.groupSize;
+		const size_t	per_queue	= (tasks.size() + q_count - 1) / q_count;
+
+		for (size_t j = 0, first = 0; first < tasks.size(); ++j)
+		{
+			auto&			q		= tq.queues[ _QueueIndex( tq, j, seed )];
+			const size_t	last	= Min( first + per_queue, tasks.size() );
+			
+			StaticArray< uint, PriorityCount >	counts = {};
+
+			EXLOCK( q.guard );
+
+			for (; first < last; ++first)
+			{
+				auto&	task = tasks[first];
+				_PushToPriorityQueue( q.tasks[ uint(task->Priority()) ], task );
+				++counts[ uint(task->Priority()) ];
+			}
+			_UpdateUrgentTime( q );
+
+			for (uint p = 0; p < PriorityCount; ++p)
+			{
+				if ( counts[p] )
+					_IncDepth( tq, p, counts[p] );
+			}
+		}
+
+		AE_SCHEDULER_PROFILING(
+			tq._insertionTime += (TimePoint_t::clock::now() - start_time).count();
+		)
+	}
+
+/*
+=================================================
+	_IncDepth
+=================================================
+*/
+	template <size_t N>
+	void  TaskScheduler::_IncDepth (_TaskQueue<N> &tq, uint priority, uint count)
+	{
+		const uint	depth = tq.depth[ priority ].fetch_add( count, EMemoryOrder::Relaxed ) + count;
+		Unused( depth );
+
+		AE_SCHEDULER_PROFILING(
+			auto&	max_depth = tq._maxDepth[ priority ];
+			for (uint expected = max_depth.load( EMemoryOrder::Relaxed );
+				 expected < depth and not max_depth.compare_exchange_weak( INOUT expected, depth, EMemoryOrder::Relaxed );)
+			{}
+		)
+	}
+
+/*
+=================================================
+	_PushToPriorityQueue
+----
+	tasks are sorted by '_urgentTime', so the first task always has the nearest deadline or waits longer than others.
+	Without deadline urgent time grows with enqueue time, so in most cases task is added to the end.
+=================================================
+*/
+	void  TaskScheduler::_PushToPriorityQueue (Deque<AsyncTask> &tasks, const AsyncTask &task)
+	{
+		if_likely( tasks.empty() or tasks.back()->_urgentTime <= task->_urgentTime )
+		{
+			tasks.push_back( task );
+			return;
+		}
+
+		auto	iter = tasks.end();
+		for (; (iter != tasks.begin()) and ((*(iter - 1))->_urgentTime > task->_urgentTime); --iter) {}
+
+		tasks.insert( iter, task );
+	}
+
 /*
 =================================================
 	_WriteProfilerStat
@@ -760,7 +2067,46 @@ DEBUG_ONLY(
 				<< " queue total work: " << ToString( Nanoseconds(work_time) )
 				<< ", stall: " << ToString( factor * 100.0, 2 ) << " %"
 				<< ", queue count: " << ToString( tq.queues.size() ) );
+
+			_WriteThrottleStat( "  throttle", tq.throttle );
+
+			const char*	prio_names[] = { "high", "normal", "background" };
+			STATIC_ASSERT( CountOf(prio_names) == PriorityCount );
+
+			for (uint p = 0; p < PriorityCount; ++p)
+			{
+				const uint64_t	count = tq._taskCount[p].load();
+				if ( count == 0 )
+					continue;
+
+				AE_LOGI( "  "s << prio_names[p]
+					<< " priority tasks: " << ToString( count )
+					<< ", avg wait: " << ToString( Nanoseconds(tq._waitTime[p].load() / count) )
+					<< ", max depth: " << ToString( tq._maxDepth[p].load() ));
+			}
+		)
+	}
+
+/*
+=================================================
+	_WriteThrottleStat
+=================================================
+*/
+	void  TaskScheduler::_WriteThrottleStat (StringView name, const _Throttle &throttle)
+	{
+		AE_SCHEDULER_PROFILING(
+			if ( not throttle.IsEnabled() )
+				return;
+
+			String	str {name};
+			if ( throttle.maxInFlight != UMax )
+				str << " max in flight: " << ToString( throttle.maxInFlight ) << ", peak: " << ToString( throttle._peakInFlight.load() ) << ',';
+			if ( throttle.interval != 0 )
+				str << " rate: " << ToString( 1.0e+9 / double(throttle.interval), 2 ) << " tasks/s,";
+
+			AE_LOGI( str << " rejected: " << ToString( throttle._rejected.load() ));
 		)
+		Unused( name, throttle );
 	}
 
 
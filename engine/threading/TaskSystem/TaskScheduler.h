@@ -3,6 +3,14 @@
 	Async task states:
 		TaskScheduler::Run() {
 			pending state
+			if all input dependencies are complete
+				add to the ready queue
+		}
+		IAsyncTask::_NotifyOutputs() {
+			close output list
+			for each output dependency
+				if it was the last incomplete input dependency
+					add dependent task to the ready queue
 		}
 		TaskScheduler::ProcessTask() {
 			if cancellation or one of input dependencies was canceled {
@@ -17,6 +25,9 @@
 					if something goes wrong
 						set failed state and return
 				}
+				if Continue() was called
+					set pending state and return, task will be added to the ready queue again
+					when new input dependency completes
 				if seccessfully completed
 					set completed state and return
 				if cancellation
@@ -29,6 +40,9 @@
 
 	Order guaranties:
 		AsyncTask::Run() will be called after all input dependencies Run() or OnCancel() methods have completed
+
+	Blocked tasks are not stored in the queues, they are referenced by output list of the input dependencies
+	(or by custom dependency manager) and will be added to the ready queue when the last dependency completes.
 */
 
 #pragma once
@@ -45,6 +59,10 @@
 
 #include "threading/Primitives/SpinLock.h"
 #include "threading/Primitives/RWSpinLock.h"
+#include "threading/Primitives/WakeupEvent.h"
+#include "threading/TaskSystem/TaskAllocator.h"
+#include "threading/TaskSystem/TaskTracer.h"
+#include "threading/Queues/LfWorkStealingDeque.h"
 
 #include <chrono>
 
@@ -83,6 +101,18 @@ namespace AE::Threading
 	using StrongDep = _TaskDependency<true>;
 
 
+	template <bool IsStrongDep>
+	struct _TaskDependencyArray
+	{
+		ArrayView<AsyncTask>	_tasks;
+
+		explicit _TaskDependencyArray (ArrayView<AsyncTask> tasks) : _tasks{tasks} {}
+	};
+
+	using WeakDepArray   = _TaskDependencyArray<false>;
+	using StrongDepArray = _TaskDependencyArray<true>;
+
+
 
 	//
 	// Interlock Dependency
@@ -114,7 +144,7 @@ namespace AE::Threading
 		ND_ explicit operator bool () const	{ return _fn; }
 
 		ND_ bool  TryLock ()				{ return _fn( _data, EAction::TryLock ); }
-		ND_ bool  Unlock ()					{ bool res = _fn ? _fn( _data, EAction::Unlock ) : true;  Clear();  return res; }
+		ND_ bool  Unlock ()					{ bool res = true;  if ( _fn ) { res = _fn( _data, EAction::Unlock );  Clear(); }  return res; }
 			void  Clear ()					{ _fn = null;  _data = null; }
 	};
 
@@ -126,9 +156,11 @@ namespace AE::Threading
 	
 	class IAsyncTask : public std::enable_shared_from_this< IAsyncTask >
 	{
-		friend class ITaskDependencyManager;	// can change '_waitBits' and '_canceledDepsCount'
+		friend class ITaskDependencyManager;	// can change '_waitCount' and '_canceledDepsCount'
 		friend class TaskScheduler;				// can change '_status'
 		friend class IThread;					// can change '_status'
+		friend class TaskTracer;				// can call 'DbgName()'
+		friend class TaskGraph;					// can change '_waitCount' and '_canceledDepsCount'
 		
 	// types
 	public:
@@ -157,46 +189,74 @@ namespace AE::Threading
 			_Count
 		};
 
-
-	private:
-		struct TaskDependency
+		enum class EPriority : uint
 		{
-			AsyncTask		task;
-			uint			bitIndex : 8;	// to reset bit in '_waitBits'
-			uint			isStrong : 1;	// to increment '_canceledDepsCount'
+			High,			// frame critical tasks
+			Normal,
+			Background,		// will be executed when there are no tasks with higher priority, or after aging
+			_Count
 		};
 
-		struct OutputChunk
+		using TimePoint_t	= std::chrono::high_resolution_clock::time_point;
+
+
+	private:
+		struct OutputNode
 		{
-			OutputChunk *						next		= null;
-			uint								selfIndex	= UMax;
-			FixedArray< TaskDependency, 15 >	tasks;
+			OutputNode *	next		= null;
+			AsyncTask		task;
+			bool			isStrong	= false;	// to increment '_canceledDepsCount'
 
-			void Init (uint idx);
+			ND_ static OutputNode*  New (const AsyncTask &task, bool isStrong);
+				static void			Delete (OutputNode* node);
 
-			static auto&  _GetPool ();
+			// output list is closed when task is finished, new dependencies can not be added
+			ND_ static OutputNode*  Closed ()	{ return reinterpret_cast<OutputNode*>( size_t(1) ); }
 		};
 
-		using WaitBits_t = uint64_t;
+		using WaitCount_t = uint;
+
+		// '_waitCount' is biased until task is added to the queue, so completed dependencies can't make task ready,
+		// it is also limits number of input dependencies
+		static constexpr WaitCount_t	WaitBias	= 1u << 30;
 
 
 	// variables
 	private:
 		alignas(AE_CACHE_LINE)
 		Atomic< EStatus >			_status					{EStatus::Initial};
-		Atomic< WaitBits_t >		_waitBits				{~0ull};
+		Atomic< WaitCount_t >		_waitCount				{WaitBias};		// number of incomplete input dependencies
 		Atomic< uint >				_canceledDepsCount		{0};
-		const EThread				_threadType;
-		
-		Mutex						_outputGuard;
-		OutputChunk *				_output					= null;
+		EThread						_threadType;		// can be changed only by 'Continue()'
+		const EPriority				_priority;
+		TimePoint_t					_deadline				= TimePoint_t::max();
+		TimePoint_t					_enqueueTime;		// time when task was added to the ready queue, used for aging
+		TimePoint_t					_urgentTime;		// time when task will be promoted to high priority by deadline or aging
+
+		Atomic< OutputNode *>		_output					{null};		// lock-free list of dependent tasks
 
 		InterlockDependency			_interlockDep;
 
+		AsyncTask					_localQueueRef;		// keeps task alive while it is in work-stealing queue
+
+		bool						_runInline				= false;	// for internal notifications, task is executed by thread that completes last dependency
+
+		AsyncTask					_continueAfter;		// input dependency for the next 'Run()' call
+		bool						_isContinued			= false;
+
+		class TaskGraph *			_graph					= null;		// graph notifies dependent tasks when this task finishes
+		uint						_graphIndex				= 0;
+
+		uint8_t						_throttleTag			= 0;		// 0 - task is not throttled by tag
+		uint8_t						_throttleType			= 0;		// thread type for which throttle slot was acquired
+		uint8_t						_throttleState			= 0;		// see 'TaskScheduler::_TryAcquireThrottle()'
+
 
 	// methods
 	public:
-		ND_ EThread	Type ()			 const	{ return _threadType; }
+		ND_ EThread		Type ()			 const	{ return _threadType; }
+		ND_ EPriority	Priority ()		 const	{ return _priority; }
+		ND_ TimePoint_t	Deadline ()		 const	{ return _deadline; }
 
 		ND_ EStatus	Status ()		 const	{ return _status.load( EMemoryOrder::Relaxed ); }
 
@@ -205,7 +265,7 @@ namespace AE::Threading
 		ND_ bool	IsInterropted () const	{ return Status() > EStatus::_Interropted; }
 
 	protected:
-		IAsyncTask (EThread type);
+		IAsyncTask (EThread type, EPriority priority = EPriority::Normal);
 
 		virtual ~IAsyncTask ();
 
@@ -216,16 +276,29 @@ namespace AE::Threading
 			// call this only inside 'Run()' method
 			bool  OnFailure ();
 
+			// call this only inside 'Run()' method, task will not be completed and 'Run()' will be called again
+			// in 'type' thread after 'dep' has been completed, task will be canceled if 'dep' is canceled or failed
+			void  Continue (const AsyncTask &dep, EThread type);
+			void  Continue (const AsyncTask &dep)	{ Continue( dep, _threadType ); }
+
+			// call this before 'TaskScheduler::Run()', task will be processed with high priority when deadline is near
+			void  SetDeadline (TimePoint_t time)	{ ASSERT( Status() == EStatus::Initial );  _deadline = time; }
+
+			// call this before 'TaskScheduler::Run()', task will be limited by 'TaskScheduler::Settings::tagLimits[tag]'
+			void  SetThrottleTag (uint tag);
+
 			// call this before reusing task
 			bool  _ResetState ();
 
 	private:
-		// call this methods only after 'Run()' method
-		void  _OnFinish ();
+		// call this methods only after 'Run()' method,
+		// '_OnFinish()' returns 'false' if task was restarted by 'Continue()', then task may be executed in another thread and must not be used
+		ND_ bool  _OnFinish ();
 		void  _Cancel ();
 
 		bool  _SetCancellationState ();
-		void  _FreeOutputChunks (bool isCanceled);
+		bool  _Restart ();
+		void  _NotifyOutputs (bool isCanceled);
 	};
 
 
@@ -239,7 +312,8 @@ namespace AE::Threading
 	{
 	// types
 	public:
-		using EThread = IAsyncTask::EThread;
+		using EThread		= IAsyncTask::EThread;
+		using ThreadMask	= BitSet< uint(EThread::_Count) >;
 
 	// interface
 	public:
@@ -264,12 +338,15 @@ namespace AE::Threading
 	{
 	// interface
 	public:
-		virtual bool  Resolve (AnyTypeCRef dep, const AsyncTask &task, INOUT uint &bitIndex) = 0;
+		// increment 'depCount' for each dependency that is not complete
+		virtual bool  Resolve (AnyTypeCRef dep, const AsyncTask &task, INOUT uint &depCount) = 0;
 
 
 	// helper functions
 	protected:
-		static void  _SetDependencyCompletionStatus (const AsyncTask &task, uint depIndex, bool cancel = false);
+		// if it was the last incomplete dependency then task will be added to the ready queue,
+		// must be called once for each dependency counted in 'Resolve()'
+		static void  _SetDependencyCompletionStatus (const AsyncTask &task, bool cancel = false);
 	};
 
 
@@ -281,13 +358,107 @@ namespace AE::Threading
 	class TaskScheduler final : public Noncopyable
 	{
 		friend class IAsyncTask;
+		friend class ITaskDependencyManager;
+		friend class TaskGraph;
 
 	// types
+	public:
+		static constexpr uint	MaxThrottleTags	= 8;
+
+		struct ThrottleSettings
+		{
+			uint	maxInFlight		= 0;		// maximal number of simultaneously running tasks, 0 - unlimited
+			float	tasksPerSecond	= 0.0f;		// token bucket rate, 0 - unlimited
+			uint	burst			= 1;		// token bucket capacity, number of tasks that can be started at once after idle
+		};
+
+		struct Settings
+		{
+			uint	maxWorkerThreads	= 4;
+			bool	workStealing		= false;	// each worker thread has own lock-free queue, idle threads steal tasks from other threads
+
+			// worker threads are pinned to the cpu cores, each NUMA node has own group of worker queues,
+			// threads process tasks from the local node first and then from other nodes
+			bool	topologyAware		= false;
+
+			// task that is waiting in queue longer than this interval multiplied by priority level will be processed as high priority task, 0 - disable aging
+			Nanoseconds	priorityAging	{20'000'000};
+
+			// task with deadline will be processed as high priority task when time until deadline is less than this value
+			Nanoseconds	deadlineMargin	{2'000'000};
+
+			// if not empty then task tracing will be enabled, trace will be saved to this file in 'Release()'
+			Path		traceFile;
+
+			// limits are checked when task is pulled from the shared queue,
+			// worker tasks are not added to the work-stealing queues if worker threads or task tag are limited
+			StaticArray< ThrottleSettings, uint(IAsyncTask::EThread::_Count) >	threadLimits;
+
+			// tag 0 is not limited, see 'IAsyncTask::SetThrottleTag()'
+			StaticArray< ThrottleSettings, MaxThrottleTags >					tagLimits;
+		};
+
 	private:
+		static constexpr uint		PriorityCount	= uint(IAsyncTask::EPriority::_Count);
+		static constexpr int64_t	NeverUrgent		= std::numeric_limits<int64_t>::max();
+
 		struct alignas(AE_CACHE_LINE) _PerQueue
 		{
-			SpinLock			guard;
-			Array<AsyncTask>	tasks;
+			SpinLock										guard;
+			StaticArray< Deque<AsyncTask>, PriorityCount >	tasks;		// only ready tasks, input dependencies are complete or canceled
+			Atomic<int64_t>									urgentTime	{NeverUrgent};	// nearest '_urgentTime' of normal and background tasks, changed under lock
+		};
+
+		struct alignas(AE_CACHE_LINE) _ParkingLot
+		{
+			Mutex					guard;
+			Array<WakeupEvent*>		events;		// parked threads
+			Atomic<uint>			count	{0};
+		};
+		using ParkingLots_t		= StaticArray< _ParkingLot, uint(IAsyncTask::EThread::_Count) >;
+
+		struct _LocalQueue
+		{
+			LfWorkStealingDeque< IAsyncTask* >	deque;
+			Atomic<bool>						inUse		{false};
+			uint								numaNode	= 0;
+		};
+
+		struct alignas(AE_CACHE_LINE) _Throttle
+		{
+			uint				maxInFlight		= UMax;
+			int64_t				interval		= 0;	// nanoseconds per task, 0 - rate is not limited
+			int64_t				burstTime		= 0;	// interval * burst
+			Atomic<uint>		inFlight		{0};
+			Atomic<int64_t>		tat				{0};	// theoretical arrival time of the next task (GCRA), nanoseconds
+
+			AE_SCHEDULER_PROFILING(
+				Atomic<uint64_t>	_rejected		{0};	// number of tasks that were not started because of limits
+				Atomic<uint>		_peakInFlight	{0};
+			)
+
+				void  Setup (const ThrottleSettings &settings);
+			ND_ bool  IsEnabled () const		{ return (maxInFlight != UMax) | (interval != 0); }
+			ND_ bool  IsExhausted (int64_t now) const;
+			ND_ bool  TryAcquireSlot ();
+			ND_ bool  TryAcquireToken (int64_t now);
+			ND_ int64_t  TokenWaitTime (int64_t now) const;
+				void  ReleaseSlot ()			{ if ( maxInFlight != UMax ) inFlight.fetch_sub( 1, EMemoryOrder::Relaxed ); }
+				void  ReturnToken ()			{ if ( interval != 0 ) tat.fetch_sub( interval, EMemoryOrder::Relaxed ); }
+		};
+		using TagThrottles_t	= StaticArray< _Throttle, MaxThrottleTags >;
+
+		enum class _EThrottleStatus : uint8_t
+		{
+			Acquired,
+			ThreadExhausted,	// none of tasks with the same thread type can be started
+			TagExhausted,		// none of tasks with the same tag can be started
+		};
+
+		struct _ThreadPlacement
+		{
+			uint16_t	cpuCore		= 0;
+			uint16_t	numaNode	= 0;
 		};
 
 		template <size_t N>
@@ -295,19 +466,26 @@ namespace AE::Threading
 		{
 		// variables
 		public:
-			FixedArray< _PerQueue, N >	queues;
+			FixedArray< _PerQueue, N >					queues;
+			StaticArray< Atomic<uint>, PriorityCount >	depth;		// number of tasks in all queues for each priority
+			uint										groupSize	= 1;	// number of queues per NUMA node
+			_Throttle									throttle;
 
 			AE_SCHEDULER_PROFILING(
 				Atomic<uint64_t>	_stallTime		{0};	// Nanoseconds
 				Atomic<uint64_t>	_workTime		{0};
 				Atomic<uint64_t>	_insertionTime	{0};
+
+				StaticArray< Atomic<uint64_t>, PriorityCount >	_waitTime;		// Nanoseconds, from enqueue to start
+				StaticArray< Atomic<uint64_t>, PriorityCount >	_taskCount;
+				StaticArray< Atomic<uint>, PriorityCount >		_maxDepth;
 			)
 
 		// methods
 		public:
 			_TaskQueue ();
 
-			void  Resize (size_t count);
+			void  Resize (size_t count, size_t groupSize = 0);
 		};
 
 		using MainQueue_t		= _TaskQueue< 2 >;
@@ -320,7 +498,9 @@ namespace AE::Threading
 		using TimePoint_t		= std::chrono::high_resolution_clock::time_point;
 		using EStatus			= IAsyncTask::EStatus;
 		using EThread			= IAsyncTask::EThread;
-		using OutputChunk_t		= IAsyncTask::OutputChunk;
+		using EPriority			= IAsyncTask::EPriority;
+		using ThreadMask		= IThread::ThreadMask;
+		using OutputNode_t		= IAsyncTask::OutputNode;
 
 		using TaskDepsMngr_t	= HashMap< std::type_index, TaskDependencyManagerPtr >;
 		
@@ -333,6 +513,23 @@ namespace AE::Threading
 		FileQueue_t			_fileQueue;
 		NetworkQueue_t		_networkQueue;
 
+		Array<UniquePtr<_LocalQueue>>	_localQueues;	// for work stealing
+		bool							_workStealing	= false;
+
+		Nanoseconds			_priorityAging;
+		Nanoseconds			_deadlineMargin;
+		Path				_traceFile;
+
+		static thread_local _LocalQueue*	_currentLocalQueue;
+		static thread_local uint			_currentNumaNode;
+		static thread_local ThreadMask		_currentThreadMask;
+
+		Array<_ThreadPlacement>	_threadPlacement;	// empty if topology-aware mode is disabled
+
+		TagThrottles_t		_tagThrottles;
+
+		ParkingLots_t		_parkingLots;
+
 		SharedMutex			_taskDepsMngrsGuard;
 		TaskDepsMngr_t		_taskDepsMngrs;
 
@@ -347,6 +544,7 @@ namespace AE::Threading
 	public:
 		ND_ static TaskScheduler&  Instance ();
 
+		bool  Setup (const Settings &settings);
 		bool  Setup (size_t maxWorkerThreads);
 		void  Release ();
 			
@@ -367,6 +565,28 @@ namespace AE::Threading
 
 		ND_ AsyncTask  PullTask (EThread type, uint seed);
 
+		// approximate number of ready tasks in shared queues and in work-stealing queue of the current thread
+		ND_ size_t  ReadyTaskCount (EThread type) const;
+
+		// returns cpu core and NUMA node for thread with 'uid', returns 'false' if topology-aware mode is disabled
+		ND_ bool  GetThreadPlacement (uint uid, OUT uint &cpuCore, OUT uint &numaNode) const;
+
+		// current thread will use queues of this NUMA node first, call this before 'AttachLocalQueue()'
+		static void  SetCurrentThreadNode (uint numaNode)	{ _currentNumaNode = numaNode; }
+		ND_ static uint  CurrentThreadNode ()				{ return _currentNumaNode; }
+
+		// types of queues that are processed by the current thread, thread that calls 'Setup()' is considered as main thread
+		static void  SetCurrentThreadMask (const ThreadMask &mask)	{ _currentThreadMask = mask; }
+		ND_ static ThreadMask  CurrentThreadMask ()					{ return _currentThreadMask; }
+
+		// attach work-stealing queue to the current thread, returns 'false' if work stealing is disabled
+		bool  AttachLocalQueue ();
+		void  DetachLocalQueue ();
+
+		// blocks current thread until new task with one of 'mask' types is added or event is signaled or timeout expired,
+		// returns 'false' if there are ready tasks and thread has not been parked
+		bool  ParkThread (WakeupEvent &event, const ThreadMask &mask, Nanoseconds timeout);
+
 	// task api
 		template <typename TaskType, typename ...Ctor, typename ...Deps>
 		AsyncTask  Run (Tuple<Ctor...>&& ctor = Default, const Tuple<Deps...> &deps = Default);
@@ -374,7 +594,13 @@ namespace AE::Threading
 		template <typename ...Deps>
 		bool  Run (const AsyncTask &task, const Tuple<Deps...> &deps = Default);
 
-		ND_ bool  Wait (ArrayView<AsyncTask> tasks, Nanoseconds timeout = Nanoseconds{30'000'000'000});
+		// same dependencies will be added to each task, all ready tasks will be added to the queues at once
+		template <typename ...Deps>
+		bool  RunBatch (ArrayView<AsyncTask> tasks, const Tuple<Deps...> &deps = Default);
+
+		// current thread helps to process tasks from queues in 'helpMask' until all tasks are finished
+		ND_ bool  Wait (ArrayView<AsyncTask> tasks, Nanoseconds timeout = Nanoseconds{30'000'000'000},
+						const ThreadMask &helpMask = ThreadMask{}.set( uint(EThread::Worker) ));
 
 		bool  Cancel (const AsyncTask &task);
 
@@ -383,27 +609,73 @@ namespace AE::Threading
 		TaskScheduler ();
 		~TaskScheduler ();
 
-		AsyncTask  _InsertTask (const AsyncTask &task, uint bitIndex);
+		AsyncTask  _InsertTask (const AsyncTask &task, uint depCount);
+		bool  _InsertTasks (ArrayView<AsyncTask> tasks, ArrayView<uint> depCounts);
+		void  _CancelTasks (ArrayView<AsyncTask> tasks);
+		bool  _SetPendingState (const AsyncTask &task, uint depCount, OUT bool &isReady);
+		bool  _ContinueTask (const AsyncTask &task, const AsyncTask &dep);
+		void  _EnqueueReadyTask (const AsyncTask &task);
+		void  _EnqueueReadyTasks (EThread type, ArrayView<AsyncTask> tasks);
+		void  _WakeupThread (EThread type, size_t count = 1);
+		ND_ bool  _HasReadyTasks (EThread type);
+
+		template <size_t N>
+		ND_ static bool  _HasReadyTasks (_TaskQueue<N> &tq);
+
+		template <size_t N>
+		ND_ static size_t  _QueueIndex (const _TaskQueue<N> &tq, size_t j, size_t seed);
+
+		void  _SetupTopology (uint maxWorkerThreads);
 
 		template <size_t N>
 		void  _AddTask (_TaskQueue<N> &tq, const AsyncTask &task) const;
+		
+		template <size_t N>
+		void  _AddTasks (_TaskQueue<N> &tq, ArrayView<AsyncTask> tasks) const;
 
 		template <size_t N>
-		AsyncTask  _PullTask (_TaskQueue<N> &tq, uint seed) const;
+		static void  _IncDepth (_TaskQueue<N> &tq, uint priority, uint count);
+
+		template <size_t N>
+		AsyncTask  _PullTask (_TaskQueue<N> &tq, uint seed, TimePoint_t now);
 		
 		template <size_t N>
-		bool  _ProcessTask (_TaskQueue<N> &tq, uint seed) const;
+		bool  _ProcessTask (_TaskQueue<N> &tq, const AsyncTask &task) const;
+
+		ND_ _EThrottleStatus  _TryAcquireThrottle (_Throttle &throttle, IAsyncTask &task, int64_t now);
+		bool  _RollbackThrottle (IAsyncTask &task);
+		void  _ReleaseThrottle (IAsyncTask &task);
+		ND_ _Throttle&  _GetThrottle (EThread type);
+
+		static void  _WriteThrottleStat (StringView name, const _Throttle &throttle);
+
+		AsyncTask  _PullWorkerTask (uint seed, TimePoint_t now);
+		AsyncTask  _StealTask (uint seed, TimePoint_t now);
+		bool  _PushToLocalQueue (const AsyncTask &task);
+
+		static bool  _TryStartTask (const AsyncTask &task);
+
+			void  _SetEnqueueTime (IAsyncTask &task, TimePoint_t now) const;
+
+		static void  _PushToPriorityQueue (Deque<AsyncTask> &tasks, const AsyncTask &task);
+		static void  _UpdateUrgentTime (_PerQueue &q);
+
+		template <size_t N>
+		ND_ static bool  _HasUrgentTask (const _TaskQueue<N> &tq, int64_t now);
+
+		template <size_t N>
+		static void  _OnTaskDequeued (_TaskQueue<N> &tq, const IAsyncTask &task, TimePoint_t now);
 
 		template <size_t N>
 		static void  _WriteProfilerStat (StringView name, const _TaskQueue<N> &tq);
 
 		template <size_t I, typename ...Args>
-		constexpr bool  _AddDependencies (const AsyncTask &task, const Tuple<Args...> &args, INOUT uint &bitIndex);
+		constexpr bool  _AddDependencies (const AsyncTask &task, const Tuple<Args...> &args, INOUT uint &depCount);
 
 		template <typename T>
-		bool  _AddCustomDependency (const AsyncTask &task, T &dep, INOUT uint &bitIndex);
+		bool  _AddCustomDependency (const AsyncTask &task, T &dep, INOUT uint &depCount);
 
-		bool  _AddTaskDependencies (const AsyncTask &task, const AsyncTask &deps, bool isStrong, INOUT uint &bitIndex);
+		bool  _AddTaskDependencies (const AsyncTask &task, const AsyncTask &deps, bool isStrong, INOUT uint &depCount);
 
 		bool  _SetInterlockDependency (const AsyncTask &task, const InterlockDependency &dep);
 	};
@@ -444,12 +716,12 @@ namespace AE::Threading
 	{
 		STATIC_ASSERT( IsBaseOf< IAsyncTask, TaskType > );
 
-		AsyncTask	task		= ctorArgs.Apply([] (auto&& ...args) { return MakeShared<TaskType>( std::forward<decltype(args)>(args)... ); });
-		uint		bit_index	= 0;
+		AsyncTask	task		= ctorArgs.Apply([] (auto&& ...args) { return MakeTask<TaskType>( std::forward<decltype(args)>(args)... ); });
+		uint		dep_count	= 0;
 		
-		CHECK_ERR( _AddDependencies<0>( task, deps, INOUT bit_index ));
+		CHECK_ERR( _AddDependencies<0>( task, deps, INOUT dep_count ));
 
-		return _InsertTask( task, bit_index );
+		return _InsertTask( task, dep_count );
 	}
 	
 /*
@@ -462,10 +734,34 @@ namespace AE::Threading
 	{
 		CHECK_ERR( task );
 
-		uint	bit_index = 0;
-		CHECK_ERR( _AddDependencies<0>( task, deps, INOUT bit_index ));
+		uint	dep_count = 0;
+		CHECK_ERR( _AddDependencies<0>( task, deps, INOUT dep_count ));
+
+		return _InsertTask( task, dep_count ) != null;
+	}
+
+/*
+=================================================
+	RunBatch
+=================================================
+*/
+	template <typename ...Deps>
+	inline bool  TaskScheduler::RunBatch (ArrayView<AsyncTask> tasks, const Tuple<Deps...> &deps)
+	{
+		Array<uint>	dep_counts;
+		dep_counts.resize( tasks.size() );
+
+		for (size_t i = 0; i < tasks.size(); ++i)
+		{
+			if ( not tasks[i] or not _AddDependencies<0>( tasks[i], deps, INOUT dep_counts[i] ))
+			{
+				// dependencies of previous tasks are already registered, they may be referenced by other tasks
+				_CancelTasks( tasks );
+				RETURN_ERR( "failed to add dependencies, all tasks in batch are canceled" );
+			}
+		}
 
-		return _InsertTask( task, bit_index ) != null;
+		return _InsertTasks( tasks, dep_counts );
 	}
 
 /*
@@ -474,7 +770,7 @@ namespace AE::Threading
 =================================================
 */
 	template <size_t I, typename ...Args>
-	inline constexpr bool  TaskScheduler::_AddDependencies (const AsyncTask &task, const Tuple<Args...> &args, INOUT uint &bitIndex)
+	inline constexpr bool  TaskScheduler::_AddDependencies (const AsyncTask &task, const Tuple<Args...> &args, INOUT uint &depCount)
 	{
 		if constexpr( I < CountOf<Args...>() )
 		{
@@ -482,26 +778,34 @@ namespace AE::Threading
 
 			// current task will start anyway, regardless of whether dependent tasks are canceled
 			if constexpr( IsSameTypes< T, WeakDep >)
-				CHECK_ERR( _AddTaskDependencies( task, args.template Get<I>()._task, false, INOUT bitIndex ))
+				CHECK_ERR( _AddTaskDependencies( task, args.template Get<I>()._task, false, INOUT depCount ))
 			else
 			// current task will be canceled if one of dependent task are canceled
 			if constexpr( IsSameTypes< T, StrongDep >)
-				CHECK_ERR( _AddTaskDependencies( task, args.template Get<I>()._task, true, INOUT bitIndex ))
+				CHECK_ERR( _AddTaskDependencies( task, args.template Get<I>()._task, true, INOUT depCount ))
+			else
+			// same as 'WeakDep' and 'StrongDep' for each task in array
+			if constexpr( IsSameTypes< T, WeakDepArray > or IsSameTypes< T, StrongDepArray >)
+			{
+				for (auto& dep : args.template Get<I>()._tasks) {
+					CHECK_ERR( _AddTaskDependencies( task, dep, IsSameTypes< T, StrongDepArray >, INOUT depCount ));
+				}
+			}
 			else
 			// implicitlly it is strong dependency
 			if constexpr( IsConvertible< T, AsyncTask >)
-				CHECK_ERR( _AddTaskDependencies( task, args.template Get<I>(), true, INOUT bitIndex ))
+				CHECK_ERR( _AddTaskDependencies( task, args.template Get<I>(), true, INOUT depCount ))
 			else
 			if constexpr( IsSameTypes< T, InterlockDependency >)
 				CHECK_ERR( _SetInterlockDependency( task, args.template Get<I>() ))
 			else
-				CHECK_ERR( _AddCustomDependency( task, args.template Get<I>(), INOUT bitIndex ));
+				CHECK_ERR( _AddCustomDependency( task, args.template Get<I>(), INOUT depCount ));
 
-				return _AddDependencies<I+1>( task, args, INOUT bitIndex );
+				return _AddDependencies<I+1>( task, args, INOUT depCount );
 		}
 		else
 		{
-			Unused( task, args, bitIndex );
+			Unused( task, args, depCount );
 			return true;
 		}
 	}
@@ -512,14 +816,14 @@ namespace AE::Threading
 =================================================
 */
 	template <typename T>
-	inline bool  TaskScheduler::_AddCustomDependency (const AsyncTask &task, T &dep, INOUT uint &bitIndex)
+	inline bool  TaskScheduler::_AddCustomDependency (const AsyncTask &task, T &dep, INOUT uint &depCount)
 	{
 		SHAREDLOCK( _taskDepsMngrsGuard );
 
 		auto	iter = _taskDepsMngrs.find( typeid(T) );
 		CHECK_ERR( iter != _taskDepsMngrs.end() );
 
-		return iter->second->Resolve( AnyTypeCRef{dep}, task, INOUT bitIndex );
+		return iter->second->Resolve( AnyTypeCRef{dep}, task, INOUT depCount );
 	}
 
 /*
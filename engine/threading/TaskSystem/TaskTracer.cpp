@@ -0,0 +1,348 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "threading/TaskSystem/TaskTracer.h"
+#include "threading/TaskSystem/TaskScheduler.h"
+#include "stl/Algorithms/StringUtils.h"
+#include "stl/Platforms/PlatformUtils.h"
+#include "stl/Stream/FileStream.h"
+
+namespace AE::Threading
+{
+namespace {
+	using TimePoint_t	= std::chrono::high_resolution_clock::time_point;
+	using EEvent		= TaskTracer::EEvent;
+
+
+	struct Event
+	{
+		int64_t			time;		// nanoseconds since tracer start
+		const void *	task;
+		EEvent			type;
+		char			name [TaskTracer::MaxNameLength];
+	};
+	STATIC_ASSERT( sizeof(Event) <= 64 );
+
+
+	//
+	// Event Slot
+	//
+	struct EventSlot
+	{
+		static constexpr uint	WordCount = (sizeof(Event) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+		// odd value - event is being written, '(pos + 1) * 2' - event with index 'pos' is written
+		Atomic<uint64_t>							seq		{0};
+		StaticArray< Atomic<uint64_t>, WordCount >	data	= {};
+
+		// called only by owner thread
+		void  Write (uint64_t pos, const Event &ev)
+		{
+			uint64_t	words [WordCount] = {};
+			std::memcpy( OUT words, &ev, sizeof(ev) );
+
+			seq.store( pos * 2 + 1, EMemoryOrder::Relaxed );
+			ThreadFence( EMemoryOrder::Release );
+
+			for (uint i = 0; i < WordCount; ++i) {
+				data[i].store( words[i], EMemoryOrder::Relaxed );
+			}
+			seq.store( (pos + 1) * 2, EMemoryOrder::Release );
+		}
+
+		// returns 'false' if slot doesn't contain event with index 'pos' or event was changed while reading
+		ND_ bool  Read (uint64_t pos, OUT Event &ev) const
+		{
+			const uint64_t	expected = (pos + 1) * 2;
+
+			if ( seq.load( EMemoryOrder::Acquire ) != expected )
+				return false;
+
+			uint64_t	words [WordCount];
+			for (uint i = 0; i < WordCount; ++i) {
+				words[i] = data[i].load( EMemoryOrder::Relaxed );
+			}
+
+			ThreadFence( EMemoryOrder::Acquire );
+
+			if ( seq.load( EMemoryOrder::Relaxed ) != expected )
+				return false;
+
+			std::memcpy( OUT &ev, words, sizeof(ev) );
+			return true;
+		}
+	};
+
+
+	//
+	// Thread Buffer
+	//
+	struct ThreadBuffer
+	{
+		Atomic<uint64_t>			writePos	{0};	// changed only by owner thread
+		uint64_t					readPos		= 0;	// changed only in 'Flush()'
+		const uint					threadId;
+		const String				threadName;
+		Array<EventSlot>			events;
+
+		ThreadBuffer (uint id, String name) :
+			threadId{id}, threadName{std::move(name)}, events( TaskTracer::BufferSize )
+		{}
+	};
+
+
+	//
+	// Tracer
+	//
+	struct Tracer
+	{
+		const TimePoint_t				startTime	= TimePoint_t::clock::now();
+
+		Mutex							guard;
+		Array<UniquePtr<ThreadBuffer>>	buffers;	// buffers are not released when thread exits, so events can be flushed later
+
+		ND_ static Tracer&  Instance ()
+		{
+			static Tracer	tracer;
+			return tracer;
+		}
+	};
+
+	static thread_local ThreadBuffer*	t_threadBuffer	= null;
+
+/*
+=================================================
+	GetThreadBuffer
+=================================================
+*/
+	ND_ ThreadBuffer&  GetThreadBuffer ()
+	{
+		if_likely( t_threadBuffer != null )
+			return *t_threadBuffer;
+
+		auto&	tracer = Tracer::Instance();
+		EXLOCK( tracer.guard );
+
+		tracer.buffers.push_back( MakeUnique<ThreadBuffer>( uint(tracer.buffers.size()), PlatformUtils::GetThreadName() ));
+		t_threadBuffer = tracer.buffers.back().get();
+		return *t_threadBuffer;
+	}
+
+/*
+=================================================
+	AppendJsonString
+=================================================
+*/
+	void  AppendJsonString (INOUT String &str, StringView value)
+	{
+		str << '"';
+		for (char c : value)
+		{
+			if ( c == '"' or c == '\\' )
+				str << '\\' << c;
+			else
+			if ( uint8_t(c) < 0x20 )
+				str << ' ';
+			else
+				str << c;
+		}
+		str << '"';
+	}
+
+/*
+=================================================
+	AppendEvent
+=================================================
+*/
+	void  AppendEvent (INOUT String &str, StringView phase, StringView name, uint tid, int64_t time)
+	{
+		str << "\n{\"ph\":\"" << phase << "\",\"pid\":0,\"tid\":" << ToString( tid ) << ",\"ts\":" << ToString( double(time) * 1.0e-3, 3 ) << ",\"name\":";
+		AppendJsonString( INOUT str, name );
+	}
+
+	void  AppendEvent (INOUT String &str, StringView phase, StringView name, uint tid, int64_t time, StringView cat, const void* id)
+	{
+		AppendEvent( INOUT str, phase, name, tid, time );
+		str << ",\"cat\":\"" << cat << "\",\"id\":\"" << ToString<16>( size_t(id) ) << '"';
+	}
+
+}	// namespace
+//-----------------------------------------------------------------------------
+
+
+	Atomic<bool>  TaskTracer::_enabled {false};
+
+/*
+=================================================
+	Enable
+=================================================
+*/
+	void  TaskTracer::Enable (bool value)
+	{
+		Unused( Tracer::Instance() );
+		_enabled.store( value, EMemoryOrder::Relaxed );
+	}
+
+/*
+=================================================
+	_Record
+=================================================
+*/
+	void  TaskTracer::_Record (EEvent type, const IAsyncTask &task)
+	{
+		auto&			buf		= GetThreadBuffer();
+		const uint64_t	pos		= buf.writePos.load( EMemoryOrder::Relaxed );
+		NtStringView	name	= task.DbgName();
+		Event			ev;
+
+		ev.time	= (TimePoint_t::clock::now() - Tracer::Instance().startTime).count();
+		ev.task	= &task;
+		ev.type	= type;
+
+		const size_t	len = Min( name.size(), CountOf(ev.name) - 1 );
+		std::memcpy( OUT ev.name, name.c_str(), len );
+		ev.name[len] = '\0';
+
+		// 'Flush()' may read this slot concurrently
+		buf.events[ pos % BufferSize ].Write( pos, ev );
+		buf.writePos.store( pos + 1, EMemoryOrder::Release );
+	}
+
+/*
+=================================================
+	Clear
+=================================================
+*/
+	void  TaskTracer::Clear ()
+	{
+		auto&	tracer = Tracer::Instance();
+		EXLOCK( tracer.guard );
+
+		for (auto& buf : tracer.buffers) {
+			buf->readPos = buf->writePos.load( EMemoryOrder::Acquire );
+		}
+	}
+
+/*
+=================================================
+	Flush
+=================================================
+*/
+	bool  TaskTracer::Flush (const Path &filename)
+	{
+		struct EventRef
+		{
+			Event		ev;
+			uint		tid;
+		};
+
+		auto&			tracer	= Tracer::Instance();
+		Array<EventRef>	events;
+		String			str;
+
+		str << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+		{
+			EXLOCK( tracer.guard );
+
+			for (auto& buf : tracer.buffers)
+			{
+				const uint64_t	end		= buf->writePos.load( EMemoryOrder::Acquire );
+				const uint64_t	begin	= Max( buf->readPos, end > BufferSize ? end - BufferSize : 0 );
+
+				// events that are overwritten while copying are skipped
+				for (uint64_t i = begin; i < end; ++i)
+				{
+					EventRef	ref;
+					ref.tid = buf->threadId;
+
+					if ( buf->events[ i % BufferSize ].Read( i, OUT ref.ev ))
+						events.push_back( ref );
+				}
+				buf->readPos = end;
+
+				str << "\n{\"ph\":\"M\",\"pid\":0,\"tid\":" << ToString( buf->threadId ) << ",\"name\":\"thread_name\",\"args\":{\"name\":";
+				AppendJsonString( INOUT str, buf->threadName.empty() ? "thread "s << ToString( buf->threadId ) : buf->threadName );
+				str << "}},";
+			}
+		}
+
+		std::stable_sort( events.begin(), events.end(), [] (auto& lhs, auto& rhs) { return lhs.ev.time < rhs.ev.time; });
+
+		HashSet< const void* >	waiting;	// tasks with 'Wait' event
+		HashSet< const void* >	enqueued;	// tasks with 'Enqueue' event
+		bool					first		= true;
+
+		const auto	Separator = [&str, &first] ()
+		{
+			if ( not first ) str << ',';
+			first = false;
+		};
+
+		for (auto& [ev, tid] : events)
+		{
+			BEGIN_ENUM_CHECKS();
+			switch ( ev.type )
+			{
+				case EEvent::Wait :
+					Separator();
+					AppendEvent( INOUT str, "b", ev.name, tid, ev.time, "wait", ev.task );
+					str << '}';
+					waiting.insert( ev.task );
+					break;
+
+				case EEvent::Enqueue :
+					if ( waiting.erase( ev.task ))
+					{
+						Separator();
+						AppendEvent( INOUT str, "e", ev.name, tid, ev.time, "wait", ev.task );
+						str << '}';
+					}
+					Separator();
+					AppendEvent( INOUT str, "s", "enqueue", tid, ev.time, "flow", ev.task );
+					str << '}';
+					enqueued.insert( ev.task );
+					break;
+
+				case EEvent::Start :
+					Separator();
+					AppendEvent( INOUT str, "B", ev.name, tid, ev.time );
+					str << '}';
+
+					if ( enqueued.erase( ev.task ))
+					{
+						Separator();
+						AppendEvent( INOUT str, "f", "enqueue", tid, ev.time, "flow", ev.task );
+						str << ",\"bp\":\"e\"}";
+					}
+					break;
+
+				case EEvent::Finish :
+					Separator();
+					AppendEvent( INOUT str, "E", ev.name, tid, ev.time );
+					str << '}';
+					break;
+
+				case EEvent::Cancel :
+					Separator();
+					AppendEvent( INOUT str, "i", "cancel "s << ev.name, tid, ev.time );
+					str << ",\"s\":\"t\"}";
+					waiting.erase( ev.task );
+					enqueued.erase( ev.task );
+					break;
+			}
+			END_ENUM_CHECKS();
+		}
+
+		// remove trailing comma after metadata if there are no events
+		if ( first and str.back() == ',' )
+			str.pop_back();
+
+		str << "\n]}\n";
+
+		FileWStream		file{ filename };
+		CHECK_ERR( file.IsOpen() );
+		CHECK_ERR( file.Write( StringView{str} ));
+		return true;
+	}
+
+
+}	// AE::Threading
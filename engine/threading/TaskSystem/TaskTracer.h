@@ -0,0 +1,86 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+/*
+	Task tracer.
+
+	Records task events to the per-thread ring buffers and saves them in Chrome trace JSON format,
+	the file can be opened in 'chrome://tracing' or 'ui.perfetto.dev'.
+
+	Events:
+		Wait	- task is waiting for input dependencies, ends when task is added to the ready queue.
+		Enqueue	- task is added to the ready queue, linked to the 'Start' event by arrow.
+		Start	- 'Run()' is called.
+		Finish	- 'Run()' has returned.
+		Cancel	- task has been canceled.
+
+	Recording is disabled by default, when disabled the overhead is a single relaxed atomic load per event.
+	If ring buffer is overflowed then old events will be overwritten.
+	'Flush()' may be called while threads are running, each slot in ring buffer is protected by sequence number (seqlock),
+	so events that are written or overwritten during flush are skipped.
+*/
+
+#pragma once
+
+#include "threading/Common.h"
+#include "stl/Types/FileSystem.h"
+
+#if 1
+#	define AE_TASK_TRACE( ... )		__VA_ARGS__
+#else
+#	define AE_TASK_TRACE( ... )
+#endif
+
+namespace AE::Threading
+{
+
+	//
+	// Task Tracer
+	//
+
+	class TaskTracer final
+	{
+	// types
+	public:
+		enum class EEvent : uint8_t
+		{
+			Wait,
+			Enqueue,
+			Start,
+			Finish,
+			Cancel,
+		};
+
+		static constexpr uint	MaxNameLength	= 46;
+		static constexpr uint	BufferSize		= 1u << 14;		// events per thread
+
+
+	// variables
+	private:
+		static Atomic<bool>		_enabled;
+
+
+	// methods
+	public:
+		TaskTracer () = delete;
+
+		// start or stop recording
+			static void  Enable (bool value);
+		ND_ static bool  IsEnabled ()		{ return _enabled.load( EMemoryOrder::Relaxed ); }
+
+		// save all events that were recorded after the previous flush
+			static bool  Flush (const Path &filename);
+
+		// remove all recorded events
+			static void  Clear ();
+
+		forceinline static void  Record (EEvent type, const class IAsyncTask &task)
+		{
+			if_unlikely( IsEnabled() )
+				_Record( type, task );
+		}
+
+	private:
+		static void  _Record (EEvent type, const IAsyncTask &task);
+	};
+
+
+}	// AE::Threading
@@ -12,11 +12,15 @@ namespace AE::Threading
 =================================================
 */
 	WorkerThread::WorkerThread () :
-		WorkerThread{ ThreadMask{}.set(uint(EThread::Worker)), Milliseconds{4} }
+		WorkerThread{ ThreadMask{}.set(uint(EThread::Worker)), EIdleMode::Park, Milliseconds{100} }
 	{}
 
 	WorkerThread::WorkerThread (ThreadMask mask, Milliseconds sleepOnIdle, StringView name) :
-		_threadMask{ mask }, _sleepOnIdle{ sleepOnIdle }, _name{ name }
+		WorkerThread{ mask, EIdleMode::Sleep, sleepOnIdle, name }
+	{}
+
+	WorkerThread::WorkerThread (ThreadMask mask, EIdleMode mode, Milliseconds timeout, StringView name) :
+		_threadMask{ mask }, _sleepOnIdle{ timeout }, _idleMode{ mode }, _name{ name }
 	{}
 
 /*
@@ -26,16 +30,28 @@ namespace AE::Threading
 */
 	bool  WorkerThread::Attach (uint uid)
 	{
-		_thread = std::thread{[this, uid] ()
+		// set before thread starts, otherwise 'Detach' may be called before and thread will not be joined
+		_looping.store( 1, EMemoryOrder::Relaxed );
+
+		uint		cpu_core	= 0;
+		uint		numa_node	= 0;
+		const bool	pinned		= Scheduler().GetThreadPlacement( uid, OUT cpu_core, OUT numa_node );
+
+		_thread = std::thread{[this, uid, numa_node] ()
 		{
 			uint	seed			= uid;
 			uint	idle_counter	= 0;
 
 			PlatformUtils::SetThreadName( _name );
 			AE_VTUNE( __itt_thread_set_name( _name.c_str() ));
-			//CHECK( PlatformUtils::SetThreadAffinity( _thread.native_handle(), uid ));
-			
-			_looping.store( 1, EMemoryOrder::Relaxed );
+
+			Scheduler().SetCurrentThreadNode( numa_node );
+			Scheduler().SetCurrentThreadMask( _threadMask );
+
+			if ( _threadMask[ uint(EThread::Worker) ])
+				Scheduler().AttachLocalQueue();
+
+
 			for (; _looping.load( EMemoryOrder::Relaxed );)
 			{
 				bool	processed = false;
@@ -48,16 +64,34 @@ namespace AE::Threading
 					processed |= Scheduler().ProcessTask( EThread(t), ++seed );
 				}
 
-				if ( not processed and _sleepOnIdle.count() )
+				if ( processed )
+				{
+					idle_counter = 0;
+					continue;
+				}
+
+				if ( _idleMode == EIdleMode::Park )
+				{
+					// try again if there are ready tasks but they can't be started yet (interlock dependency)
+					if ( not Scheduler().ParkThread( _wakeup, _threadMask, _sleepOnIdle ))
+						std::this_thread::yield();
+				}
+				else
+				if ( _sleepOnIdle.count() )
 				{
 					idle_counter = Min( 4u, idle_counter );
 					std::this_thread::sleep_for( _sleepOnIdle * idle_counter );
 					++idle_counter;
 				}
-				else
-					idle_counter = 0;
 			}
+
+			Scheduler().DetachLocalQueue();
 		}};
+
+		// '_thread' is not initialized inside thread function, so affinity is set here
+		if ( pinned )
+			CHECK( PlatformUtils::SetThreadAffinity( _thread.native_handle(), cpu_core ));
+
 		return true;
 	}
 	
@@ -70,6 +104,7 @@ namespace AE::Threading
 	{
 		if ( _looping.exchange( 0, EMemoryOrder::Relaxed ))
 		{
+			_wakeup.Signal();
 			_thread.join();
 		}
 	}
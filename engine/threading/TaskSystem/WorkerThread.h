@@ -16,9 +16,14 @@ namespace AE::Threading
 	{
 	// types
 	public:
-		using ThreadMask	= BitSet< uint(EThread::_Count) >;
 		using Milliseconds	= std::chrono::duration<uint, std::milli>;
 
+		enum class EIdleMode : uint
+		{
+			Sleep,		// spin then sleep with increasing interval, thread may wake up with delay
+			Park,		// block thread until new task is added, timeout is used as maximal time of parking
+		};
+
 
 	// variables
 	private:
@@ -26,13 +31,16 @@ namespace AE::Threading
 		Atomic<uint>			_looping;
 		const ThreadMask		_threadMask;
 		const Milliseconds		_sleepOnIdle;
+		const EIdleMode			_idleMode;
 		const FixedString<64>	_name;
+		WakeupEvent				_wakeup;
 
 
 	// methods
 	public:
 		WorkerThread ();
 		WorkerThread (ThreadMask mask, Milliseconds sleepOnIdle, StringView name = "thread");
+		WorkerThread (ThreadMask mask, EIdleMode mode, Milliseconds timeout, StringView name = "thread");
 
 		bool  Attach (uint uid) override;
 		void  Detach () override;
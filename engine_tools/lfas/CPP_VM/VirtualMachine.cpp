@@ -338,6 +338,7 @@ namespace LFAS::CPP
 
 		auto	iter = _storageMap.find( ptr );
 		CHECK_ERR( iter != _storageMap.end(), void());
+		CHECK( not iter->second.isDestroyed );	// use after free
 		
 		ASSERT( offset + size <= iter->second.size );
 		
@@ -355,6 +356,7 @@ namespace LFAS::CPP
 
 		auto	iter = _storageMap.find( ptr );
 		CHECK_ERR( iter != _storageMap.end(), void());
+		CHECK( not iter->second.isDestroyed );	// use after free
 		
 		ASSERT( offset + size <= iter->second.size );
 		
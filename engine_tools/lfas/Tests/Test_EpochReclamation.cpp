@@ -0,0 +1,244 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "CPP_VM/VirtualMachine.h"
+#include "CPP_VM/Atomic.h"
+#include "CPP_VM/Storage.h"
+
+#include "stl/Math/BitMath.h"
+
+#include "UnitTest_Common.h"
+
+using namespace LFAS;
+using namespace LFAS::CPP;
+
+#include "threading/Primitives/SpinLock.h"
+#include "threading/Memory/EpochReclamation.h"
+
+namespace
+{
+	using AE::Threading::EpochReclamation;
+
+	struct Node
+	{
+		Storage<uint>	value;
+	};
+
+	struct Graveyard
+	{
+		std::mutex		guard;
+		Array<Node*>	nodes;
+	};
+
+
+	// destroys node but keeps memory, so address is never reused and VM can detect access to the destroyed node
+	static void  DestroyNode (void* ptr, void* userData)
+	{
+		auto&	vm			= VirtualMachine::Instance();
+		auto*	node		= static_cast<Node *>( ptr );
+		auto*	graveyard	= static_cast<Graveyard *>( userData );
+
+		// cache must be invalidated before calling destructor
+		vm.ThreadFenceAcquire();
+		node->~Node();
+
+		EXLOCK( graveyard->guard );
+		graveyard->nodes.push_back( node );
+	}
+
+	ND_ static Node*  CreateNode (uint value)
+	{
+		Node*	node = PlacementNew<Node>( std::malloc( sizeof(Node) ));
+		node->value.Write( value );
+		return node;
+	}
+
+
+	void EpochReclamation_Test1 ()
+	{
+		VirtualMachine::CreateInstance();
+		{
+			struct PerThread
+			{
+				uint		slot	= UMax;
+				uint		counter	= 0;
+			};
+
+			struct
+			{
+				EpochReclamation							ebr;
+				Atomic< Node *>								head	{null};
+				Graveyard									graveyard;
+
+				std::mutex									guard;
+				HashMap< std::thread::id, PerThread >		perThread;
+
+			}	global;
+
+			auto&	vm = VirtualMachine::Instance();
+
+			global.head.store( CreateNode( 0 ), EMemoryOrder::Relaxed );
+			vm.ThreadFenceRelease();
+
+			auto	sc1 = vm.CreateScript( [g = &global, &vm] ()
+			{
+				PerThread*	pt = null;
+				{
+					EXLOCK( g->guard );
+					pt = &g->perThread[ std::this_thread::get_id() ];
+				}
+
+				if ( pt->slot == UMax )
+					TEST( g->ebr.RegisterThread( OUT pt->slot ));
+
+				for (uint i = 0; i < 8; ++i)
+				{
+					EpochReclamation::Guard	guard{ g->ebr, pt->slot };
+
+					Node*	node = g->head.load( EMemoryOrder::Acquire );
+
+					// node may be replaced and retired by another thread, but must not be destroyed
+					vm.ThreadFenceAcquire();
+					Unused( node->value.Read() );
+
+					if ( (++pt->counter & 3) == 0 )
+					{
+						Node*	new_node = CreateNode( pt->counter );
+						vm.ThreadFenceRelease();
+
+						Node*	old_node = g->head.exchange( new_node, EMemoryOrder::Release );
+						g->ebr.Retire( pt->slot, old_node, &DestroyNode, &g->graveyard );
+					}
+
+					// release memory as soon as possible
+					Unused( g->ebr.TryAdvance() );
+					g->ebr.Collect( pt->slot );
+				}
+				vm.CheckForUncommitedChanges();
+			});
+
+			vm.RunParallel({ sc1 }, SecondsF{30.0f} );
+
+			vm.ThreadFenceAcquire();
+
+			for (auto& pt : global.perThread)
+			{
+				if ( pt.second.slot != UMax )
+					global.ebr.UnregisterThread( pt.second.slot );
+			}
+			global.perThread.clear();
+			global.ebr.Release();
+
+			DestroyNode( global.head.exchange( null, EMemoryOrder::Relaxed ), &global.graveyard );
+
+			TEST( global.graveyard.nodes.size() > 1 );
+
+			for (auto* node : global.graveyard.nodes) {
+				std::free( node );
+			}
+		}
+		VirtualMachine::DestroyInstance();
+	}
+
+
+	// reader enters critical section in the current epoch 'e' and reads node which is retired in the same epoch,
+	// global epoch can be advanced to 'e + 1' while reader is in critical section,
+	// so node must not be released until 'e + 2'
+	void EpochReclamation_Test2 ()
+	{
+		VirtualMachine::CreateInstance();
+		{
+			EpochReclamation	ebr;
+			Atomic< Node *>		head	{null};
+			Graveyard			graveyard;
+			std::atomic<uint>	step	{0};
+
+			auto&	vm = VirtualMachine::Instance();
+
+			head.store( CreateNode( 1 ), EMemoryOrder::Relaxed );
+			vm.ThreadFenceRelease();
+
+			const auto	IsDestroyed = [&graveyard] (Node* node)
+			{
+				EXLOCK( graveyard.guard );
+				return std::find( graveyard.nodes.begin(), graveyard.nodes.end(), node ) != graveyard.nodes.end();
+			};
+
+			std::thread	reader{ [&] ()
+			{
+				uint	slot;
+				TEST( ebr.RegisterThread( OUT slot ));
+				{
+					EpochReclamation::Guard	guard{ ebr, slot };
+
+					Node*	node = head.load( EMemoryOrder::Acquire );
+					vm.ThreadFenceAcquire();
+					TEST( node->value.Read() == 1 );
+
+					step.store( 1 );
+					for (; step.load() != 2;) { std::this_thread::yield(); }
+
+					// node is retired but still referenced
+					TEST( not IsDestroyed( node ));
+					TEST( node->value.Read() == 1 );
+				}
+				ebr.UnregisterThread( slot );
+				step.store( 3 );
+			}};
+
+			std::thread	writer{ [&] ()
+			{
+				for (; step.load() != 1;) { std::this_thread::yield(); }
+
+				uint	slot;
+				TEST( ebr.RegisterThread( OUT slot ));
+
+				Node*	new_node = CreateNode( 2 );
+				vm.ThreadFenceRelease();
+
+				Node*	old_node = head.exchange( new_node, EMemoryOrder::Release );
+				ebr.Retire( slot, old_node, &DestroyNode, &graveyard );
+
+				// first advance is allowed, reader has announced the current epoch
+				const uint	epoch = ebr.CurrentEpoch();
+				TEST( ebr.TryAdvance() );
+				TEST( not ebr.TryAdvance() );
+				TEST( ebr.CurrentEpoch() == epoch + 1 );
+
+				ebr.Collect( slot );
+				TEST( not IsDestroyed( old_node ));
+
+				step.store( 2 );
+				for (; step.load() != 3;) { std::this_thread::yield(); }
+
+				// reader has left critical section
+				TEST( ebr.TryAdvance() );
+				ebr.Collect( slot );
+				TEST( IsDestroyed( old_node ));
+
+				ebr.UnregisterThread( slot );
+			}};
+
+			reader.join();
+			writer.join();
+
+			vm.ThreadFenceAcquire();
+			ebr.Release();
+
+			DestroyNode( head.exchange( null, EMemoryOrder::Relaxed ), &graveyard );
+
+			for (auto* node : graveyard.nodes) {
+				std::free( node );
+			}
+		}
+		VirtualMachine::DestroyInstance();
+	}
+}
+
+
+extern void Test_EpochReclamation ()
+{
+	EpochReclamation_Test1();
+	EpochReclamation_Test2();
+
+	AE_LOGI( "Test_EpochReclamation - passed" );
+}
@@ -0,0 +1,135 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "CPP_VM/VirtualMachine.h"
+#include "CPP_VM/Atomic.h"
+#include "CPP_VM/Storage.h"
+
+#include "stl/Math/BitMath.h"
+#include "stl/Math/Math.h"
+#include "stl/Memory/UntypedAllocator.h"
+#include "stl/CompileTime/Math.h"
+
+#include "UnitTest_Common.h"
+
+using namespace LFAS;
+using namespace LFAS::CPP;
+
+#include "threading/Primitives/SpinLock.h"
+#include "threading/Memory/EpochReclamation.h"
+#include "threading/Containers/LfIndexedPool2.h"
+#include "threading/Containers/LfCachedIndexedPool.h"
+
+namespace
+{
+	struct Key
+	{
+		Storage<uint>	value;
+
+		Key () {}
+		explicit Key (uint v) { value.Write( v ); }
+
+		ND_ bool  operator == (const Key &rhs) const	{ return value.Read() == rhs.value.Read(); }
+	};
+}
+
+namespace std
+{
+	template <>
+	struct hash< Key > {
+		ND_ size_t  operator () (const Key &key) const	{ return size_t(key.value.Read()) * 0x9E3779B97F4A7C15ull; }
+	};
+}
+
+namespace
+{
+	using AE::Threading::LfCachedIndexedPool;
+
+
+	void LfCachedIndexedPool_Test1 ()
+	{
+		VirtualMachine::CreateInstance();
+		{
+			struct PerThread
+			{
+				uint		seed	= 0;
+				uint		slot	= UMax;
+			};
+
+			struct
+			{
+				LfCachedIndexedPool< Key, uint, 256, 16 >	pool;
+
+				std::mutex									guard;
+				HashMap< std::thread::id, PerThread >		perThread;
+
+			}	global;
+
+			auto&	vm = VirtualMachine::Instance();
+			vm.ThreadFenceAcquireRelease();
+
+			auto	sc1 = vm.CreateScript( [g = &global, &vm] ()
+			{
+				PerThread*	pt = null;
+				{
+					EXLOCK( g->guard );
+					pt = &g->perThread[ std::this_thread::get_id() ];
+				}
+
+				if ( pt->slot == UMax )
+					TEST( g->pool.RegisterThread( OUT pt->slot ));
+
+				for (uint i = 0; i < 16; ++i)
+				{
+					const uint	value	= (pt->seed++ * 7 + i) % 256;
+					uint		index;
+					TEST( g->pool.Assign( OUT index ));
+
+					// index may be unassigned by another thread, cache must be invalidated before writing
+					vm.ThreadFenceAcquire();
+
+					// value must be visible for other threads after adding to the cache
+					g->pool[index].value.Write( value );
+
+					auto	[cached, inserted] = g->pool.AddToCache( index, pt->slot );
+					TEST( cached != UMax );
+
+					// read value that was written by another thread
+					TEST( g->pool[cached].value.Read() == value );
+
+					// cache must be flushed before index can be used by another thread,
+					// index was not added to the cache, so it can be returned to the pool immediately
+					if ( not inserted )
+					{
+						vm.ThreadFenceRelease();
+						g->pool.Unassign( index );
+					}
+
+					const Key	key{ value };
+					vm.ThreadFenceRelease();	// local variable is visible for VM in all threads
+
+					TEST( g->pool.Find( &key, pt->slot ) == cached );
+				}
+				vm.CheckForUncommitedChanges();
+			});
+
+			vm.RunParallel({ sc1 }, SecondsF{30.0f} );
+
+			vm.ThreadFenceAcquire();
+			for (auto& pt : global.perThread) {
+				if ( pt.second.slot != UMax )
+					global.pool.UnregisterThread( pt.second.slot );
+			}
+			global.perThread.clear();
+			global.pool.Release();
+		}
+		VirtualMachine::DestroyInstance();
+	}
+}
+
+
+extern void Test_LfCachedIndexedPool ()
+{
+	LfCachedIndexedPool_Test1();
+
+	AE_LOGI( "Test_LfCachedIndexedPool - passed" );
+}
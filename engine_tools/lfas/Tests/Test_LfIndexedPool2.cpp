@@ -7,6 +7,7 @@
 #include "stl/Math/BitMath.h"
 #include "stl/Math/Math.h"
 #include "stl/Memory/UntypedAllocator.h"
+#include "stl/Containers/FixedArray.h"
 
 #include "UnitTest_Common.h"
 
@@ -31,6 +32,7 @@ namespace
 	};
 
 
+	template <bool UseBatch>
 	void LfIndexedPool2_Test1 ()
 	{
 		using T = DebugInstanceCounter< int, 1 >;
@@ -41,9 +43,8 @@ namespace
 		{
 			struct PerThread
 			{
-				EAction		act				= EAction::Assign;
-				uint		indices [64];
-				size_t		indexCount		= 0;
+				EAction				act		= EAction::Assign;
+				FixedArray<uint, 64>	indices;
 			};
 
 			struct
@@ -71,10 +72,22 @@ namespace
 				{
 					case EAction::Assign :
 					{
-						for (; pt->indexCount < CountOf(pt->indices); ++pt->indexCount)
+						if constexpr( UseBatch )
 						{
-							if ( not g->pool.Assign( OUT pt->indices[pt->indexCount] ))
-								break;
+							while ( pt->indices.size() < pt->indices.capacity() )
+							{
+								if ( g->pool.Assign( 8, INOUT pt->indices ) == 0 )
+									break;
+							}
+						}
+						else
+						{
+							for (uint index; pt->indices.size() < pt->indices.capacity();)
+							{
+								if ( not g->pool.Assign( OUT index ))
+									break;
+								pt->indices.push_back( index );
+							}
 						}
 						pt->act = EAction::Write;
 						
@@ -88,11 +101,19 @@ namespace
 					{
 						// cache invalidation is not needed here
 
-						for (size_t i = 0; i < pt->indexCount; ++i)
+						if constexpr( UseBatch )
 						{
-							g->pool.Unassign( pt->indices[i] );
+							while ( not pt->indices.empty() ) {
+								g->pool.Unassign( 8, INOUT pt->indices );
+							}
+						}
+						else
+						{
+							for (uint index : pt->indices) {
+								g->pool.Unassign( index );
+							}
+							pt->indices.clear();
 						}
-						pt->indexCount = 0;
 						pt->act = EAction::Assign;
 						
 						vm.CheckForUncommitedChanges();
@@ -105,7 +126,7 @@ namespace
 						// it can happen when you send index to another thread.
 						vm.ThreadFenceAcquire();
 
-						for (size_t i = 0; i < pt->indexCount; ++i)
+						for (size_t i = 0; i < pt->indices.size(); ++i)
 						{
 							auto&	st  = g->pool[ pt->indices[i] ];
 							auto	val = st.Read();
@@ -119,7 +140,7 @@ namespace
 
 					case EAction::Write :
 					{
-						for (size_t i = 0; i < pt->indexCount; ++i)
+						for (size_t i = 0; i < pt->indices.size(); ++i)
 						{
 							auto&	st  = g->pool[ pt->indices[i] ];
 
@@ -144,9 +165,8 @@ namespace
 			vm.ThreadFenceAcquire();
 			for (auto& pt : global.perThread)
 			{
-				for (size_t i = 0; i < pt.second.indexCount; ++i)
-				{
-					global.pool.Unassign( pt.second.indices[i] );
+				for (uint index : pt.second.indices) {
+					global.pool.Unassign( index );
 				}
 			}
 			global.perThread.clear();
@@ -161,7 +181,8 @@ namespace
 
 extern void Test_LfIndexedPool2 ()
 {
-	LfIndexedPool2_Test1();
+	LfIndexedPool2_Test1< false >();
+	LfIndexedPool2_Test1< true >();
 
 	AE_LOGI( "Test_LfIndexedPool2 - passed" );
 }
@@ -345,8 +345,11 @@ namespace LFAS
 				r.globalVersion = iter->second;
 				r.unavailable.erase( iter );
 			}
-			
-			CHECK( r.globalVersion != InitialVer );
+
+			// memory that is not released by another thread is not visible,
+			// reading from it will be detected as reading from uninitialized memory,
+			// but memory which is not in global memory must be written by some thread
+			CHECK( r.globalVersion != InitialVer or not r.unavailable.empty() );
 
 			r.visible[tid] = r.globalVersion;
 		}
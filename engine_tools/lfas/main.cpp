@@ -5,6 +5,8 @@ extern void Test_SpinLock ();
 extern void Test_LfIndexedPool ();
 extern void Test_LfIndexedPool2 ();
 extern void Test_LfStaticPool ();
+extern void Test_LfCachedIndexedPool ();
+extern void Test_EpochReclamation ();
 
 
 int main ()
@@ -14,4 +16,6 @@ int main ()
 	Test_LfIndexedPool();
 	Test_LfIndexedPool2();
 	Test_LfStaticPool();
+	Test_LfCachedIndexedPool();
+	Test_EpochReclamation();
 }
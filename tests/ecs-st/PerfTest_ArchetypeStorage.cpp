@@ -0,0 +1,214 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "ecs-st/Core/Registry.h"
+#include "UnitTest_Common.h"
+
+namespace
+{
+	using Index_t		= ArchetypeStorage::Index_t;
+	using TimePoint_t	= std::chrono::high_resolution_clock::time_point;
+	using Duration_t	= std::chrono::high_resolution_clock::duration;
+
+	struct Comp1
+	{
+		float	value [4];
+	};
+
+	struct Comp2
+	{
+		int		value;
+	};
+
+	static constexpr uint	EntityCount	= 1u << 18;
+
+
+	//
+	// Contiguous Storage
+	//
+
+	// previous layout: single SoA memory block that is reallocated when capacity changes
+	class ContiguousStorage final
+	{
+	private:
+		void*		_memory		= null;
+		size_t		_count		= 0;
+		size_t		_capacity	= 0;
+
+		EntityID*	_entities	= null;
+		Comp1*		_comp1		= null;
+		Comp2*		_comp2		= null;
+
+		static constexpr size_t	_align = AE_CACHE_LINE;
+
+	public:
+		ContiguousStorage () {}
+		~ContiguousStorage () { UntypedAlignedAllocator{}.Deallocate( _memory, BytesU{_align} ); }
+
+		void  Add (EntityID id)
+		{
+			// same as 'Registry::_IncreaseStorageSize' before chunks were used
+			if ( _count == _capacity )
+				Reserve( Max( size_t(16), _capacity * 2 ));
+
+			_entities[_count]	= id;
+			_comp1[_count]		= {};
+			_comp2[_count]		= {};
+			++_count;
+		}
+
+		void  Erase (size_t index)
+		{
+			const size_t	last = --_count;
+			_entities[index]	= _entities[last];
+			_comp1[index]		= _comp1[last];
+			_comp2[index]		= _comp2[last];
+		}
+
+		void  Reserve (size_t size)
+		{
+			const BytesU	ent_size	= AlignToLarger( SizeOf<EntityID> * size, BytesU{_align} );
+			const BytesU	comp1_size	= AlignToLarger( SizeOf<Comp1> * size, BytesU{_align} );
+			const BytesU	comp2_size	= AlignToLarger( SizeOf<Comp2> * size, BytesU{_align} );
+
+			UntypedAlignedAllocator	alloc;
+			void*		mem			= alloc.Allocate( ent_size + comp1_size + comp2_size, BytesU{_align} );
+			EntityID*	entities	= Cast<EntityID>( mem );
+			Comp1*		comp1		= Cast<Comp1>( mem + ent_size );
+			Comp2*		comp2		= Cast<Comp2>( mem + ent_size + comp1_size );
+
+			if ( _memory )
+			{
+				std::memcpy( OUT entities, _entities, sizeof(EntityID) * _count );
+				std::memcpy( OUT comp1, _comp1, sizeof(Comp1) * _count );
+				std::memcpy( OUT comp2, _comp2, sizeof(Comp2) * _count );
+				alloc.Deallocate( _memory, BytesU{_align} );
+			}
+
+			_memory		= mem;
+			_capacity	= size;
+			_entities	= entities;
+			_comp1		= comp1;
+			_comp2		= comp2;
+		}
+
+		template <typename Fn>
+		void  ForEach (Fn &&fn)
+		{
+			fn( _count, _comp1, _comp2 );
+		}
+
+		ND_ size_t  Count () const	{ return _count; }
+	};
+
+
+	//
+	// Chunked Storage
+	//
+
+	class ChunkedStorage final
+	{
+	private:
+		ArchetypeStorage	_storage;
+
+	public:
+		ChunkedStorage (const Registry &reg, const Archetype &arch) : _storage{ reg, arch, 0 } {}
+		~ChunkedStorage () { _storage.Clear(); }
+
+		void  Add (EntityID id)
+		{
+			// same as 'Registry::_IncreaseStorageSize'
+			if ( _storage.Count() == _storage.Capacity() )
+				_storage.Reserve( _storage.Count() + 1 );
+
+			Index_t	index;
+			Unused( _storage.Add( id, OUT index ));
+		}
+
+		void  Erase (size_t index)
+		{
+			EntityID	moved;
+			Unused( _storage.Erase( Index_t(index), OUT moved ));
+		}
+
+		template <typename Fn>
+		void  ForEach (Fn &&fn)
+		{
+			for (size_t c = 0, cnt = _storage.ChunkCount(); c < cnt; ++c)
+			{
+				fn( _storage.ChunkEntityCount( c ), _storage.GetComponents<Comp1>( c ), _storage.GetComponents<Comp2>( c ));
+			}
+		}
+
+		ND_ size_t  Count () const	{ return _storage.Count(); }
+	};
+
+
+	template <typename Storage>
+	static void  Measure (StringView name, Storage &storage)
+	{
+		Duration_t	max_add {0};
+
+		// add
+		const auto	add_start = TimePoint_t::clock::now();
+		for (uint i = 0; i < EntityCount; ++i)
+		{
+			const auto	t = TimePoint_t::clock::now();
+			storage.Add( EntityID{ i & 0xFFFF, i >> 16 });
+			max_add = Max( max_add, TimePoint_t::clock::now() - t );
+		}
+		const auto	add_time = TimePoint_t::clock::now() - add_start;
+
+		// iterate
+		float		sum			= 0.0f;
+		const auto	iter_start	= TimePoint_t::clock::now();
+		for (uint j = 0; j < 10; ++j)
+		{
+			storage.ForEach( [&sum] (size_t count, Comp1* comp1, Comp2* comp2)
+				{
+					for (size_t i = 0; i < count; ++i)
+					{
+						comp1[i].value[0] += 1.0f;
+						comp2[i].value    += 1;
+						sum += comp1[i].value[0];
+					}
+				});
+		}
+		const auto	iter_time = (TimePoint_t::clock::now() - iter_start) / 10;
+
+		// remove
+		const auto	remove_start = TimePoint_t::clock::now();
+		for (uint i = 0; i < EntityCount; ++i)
+		{
+			// remove from the middle to force move of the last element
+			storage.Erase( (storage.Count() - 1) / 2 );
+		}
+		const auto	remove_time = TimePoint_t::clock::now() - remove_start;
+
+		TEST( storage.Count() == 0 );
+		TEST( sum > 0.0f );
+
+		AE_LOGI( String(name) << " add: " << ToString( add_time ) << " (max " << ToString( max_add )
+				<< "), iterate: " << ToString( iter_time ) << ", remove: " << ToString( remove_time ));
+	}
+}
+
+
+extern void PerfTest_ArchetypeStorage ()
+{
+	Registry	reg;
+	reg.RegisterComponents< Comp1, Comp2 >();
+
+	ArchetypeDesc	desc;
+	desc.Add<Comp1>();
+	desc.Add<Comp2>();
+
+	{
+		ContiguousStorage	storage;
+		Measure( "contiguous", storage );
+	}{
+		ChunkedStorage		storage{ reg, Archetype{desc} };
+		Measure( "chunked", storage );
+	}
+
+	AE_LOGI( "PerfTest_ArchetypeStorage - passed" );
+}
@@ -88,6 +88,98 @@ namespace
 	}
 
 
+	static void  ArchetypeStorage_Test2 ()
+	{
+		ArchetypeDesc		desc;
+		desc.Add<Comp1>();
+		desc.Add<Comp2>();
+		desc.Add<Tag1>();
+
+		Registry			reg;
+		reg.RegisterComponents< Comp1, Comp2, Tag1, Tag2 >();
+
+		Archetype			arch{ desc };
+		ArchetypeStorage	storage{ reg, arch, 1 };
+		const size_t		count = storage.ChunkCapacity() * 2 + 10;
+
+		TEST( storage.ChunkCapacity() > 1 );
+		TEST( storage.ChunkSize() <= BytesU{ECS_Config::ArchetypeChunkSize} );
+		TEST( storage.Capacity() == storage.ChunkCapacity() );
+
+		Comp1*	first = null;
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			// new chunks are allocated, existing components must not be moved
+			if ( storage.Count() == storage.Capacity() )
+				storage.Reserve( storage.Count() + 1 );
+
+			Index_t	index;
+			TEST( storage.Add( EntityID{ uint(i), 0 }, OUT index ));
+			TEST( size_t(index) == i );
+
+			storage.GetComponent<Comp1>( index )->value = int(i);
+			storage.GetComponent<Comp2>( index )->value = float(i);
+
+			if ( i == 0 )
+				first = storage.GetComponent<Comp1>( index );
+		}
+
+		TEST( storage.ChunkCount() == 3 );
+		TEST( storage.ChunkEntityCount( 2 ) == 10 );
+		TEST( storage.GetComponent<Comp1>( Index_t(0) ) == first );
+
+		for (size_t c = 0, idx = 0; c < storage.ChunkCount(); ++c)
+		{
+			auto*	ent		= storage.GetEntities( c );
+			auto*	comp1	= storage.GetComponents<Comp1>( c );
+			auto*	comp2	= storage.GetComponents<Comp2>( c );
+
+			TEST( storage.GetComponents( c, ComponentTypeInfo<Tag1>::id ) == null );
+
+			for (size_t i = 0; i < storage.ChunkEntityCount( c ); ++i, ++idx)
+			{
+				TEST( ent[i] == EntityID{ uint(idx), 0 });
+				TEST( comp1[i].value == int(idx) );
+				TEST( comp2[i].value == float(idx) );
+			}
+		}
+
+		// last entity is moved from the last chunk to the first chunk
+		EntityID	moved;
+		TEST( storage.Erase( Index_t(1), OUT moved ));
+		TEST( moved == EntityID{ uint(count-1), 0 });
+		TEST( storage.IsValid( moved, Index_t(1) ));
+		TEST( storage.GetComponent<Comp1>( Index_t(1) )->value == int(count-1) );
+
+		// copy between chunks of different storages
+		ArchetypeDesc		desc2;
+		desc2.Add<Comp1>();
+
+		ArchetypeStorage	storage2{ reg, Archetype{desc2}, storage.Count() };
+		Index_t				start;
+		Array<EntityID>		ids;
+
+		for (size_t i = 0; i < storage.Count(); ++i) {
+			ids.push_back( storage.GetEntity( Index_t(i) ));
+		}
+		TEST( storage2.AddEntities( ids, OUT start ));
+		storage2.CopyComponents( start, storage, Index_t(0), storage.Count() );
+
+		for (size_t i = 0; i < storage.Count(); ++i)
+		{
+			TEST( storage2.GetEntity( Index_t(i) ) == storage.GetEntity( Index_t(i) ));
+			TEST( storage2.GetComponent<Comp1>( Index_t(i) )->value == storage.GetComponent<Comp1>( Index_t(i) )->value );
+		}
+
+		storage.Clear();
+		storage2.Clear();
+
+		storage.Reserve( 0 );
+		TEST( storage.Capacity() == 0 );
+	}
+
+
 	static void  ArchetypeDesc_Test1 ()
 	{
 		ArchetypeDesc	a1;
@@ -257,6 +349,7 @@ extern void UnitTest_Archetype ()
 {
 	RegisterComponents_Test1();
 	ArchetypeStorage_Test1();
+	ArchetypeStorage_Test2();
 	ArchetypeDesc_Test1();
 	ArchetypeQuery_Test1();
 
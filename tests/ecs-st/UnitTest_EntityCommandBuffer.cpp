@@ -0,0 +1,222 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "ecs-st/Core/EntityCommandBuffer.h"
+#include "threading/TaskSystem/WorkerThread.h"
+#include "UnitTest_Common.h"
+
+namespace
+{
+	using namespace AE::Threading;
+
+	struct Comp1
+	{
+		int		value;
+	};
+
+	struct Comp2
+	{
+		float	value;
+	};
+
+	struct Tag1 {};
+	struct Tag2 {};
+
+
+	static void  CommandBuffer_Test1 ()
+	{
+		Registry			reg;
+		EntityCommandBuffer	cmdbuf;
+		const size_t		count = 100;
+		Array<EntityID>		entities;
+
+		reg.RegisterComponents< Comp1, Comp2, Tag1, Tag2 >();
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			EntityID	e = reg.CreateEntity( Comp1{int(i)} );
+			TEST( e );
+			entities.push_back( e );
+		}
+
+		size_t	added_cnt	= 0;
+		size_t	removed_cnt	= 0;
+
+		reg.AddMessageListener< Tag1, MsgTag_AddedComponent >(
+			[&added_cnt] (ArrayView<EntityID> ids) { added_cnt += ids.size(); });
+
+		reg.AddMessageListener< Comp1, MsgTag_RemovedComponent >(
+			[&removed_cnt] (ArrayView<EntityID> ids, ArrayView<Comp1> comps)
+			{
+				TEST( ids.size() == comps.size() );
+				removed_cnt += ids.size();
+			});
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const EntityID	e = entities[i];
+
+			switch ( i % 4 )
+			{
+				// move to new archetype
+				case 0 :
+					cmdbuf.AddComponent<Tag1>( e );
+					cmdbuf.AddComponent( e, Comp2{ float(i) });
+					break;
+
+				// added and removed in the same buffer, archetype is not changed
+				case 1 :
+					cmdbuf.AddComponent<Tag2>( e );
+					cmdbuf.RemoveComponent<Tag2>( e );
+					cmdbuf.AddComponent( e, Comp1{ -int(i) });
+					break;
+
+				case 2 :
+					cmdbuf.AddComponent<Tag1>( e );
+					cmdbuf.DestroyEntity( e );
+					break;
+
+				case 3 :
+					cmdbuf.RemoveComponent<Comp1>( e );
+					cmdbuf.AddComponent<Tag2>( e );
+					break;
+			}
+		}
+
+		cmdbuf.CreateEntity( Comp1{1000}, Tag1{} );
+		cmdbuf.CreateEntity( Comp2{2.0f} );
+		cmdbuf.CreateEntity( Comp1{1001}, Tag1{} );
+
+		TEST( cmdbuf.Count() == count*2 + count/4 + 3 );
+
+		// registry is not changed until buffer is applied
+		const auto	arch1 = reg.GetArchetype( entities[0] );
+		TEST( arch1 == reg.GetArchetype( entities[3] ));
+
+		cmdbuf.Apply( reg );
+		TEST( cmdbuf.Empty() );
+
+		reg.Process();
+
+		// 'Tag1' is added for entities (i % 4 == 0) and 2 created entities
+		TEST( added_cnt == count/4 + 2 );
+
+		// 'Comp1' is removed from entities (i % 4 == 3) and destroyed entities
+		TEST( removed_cnt == count/4 * 2 );
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const EntityID	e		= entities[i];
+			auto			arch	= reg.GetArchetype( e );
+
+			switch ( i % 4 )
+			{
+				case 0 :
+					TEST( arch and arch->Desc().Exists<Tag1>() );
+					TEST( reg.GetComponent<Comp1>( e )->value == int(i) );
+					TEST( reg.GetComponent<Comp2>( e )->value == float(i) );
+					break;
+
+				case 1 :
+					TEST( arch == arch1 );
+					TEST( not arch->Desc().Exists<Tag2>() );
+					TEST( reg.GetComponent<Comp1>( e )->value == -int(i) );
+					break;
+
+				case 2 :
+					TEST( not arch );
+					TEST( not reg.GetComponent<Comp1>( e ));
+					break;
+
+				case 3 :
+					TEST( arch and arch->Desc().Exists<Tag2>() );
+					TEST( not reg.GetComponent<Comp1>( e ));
+					break;
+			}
+		}
+
+		// check created entities
+		size_t	created = 0;
+		QueryID	q1		= reg.CreateQuery< ReadAccess<Comp1>, Require<Tag1>, Subtractive<Comp2> >();
+
+		reg.Execute( q1, [&created] (const Comp1 &c1)
+			{
+				TEST( c1.value == 1000 or c1.value == 1001 );
+				++created;
+			});
+		TEST( created == 2 );
+
+		reg.DestroyAllEntities();
+	}
+
+
+	static void  CommandBuffer_Test2 ()
+	{
+		Registry				reg;
+		ParallelCommandBuffer	cmdbuf;
+		const size_t			count = 10'000;
+
+		reg.RegisterComponents< Comp1, Comp2, Tag1, Tag2 >();
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			EntityID	e = reg.CreateEntity( Comp1{int(i)} );
+			TEST( e );
+		}
+
+		Scheduler().Setup( 2 );
+		Scheduler().AddThread( MakeShared<WorkerThread>() );
+		Scheduler().AddThread( MakeShared<WorkerThread>() );
+
+		QueryID	q1 = reg.CreateQuery< ReadAccess<EntityID>, ReadAccess<Comp1> >();
+		QueryID	q2 = reg.CreateQuery< ReadAccess<Comp1>, Require<Tag1> >();
+
+		// tag is toggled from worker threads
+		for (uint frame = 0; frame < 4; ++frame)
+		{
+			reg.ExecuteParallel( q1,
+				[&cmdbuf, frame] (ArrayView<Tuple< size_t, ReadAccess<EntityID>, ReadAccess<Comp1> >> chunks)
+				{
+					auto&	local = cmdbuf.Local();
+
+					for (auto& chunk : chunks)
+					{
+						for (size_t i = 0; i < chunk.Get<0>(); ++i)
+						{
+							if ( (chunk.Get<2>()[i].value & 1) == 0 )
+								continue;
+
+							if ( frame & 1 )
+								local.RemoveComponent<Tag1>( chunk.Get<1>()[i] );
+							else
+								local.AddComponent<Tag1>( chunk.Get<1>()[i] );
+						}
+					}
+				});
+
+			cmdbuf.Apply( reg );
+
+			size_t	tagged = 0;
+
+			reg.Execute( q2, [&tagged] (const Comp1 &c1)
+				{
+					TEST( (c1.value & 1) == 1 );
+					++tagged;
+				});
+
+			TEST( tagged == ((frame & 1) ? 0 : count/2) );
+		}
+
+		Scheduler().Release();
+
+		reg.DestroyAllEntities();
+	}
+}
+
+
+extern void UnitTest_EntityCommandBuffer ()
+{
+	CommandBuffer_Test1();
+	CommandBuffer_Test2();
+
+	AE_LOGI( "UnitTest_EntityCommandBuffer - passed" );
+}
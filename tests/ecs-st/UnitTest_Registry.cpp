@@ -1,6 +1,7 @@
 // Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
 
 #include "ecs-st/Core/Registry.h"
+#include "threading/TaskSystem/WorkerThread.h"
 #include "UnitTest_Common.h"
 
 namespace
@@ -319,6 +320,69 @@ namespace
 	}
 
 
+	static void  Entity_Test3 ()
+	{
+		Registry		reg;
+		InitRegistry( reg );
+
+		const size_t		count = 100;
+		Array<EntityID>		entities;
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			EntityID	e = reg.CreateEntity( Comp1{int(i)} );
+			TEST( e );
+			entities.push_back( e );
+		}
+
+		const auto	arch1 = reg.GetArchetype( entities[0] );
+		TEST( arch1 );
+
+		// toggle tag, transitions are cached after first add and remove
+		for (uint frame = 0; frame < 4; ++frame)
+		{
+			for (auto& e : entities) {
+				reg.AssignComponent<Tag1>( e );
+			}
+
+			const auto	arch2 = reg.GetArchetype( entities[0] );
+			TEST( arch2 and arch2 != arch1 );
+			TEST( arch2->Desc().Exists<Tag1>() );
+
+			for (auto& e : entities)
+			{
+				TEST( reg.GetArchetype( e ) == arch2 );
+				TEST( reg.RemoveComponent<Tag1>( e ));
+				TEST( not reg.RemoveComponent<Tag1>( e ));
+			}
+
+			for (auto& e : entities) {
+				TEST( reg.GetArchetype( e ) == arch1 );
+			}
+		}
+
+		// add and remove component with data
+		for (size_t i = 0; i < count; ++i)
+		{
+			reg.AssignComponent<Comp2>( entities[i] ).value = float(i);
+			TEST( reg.RemoveComponent<Comp1>( entities[i] ));
+		}
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			auto	c1 = reg.GetComponent<Comp1>( entities[i] );
+			auto	c2 = reg.GetComponent<Comp2>( entities[i] );
+			TEST( not c1 );
+			TEST( c2 and c2->value == float(i) );
+
+			reg.AssignComponent<Comp1>( entities[i] ).value = int(i);
+			TEST( reg.GetComponent<Comp1>( entities[i] )->value == int(i) );
+		}
+
+		reg.DestroyAllEntities();
+	}
+
+
 	static void  SingleComponent_Test1 ()
 	{
 		Registry	reg;
@@ -517,6 +581,72 @@ namespace
 	}
 
 
+	static void  System_Test4 ()
+	{
+		using namespace AE::Threading;
+
+		struct SingleComp1
+		{
+			int		scale;
+		};
+
+		Scheduler().Setup( 2 );
+		Scheduler().AddThread( MakeShared<WorkerThread>() );
+		Scheduler().AddThread( MakeShared<WorkerThread>() );
+		{
+			Registry		reg;
+			const size_t	count = ECS_Config::ParallelExecChunkSize * 10 + 7;
+
+			InitRegistry( reg );
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				EntityID	e1 = reg.CreateEntity( Comp1{int(i)}, Comp2{0.f} );
+				EntityID	e2 = reg.CreateEntity( Comp1{int(i)}, Comp2{0.f}, Tag1{} );
+				TEST( e1 and e2 );
+			}
+			reg.AssignSingleComponent<SingleComp1>().scale = 2;
+
+			QueryID			q		= reg.CreateQuery< Require<Comp1, Comp2> >();
+			Atomic<size_t>	cnt1	{0};
+
+			reg.ExecuteParallel( q,
+				[&cnt1] (ArrayView<Tuple< size_t, ReadAccess<Comp1>, WriteAccess<Comp2> >> chunks, Tuple< SingleComp1 const& > single)
+				{
+					const int	scale = single.Get<0>().scale;
+
+					for (auto& chunk : chunks)
+					{
+						chunk.Apply(
+							[&cnt1, scale] (size_t count, ReadAccess<Comp1> comp1, WriteAccess<Comp2> comp2)
+							{
+								TEST( count <= ECS_Config::ParallelExecChunkSize );
+
+								for (size_t i = 0; i < count; ++i) {
+									comp2[i].value = float(comp1[i].value * scale);
+								}
+								cnt1.fetch_add( count );
+							});
+					}
+				});
+			TEST( cnt1.load() == count*2 );
+
+			Atomic<size_t>	cnt2	{0};
+			reg.ExecuteParallel( q,
+				[&cnt2] (const Comp1 &comp1, const Comp2 &comp2)
+				{
+					TEST( comp2.value == float(comp1.value * 2) );
+					cnt2.fetch_add( 1 );
+				});
+			TEST( cnt2.load() == count*2 );
+
+			reg.DestroyAllEntities();
+			reg.DestroyAllSingleComponents();
+		}
+		Scheduler().Release();
+	}
+
+
 	static void  Events_Test1 ()
 	{
 		Registry	reg;
@@ -649,10 +779,12 @@ extern void UnitTest_Registry ()
 	ComponentValidator_Test1();
 	Entity_Test1();
 	Entity_Test2();
+	Entity_Test3();
 	SingleComponent_Test1();
 	System_Test1();
 	System_Test2();
 	System_Test3();
+	System_Test4();
 	Events_Test1();
 	Messages_Test1();
 	Messages_Test2();
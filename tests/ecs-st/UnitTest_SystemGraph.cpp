@@ -0,0 +1,118 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "ecs-st/Core/SystemGraph.h"
+#include "threading/TaskSystem/WorkerThread.h"
+#include "UnitTest_Common.h"
+
+namespace
+{
+	using namespace AE::Threading;
+
+	struct Comp1
+	{
+		int		value;
+	};
+
+	struct Comp2
+	{
+		int		value;
+	};
+
+	struct Tag1 {};
+
+	struct SingleComp1
+	{
+		int		sum;
+	};
+
+
+	static void  SystemGraph_Test1 ()
+	{
+		Registry		reg;
+		const size_t	count = 1000;
+
+		reg.RegisterComponents< Comp1, Comp2, Tag1 >();
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			EntityID	e1 = reg.CreateEntity( Comp1{0}, Comp2{int(i)} );
+			TEST( e1 );
+		}
+
+		QueryID	q1	= reg.CreateQuery< WriteAccess<Comp1>, ReadAccess<Comp2> >();
+		QueryID	q2	= reg.CreateQuery< ReadAccess<Comp2> >();
+		QueryID	q3	= reg.CreateQuery< WriteAccess<Comp2>, Subtractive<Tag1> >();
+
+		Atomic<size_t>	cnt2 {0};
+		SystemGraph		graph;
+
+		const uint	s0 = graph.Add( q1, [] (Comp1 &c1, const Comp2 &c2) { c1.value = c2.value; }, "Copy" );
+
+		const uint	s1 = graph.Add( q2,
+			[&cnt2] (ArrayView<Tuple< size_t, ReadAccess<Comp2> >> chunks, Tuple< SingleComp1 const* >)
+			{
+				for (auto& chunk : chunks) {
+					cnt2.fetch_add( chunk.Get<0>() );
+				}
+			},
+			"Count" );
+
+		const uint	s2 = graph.Add( q3,
+			[] (ArrayView<Tuple< size_t, WriteAccess<Comp2> >> chunks, Tuple< SingleComp1& > single)
+			{
+				for (auto& chunk : chunks)
+				{
+					for (size_t i = 0; i < chunk.Get<0>(); ++i) {
+						single.Get<0>().sum += chunk.Get<1>()[i].value;
+						chunk.Get<1>()[i].value = -1;
+					}
+				}
+			},
+			"Clear" );
+
+		TEST( graph.Build() );
+
+		TEST( graph.GetAccess( s0 ).write.Exists<Comp1>() );
+		TEST( graph.GetAccess( s0 ).read.Exists<Comp2>() );
+		TEST( graph.GetAccess( s1 ).singleRead.size() == 1 );
+		TEST( graph.GetAccess( s2 ).singleWrite.size() == 1 );
+
+		// 'Copy' and 'Count' only read 'Comp2', 'Clear' writes it
+		TEST( graph.DependsOn( s0 ).empty() );
+		TEST( graph.DependsOn( s1 ).empty() );
+		TEST( graph.DependsOn( s2 ).size() == 2 );
+
+		const String	dot = graph.ToGraphviz();
+		TEST( HasSubString( dot, "s0 -> s2" ));
+		TEST( HasSubString( dot, "s1 -> s2" ));
+		TEST( HasSubString( dot, "label=\"Copy\"" ));
+
+		Scheduler().Setup( 2 );
+		Scheduler().AddThread( MakeShared<WorkerThread>() );
+		Scheduler().AddThread( MakeShared<WorkerThread>() );
+
+		for (uint frame = 0; frame < 3; ++frame)
+		{
+			TEST( graph.Execute( reg ));
+		}
+
+		Scheduler().Release();
+
+		TEST( cnt2.load() == count*3 );
+		TEST( reg.GetSingleComponent<SingleComp1>()->sum == int(count * (count - 1) / 2) - int(count) * 2 );
+
+		reg.Execute( q1, [] (const Comp1 &c1, const Comp2 &c2) { TEST( c1.value == -1 and c2.value == -1 ); });
+
+		graph.Clear();
+		reg.DestroyAllEntities();
+		reg.DestroyAllSingleComponents();
+	}
+}
+
+
+extern void UnitTest_SystemGraph ()
+{
+	SystemGraph_Test1();
+
+	AE_LOGI( "UnitTest_SystemGraph - passed" );
+}
@@ -3,10 +3,14 @@
 #include "stl/Common.h"
 
 extern void UnitTest_Archetype ();
+extern void UnitTest_EntityCommandBuffer ();
 extern void UnitTest_EntityPool ();
 extern void UnitTest_Registry ();
+extern void UnitTest_SystemGraph ();
 extern void UnitTest_Transformation ();
 
+extern void PerfTest_ArchetypeStorage ();
+
 
 #ifdef PLATFORM_ANDROID
 extern int Test_ECSst ()
@@ -17,8 +21,14 @@ int main ()
 	UnitTest_Archetype();
 	UnitTest_EntityPool();
 	UnitTest_Registry();
+	UnitTest_SystemGraph();
+	UnitTest_EntityCommandBuffer();
 	UnitTest_Transformation();
 
+#if (not defined(AE_CI_BUILD)) and (not defined(PLATFORM_ANDROID))
+	PerfTest_ArchetypeStorage();
+#endif
+
 	AE_LOGI( "Tests.ECS finished" );
 	return 0;
 }
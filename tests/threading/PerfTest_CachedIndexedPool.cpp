@@ -0,0 +1,72 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "threading/Containers/CachedIndexedPool.h"
+#include "threading/Containers/ShardedCachedIndexedPool.h"
+#include "stl/Algorithms/StringUtils.h"
+#include "UnitTest_Common.h"
+
+namespace
+{
+	using TimePoint_t	= std::chrono::high_resolution_clock::time_point;
+
+
+	// most of accesses are cache hits, as in render pass, framebuffer and descriptor set caches
+	template <typename Pool>
+	static void  CachedIndexedPool_Test1 (StringView name, uint numThreads)
+	{
+		const uint			count		= 1024;
+		const uint			num_finds	= 2'000'000;
+		auto				pool		= MakeUnique<Pool>();
+		Atomic<uint>		hits		{0};
+		Array<std::thread>	threads;
+
+		for (uint i = 0; i < count; ++i)
+		{
+			uint	idx;
+			TEST( pool->Assign( OUT idx ));
+			TEST( pool->Insert( idx, uint(i) ).second );
+		}
+
+		const auto	start_time = TimePoint_t::clock::now();
+
+		for (uint t = 0; t < numThreads; ++t)
+		{
+			threads.emplace_back( [&pool, &hits, t] ()
+			{
+				uint	local_hits = 0;
+				for (uint i = 0; i < num_finds; ++i)
+				{
+					const uint	key = (i * 13 + t) % (count + count / 16);	// ~6% misses
+					local_hits += uint(pool->Find( &key ) != UMax);
+				}
+				hits.fetch_add( local_hits );
+			});
+		}
+
+		for (auto& t : threads) {
+			t.join();
+		}
+
+		const auto	dt = TimePoint_t::clock::now() - start_time;
+
+		TEST( hits.load() > 0 );
+
+		AE_LOGI( String(name) << ", threads: " << ToString( numThreads ) << ", time: " << ToString( dt )
+				<< ", find/s: " << ToString( double(num_finds) * numThreads / std::chrono::duration_cast<std::chrono::duration<double>>( dt ).count(), 0 ));
+	}
+}
+
+
+extern void PerfTest_CachedIndexedPool ()
+{
+	using Locked_t	= AE::Threading::CachedIndexedPool< uint, uint, 1024, 4 >;
+	using Sharded_t	= AE::Threading::ShardedCachedIndexedPool< uint, uint, 1024, 4 >;
+
+	for (uint num_threads : { 1u, Max( 2u, std::thread::hardware_concurrency() / 2 ), Max( 2u, std::thread::hardware_concurrency() )})
+	{
+		CachedIndexedPool_Test1< Locked_t >(  "shared mutex", num_threads );
+		CachedIndexedPool_Test1< Sharded_t >( "sharded",      num_threads );
+	}
+
+	AE_LOGI( "PerfTest_CachedIndexedPool - passed" );
+}
@@ -0,0 +1,82 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "threading/Containers/LfIndexedPool2.h"
+#include "stl/Algorithms/StringUtils.h"
+#include "UnitTest_Common.h"
+
+namespace
+{
+	using TimePoint_t	= std::chrono::high_resolution_clock::time_point;
+	using Pool_t		= LfIndexedPool2< uint64_t, uint, 1024, 16 >;
+
+
+	// each thread keeps a few indices and frequently assigns and unassigns them
+	template <bool UseMagazine>
+	static void  LfIndexedPool2_Test1 (uint numThreads)
+	{
+		const uint			count		= 2'000'000;
+		const uint			in_flight	= 8;
+		auto				pool		= MakeUnique<Pool_t>();
+		Array<std::thread>	threads;
+
+		const auto	start_time = TimePoint_t::clock::now();
+
+		for (uint t = 0; t < numThreads; ++t)
+		{
+			threads.emplace_back( [&pool] ()
+			{
+				Pool_t::Magazine	mag {*pool};
+				uint				indices [in_flight];
+
+				const auto	Assign = [&] (OUT uint &idx) {
+						if constexpr( UseMagazine )	return mag.Assign( OUT idx );
+						else						return pool->Assign( OUT idx );
+					};
+				const auto	Unassign = [&] (uint idx) {
+						if constexpr( UseMagazine )	mag.Unassign( idx );
+						else						pool->Unassign( idx );
+					};
+
+				for (uint i = 0; i < count; ++i)
+				{
+					uint&	idx = indices[ i % in_flight ];
+
+					if ( i >= in_flight )
+						Unassign( idx );
+
+					TEST( Assign( OUT idx ));
+					(*pool)[idx] = i;
+				}
+
+				for (uint i = 0; i < in_flight; ++i) {
+					Unassign( indices[i] );
+				}
+			});
+		}
+
+		for (auto& t : threads) {
+			t.join();
+		}
+
+		const auto	dt = TimePoint_t::clock::now() - start_time;
+
+		for (uint i = 0; i < Pool_t::Capacity(); ++i) {
+			TEST( not pool->IsAssigned( i ));
+		}
+
+		AE_LOGI( String(UseMagazine ? "magazine" : "pool") << ", threads: " << ToString( numThreads ) << ", time: " << ToString( dt )
+				<< ", assign/s: " << ToString( double(count) * numThreads / std::chrono::duration_cast<std::chrono::duration<double>>( dt ).count(), 0 ));
+	}
+}
+
+
+extern void PerfTest_LfIndexedPool2 ()
+{
+	for (uint num_threads : { 1u, Max( 2u, std::thread::hardware_concurrency() / 2 ), Max( 2u, std::thread::hardware_concurrency() )})
+	{
+		LfIndexedPool2_Test1< false >( num_threads );
+		LfIndexedPool2_Test1< true >( num_threads );
+	}
+
+	AE_LOGI( "PerfTest_LfIndexedPool2 - passed" );
+}
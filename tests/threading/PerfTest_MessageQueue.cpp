@@ -0,0 +1,142 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "threading/Queues/MessageQueue.h"
+#include "stl/Algorithms/StringUtils.h"
+#include "UnitTest_Common.h"
+
+#include <deque>
+
+namespace
+{
+	using TimePoint_t	= std::chrono::high_resolution_clock::time_point;
+
+	struct Message
+	{
+		uint	id;
+		uint	data [3];
+	};
+
+
+	//
+	// Mutex + std::deque
+	//
+	class LockQueue
+	{
+	private:
+		Mutex					_guard;
+		std::deque<Message>		_queue;
+
+	public:
+		ND_ bool  Produce (const Message &msg)
+		{
+			EXLOCK( _guard );
+			_queue.push_back( msg );
+			return true;
+		}
+
+		ND_ size_t  Produce (ArrayView<Message> msgs)
+		{
+			EXLOCK( _guard );
+			_queue.insert( _queue.end(), msgs.begin(), msgs.end() );
+			return msgs.size();
+		}
+
+		template <typename Fn>
+		size_t  ConsumeAll (Fn &&fn)
+		{
+			std::deque<Message>	temp;
+			{
+				EXLOCK( _guard );
+				std::swap( temp, _queue );
+			}
+			for (auto& msg : temp) {
+				fn( std::move(msg) );
+			}
+			return temp.size();
+		}
+	};
+
+
+	template <typename Queue>
+	static void  MessageQueue_Test1 (StringView name, uint numProducers, uint numConsumers, uint batchSize)
+	{
+		const uint			count		= 1'000'000;
+		const uint			per_thread	= count / numProducers;
+		auto				queue		= MakeUnique<Queue>();
+		Atomic<uint>		consumed	{0};
+		Atomic<uint64_t>	checksum	{0};
+		Array<std::thread>	threads;
+
+		const auto	start_time = TimePoint_t::clock::now();
+
+		for (uint p = 0; p < numProducers; ++p)
+		{
+			threads.emplace_back( [&queue, per_thread, batchSize] ()
+			{
+				Array<Message>	batch;
+				batch.resize( batchSize );
+
+				for (uint i = 0; i < per_thread;)
+				{
+					const uint	n = Min( batchSize, per_thread - i );
+					for (uint j = 0; j < n; ++j) {
+						batch[j].id = i + j;
+					}
+
+					const size_t	added = (n == 1 ? size_t(queue->Produce( batch[0] )) : queue->Produce( ArrayView<Message>{ batch.data(), n }));
+					i += uint(added);
+
+					if ( added == 0 )
+						std::this_thread::yield();
+				}
+			});
+		}
+
+		for (uint c = 0; c < numConsumers; ++c)
+		{
+			threads.emplace_back( [&, total = per_thread * numProducers] ()
+			{
+				uint64_t	sum = 0;
+				for (; consumed.load( EMemoryOrder::Relaxed ) < total;)
+				{
+					const size_t	n = queue->ConsumeAll( [&sum] (Message &&msg) { sum += msg.id; });
+					consumed.fetch_add( uint(n), EMemoryOrder::Relaxed );
+
+					if ( n == 0 )
+						std::this_thread::yield();
+				}
+				checksum.fetch_add( sum );
+			});
+		}
+
+		for (auto& t : threads) {
+			t.join();
+		}
+
+		const auto	dt = TimePoint_t::clock::now() - start_time;
+
+		TEST( consumed.load() == per_thread * numProducers );
+		TEST( checksum.load() == uint64_t(per_thread - 1) * per_thread / 2 * numProducers );
+
+		AE_LOGI( String(name) << ", producers: " << ToString( numProducers ) << ", consumers: " << ToString( numConsumers )
+				<< ", batch: " << ToString( batchSize ) << ", time: " << ToString( dt )
+				<< ", msg/s: " << ToString( double(consumed.load()) / std::chrono::duration_cast<std::chrono::duration<double>>( dt ).count(), 0 ));
+	}
+}
+
+
+extern void PerfTest_MessageQueue ()
+{
+	const uint	num_threads = Max( 2u, std::thread::hardware_concurrency() / 2 );
+
+	for (uint batch : {1u, 16u})
+	{
+		MessageQueue_Test1< LockQueue >(                        "mutex + deque", num_threads, 1, batch );
+		MessageQueue_Test1< MPSCMessageQueue< Message, 4096 >>( "lock-free MPSC", num_threads, 1, batch );
+
+		MessageQueue_Test1< LockQueue >(                        "mutex + deque", num_threads, num_threads, batch );
+		MessageQueue_Test1< MPMCMessageQueue< Message, 4096 >>( "lock-free MPMC", num_threads, num_threads, batch );
+	}
+
+	AE_LOGI( "PerfTest_MessageQueue - passed" );
+}
@@ -0,0 +1,124 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "threading/TaskSystem/ParallelFor.h"
+#include "threading/TaskSystem/WorkerThread.h"
+
+#include "stl/Algorithms/StringUtils.h"
+#include "PerlinNoise.hpp"
+
+#include "UnitTest_Common.h"
+
+using namespace AE::Threading;
+
+namespace
+{
+	using TimePoint_t = std::chrono::high_resolution_clock::time_point;
+
+	static constexpr uint	W = 256;
+	static constexpr uint	H = 1024;
+
+	static siv::PerlinNoise		noise;
+
+
+	static double  NoiseRow (uint y)
+	{
+		double	sum = 0.0;
+		for (uint x = 0; x < W; ++x) {
+			sum += noise.octaveNoise( double(x) / W, double(y) / H, 4 );
+		}
+		return sum;
+	}
+
+
+	class RowTask final : public IAsyncTask
+	{
+	private:
+		const uint			_row;
+		Array<double>&		_rows;
+		Atomic<uint>&		_counter;
+
+	public:
+		RowTask (uint row, Array<double> &rows, Atomic<uint> &counter) :
+			IAsyncTask{ EThread::Worker }, _row{ row }, _rows{ rows }, _counter{ counter }
+		{}
+
+		void Run () override
+		{
+			_rows[_row] = NoiseRow( _row );
+			_counter.fetch_add( 1, EMemoryOrder::Release );
+		}
+	};
+
+
+	// current approach: one task per row
+	static void  ParallelFor_Test1 (Array<double> &rows)
+	{
+		Atomic<uint>	counter {0};
+
+		for (uint y = 0; y < H; ++y) {
+			Scheduler().Run<RowTask>( Tuple{ y, std::ref(rows), std::ref(counter) });
+		}
+
+		for (uint seed = 0; counter.load( EMemoryOrder::Acquire ) < H; ++seed)
+		{
+			if ( not Scheduler().ProcessTask( IAsyncTask::EThread::Worker, seed ))
+				std::this_thread::yield();
+		}
+	}
+
+
+	static void  ParallelFor_Test2 (Array<double> &rows)
+	{
+		ParallelFor( 0, H, 1, [&rows] (size_t y) { rows[y] = NoiseRow( uint(y) ); });
+	}
+
+
+	static double  ParallelFor_Test3 ()
+	{
+		return ParallelReduce( 0, H, 1, 0.0,
+					[] (size_t y) { return NoiseRow( uint(y) ); },
+					[] (double lhs, double rhs) { return lhs + rhs; });
+	}
+
+
+	template <typename Fn>
+	static void  Measure (StringView name, Fn &&fn)
+	{
+		const auto	start_time = TimePoint_t::clock::now();
+
+		for (uint i = 0; i < 10; ++i) {
+			fn();
+		}
+
+		AE_LOGI( String(name) << " time: " << ToString( (TimePoint_t::clock::now() - start_time) / 10 ));
+	}
+}
+
+
+extern void PerfTest_ParallelFor ()
+{
+	const uint			num_threads = std::thread::hardware_concurrency()-1;
+	LocalTaskScheduler	scheduler	{num_threads};
+
+	for (uint i = 0; i < num_threads; ++i) {
+		scheduler->AddThread( MakeShared<WorkerThread>() );
+	}
+
+	Array<double>	rows1 ( H );
+	Array<double>	rows2 ( H );
+	double			sum3	= 0.0;
+
+	Measure( "per-row tasks",  [&] () { ParallelFor_Test1( rows1 ); });
+	Measure( "ParallelFor",    [&] () { ParallelFor_Test2( rows2 ); });
+	Measure( "ParallelReduce", [&] () { sum3 = ParallelFor_Test3(); });
+
+	double	sum1 = 0.0;
+	for (uint y = 0; y < H; ++y)
+	{
+		TEST( rows1[y] == rows2[y] );
+		sum1 += rows1[y];
+	}
+	TEST( Abs( sum1 - sum3 ) < 1.0e-6 * Max( 1.0, Abs( sum1 )));
+
+	AE_LOGI( "PerfTest_ParallelFor - passed" );
+}
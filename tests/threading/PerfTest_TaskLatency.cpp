@@ -0,0 +1,86 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "threading/TaskSystem/TaskScheduler.h"
+#include "threading/TaskSystem/WorkerThread.h"
+
+#include "stl/Algorithms/StringUtils.h"
+
+#include "UnitTest_Common.h"
+
+using namespace AE::Threading;
+
+namespace
+{
+	using TimePoint_t	= std::chrono::high_resolution_clock::time_point;
+	using EIdleMode		= WorkerThread::EIdleMode;
+
+
+	class LatencyTask final : public IAsyncTask
+	{
+	public:
+		const TimePoint_t	startTime;
+		Atomic<int64_t>&	latency;	// Nanoseconds
+
+		LatencyTask (Atomic<int64_t> &latency) :
+			IAsyncTask{ EThread::Worker },
+			startTime{ TimePoint_t::clock::now() }, latency{ latency }
+		{}
+
+		void Run () override
+		{
+			latency.store( (TimePoint_t::clock::now() - startTime).count() );
+		}
+	};
+
+
+	static void  TaskLatency_Test1 (EIdleMode mode)
+	{
+		const uint			num_threads	= Max( 2u, std::thread::hardware_concurrency() / 2 );
+		const uint			count		= 200;
+		LocalTaskScheduler	scheduler	{num_threads};
+
+		for (uint i = 0; i < num_threads; ++i) {
+			scheduler->AddThread( MakeShared<WorkerThread>(
+				WorkerThread::ThreadMask{}.set(uint(WorkerThread::EThread::Worker)),
+				mode,
+				WorkerThread::Milliseconds{mode == EIdleMode::Park ? 100 : 4} ));
+		}
+
+		Array<int64_t>	latencies;
+		latencies.reserve( count );
+
+		for (uint i = 0; i < count; ++i)
+		{
+			// pool is mostly idle, all threads should be parked or sleeping
+			std::this_thread::sleep_for( std::chrono::milliseconds{2} );
+
+			Atomic<int64_t>	latency {-1};
+			AsyncTask		task = scheduler->Run<LatencyTask>( Tuple{std::ref(latency)} );
+
+			TEST( scheduler->Wait({ task }));
+			TEST( latency.load() >= 0 );
+
+			latencies.push_back( latency.load() );
+		}
+
+		std::sort( latencies.begin(), latencies.end() );
+
+		int64_t	sum = 0;
+		for (auto& t : latencies) { sum += t; }
+
+		AE_LOGI( String(mode == EIdleMode::Park ? "park" : "sleep")
+			<< " latency avg: " << ToString( Nanoseconds{sum / int64_t(latencies.size())} )
+			<< ", median: " << ToString( Nanoseconds{latencies[ latencies.size()/2 ]} )
+			<< ", p99: " << ToString( Nanoseconds{latencies[ latencies.size()*99/100 ]} )
+			<< ", max: " << ToString( Nanoseconds{latencies.back()} ));
+	}
+}
+
+
+extern void PerfTest_TaskLatency ()
+{
+	TaskLatency_Test1( EIdleMode::Sleep );
+	TaskLatency_Test1( EIdleMode::Park );
+
+	AE_LOGI( "PerfTest_TaskLatency - passed" );
+}
@@ -3,9 +3,11 @@
 #include "threading/TaskSystem/TaskScheduler.h"
 #include "threading/TaskSystem/WorkerThread.h"
 #include "threading/TaskSystem/FunctionTask.h"
+#include "threading/TaskSystem/TaskGraph.h"
 
 #include "stl/Math/Vec.h"
 #include "stl/Algorithms/StringUtils.h"
+#include "stl/Platforms/CPUInfo.h"
 #include "PerlinNoise.hpp"
 
 #include "UnitTest_Common.h"
@@ -88,14 +90,18 @@ namespace
 		}
 	};
 
-	static void  Threading_Test1 ()
+	static void  Threading_Test1 (bool workStealing)
 	{
 		using TimePoint_t = std::chrono::high_resolution_clock::time_point;
 
 		task_complete.store( 0 );
 
-		const size_t		num_threads = std::thread::hardware_concurrency()-1;
-		LocalTaskScheduler	scheduler	{num_threads};
+		const size_t			num_threads = std::thread::hardware_concurrency()-1;
+		TaskScheduler::Settings	settings;
+		settings.maxWorkerThreads	= uint(num_threads);
+		settings.workStealing		= workStealing;
+
+		LocalTaskScheduler	scheduler	{settings};
 		{
 			for (size_t i = 0; i < num_threads; ++i) {
 				scheduler->AddThread( MakeShared<WorkerThread>(
@@ -218,10 +224,233 @@ namespace
 }
 
 
+namespace
+{
+	class EmptyTask final : public IAsyncTask
+	{
+	public:
+		EmptyTask () : IAsyncTask{ EThread::Worker } {}
+
+		void Run () override
+		{
+			task_complete.fetch_add( 1, EMemoryOrder::Relaxed );
+		}
+	};
+
+	static void  Threading_Test3 (bool batch)
+	{
+		using TimePoint_t = std::chrono::high_resolution_clock::time_point;
+
+		task_complete.store( 0 );
+
+		const size_t		num_threads = std::thread::hardware_concurrency()-1;
+		const uint			count		= 10'000;
+		LocalTaskScheduler	scheduler	{num_threads};
+		{
+			for (size_t i = 0; i < num_threads; ++i) {
+				scheduler->AddThread( MakeShared<WorkerThread>() );
+			}
+
+			Array<AsyncTask>	tasks;
+			for (uint i = 0; i < count; ++i) {
+				tasks.push_back( MakeShared<EmptyTask>() );
+			}
+
+			const auto	start_time = TimePoint_t::clock::now();
+
+			if ( batch )
+				TEST( scheduler->RunBatch( tasks ))
+			else
+			{
+				for (auto& task : tasks) {
+					TEST( scheduler->Run( task ));
+				}
+			}
+
+			const auto	insert_time = TimePoint_t::clock::now() - start_time;
+
+			for (;;)
+			{
+				if ( task_complete.load( EMemoryOrder::Relaxed ) >= count )
+					break;
+
+				std::this_thread::yield();
+			}
+
+			AE_LOGI( (batch ? "RunBatch"s : "Run"s) << " insertion time: " << ToString( insert_time )
+				<< ", total time: " << ToString( TimePoint_t::clock::now() - start_time ) << ", jobs: " << ToString( count ));
+		}
+	}
+
+
+	static void  Threading_Test4 (bool pooled)
+	{
+		using TimePoint_t = std::chrono::high_resolution_clock::time_point;
+
+		const uint			count	= 100'000;
+		Array<AsyncTask>	tasks;
+		tasks.reserve( 1000 );
+
+		TaskAllocator::ResetStatistic();
+		const auto	start_time = TimePoint_t::clock::now();
+
+		// burst of task allocations, tasks are released in groups
+		for (uint i = 0; i < count; ++i)
+		{
+			if ( pooled )
+				tasks.push_back( MakeTask<EmptyTask>() );
+			else
+				tasks.push_back( MakeShared<EmptyTask>() );
+
+			if ( tasks.size() == tasks.capacity() )
+				tasks.clear();
+		}
+		tasks.clear();
+
+		const auto	stat = TaskAllocator::GetStatistic();
+
+		AE_LOGI( (pooled ? "MakeTask"s : "MakeShared"s) << " allocation time: " << ToString( TimePoint_t::clock::now() - start_time )
+			<< ", tasks: " << ToString( count ) << ", pool hits: " << ToString( stat.hits ) << ", misses: " << ToString( stat.misses ));
+	}
+
+
+	class NodeTask final : public IAsyncTask
+	{
+	public:
+		static inline Atomic<uint>	remote	{0};	// number of tasks that were executed on another NUMA node
+
+		const uint	level;
+		const uint	node	= TaskScheduler::CurrentThreadNode();
+
+		explicit NodeTask (uint level) : IAsyncTask{ EThread::Worker }, level{level} {}
+
+		void Run () override
+		{
+			if ( TaskScheduler::CurrentThreadNode() != node )
+				remote.fetch_add( 1, EMemoryOrder::Relaxed );
+
+			if ( level > 0 )
+			{
+				for (uint i = 0; i < 4; ++i) {
+					Scheduler().Run<NodeTask>( Tuple{level-1} );
+				}
+			}
+			task_complete.fetch_add( 1, EMemoryOrder::Relaxed );
+		}
+	};
+
+	static void  Threading_Test5 (bool topologyAware)
+	{
+		using TimePoint_t = std::chrono::high_resolution_clock::time_point;
+
+		task_complete.store( 0 );
+		NodeTask::remote.store( 0 );
+
+		TaskScheduler::Settings	settings;
+		settings.maxWorkerThreads	= Max( 2u, std::thread::hardware_concurrency() );
+		settings.workStealing		= true;
+		settings.topologyAware		= topologyAware;
+
+		const uint			levels	= 8;
+		const uint			count	= (1u << (2 * (levels + 1))) / 3;	// 1 + 4 + 16 + ...
+		LocalTaskScheduler	scheduler {settings};
+		{
+			for (uint i = 0; i < settings.maxWorkerThreads; ++i) {
+				scheduler->AddThread( MakeShared<WorkerThread>() );
+			}
+
+			const auto	start_time = TimePoint_t::clock::now();
+
+			TEST( scheduler->Run<NodeTask>( Tuple{levels} ));
+
+			for (;;)
+			{
+				if ( task_complete.load( EMemoryOrder::Relaxed ) >= count )
+					break;
+
+				std::this_thread::yield();
+			}
+
+			AE_LOGI( (topologyAware ? "topology-aware"s : "default"s) << " total time: " << ToString( TimePoint_t::clock::now() - start_time )
+				<< ", jobs: " << ToString( count ) << ", cross-node: " << ToString( NodeTask::remote.load() )
+				<< ", NUMA nodes: " << ToString( CPUInfo::Get().numaNodeCount ));
+		}
+	}
+
+
+	static void  Threading_Test6 (bool useGraph)
+	{
+		using TimePoint_t = std::chrono::high_resolution_clock::time_point;
+
+		const uint			layers		= 10;
+		const uint			width		= 30;
+		const uint			frames		= 1000;
+		const size_t		num_threads	= std::thread::hardware_concurrency()-1;
+		LocalTaskScheduler	scheduler	{num_threads};
+		{
+			for (size_t i = 0; i < num_threads; ++i) {
+				scheduler->AddThread( MakeShared<WorkerThread>() );
+			}
+
+			// each task depends on two tasks from the previous layer
+			TaskGraph	graph;
+			if ( useGraph )
+			{
+				for (uint l = 0; l < layers; ++l)
+				for (uint i = 0; i < width; ++i)
+				{
+					if ( l == 0 )
+						TEST( graph.Add( MakeTask<EmptyTask>() ) != UMax )
+					else
+						TEST( graph.Add( MakeTask<EmptyTask>(), {(l-1)*width + i, (l-1)*width + (i+1) % width} ) != UMax );
+				}
+			}
+
+			Array<AsyncTask>	tasks;
+			tasks.resize( layers * width );
+
+			Nanoseconds	schedule_time {0};
+			const auto	start_time = TimePoint_t::clock::now();
+
+			for (uint f = 0; f < frames; ++f)
+			{
+				const auto	frame_start = TimePoint_t::clock::now();
+
+				if ( useGraph )
+					TEST( graph.Run() )
+				else
+				{
+					for (uint l = 0; l < layers; ++l)
+					for (uint i = 0; i < width; ++i)
+					{
+						if ( l == 0 )
+							tasks[i] = scheduler->Run<EmptyTask>();
+						else
+							tasks[l*width + i] = scheduler->Run<EmptyTask>( Tuple{}, Tuple{ tasks[(l-1)*width + i], tasks[(l-1)*width + (i+1) % width] });
+					}
+				}
+
+				schedule_time += TimePoint_t::clock::now() - frame_start;
+
+				TEST( useGraph ? graph.Wait() : scheduler->Wait( tasks ));
+			}
+
+			AE_LOGI( (useGraph ? "TaskGraph"s : "Run"s) << " scheduling time per frame: " << ToString( schedule_time / frames )
+				<< ", total time: " << ToString( TimePoint_t::clock::now() - start_time ) << ", tasks per frame: " << ToString( layers * width ));
+		}
+	}
+}
+
+
 extern void PerfTest_Threading ()
 {
 	for (uint i = 0; i < 4; ++i) {
-		Threading_Test1();
+		Threading_Test1( false );
+	}
+	
+	AE_LOGI( "------------------------" );
+	for (uint i = 0; i < 4; ++i) {
+		Threading_Test1( true );
 	}
 
 	AE_LOGI( "------------------------" );
@@ -229,5 +458,29 @@ extern void PerfTest_Threading ()
 		Threading_Test2();
 	}
 
+	AE_LOGI( "------------------------" );
+	for (uint i = 0; i < 4; ++i) {
+		Threading_Test3( false );
+		Threading_Test3( true );
+	}
+
+	AE_LOGI( "------------------------" );
+	for (uint i = 0; i < 4; ++i) {
+		Threading_Test4( false );
+		Threading_Test4( true );
+	}
+
+	AE_LOGI( "------------------------" );
+	for (uint i = 0; i < 4; ++i) {
+		Threading_Test5( false );
+		Threading_Test5( true );
+	}
+
+	AE_LOGI( "------------------------" );
+	for (uint i = 0; i < 4; ++i) {
+		Threading_Test6( false );
+		Threading_Test6( true );
+	}
+
 	AE_LOGI( "PerfTest_Threading - passed" );
 }
@@ -16,6 +16,11 @@ struct LocalTaskScheduler
 		Scheduler().Setup( maxWorkerThreads );
 	}
 
+	LocalTaskScheduler (const TaskScheduler::Settings &settings)
+	{
+		Scheduler().Setup( settings );
+	}
+
 	~LocalTaskScheduler ()
 	{
 		Scheduler().Release();
@@ -0,0 +1,155 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "threading/TaskSystem/Coroutine.h"
+#include "threading/TaskSystem/FunctionTask.h"
+#include "threading/TaskSystem/WorkerThread.h"
+#include "UnitTest_Common.h"
+
+#ifdef AE_STD_COROUTINE
+
+namespace
+{
+	using EStatus	= IAsyncTask::EStatus;
+	using EThread	= IAsyncTask::EThread;
+
+
+	static CoroTask  Coroutine_Test1_Impl (Atomic<uint>* counter)
+	{
+		AsyncTask	t1 = Scheduler().Run<FunctionTask>( Tuple{[counter] () { counter->fetch_add( 1 ); }} );
+		co_await t1;
+		TEST( counter->load() == 1 );
+
+		auto	p1 = MakePromise( [] () { return 10u; });
+		uint	v1 = co_await p1;
+		TEST( v1 == 10 );
+		counter->fetch_add( v1 );
+
+		// already completed
+		co_await t1;
+		uint	v2 = co_await p1;
+		counter->fetch_add( v2 );
+	}
+
+	static void  Coroutine_Test1 ()
+	{
+		LocalTaskScheduler	scheduler	{1};
+		Atomic<uint>		counter		{0};
+
+		// there are no worker threads, coroutine will be executed in current thread
+		AsyncTask	task = Coroutine_Test1_Impl( &counter );
+		TEST( scheduler->Run( task ));
+
+		TEST( scheduler->Wait({ task }));
+		TEST( task->Status() == EStatus::Completed );
+		TEST( counter.load() == 21 );
+	}
+
+
+	static CoroTask  Coroutine_Test2_Impl (ThreadID mainThread, Atomic<uint>* counter)
+	{
+		TEST( std::this_thread::get_id() != mainThread );
+		counter->fetch_add( 1 );
+
+		co_await EThread::Main;
+		TEST( std::this_thread::get_id() == mainThread );
+		counter->fetch_add( 1 );
+
+		co_await EThread::Worker;
+		TEST( std::this_thread::get_id() != mainThread );
+		counter->fetch_add( 1 );
+	}
+
+	static void  Coroutine_Test2 ()
+	{
+		LocalTaskScheduler	scheduler	{1};
+		Atomic<uint>		counter		{0};
+
+		scheduler->AddThread( MakeShared<WorkerThread>() );
+
+		// main queue is processed only by current thread
+		AsyncTask	task = Coroutine_Test2_Impl( std::this_thread::get_id(), &counter );
+		TEST( scheduler->Run( task ));
+
+		TEST( scheduler->Wait( {task}, Nanoseconds{std::chrono::seconds{10}}, IThread::ThreadMask{}.set( uint(EThread::Main) )));
+		TEST( task->Status() == EStatus::Completed );
+		TEST( counter.load() == 3 );
+	}
+
+
+	static CoroTask  Coroutine_Test3_Impl (Atomic<uint>* counter)
+	{
+		counter->fetch_add( 1 );
+
+		auto	p1 = MakePromise( [] () -> PromiseResult<uint> { return CancelPromise; });
+		uint	v1 = co_await p1;
+
+		// coroutine must be canceled
+		counter->fetch_add( 100 + v1 );
+	}
+
+	static void  Coroutine_Test3 ()
+	{
+		LocalTaskScheduler	scheduler	{1};
+		Atomic<uint>		counter		{0};
+
+		AsyncTask	task = Coroutine_Test3_Impl( &counter );
+		TEST( scheduler->Run( task ));
+
+		TEST( scheduler->Wait({ task }));
+		TEST( task->Status() == EStatus::Canceled );
+		TEST( counter.load() == 1 );
+	}
+
+
+	static CoroTask  Coroutine_Test4_Inner (Atomic<uint>* counter)
+	{
+		co_await EThread::Worker;
+		counter->fetch_add( 1 );
+	}
+
+	static CoroTask  Coroutine_Test4_Outer (Atomic<uint>* counter)
+	{
+		co_await Coroutine_Test4_Inner( counter );
+		TEST( counter->load() == 1 );
+
+		co_await Coroutine_Test4_Inner( counter );
+		TEST( counter->load() == 2 );
+
+		counter->fetch_add( 10 );
+	}
+
+	static void  Coroutine_Test4 ()
+	{
+		LocalTaskScheduler	scheduler	{1};
+		Atomic<uint>		counter		{0};
+
+		scheduler->AddThread( MakeShared<WorkerThread>() );
+
+		AsyncTask	task = Coroutine_Test4_Outer( &counter );
+		TEST( scheduler->Run( task ));
+
+		TEST( scheduler->Wait({ task }));
+		TEST( task->Status() == EStatus::Completed );
+		TEST( counter.load() == 12 );
+	}
+}
+
+
+extern void UnitTest_Coroutine ()
+{
+	Coroutine_Test1();
+	Coroutine_Test2();
+	Coroutine_Test3();
+	Coroutine_Test4();
+
+	AE_LOGI( "UnitTest_Coroutine - passed" );
+}
+
+#else
+
+extern void UnitTest_Coroutine ()
+{
+	AE_LOGI( "UnitTest_Coroutine - skipped, coroutines are not supported" );
+}
+
+#endif	// AE_STD_COROUTINE
@@ -0,0 +1,126 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "threading/Memory/EpochReclamation.h"
+#include "../stl/UnitTest_Common.h"
+using namespace AE::Threading;
+
+namespace
+{
+	static void  EpochReclamation_Test1 ()
+	{
+		EpochReclamation	ebr;
+		uint				slot0, slot1;
+		uint				released	= 0;
+
+		const auto	deleter = [] (void*, void* user) { ++*static_cast<uint*>(user); };
+
+		TEST( ebr.RegisterThread( OUT slot0 ));
+		TEST( ebr.RegisterThread( OUT slot1 ));
+		TEST( slot0 != slot1 );
+
+		// thread 1 is in critical section with current epoch
+		ebr.Enter( slot1 );
+
+		ebr.Retire( slot0, &released, deleter, &released );
+
+		TEST( ebr.TryAdvance() );
+		TEST( not ebr.TryAdvance() );	// thread 1 has not announced the new epoch
+		ebr.Collect( slot0 );
+		TEST( released == 0 );
+
+		// re-enter with new epoch
+		ebr.Enter( slot1 );		// nested, epoch is not changed
+		ebr.Leave( slot1 );
+		TEST( not ebr.TryAdvance() );
+
+		ebr.Leave( slot1 );
+		ebr.Enter( slot1 );
+		TEST( ebr.TryAdvance() );
+		ebr.Leave( slot1 );
+
+		ebr.Collect( slot0 );
+		TEST( released == 1 );
+
+		// memory from unregistered thread is released later
+		ebr.Retire( slot0, &released, deleter, &released );
+		ebr.UnregisterThread( slot0 );
+		TEST( released == 1 );
+
+		TEST( ebr.TryAdvance() );
+		TEST( ebr.TryAdvance() );
+		ebr.Collect( slot1 );
+		TEST( released == 2 );
+
+		// released in destructor
+		ebr.Retire( slot1, &released, deleter, &released );
+		ebr.UnregisterThread( slot1 );
+		ebr.Release();
+		TEST( released == 3 );
+	}
+
+
+	static void  EpochReclamation_Test2 ()
+	{
+		struct Node
+		{
+			Atomic<uint>	alive	{1};
+			Atomic<uint>	value	{0};
+
+			~Node ()	{ alive.store( 0 ); }
+		};
+
+		const uint			num_threads	= 4;
+		const uint			count		= 20'000;
+		EpochReclamation	ebr;
+		Atomic<Node*>		head		{ new Node{} };
+		Atomic<uint>		retired		{0};
+		Array<std::thread>	threads;
+
+		for (uint t = 0; t < num_threads; ++t)
+		{
+			threads.emplace_back( [&] ()
+			{
+				uint	slot;
+				TEST( ebr.RegisterThread( OUT slot ));
+
+				for (uint i = 0; i < count; ++i)
+				{
+					EpochReclamation::Guard	guard{ ebr, slot };
+
+					Node*	node = head.load( EMemoryOrder::Acquire );
+
+					// node must not be destroyed while thread is in critical section
+					TEST( node->alive.load() == 1 );
+					Unused( node->value.load() );
+
+					if ( (i & 7) == 0 )
+					{
+						Node*	old = head.exchange( new Node{}, EMemoryOrder::AcquireRelase );
+						ebr.Retire( slot, old );
+						retired.fetch_add( 1 );
+					}
+
+					TEST( node->alive.load() == 1 );
+				}
+
+				ebr.UnregisterThread( slot );
+			});
+		}
+
+		for (auto& t : threads) {
+			t.join();
+		}
+
+		TEST( retired.load() == num_threads * count / 8 );
+		delete head.exchange( null );
+	}
+}
+
+
+extern void UnitTest_EpochReclamation ()
+{
+	EpochReclamation_Test1();
+	EpochReclamation_Test2();
+
+	AE_LOGI( "UnitTest_EpochReclamation - passed" );
+}
@@ -0,0 +1,297 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "threading/Containers/LfCachedIndexedPool.h"
+#include "../stl/UnitTest_Common.h"
+using namespace AE::Threading;
+
+namespace
+{
+	// all values have the same hash
+	struct BadHash
+	{
+		uint	value	= 0;
+
+		BadHash () {}
+		BadHash (uint v) : value{v} {}
+
+		ND_ bool  operator == (const BadHash &rhs) const	{ return value == rhs.value; }
+	};
+}
+
+namespace std
+{
+	template <>
+	struct hash< BadHash > {
+		ND_ size_t  operator () (const BadHash &) const	{ return 0x12345678; }
+	};
+}
+
+namespace
+{
+	static void  LfCachedIndexedPool_Test1 ()
+	{
+		LfCachedIndexedPool< uint, uint, 64, 4 >	pool;
+
+		uint	slot;
+		TEST( pool.RegisterThread( OUT slot ));
+
+		uint	idx1, idx2;
+
+		TEST( pool.Assign( OUT idx1 ));
+		TEST( pool.Assign( OUT idx2 ));
+
+		TEST( pool.Insert( idx1, 2, slot ).second );
+		TEST( not pool.Insert( idx2, 2, slot ).second );
+		TEST( pool.Insert( idx2, 2, slot ).first == idx1 );
+
+		const uint	val = 2;
+		TEST( pool.Find( &val, slot ) == idx1 );
+
+		TEST( not pool.RemoveFromCache( idx2 ));
+		TEST( pool.RemoveFromCache( idx1 ));
+		TEST( pool.Find( &val, slot ) == UMax );
+
+		// value can be added again after removing
+		TEST( pool.AddToCache( idx2, slot ).second );
+		TEST( pool.Find( &val, slot ) == idx2 );
+
+		TEST( pool.RemoveFromCache( idx2 ));
+		pool.Unassign( idx2, slot );
+		pool.Unassign( idx1, slot );
+
+		// indices are returned to the pool later
+		TEST( pool.IsAssigned( idx1 ));
+		TEST( pool.IsAssigned( idx2 ));
+
+		pool.UnregisterThread( slot );
+	}
+
+
+	static void  LfCachedIndexedPool_Test2 ()
+	{
+		LfCachedIndexedPool< BadHash, uint, 64, 4 >	pool;
+		Array<uint>									indices;
+
+		uint	slot;
+		TEST( pool.RegisterThread( OUT slot ));
+
+		// windows will be filled and new levels will be created
+		for (uint i = 0; i < 40; ++i)
+		{
+			uint	idx;
+			TEST( pool.Assign( OUT idx ));
+			TEST( pool.Insert( idx, BadHash{i}, slot ).second );
+			indices.push_back( idx );
+		}
+
+		const BytesU	size = pool.DynamicSize();
+		TEST( size > 0 );
+
+		for (uint i = 0; i < 40; ++i)
+		{
+			const BadHash	key {i};
+			TEST( pool.Find( &key, slot ) == indices[i] );
+		}
+
+		// removed slots stay in table until new value is added
+		for (uint i = 0; i < 40; i += 2) {
+			TEST( pool.RemoveFromCache( indices[i] ));
+		}
+		for (uint i = 0; i < 40; ++i)
+		{
+			const BadHash	key {i};
+			TEST( pool.Find( &key, slot ) == (i & 1 ? indices[i] : UMax) );
+		}
+
+		TEST( pool.DynamicSize() == size );
+
+		// value in next slots must be found before removed slot is reused
+		for (uint i = 1; i < 40; i += 2)
+		{
+			uint	idx;
+			TEST( pool.Assign( OUT idx ));
+
+			auto	[cached, inserted] = pool.Insert( idx, BadHash{i}, slot );
+			TEST( not inserted );
+			TEST( cached == indices[i] );
+			pool.Unassign( idx );
+		}
+		TEST( pool.DynamicSize() == size );
+
+		pool.UnregisterThread( slot );
+	}
+
+
+	static void  LfCachedIndexedPool_Test3 ()
+	{
+		using Pool_t = LfCachedIndexedPool< uint, uint, 1024, 16 >;
+
+		const uint			num_threads	= 4;
+		const uint			count		= 2000;
+		Pool_t				pool;
+		Array<std::thread>	threads;
+		Array<uint>			result		[num_threads];
+
+		// all threads add same values, only one index must be cached for each value
+		for (uint t = 0; t < num_threads; ++t)
+		{
+			threads.emplace_back( [&pool, &res = result[t], t] ()
+			{
+				res.resize( count );
+
+				uint	slot;
+				TEST( pool.RegisterThread( OUT slot ));
+
+				for (uint i = 0; i < count; ++i)
+				{
+					const uint	value = (t & 1 ? count - i - 1 : i);
+					uint		idx;
+					TEST( pool.Assign( OUT idx ));
+
+					auto	[cached, inserted] = pool.Insert( idx, uint(value), slot );
+					TEST( cached != UMax );
+
+					if ( not inserted )
+						pool.Unassign( idx );
+
+					res[value] = cached;
+				}
+				pool.UnregisterThread( slot );
+			});
+		}
+
+		for (auto& t : threads) {
+			t.join();
+		}
+
+		uint	slot;
+		TEST( pool.RegisterThread( OUT slot ));
+
+		for (uint i = 0; i < count; ++i)
+		{
+			for (uint t = 1; t < num_threads; ++t) {
+				TEST( result[0][i] == result[t][i] );
+			}
+			TEST( pool.Find( &i, slot ) == result[0][i] );
+		}
+		pool.UnregisterThread( slot );
+	}
+
+
+	static void  LfCachedIndexedPool_Test4 ()
+	{
+		LfCachedIndexedPool< BadHash, uint, 64, 4 >	pool;
+		Array<uint>									indices;
+
+		uint	slot;
+		TEST( pool.RegisterThread( OUT slot ));
+
+		for (uint i = 0; i < 16; ++i)
+		{
+			uint	idx;
+			TEST( pool.Assign( OUT idx ));
+			TEST( pool.Insert( idx, BadHash{i}, slot ).second );
+			indices.push_back( idx );
+		}
+		const BytesU	size = pool.DynamicSize();
+
+		// all values share the same windows, removed slots must be reused, otherwise cache will be full
+		for (uint i = 16; i < 10'000; ++i)
+		{
+			const uint	j = i % 16;
+			TEST( pool.RemoveFromCache( indices[j] ));
+			pool.Unassign( indices[j], slot );
+
+			// retired indices are returned to the pool, otherwise pool will be exhausted
+			TEST( pool.Assign( OUT indices[j] ));
+			TEST( pool.Insert( indices[j], BadHash{i}, slot ).second );
+		}
+
+		for (uint j = 0; j < 16; ++j)
+		{
+			const BadHash	key {10'000 - 16 + j};
+			TEST( pool.Find( &key, slot ) == indices[ key.value % 16 ]);
+		}
+		TEST( pool.DynamicSize() == size );
+
+		pool.UnregisterThread( slot );
+	}
+
+
+	static void  LfCachedIndexedPool_Test5 ()
+	{
+		using Pool_t = LfCachedIndexedPool< uint, uint, 256, 4 >;
+
+		const uint			num_threads	= 4;
+		const uint			num_values	= 64;
+		const uint			count		= 20'000;
+		Pool_t				pool;
+		Array<std::thread>	threads;
+
+		// one thread removes values and reuses indices, other threads search values,
+		// index which is compared in 'Find()' can't be reused while reader is in critical section (check with thread sanitizer)
+		threads.emplace_back( [&pool] ()
+		{
+			uint	slot;
+			TEST( pool.RegisterThread( OUT slot ));
+
+			uint	indices [num_values];
+			for (uint i = 0; i < num_values; ++i)
+			{
+				TEST( pool.Assign( OUT indices[i] ));
+				TEST( pool.Insert( indices[i], uint(i), slot ).second );
+			}
+
+			for (uint i = 0; i < count; ++i)
+			{
+				const uint	j = i % num_values;
+				TEST( pool.RemoveFromCache( indices[j] ));
+				pool.Unassign( indices[j], slot );
+
+				TEST( pool.Assign( OUT indices[j] ));
+				TEST( pool.Insert( indices[j], uint(j + (i & 1 ? num_values : 0)), slot ).second );
+			}
+
+			for (uint i = 0; i < num_values; ++i)
+			{
+				TEST( pool.RemoveFromCache( indices[i] ));
+				pool.Unassign( indices[i], slot );
+			}
+			pool.UnregisterThread( slot );
+		});
+
+		for (uint t = 1; t < num_threads; ++t)
+		{
+			threads.emplace_back( [&pool, t] ()
+			{
+				uint	slot;
+				TEST( pool.RegisterThread( OUT slot ));
+
+				for (uint i = 0; i < count; ++i)
+				{
+					const uint	value	= (i * 7 + t) % (num_values * 2);
+					const uint	idx		= pool.Find( &value, slot );
+
+					TEST( idx == UMax or idx < Pool_t::capacity() );
+				}
+				pool.UnregisterThread( slot );
+			});
+		}
+
+		for (auto& t : threads) {
+			t.join();
+		}
+	}
+}
+
+
+extern void UnitTest_LfCachedIndexedPool ()
+{
+	LfCachedIndexedPool_Test1();
+	LfCachedIndexedPool_Test2();
+	LfCachedIndexedPool_Test3();
+	LfCachedIndexedPool_Test4();
+	LfCachedIndexedPool_Test5();
+
+	AE_LOGI( "UnitTest_LfCachedIndexedPool - passed" );
+}
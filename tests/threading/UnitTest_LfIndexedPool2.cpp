@@ -63,6 +63,73 @@ namespace
 		}
 		TEST( T::CheckStatistic() );
 	}
+
+
+	static void  LfIndexedPool2_Test3 ()
+	{
+		constexpr uint	count = 64*8;
+
+		using T = DebugInstanceCounter< int, 3 >;
+		using Pool_t = LfIndexedPool2< T, uint, 64, 8 >;
+	
+		T::ClearStatistic();
+		{
+			Pool_t					pool;
+			FixedArray< uint, 100 >	indices;
+
+			// batch
+			TEST( pool.Assign( 100, INOUT indices ) == 100 );
+			TEST( indices.size() == 100 );
+
+			for (uint idx : indices) {
+				TEST( pool.IsAssigned( idx ));
+			}
+
+			pool.Unassign( 40, INOUT indices );
+			TEST( indices.size() == 60 );
+			
+			for (uint i = 0; i < count; ++i) {
+				TEST( pool.IsAssigned( i ) == (i < 60) );
+			}
+
+			pool.Unassign( 60, INOUT indices );
+			TEST( indices.empty() );
+
+			// magazine
+			{
+				Pool_t::Magazine	mag {pool};
+				Array<uint>			assigned;
+
+				for (uint i = 0; i < count+1; ++i)
+				{
+					uint	index;
+					bool	res = mag.Assign( OUT index );
+
+					TEST( res == (i < count) );
+					if ( res ) {
+						TEST( pool.IsAssigned( index ));
+						assigned.push_back( index );
+					}
+				}
+
+				std::sort( assigned.begin(), assigned.end() );
+				TEST( std::unique( assigned.begin(), assigned.end() ) == assigned.end() );
+
+				for (uint index : assigned) {
+					mag.Unassign( index );
+				}
+				TEST( mag.size() <= Pool_t::Magazine::MaxIndices );
+
+				mag.Flush();
+				TEST( mag.size() == 0 );
+			}
+
+			for (uint i = 0; i < count; ++i) {
+				TEST( not pool.IsAssigned( i ));
+			}
+		}
+		TEST( T::CheckStatistic() );
+	}
 }
 
 
@@ -70,6 +137,7 @@ extern void UnitTest_LfIndexedPool2 ()
 {
 	LfIndexedPool2_Test1();
 	LfIndexedPool2_Test2();
+	LfIndexedPool2_Test3();
 
 	AE_LOGI( "UnitTest_LfIndexedPool2 - passed" );
 }
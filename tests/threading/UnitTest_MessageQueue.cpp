@@ -0,0 +1,188 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "threading/TaskSystem/MessageConsumer.h"
+#include "threading/TaskSystem/WorkerThread.h"
+#include "stl/Algorithms/StringUtils.h"
+#include "UnitTest_Common.h"
+
+namespace
+{
+	static void  MessageQueue_Test1 ()
+	{
+		MPSCMessageQueue< String, 8 >	queue;
+
+		TEST( queue.Empty() );
+		TEST( queue.Produce( "0"s ));
+		TEST( queue.Produce( "1"s ));
+		TEST( not queue.Empty() );
+
+		String	msg;
+		TEST( queue.Consume( OUT msg ));
+		TEST( msg == "0" );
+
+		const String	batch[] = { "2", "3", "4", "5", "6", "7", "8", "9", "10" };
+
+		// only 7 messages can be added
+		TEST( queue.Produce( ArrayView<String>{ batch }) == 7 );
+		TEST( not queue.Produce( "x"s ));
+
+		Array<String>	result;
+		TEST( queue.ConsumeAll( [&result] (String &&m) { result.push_back( std::move(m) ); }) == 8 );
+		TEST( queue.Empty() );
+		TEST( result.size() == 8 );
+
+		for (size_t i = 0; i < result.size(); ++i) {
+			TEST( result[i] == ToString( i+1 ));
+		}
+
+		// messages that are not consumed must be destroyed
+		auto	ptr = MakeShared<int>( 1 );
+		{
+			MPMCMessageQueue< SharedPtr<int>, 4 >	queue2;
+			TEST( queue2.Produce( ptr ));
+			TEST( queue2.Produce( ptr ));
+			TEST( ptr.use_count() == 3 );
+		}
+		TEST( ptr.use_count() == 1 );
+	}
+
+
+	template <bool MultiConsumer>
+	static void  MessageQueue_Test2 ()
+	{
+		struct Message
+		{
+			uint	producer;
+			uint	index;
+		};
+
+		using Queue_t = MessageQueue< Message, 1u << 8, MultiConsumer >;
+
+		const uint			num_producers	= 3;
+		const uint			num_consumers	= MultiConsumer ? 3 : 1;
+		const uint			count			= 20'000;
+		Queue_t				queue;
+		Atomic<uint>		consumed		{0};
+		Atomic<uint64_t>	checksum		{0};
+		Atomic<bool>		ordered			{true};
+		Array<std::thread>	threads;
+
+		for (uint p = 0; p < num_producers; ++p)
+		{
+			threads.emplace_back( [&queue, p] ()
+			{
+				for (uint i = 0; i < count;)
+				{
+					if ( i % 3 == 0 )
+					{
+						const Message	batch[] = { {p, i}, {p, i+1}, {p, i+2} };
+						i += uint(queue.Produce( ArrayView<Message>{ batch, Min( 3u, count - i )}));
+					}
+					else
+					if ( queue.Produce( Message{ p, i }))
+						++i;
+
+					std::this_thread::yield();
+				}
+			});
+		}
+
+		for (uint c = 0; c < num_consumers; ++c)
+		{
+			threads.emplace_back( [&] ()
+			{
+				StaticArray< uint, num_producers >	last_index;
+				last_index.fill( 0 );
+
+				for (; consumed.load() < count * num_producers;)
+				{
+					const size_t	n = queue.ConsumeAll( [&] (Message &&msg)
+						{
+							// messages from one producer must be consumed in the same order
+							if ( not MultiConsumer and msg.index != last_index[ msg.producer ]++ )
+								ordered.store( false );
+
+							checksum.fetch_add( msg.index );
+						});
+					consumed.fetch_add( uint(n) );
+
+					if ( n == 0 )
+						std::this_thread::yield();
+				}
+			});
+		}
+
+		for (auto& t : threads) {
+			t.join();
+		}
+
+		TEST( queue.Empty() );
+		TEST( ordered.load() );
+		TEST( consumed.load() == count * num_producers );
+		TEST( checksum.load() == uint64_t(count - 1) * count / 2 * num_producers );
+	}
+
+
+	static void  MessageQueue_Test3 ()
+	{
+		LocalTaskScheduler	scheduler	{2};
+
+		scheduler->AddThread( MakeShared<WorkerThread>() );
+		scheduler->AddThread( MakeShared<WorkerThread>() );
+
+		const uint					count		= 10'000;
+		Atomic<uint>				consumed	{0};
+		Atomic<uint>				active		{0};
+		Atomic<bool>				exclusive	{true};
+		MPSCMessageQueue< uint >	queue;
+		Array<std::thread>			threads;
+		{
+			MessageConsumer< MPSCMessageQueue< uint >>	consumer{ queue, [&] (uint &&)
+				{
+					// only one consumer task must be active
+					if ( active.fetch_add( 1 ) != 0 )
+						exclusive.store( false );
+
+					consumed.fetch_add( 1 );
+					active.fetch_sub( 1 );
+				}};
+
+			for (uint p = 0; p < 2; ++p)
+			{
+				threads.emplace_back( [&consumer] ()
+				{
+					for (uint i = 0; i < count;)
+					{
+						if ( consumer.Produce( i ))
+							++i;
+						else
+							std::this_thread::yield();
+					}
+				});
+			}
+
+			for (auto& t : threads) {
+				t.join();
+			}
+
+			for (uint i = 0; i < 1000 and consumed.load() < count * 2; ++i) {
+				std::this_thread::sleep_for( std::chrono::milliseconds{1} );
+			}
+		}
+
+		TEST( exclusive.load() );
+		TEST( consumed.load() == count * 2 );
+		TEST( queue.Empty() );
+	}
+}
+
+
+extern void UnitTest_MessageQueue ()
+{
+	MessageQueue_Test1();
+	MessageQueue_Test2< false >();
+	MessageQueue_Test2< true >();
+	MessageQueue_Test3();
+
+	AE_LOGI( "UnitTest_MessageQueue - passed" );
+}
@@ -0,0 +1,75 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "threading/TaskSystem/ParallelFor.h"
+#include "threading/TaskSystem/WorkerThread.h"
+#include "UnitTest_Common.h"
+
+
+namespace
+{
+	static void  ParallelFor_Test1 (uint numThreads)
+	{
+		LocalTaskScheduler	scheduler	{numThreads};
+
+		for (uint i = 0; i < numThreads; ++i) {
+			scheduler->AddThread( MakeShared<WorkerThread>() );
+		}
+
+		const size_t			count = 10'000;
+		Array< Atomic<uint> >	visited ( count );
+
+		for (auto& v : visited) { v.store( 0 ); }
+
+		// per element
+		ParallelFor( 0, count, 16, [&visited] (size_t i) { visited[i].fetch_add( 1 ); });
+
+		// per range
+		ParallelFor( 0, count, 100, [&visited] (size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++i) {
+					visited[i].fetch_add( 1 );
+				}
+			});
+
+		for (auto& v : visited) {
+			TEST( v.load() == 2 );
+		}
+
+		// empty range
+		ParallelFor( 10, 10, 1, [] (size_t) { TEST(false); });
+	}
+
+
+	static void  ParallelReduce_Test1 (uint numThreads)
+	{
+		LocalTaskScheduler	scheduler	{numThreads};
+
+		for (uint i = 0; i < numThreads; ++i) {
+			scheduler->AddThread( MakeShared<WorkerThread>() );
+		}
+
+		const size_t	count	= 100'000;
+		const uint64_t	sum		= ParallelReduce( 0, count, 64, uint64_t(0),
+									[] (size_t i) { return uint64_t(i); },
+									[] (uint64_t lhs, uint64_t rhs) { return lhs + rhs; });
+		TEST( sum == uint64_t(count) * (count - 1) / 2 );
+
+		const uint64_t	max		= ParallelReduce( 0, count, 1000, uint64_t(0),
+									[] (size_t begin, size_t end) { return uint64_t(end - 1); Unused( begin ); },
+									[] (uint64_t lhs, uint64_t rhs) { return Max( lhs, rhs ); });
+		TEST( max == count - 1 );
+	}
+}
+
+
+extern void UnitTest_ParallelFor ()
+{
+	// without worker threads all tasks will be executed in current thread
+	ParallelFor_Test1( 0 );
+	ParallelFor_Test1( 2 );
+
+	ParallelReduce_Test1( 0 );
+	ParallelReduce_Test1( 2 );
+
+	AE_LOGI( "UnitTest_ParallelFor - passed" );
+}
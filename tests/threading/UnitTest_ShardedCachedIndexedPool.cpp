@@ -0,0 +1,165 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "threading/Containers/ShardedCachedIndexedPool.h"
+#include "../stl/UnitTest_Common.h"
+using namespace AE::Threading;
+
+namespace
+{
+	struct Value
+	{
+		Atomic<uint>	key		{0};
+		Atomic<bool>	alive	{false};
+
+		Value () {}
+		Value (uint k) : key{k}, alive{true} {}
+		Value (Value &&other) : key{other.key.load()}, alive{other.alive.load()} {}
+
+		Value&  operator = (Value &&rhs)		{ key.store( rhs.key.load() );  alive.store( rhs.alive.load() );  return *this; }
+
+		ND_ bool  operator == (const Value &rhs) const
+		{
+			// value must not be destroyed while it is used by reader
+			TEST( alive.load() and rhs.alive.load() );
+			return key.load() == rhs.key.load();
+		}
+	};
+}
+
+namespace std
+{
+	template <>
+	struct hash< Value > {
+		ND_ size_t  operator () (const Value &v) const	{ return size_t(v.key.load()) * 0x9E3779B97F4A7C15ull; }
+	};
+}
+
+namespace
+{
+	static void  ShardedCachedIndexedPool_Test1 ()
+	{
+		ShardedCachedIndexedPool< uint, uint, 64, 4 >	pool;
+
+		uint	idx1, idx2;
+
+		TEST( pool.Assign( OUT idx1 ));
+		TEST( pool.Assign( OUT idx2 ));
+
+		TEST( pool.Insert( idx1, 2 ).second );
+		TEST( not pool.Insert( idx2, 2 ).second );
+		TEST( pool.Insert( idx2, 2 ).first == idx1 );
+
+		const uint	val = 2;
+		TEST( pool.Find( &val ) == idx1 );
+
+		TEST( not pool.RemoveFromCache( idx2 ));
+		TEST( pool.RemoveFromCache( idx1 ));
+		TEST( pool.Find( &val ) == UMax );
+
+		// value can be added again after removing
+		TEST( pool.AddToCache( idx2 ).second );
+		TEST( pool.Find( &val ) == idx2 );
+
+		// table will be rebuilt many times
+		Array<uint>	indices;
+		for (uint i = 0; i < 200; ++i)
+		{
+			uint	idx;
+			TEST( pool.Assign( OUT idx ));
+			TEST( pool.Insert( idx, i + 100 ).second );
+			indices.push_back( idx );
+		}
+		for (uint i = 0; i < 200; i += 2) {
+			TEST( pool.RemoveFromCache( indices[i] ));
+		}
+		for (uint i = 0; i < 200; ++i)
+		{
+			const uint	key = i + 100;
+			TEST( pool.Find( &key ) == (i & 1 ? indices[i] : UMax) );
+		}
+
+		auto	stat = pool.GetStatistic();
+		AE_CACHED_POOL_STATISTIC(
+			TEST( stat.hits == 102 );
+			TEST( stat.misses == 101 );
+		)
+		TEST( stat.contended == 0 );
+	}
+
+
+	static void  ShardedCachedIndexedPool_Test2 ()
+	{
+		using Pool_t = ShardedCachedIndexedPool< Value, uint, 1024, 16, UntypedAlignedAllocator, 4 >;
+
+		const uint			num_writers	= 2;
+		const uint			num_readers	= 4;
+		const uint			count		= 1000;
+		Pool_t				pool;
+		Atomic<bool>		looping		{true};
+		Atomic<uint>		hits		{0};
+		Array<std::thread>	threads;
+
+		// writers add and remove values, value is destroyed after removing from cache
+		for (uint t = 0; t < num_writers; ++t)
+		{
+			threads.emplace_back( [&pool, t] ()
+			{
+				for (uint j = 0; j < 20; ++j)
+				{
+					Array<uint>	indices;
+					for (uint i = t; i < count; i += num_writers)
+					{
+						uint	idx;
+						TEST( pool.Assign( OUT idx ));
+						TEST( pool.Insert( idx, Value{i} ).second );
+						indices.push_back( idx );
+					}
+					for (uint idx : indices)
+					{
+						TEST( pool.RemoveFromCache( idx ));
+						pool[idx].alive.store( false );
+						pool.Unassign( idx );
+					}
+				}
+			});
+		}
+
+		for (uint t = 0; t < num_readers; ++t)
+		{
+			threads.emplace_back( [&] ()
+			{
+				for (uint i = 0; looping.load(); i = (i + 7) % count)
+				{
+					const Value	key {i};
+					const uint	idx = pool.Find( &key );
+
+					if ( idx != UMax )
+						hits.fetch_add( 1 );
+				}
+			});
+		}
+
+		for (uint t = 0; t < num_writers; ++t) {
+			threads[t].join();
+		}
+		looping.store( false );
+
+		for (uint t = num_writers; t < threads.size(); ++t) {
+			threads[t].join();
+		}
+
+		AE_CACHED_POOL_STATISTIC(
+			TEST( pool.GetStatistic().hits == hits.load() );
+		)
+		TEST( pool.empty() );
+	}
+}
+
+
+extern void UnitTest_ShardedCachedIndexedPool ()
+{
+	ShardedCachedIndexedPool_Test1();
+	ShardedCachedIndexedPool_Test2();
+
+	AE_LOGI( "UnitTest_ShardedCachedIndexedPool - passed" );
+}
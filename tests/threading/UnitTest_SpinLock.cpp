@@ -0,0 +1,101 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "threading/Primitives/SpinLock.h"
+#include "threading/Primitives/RWSpinLock.h"
+#include "../stl/UnitTest_Common.h"
+using namespace AE::Threading;
+
+namespace
+{
+	// more threads than CPU cores, lock holder will be preempted
+	static void  SpinLock_Test1 ()
+	{
+		const uint			num_threads	= Max( 8u, std::thread::hardware_concurrency() * 4 );
+		const uint			count		= 20'000;
+		SpinLock			lock;
+		uint				value		= 0;
+		Array<std::thread>	threads;
+
+		for (uint t = 0; t < num_threads; ++t)
+		{
+			threads.emplace_back( [&] ()
+			{
+				for (uint i = 0; i < count; ++i)
+				{
+					EXLOCK( lock );
+					++value;
+				}
+			});
+		}
+
+		for (auto& t : threads) {
+			t.join();
+		}
+
+		TEST( value == num_threads * count );
+	}
+
+
+	static void  RWSpinLock_Test1 ()
+	{
+		const uint			num_threads	= Max( 8u, std::thread::hardware_concurrency() * 4 );
+		const uint			count		= 20'000;
+		RWSpinLock			lock;
+		uint				value1		= 0;
+		uint				value2		= 0;
+		Atomic<uint>		reads		{0};
+		Array<std::thread>	threads;
+
+		for (uint t = 0; t < num_threads; ++t)
+		{
+			threads.emplace_back( [&, t] ()
+			{
+				uint	local_reads = 0;
+				for (uint i = 0; i < count; ++i)
+				{
+					if ( ((i + t) & 3) == 0 )
+					{
+						EXLOCK( lock );
+						++value1;
+						++value2;
+					}
+					else
+					if ( ((i + t) & 3) == 1 )
+					{
+						// writer downgrades to reader, parked readers must be woken up
+						lock.lock();
+						++value1;
+						++value2;
+						lock.exclusive_to_shared();
+						TEST( value1 == value2 );
+						lock.unlock_shared();
+					}
+					else
+					{
+						SHAREDLOCK( lock );
+						TEST( value1 == value2 );
+						++local_reads;
+					}
+				}
+				reads.fetch_add( local_reads );
+			});
+		}
+
+		for (auto& t : threads) {
+			t.join();
+		}
+
+		TEST( value1 == num_threads * count / 2 );
+		TEST( value2 == value1 );
+		TEST( reads.load() == num_threads * count / 2 );
+	}
+}
+
+
+extern void UnitTest_SpinLock ()
+{
+	SpinLock_Test1();
+	RWSpinLock_Test1();
+
+	AE_LOGI( "UnitTest_SpinLock - passed" );
+}
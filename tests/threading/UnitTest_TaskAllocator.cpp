@@ -0,0 +1,88 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "threading/TaskSystem/TaskScheduler.h"
+#include "UnitTest_Common.h"
+
+
+namespace
+{
+	class SmallTask final : public IAsyncTask
+	{
+	public:
+		SmallTask () : IAsyncTask{ EThread::Worker } {}
+		void Run () override {}
+	};
+
+	class LargeTask final : public IAsyncTask
+	{
+	public:
+		uint8_t		data [TaskAllocator::MaxBlockSize];
+
+		LargeTask () : IAsyncTask{ EThread::Worker } {}
+		void Run () override {}
+	};
+
+
+	static void  TaskAllocator_Test1 ()
+	{
+		// warm up thread cache
+		{
+			AsyncTask	task = MakeTask<SmallTask>();
+		}
+		TaskAllocator::ResetStatistic();
+
+		// freed block must be reused
+		for (uint i = 0; i < 100; ++i)
+		{
+			AsyncTask	task = MakeTask<SmallTask>();
+			TEST( CheckPointerAlignment<SmallTask>( task.get() ));
+		}
+
+		auto	stat = TaskAllocator::GetStatistic();
+		TEST( stat.hits == 100 );
+		TEST( stat.misses == 0 );
+
+		// too large for the pool
+		{
+			AsyncTask	task = MakeTask<LargeTask>();
+		}
+		stat = TaskAllocator::GetStatistic();
+		TEST( stat.misses == 1 );
+	}
+
+
+	static void  TaskAllocator_Test2 ()
+	{
+		const uint			count = 1000;
+		Array<AsyncTask>	tasks;
+
+		for (uint i = 0; i < count; ++i) {
+			tasks.push_back( MakeTask<SmallTask>() );
+		}
+
+		// tasks are freed in another thread, blocks are returned to the global pool when thread exits
+		std::thread		thread{ [&tasks] () { tasks.clear(); }};
+		thread.join();
+		TEST( tasks.empty() );
+
+		TaskAllocator::ResetStatistic();
+
+		for (uint i = 0; i < count; ++i) {
+			tasks.push_back( MakeTask<SmallTask>() );
+		}
+		tasks.clear();
+
+		const auto	stat = TaskAllocator::GetStatistic();
+		TEST( stat.hits == count );
+		TEST( stat.misses == 0 );
+	}
+}
+
+
+extern void UnitTest_TaskAllocator ()
+{
+	TaskAllocator_Test1();
+	TaskAllocator_Test2();
+
+	AE_LOGI( "UnitTest_TaskAllocator - passed" );
+}
@@ -190,9 +190,8 @@ namespace
 		{
 			Test4_CustomDep		dep;
 			AsyncTask			task;
-			uint				bitIndex;
 
-			TaskDependency (const Test4_CustomDep &dep, const AsyncTask &task, uint index) : dep{dep}, task{task}, bitIndex{index} {}
+			TaskDependency (const Test4_CustomDep &dep, const AsyncTask &task) : dep{dep}, task{task} {}
 		};
 			
 		class UpdateTask : public IAsyncTask
@@ -223,7 +222,7 @@ namespace
 			{
 				if ( iter->dep.flagRef->load() )
 				{
-					_SetDependencyCompletionStatus( iter->task, iter->bitIndex, false );
+					_SetDependencyCompletionStatus( iter->task, false );
 					iter = _depsList.erase( iter );
 				}
 				else
@@ -234,13 +233,13 @@ namespace
 				Scheduler().Run<UpdateTask>( Tuple{Cast<Test4_TaskDepManager>(shared_from_this())} );
 		}
 
-		bool  Resolve (AnyTypeCRef dep, const AsyncTask &task, INOUT uint &bitIndex) override
+		bool  Resolve (AnyTypeCRef dep, const AsyncTask &task, INOUT uint &depCount) override
 		{
 			CHECK_ERR( dep.Is<Test4_CustomDep>() );
 			EXLOCK( _depsListGuard );
 
-			_depsList.emplace_back( dep.As<Test4_CustomDep>(), task, bitIndex );
-			++bitIndex;
+			_depsList.emplace_back( dep.As<Test4_CustomDep>(), task );
+			++depCount;
 
 			if ( _depsList.size() == 1 )
 				Scheduler().Run<UpdateTask>( Tuple{Cast<Test4_TaskDepManager>(shared_from_this())} );
@@ -440,6 +439,148 @@ namespace
 
 		TEST( shared.values.size() == total_tasks/3 );
 	}
+//-----------------------------------------------------------------------------
+
+
+
+	class Test6_Task : public IAsyncTask
+	{
+	public:
+		Array<uint>&	order;
+		const uint		id;
+
+		Test6_Task (Array<uint> &order, uint id) : IAsyncTask{ EThread::Worker }, order{order}, id{id} {}
+
+		void Run () override
+		{
+			order.push_back( id );
+		}
+	};
+
+	static void  TaskDeps_Test6 ()
+	{
+		LocalTaskScheduler	scheduler	{1};
+		Array<uint>			order;		// tasks are executed only in current thread
+
+		// blocked tasks are added before ready task, they must not be pulled from queue
+		AsyncTask			root	= MakeShared<Test6_Task>( order, 0 );
+		Array<AsyncTask>	level1;
+
+		for (uint i = 0; i < 8; ++i) {
+			level1.push_back( scheduler->Run<Test6_Task>( Tuple{std::ref(order), 1u}, Tuple{root} ));
+		}
+		AsyncTask			last	= scheduler->Run<Test6_Task>( Tuple{std::ref(order), 2u}, Tuple{level1[0], level1[3], level1[7]} );
+
+		// it is the only ready task
+		TEST( scheduler->Run( root ));
+		TEST( scheduler->ProcessTask( IAsyncTask::EThread::Worker, 0 ));
+		TEST( order.size() == 1 and order[0] == 0 );
+
+		for (uint i = 0; i < 8; ++i) {
+			TEST( scheduler->ProcessTask( IAsyncTask::EThread::Worker, i ));
+		}
+		TEST( scheduler->ProcessTask( IAsyncTask::EThread::Worker, 0 ));
+		TEST( not scheduler->ProcessTask( IAsyncTask::EThread::Worker, 0 ));
+
+		TEST( order.size() == 10 );
+		TEST( order.back() == 2 );
+		for (uint i = 1; i < 9; ++i) {
+			TEST( order[i] == 1 );
+		}
+		TEST( last->Status() == IAsyncTask::EStatus::Completed );
+	}
+//-----------------------------------------------------------------------------
+
+
+
+	class Test7_Task : public IAsyncTask
+	{
+	public:
+		Atomic<uint>&	counter;
+
+		Test7_Task (Atomic<uint> &counter) : IAsyncTask{ EThread::Worker }, counter{counter} {}
+
+		void Run () override
+		{
+			counter.fetch_add( 1 );
+		}
+	};
+
+	static void  TaskDeps_Test7 ()
+	{
+		LocalTaskScheduler	scheduler	{4};
+		Atomic<uint>		counter		{0};
+		const uint			count		= 1000;
+
+		AsyncTask			root		= MakeShared<Test7_Task>( counter );
+		Array<AsyncTask>	batch1;
+		Array<AsyncTask>	batch2;
+
+		for (uint i = 0; i < count; ++i) {
+			batch1.push_back( MakeShared<Test7_Task>( counter ));
+			batch2.push_back( MakeShared<Test7_Task>( counter ));
+		}
+
+		// batch1 is blocked by root, batch2 is ready
+		TEST( scheduler->RunBatch( batch1, Tuple{root} ));
+		TEST( scheduler->RunBatch( batch2 ));
+		TEST( scheduler->Run( root ));
+
+		scheduler->AddThread( MakeShared<WorkerThread>() );
+		scheduler->AddThread( MakeShared<WorkerThread>() );
+
+		TEST( scheduler->Wait( batch1 ));
+		TEST( scheduler->Wait( batch2 ));
+		TEST( counter.load() == count*2 + 1 );
+	}
+//-----------------------------------------------------------------------------
+
+
+
+	static void  TaskDeps_Test8 ()
+	{
+		LocalTaskScheduler	scheduler	{4};
+		Atomic<uint>		counter		{0};
+		const uint			count		= 300;
+
+		scheduler->AddThread( MakeShared<WorkerThread>() );
+
+		// many threads add output dependencies to the same task while it may be completing
+		AsyncTask				root	= MakeShared<Test7_Task>( counter );
+		StaticArray< Array<AsyncTask>, 4 >	consumers;
+		StaticArray< std::thread, 4 >		threads;
+
+		for (size_t t = 0; t < threads.size(); ++t)
+		{
+			threads[t] = std::thread{ [&, t] ()
+				{
+					for (uint i = 0; i < count; ++i) {
+						consumers[t].push_back( Scheduler().Run<Test7_Task>( Tuple{std::ref(counter)}, Tuple{root} ));
+					}
+				}};
+		}
+
+		TEST( scheduler->Run( root ));
+
+		for (auto& t : threads) {
+			t.join();
+		}
+
+		// more than 64 input dependencies
+		Array<AsyncTask>	inputs;
+		for (auto& c : consumers) {
+			inputs.insert( inputs.end(), c.begin(), c.end() );
+		}
+
+		AsyncTask	last = scheduler->Run<Test7_Task>( Tuple{std::ref(counter)}, Tuple{StrongDepArray{inputs}} );
+
+		TEST( scheduler->Wait({ last }));
+		TEST( counter.load() == count * 4 + 2 );
+
+		for (auto& task : inputs) {
+			TEST( task->Status() == IAsyncTask::EStatus::Completed );
+		}
+	}
 }
 
 
@@ -450,6 +591,9 @@ extern void UnitTest_TaskDeps ()
 	TaskDeps_Test3();
 	TaskDeps_Test4();
 	TaskDeps_Test5();
+	TaskDeps_Test6();
+	TaskDeps_Test7();
+	TaskDeps_Test8();
 
 	AE_LOGI( "UnitTest_TaskDeps - passed" );
 }
@@ -0,0 +1,192 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "threading/TaskSystem/TaskGraph.h"
+#include "threading/TaskSystem/WorkerThread.h"
+#include "UnitTest_Common.h"
+
+namespace
+{
+	using EStatus = IAsyncTask::EStatus;
+
+
+	class OrderTask final : public IAsyncTask
+	{
+	public:
+		Atomic<uint>&	counter;
+		Atomic<uint>	order	{0};
+		const bool		fail;
+
+		OrderTask (Atomic<uint> &counter, bool fail = false) : IAsyncTask{ EThread::Worker }, counter{counter}, fail{fail} {}
+
+		void Run () override
+		{
+			order.store( counter.fetch_add( 1 ));
+
+			if ( fail )
+				OnFailure();
+		}
+	};
+
+	ND_ static uint  OrderOf (const AsyncTask &task)
+	{
+		return Cast<OrderTask>( task )->order.load();
+	}
+
+
+	static void  TaskGraph_Test1 ()
+	{
+		LocalTaskScheduler	scheduler	{2};
+		Atomic<uint>		counter		{0};
+		TaskGraph			graph;
+
+		scheduler->AddThread( MakeShared<WorkerThread>() );
+		scheduler->AddThread( MakeShared<WorkerThread>() );
+
+		// diamond
+		const uint	a = graph.Add( MakeTask<OrderTask>( counter ));
+		const uint	b = graph.Add( MakeTask<OrderTask>( counter ), {a} );
+		const uint	c = graph.Add( MakeTask<OrderTask>( counter ), {a} );
+		const uint	d = graph.Add( MakeTask<OrderTask>( counter ), {b, c} );
+		TEST( a != UMax and b != UMax and c != UMax and d != UMax );
+
+		for (uint i = 0; i < 100; ++i)
+		{
+			counter.store( 0 );
+
+			TEST( graph.Run() );
+			TEST( graph.Wait() );
+			TEST( graph.IsFinished() );
+
+			for (auto& task : graph.Tasks()) {
+				TEST( task->Status() == EStatus::Completed );
+			}
+
+			TEST( OrderOf( graph[a] ) == 0 );
+			TEST( OrderOf( graph[b] ) < OrderOf( graph[d] ));
+			TEST( OrderOf( graph[c] ) < OrderOf( graph[d] ));
+			TEST( OrderOf( graph[d] ) == 3 );
+		}
+	}
+
+
+	static void  TaskGraph_Test2 ()
+	{
+		LocalTaskScheduler	scheduler	{1};
+		Atomic<uint>		counter		{0};
+		TaskGraph			graph;
+
+		// strong dependency on failed task
+		const uint	a = graph.Add( MakeTask<OrderTask>( counter, true ));
+		const uint	b = graph.Add( MakeTask<OrderTask>( counter ), {a}, true );
+		const uint	c = graph.Add( MakeTask<OrderTask>( counter ), {a}, false );
+		const uint	d = graph.Add( MakeTask<OrderTask>( counter ), {b} );
+
+		for (uint i = 0; i < 3; ++i)
+		{
+			TEST( graph.Run() );
+			TEST( graph.Wait() );
+
+			TEST( graph[a]->Status() == EStatus::Failed );
+			TEST( graph[b]->Status() == EStatus::Canceled );
+			TEST( graph[c]->Status() == EStatus::Completed );
+			TEST( graph[d]->Status() == EStatus::Canceled );
+		}
+	}
+
+
+	static void  TaskGraph_Test3 ()
+	{
+		LocalTaskScheduler	scheduler	{1};
+		Atomic<uint>		counter		{0};
+		TaskGraph			graph;
+
+		scheduler->AddThread( MakeShared<WorkerThread>() );
+
+		const uint	a = graph.Add( MakeTask<OrderTask>( counter ));
+		const uint	b = graph.Add( MakeTask<OrderTask>( counter ), {a} );
+
+		for (uint i = 0; i < 10; ++i)
+		{
+			// external dependencies
+			AsyncTask	before	= MakeTask<OrderTask>( counter );
+			TEST( graph.Run( Tuple{before} ));
+			AsyncTask	after	= scheduler->Run<OrderTask>( Tuple{std::ref(counter)}, Tuple{graph[b]} );
+			TEST( scheduler->Run( before ));
+
+			TEST( scheduler->Wait({ after }));
+			TEST( graph.Wait() );
+			TEST( graph.IsFinished() );
+
+			TEST( OrderOf( before ) < OrderOf( graph[a] ));
+			TEST( OrderOf( graph[a] ) < OrderOf( graph[b] ));
+			TEST( OrderOf( graph[b] ) < OrderOf( after ));
+		}
+	}
+
+
+	static void  TaskGraph_Test4 ()
+	{
+		LocalTaskScheduler	scheduler	{1};
+		Atomic<uint>		counter		{0};
+		TaskGraph			graph;
+
+		const uint	a = graph.Add( MakeTask<OrderTask>( counter ));
+		const uint	b = graph.Add( MakeTask<OrderTask>( counter ), {a} );
+
+		TEST( graph.Run() );
+		TEST( graph.Wait() );
+		TEST( OrderOf( graph[a] ) < OrderOf( graph[b] ));
+
+		// tasks can be moved to another graph with different dependencies
+		AsyncTask	task_a	= graph[a];
+		AsyncTask	task_b	= graph[b];
+		graph.Clear();
+
+		TaskGraph	graph2;
+		const uint	b2 = graph2.Add( task_b );
+		const uint	a2 = graph2.Add( task_a, {b2} );
+
+		TEST( graph2.Run() );
+		TEST( graph2.Wait() );
+		TEST( OrderOf( graph2[b2] ) < OrderOf( graph2[a2] ));
+	}
+
+
+	static void  TaskGraph_Test5 ()
+	{
+		LocalTaskScheduler	scheduler	{2};
+		Atomic<uint>		counter		{0};
+
+		scheduler->AddThread( MakeShared<WorkerThread>() );
+		scheduler->AddThread( MakeShared<WorkerThread>() );
+
+		// graph is destroyed right after 'Wait()', when the last tasks may still notify it in another thread
+		for (uint i = 0; i < 1000; ++i)
+		{
+			TaskGraph	graph;
+			Array<uint>	deps;
+
+			const uint	a = graph.Add( MakeTask<OrderTask>( counter ));
+			for (uint j = 0; j < 8; ++j) {
+				deps.push_back( graph.Add( MakeTask<OrderTask>( counter ), {a} ));
+			}
+			TEST( graph.Add( MakeTask<OrderTask>( counter ), deps ) != UMax );
+
+			TEST( graph.Run() );
+			TEST( graph.Wait() );
+			TEST( graph.IsFinished() );
+		}
+	}
+}
+
+
+extern void UnitTest_TaskGraph ()
+{
+	TaskGraph_Test1();
+	TaskGraph_Test2();
+	TaskGraph_Test3();
+	TaskGraph_Test4();
+	TaskGraph_Test5();
+
+	AE_LOGI( "UnitTest_TaskGraph - passed" );
+}
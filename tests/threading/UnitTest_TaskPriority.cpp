@@ -0,0 +1,154 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "threading/TaskSystem/TaskScheduler.h"
+#include "UnitTest_Common.h"
+
+
+namespace
+{
+	using EPriority = IAsyncTask::EPriority;
+
+
+	class PriorityTask : public IAsyncTask
+	{
+	public:
+		Array<uint>&	order;		// tasks are executed only in current thread
+		const uint		id;
+
+		PriorityTask (Array<uint> &order, uint id, EPriority priority) :
+			IAsyncTask{ EThread::Worker, priority }, order{order}, id{id}
+		{}
+
+		PriorityTask (Array<uint> &order, uint id, EPriority priority, Nanoseconds deadline) :
+			PriorityTask{ order, id, priority }
+		{
+			SetDeadline( TimePoint_t::clock::now() + deadline );
+		}
+
+		void Run () override
+		{
+			order.push_back( id );
+		}
+	};
+
+
+	static void  ProcessAll (Array<uint> &order, size_t count)
+	{
+		while ( Scheduler().ProcessTask( IAsyncTask::EThread::Worker, 0 )) {}
+		TEST( order.size() == count );
+	}
+
+
+	static void  TaskPriority_Test1 ()
+	{
+		TaskScheduler::Settings	settings;
+		settings.priorityAging = {};
+
+		LocalTaskScheduler	scheduler	{settings};
+		Array<uint>			order;
+
+		TEST( scheduler->Run<PriorityTask>( Tuple{std::ref(order), 0u, EPriority::Background} ));
+		TEST( scheduler->Run<PriorityTask>( Tuple{std::ref(order), 1u, EPriority::Normal} ));
+		TEST( scheduler->Run<PriorityTask>( Tuple{std::ref(order), 2u, EPriority::Background} ));
+		TEST( scheduler->Run<PriorityTask>( Tuple{std::ref(order), 3u, EPriority::High} ));
+		TEST( scheduler->Run<PriorityTask>( Tuple{std::ref(order), 4u, EPriority::Normal} ));
+
+		ProcessAll( order, 5 );
+		TEST(( order == Array<uint>{ 3, 1, 4, 0, 2 }));
+	}
+
+
+	static void  TaskPriority_Test2 ()
+	{
+		TaskScheduler::Settings	settings;
+		settings.priorityAging = std::chrono::milliseconds{1};
+
+		LocalTaskScheduler	scheduler	{settings};
+		Array<uint>			order;
+
+		// background task is waiting long enough to be promoted to high priority
+		TEST( scheduler->Run<PriorityTask>( Tuple{std::ref(order), 0u, EPriority::Background} ));
+		std::this_thread::sleep_for( std::chrono::milliseconds{5} );
+
+		TEST( scheduler->Run<PriorityTask>( Tuple{std::ref(order), 1u, EPriority::Normal} ));
+
+		ProcessAll( order, 2 );
+		TEST(( order == Array<uint>{ 0, 1 }));
+	}
+
+
+	static void  TaskPriority_Test3 ()
+	{
+		TaskScheduler::Settings	settings;
+		settings.priorityAging	= {};
+		settings.deadlineMargin	= std::chrono::milliseconds{10};
+
+		LocalTaskScheduler	scheduler	{settings};
+		Array<uint>			order;
+
+		TEST( scheduler->Run<PriorityTask>( Tuple{std::ref(order), 0u, EPriority::Normal} ));
+		TEST( scheduler->Run<PriorityTask>( Tuple{std::ref(order), 1u, EPriority::Background, Nanoseconds{std::chrono::seconds{10}}} ));
+		TEST( scheduler->Run<PriorityTask>( Tuple{std::ref(order), 2u, EPriority::Background, Nanoseconds{std::chrono::milliseconds{1}}} ));
+
+		ProcessAll( order, 3 );
+		TEST(( order == Array<uint>{ 2, 0, 1 }));
+	}
+
+
+	static void  TaskPriority_Test4 ()
+	{
+		TaskScheduler::Settings	settings;
+		settings.priorityAging	= std::chrono::milliseconds{1};
+		settings.deadlineMargin	= std::chrono::milliseconds{1};
+
+		LocalTaskScheduler	scheduler	{settings};
+		Array<uint>			order;
+
+		// task with far deadline must not hide aged task behind it
+		TEST( scheduler->Run<PriorityTask>( Tuple{std::ref(order), 0u, EPriority::Background} ));
+		std::this_thread::sleep_for( std::chrono::milliseconds{5} );
+
+		TEST( scheduler->Run<PriorityTask>( Tuple{std::ref(order), 1u, EPriority::Background, Nanoseconds{std::chrono::seconds{10}}} ));
+		TEST( scheduler->Run<PriorityTask>( Tuple{std::ref(order), 2u, EPriority::Normal} ));
+
+		ProcessAll( order, 3 );
+		TEST(( order == Array<uint>{ 0, 2, 1 }));
+	}
+
+
+	static void  TaskPriority_Test5 ()
+	{
+		TaskScheduler::Settings	settings;
+		settings.workStealing	= true;
+		settings.priorityAging	= std::chrono::milliseconds{1};
+
+		LocalTaskScheduler	scheduler	{settings};
+		Array<uint>			order;
+
+		// thread without local queue adds task to the shared queue
+		TEST( scheduler->Run<PriorityTask>( Tuple{std::ref(order), 0u, EPriority::Normal} ));
+		std::this_thread::sleep_for( std::chrono::milliseconds{5} );
+
+		// aged task in the shared queue must be processed before tasks in the local queue
+		TEST( scheduler->AttachLocalQueue() );
+		TEST( scheduler->Run<PriorityTask>( Tuple{std::ref(order), 1u, EPriority::Normal} ));
+		TEST( scheduler->Run<PriorityTask>( Tuple{std::ref(order), 2u, EPriority::Normal} ));
+
+		ProcessAll( order, 3 );
+		TEST(( order == Array<uint>{ 0, 2, 1 }));
+
+		scheduler->DetachLocalQueue();
+	}
+}
+
+
+extern void UnitTest_TaskPriority ()
+{
+	TaskPriority_Test1();
+	TaskPriority_Test2();
+	TaskPriority_Test3();
+	TaskPriority_Test4();
+	TaskPriority_Test5();
+
+	AE_LOGI( "UnitTest_TaskPriority - passed" );
+}
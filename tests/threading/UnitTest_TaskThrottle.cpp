@@ -0,0 +1,133 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "threading/TaskSystem/WorkerThread.h"
+#include "UnitTest_Common.h"
+
+namespace
+{
+	using EThread		= IAsyncTask::EThread;
+	using ThreadMask	= IThread::ThreadMask;
+
+
+	struct Concurrency
+	{
+		Atomic<uint>	current	{0};
+		Atomic<uint>	peak	{0};
+		Atomic<uint>	count	{0};
+	};
+
+
+	class LimitedTask final : public IAsyncTask
+	{
+	public:
+		Concurrency&	cc;
+
+		LimitedTask (Concurrency &cc, EThread type, uint tag = 0) : IAsyncTask{ type }, cc{cc}
+		{
+			SetThrottleTag( tag );
+		}
+
+		void Run () override
+		{
+			const uint	curr = cc.current.fetch_add( 1 ) + 1;
+
+			for (uint peak = cc.peak.load(); peak < curr and not cc.peak.compare_exchange_weak( INOUT peak, curr );) {}
+
+			std::this_thread::sleep_for( std::chrono::milliseconds{2} );
+
+			cc.current.fetch_sub( 1 );
+			cc.count.fetch_add( 1 );
+		}
+	};
+
+
+	static void  TaskThrottle_Test1 ()
+	{
+		TaskScheduler::Settings	settings;
+		settings.threadLimits[ uint(EThread::FileIO) ].maxInFlight = 1;
+
+		LocalTaskScheduler	scheduler	{settings};
+		Concurrency			cc;
+
+		for (uint i = 0; i < 3; ++i) {
+			scheduler->AddThread( MakeShared<WorkerThread>( ThreadMask{}.set( uint(EThread::FileIO) ), WorkerThread::Milliseconds{10} ));
+		}
+
+		Array<AsyncTask>	tasks;
+		for (uint i = 0; i < 20; ++i) {
+			tasks.push_back( scheduler->Run<LimitedTask>( Tuple{std::ref(cc), EThread::FileIO} ));
+		}
+
+		TEST( scheduler->Wait( tasks ));
+		TEST( cc.count.load() == 20 );
+		TEST( cc.peak.load() == 1 );
+	}
+
+
+	static void  TaskThrottle_Test2 ()
+	{
+		TaskScheduler::Settings	settings;
+		settings.threadLimits[ uint(EThread::Network) ].tasksPerSecond	= 200.0f;
+		settings.threadLimits[ uint(EThread::Network) ].burst			= 1;
+
+		LocalTaskScheduler	scheduler	{settings};
+		Concurrency			cc;
+
+		for (uint i = 0; i < 2; ++i) {
+			scheduler->AddThread( MakeShared<WorkerThread>( ThreadMask{}.set( uint(EThread::Network) ), WorkerThread::Milliseconds{10} ));
+		}
+
+		const uint			count		= 21;
+		const auto			start_time	= std::chrono::high_resolution_clock::now();
+		Array<AsyncTask>	tasks;
+
+		for (uint i = 0; i < count; ++i) {
+			tasks.push_back( scheduler->Run<LimitedTask>( Tuple{std::ref(cc), EThread::Network} ));
+		}
+
+		TEST( scheduler->Wait( tasks ));
+		TEST( cc.count.load() == count );
+
+		// 200 tasks per second, first task is started immediately
+		const auto	dt = std::chrono::high_resolution_clock::now() - start_time;
+		TEST( dt >= std::chrono::milliseconds{ (count - 1) * 5 - 1 });
+	}
+
+
+	static void  TaskThrottle_Test3 ()
+	{
+		TaskScheduler::Settings	settings;
+		settings.maxWorkerThreads = 3;
+		settings.tagLimits[1].maxInFlight = 1;
+
+		LocalTaskScheduler	scheduler	{settings};
+		Concurrency			limited;
+		Concurrency			unlimited;
+
+		for (uint i = 0; i < 3; ++i) {
+			scheduler->AddThread( MakeShared<WorkerThread>() );
+		}
+
+		Array<AsyncTask>	tasks;
+		for (uint i = 0; i < 20; ++i)
+		{
+			tasks.push_back( scheduler->Run<LimitedTask>( Tuple{std::ref(limited), EThread::Worker, 1u} ));
+			tasks.push_back( scheduler->Run<LimitedTask>( Tuple{std::ref(unlimited), EThread::Worker, 0u} ));
+		}
+
+		TEST( scheduler->Wait( tasks ));
+		TEST( limited.count.load() == 20 );
+		TEST( unlimited.count.load() == 20 );
+		TEST( limited.peak.load() == 1 );
+	}
+}
+
+
+extern void UnitTest_TaskThrottle ()
+{
+	TaskThrottle_Test1();
+	TaskThrottle_Test2();
+	TaskThrottle_Test3();
+
+	AE_LOGI( "UnitTest_TaskThrottle - passed" );
+}
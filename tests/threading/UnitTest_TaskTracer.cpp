@@ -0,0 +1,125 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "threading/TaskSystem/WorkerThread.h"
+#include "stl/Stream/FileStream.h"
+#include "stl/Algorithms/StringUtils.h"
+#include "UnitTest_Common.h"
+
+namespace
+{
+	class TracedTask final : public IAsyncTask
+	{
+	public:
+		TracedTask () : IAsyncTask{ EThread::Worker } {}
+
+		void Run () override {}
+
+		NtStringView  DbgName () const override	{ return "Traced\"Task"; }
+	};
+
+
+	ND_ static String  ReadTrace (const Path &filename)
+	{
+		String		str;
+		FileRStream	file{ filename };
+		TEST( file.IsOpen() );
+		TEST( file.Read( size_t(file.Size()), OUT str ));
+		return str;
+	}
+
+	ND_ static size_t  CountSubstr (StringView str, StringView substr)
+	{
+		size_t	count = 0;
+		for (size_t pos = str.find( substr ); pos != StringView::npos; pos = str.find( substr, pos + 1 )) {
+			++count;
+		}
+		return count;
+	}
+
+
+	static void  TaskTracer_Test1 ()
+	{
+		const Path	filename = _ae_fs_::temp_directory_path() / "ae_task_trace1.json";
+
+		TaskScheduler::Settings	settings;
+		settings.maxWorkerThreads	= 1;
+		settings.traceFile			= filename;
+		{
+			LocalTaskScheduler	scheduler {settings};
+			scheduler->AddThread( MakeShared<WorkerThread>() );
+
+			TEST( TaskTracer::IsEnabled() );
+
+			AsyncTask	t0 = scheduler->Run<TracedTask>();
+			AsyncTask	t1 = scheduler->Run<TracedTask>( Tuple{}, Tuple{t0} );
+			AsyncTask	t2 = MakeTask<TracedTask>();
+
+			TEST( scheduler->Cancel( t2 ));
+			TEST( scheduler->Run( t2 ));
+
+			TEST( scheduler->Wait({ t0, t1, t2 }));
+			TEST( t1->Status() == IAsyncTask::EStatus::Completed );
+			TEST( t2->Status() == IAsyncTask::EStatus::Canceled );
+		}
+		// trace is saved in 'Release()'
+		TEST( not TaskTracer::IsEnabled() );
+
+		const String	str = ReadTrace( filename );
+
+		TEST( StartsWith( str, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" ));
+		TEST( EndsWith( str, "]}\n" ));
+		TEST( CountSubstr( str, "\"name\":\"Traced\\\"Task\"" ) >= 4 );
+		TEST( CountSubstr( str, "\"ph\":\"B\"" ) == 2 );
+		TEST( CountSubstr( str, "\"ph\":\"E\"" ) == 2 );
+		TEST( CountSubstr( str, "\"ph\":\"s\"" ) == 3 );	// canceled task is enqueued too
+		TEST( CountSubstr( str, "\"ph\":\"f\"" ) == 2 );
+		TEST( CountSubstr( str, "cancel Traced" ) == 1 );
+
+		// 't1' is waiting for 't0' if 't0' was not completed before 't1' was added
+		TEST( CountSubstr( str, "\"ph\":\"b\"" ) == CountSubstr( str, "\"ph\":\"e\"" ));
+		TEST( CountSubstr( str, "\"ph\":\"b\"" ) <= 1 );
+
+		Unused( _ae_fs_::remove( filename ));
+	}
+
+
+	static void  TaskTracer_Test2 ()
+	{
+		const Path			filename	= _ae_fs_::temp_directory_path() / "ae_task_trace2.json";
+		LocalTaskScheduler	scheduler	{1};
+
+		TaskTracer::Enable( true );
+
+		// ring buffer overflow, old events must be skipped
+		const uint	count = TaskTracer::BufferSize;
+		for (uint i = 0; i < count; ++i)
+		{
+			AsyncTask	task = scheduler->Run<TracedTask>();
+			TEST( scheduler->Wait({ task }));
+		}
+		TaskTracer::Enable( false );
+
+		TEST( TaskTracer::Flush( filename ));
+		String	str = ReadTrace( filename );
+
+		const size_t	started = CountSubstr( str, "\"ph\":\"B\"" );
+		TEST( started > 0 and started < count );
+		TEST( CountSubstr( str, "\"ph\":\"E\"" ) >= started - 1 );
+
+		// events are flushed only once
+		TEST( TaskTracer::Flush( filename ));
+		str = ReadTrace( filename );
+		TEST( CountSubstr( str, "\"ph\":\"B\"" ) == 0 );
+
+		Unused( _ae_fs_::remove( filename ));
+	}
+}
+
+
+extern void UnitTest_TaskTracer ()
+{
+	TaskTracer_Test1();
+	TaskTracer_Test2();
+
+	AE_LOGI( "UnitTest_TaskTracer - passed" );
+}
@@ -0,0 +1,92 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "threading/TaskSystem/WorkerThread.h"
+#include "threading/TaskSystem/FunctionTask.h"
+#include "UnitTest_Common.h"
+
+
+namespace
+{
+	class Test1_Task : public IAsyncTask
+	{
+	public:
+		Atomic<uint>&	counter;
+
+		Test1_Task (Atomic<uint> &counter) : IAsyncTask{ EThread::Worker }, counter{counter} {}
+
+		void Run () override
+		{
+			counter.fetch_add( 1 );
+		}
+	};
+
+	static void  TaskWait_Test1 ()
+	{
+		LocalTaskScheduler	scheduler	{1};
+		Atomic<uint>		counter		{0};
+
+		// there are no worker threads, tasks will be executed in current thread
+		AsyncTask	task1 = scheduler->Run<Test1_Task>( Tuple{std::ref(counter)} );
+		AsyncTask	task2 = scheduler->Run<Test1_Task>( Tuple{std::ref(counter)}, Tuple{task1} );
+
+		TEST( scheduler->Wait({ task2, task1 }));
+		TEST( counter.load() == 2 );
+	}
+
+
+	static void  TaskWait_Test2 ()
+	{
+		LocalTaskScheduler	scheduler	{1};
+		Atomic<uint>		counter		{0};
+
+		scheduler->AddThread( MakeShared<WorkerThread>() );
+
+		// wait inside task with single worker thread, nested tasks will be executed in the same thread
+		AsyncTask	root = scheduler->Run<FunctionTask>( Tuple{[&counter] ()
+							{
+								AsyncTask	t1 = Scheduler().Run<Test1_Task>( Tuple{std::ref(counter)} );
+								AsyncTask	t2 = Scheduler().Run<Test1_Task>( Tuple{std::ref(counter)} );
+
+								TEST( Scheduler().Wait({ t1, t2 }, Nanoseconds{std::chrono::seconds{10}} ));
+								counter.fetch_add( 10 );
+							}});
+
+		TEST( scheduler->Wait({ root }));
+		TEST( counter.load() == 12 );
+	}
+
+
+	static void  TaskWait_Test3 ()
+	{
+		LocalTaskScheduler	scheduler	{1};
+		Atomic<bool>		flag		{false};
+
+		scheduler->AddThread( MakeShared<WorkerThread>() );
+
+		// task is executed by worker thread, main thread is parked until task finishes
+		AsyncTask	task = scheduler->Run<FunctionTask>( Tuple{[&flag] ()
+							{
+								std::this_thread::sleep_for( std::chrono::milliseconds{20} );
+								flag.store( true );
+							}});
+
+		TEST( scheduler->Wait({ task }));
+		TEST( flag.load() );
+
+		// main queue is not processed by current thread
+		AsyncTask	task2 = scheduler->Run<FunctionTask>( Tuple{[] () {}, IAsyncTask::EThread::Main} );
+		TEST( not scheduler->Wait( {task2}, Nanoseconds{std::chrono::milliseconds{10}} ));
+
+		TEST( scheduler->Wait( {task2}, Nanoseconds{std::chrono::seconds{1}}, IThread::ThreadMask{}.set( uint(IThread::EThread::Main) )));
+	}
+}
+
+
+extern void UnitTest_TaskWait ()
+{
+	TaskWait_Test1();
+	TaskWait_Test2();
+	TaskWait_Test3();
+
+	AE_LOGI( "UnitTest_TaskWait - passed" );
+}
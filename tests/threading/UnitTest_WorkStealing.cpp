@@ -0,0 +1,220 @@
+// Copyright (c) 2018-2020,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "threading/Queues/LfWorkStealingDeque.h"
+#include "threading/TaskSystem/WorkerThread.h"
+#include "stl/Platforms/CPUInfo.h"
+#include "UnitTest_Common.h"
+
+namespace
+{
+	static void  WorkStealingDeque_Test1 ()
+	{
+		LfWorkStealingDeque< uint*, 64 >	deque;
+		uint								values [64] = {};
+
+		for (uint i = 0; i < 64; ++i) {
+			TEST( deque.Push( &values[i] ));
+		}
+		TEST( not deque.Push( &values[0] ));
+		TEST( deque.Size() == 64 );
+
+		uint*	ptr = null;
+
+		// owner pops in LIFO order
+		TEST( deque.Pop( OUT ptr ));
+		TEST( ptr == &values[63] );
+
+		// thief steals in FIFO order
+		TEST( deque.Steal( OUT ptr ));
+		TEST( ptr == &values[0] );
+
+		for (uint i = 1; i < 63; ++i)
+		{
+			TEST( deque.Pop( OUT ptr ));
+			TEST( ptr == &values[63 - i] );
+		}
+
+		TEST( not deque.Pop( OUT ptr ));
+		TEST( not deque.Steal( OUT ptr ));
+		TEST( deque.Empty() );
+	}
+
+
+	static void  WorkStealingDeque_Test2 ()
+	{
+		static constexpr uint	count		= 100'000;
+		static constexpr uint	num_thieves	= 3;
+
+		LfWorkStealingDeque< uint*, 256 >	deque;
+		Array<uint>							values;		values.resize( count );
+		Atomic<uint>						processed	{0};
+		Atomic<bool>						looping		{true};
+
+		const auto	Process = [&processed] (uint* ptr)
+		{
+			++(*ptr);
+			processed.fetch_add( 1, EMemoryOrder::Relaxed );
+		};
+
+		StaticArray< std::thread, num_thieves >	thieves;
+		for (auto& t : thieves)
+		{
+			t = std::thread{ [&] ()
+			{
+				for (uint* ptr; looping.load( EMemoryOrder::Relaxed );)
+				{
+					if ( deque.Steal( OUT ptr ))
+						Process( ptr );
+					else
+						std::this_thread::yield();
+				}
+			}};
+		}
+
+		// owner
+		for (uint i = 0; i < count;)
+		{
+			if ( deque.Push( &values[i] ))
+			{
+				++i;
+				continue;
+			}
+
+			uint*	ptr;
+			if ( deque.Pop( OUT ptr ))
+				Process( ptr );
+		}
+
+		for (uint* ptr; deque.Pop( OUT ptr );) {
+			Process( ptr );
+		}
+
+		for (; processed.load() < count;) {
+			std::this_thread::yield();
+		}
+		looping.store( false );
+
+		for (auto& t : thieves) {
+			t.join();
+		}
+
+		// each value must be processed only once
+		for (auto& v : values) {
+			TEST( v == 1 );
+		}
+	}
+
+
+	class WS_Task final : public IAsyncTask
+	{
+	public:
+		Atomic<uint>&	counter;
+		const uint		level;
+
+		WS_Task (Atomic<uint> &counter, uint level) : IAsyncTask{ EThread::Worker }, counter{counter}, level{level} {}
+
+		void Run () override
+		{
+			counter.fetch_add( 1, EMemoryOrder::Relaxed );
+
+			if ( level > 0 )
+			{
+				// subtasks will be added to the local queue
+				for (uint i = 0; i < 4; ++i) {
+					Scheduler().Run<WS_Task>( Tuple{std::ref(counter), level-1} );
+				}
+			}
+		}
+	};
+
+	static void  WorkStealing_Test1 ()
+	{
+		TaskScheduler::Settings	settings;
+		settings.maxWorkerThreads	= 2;
+		settings.workStealing		= true;
+
+		LocalTaskScheduler	scheduler {settings};
+		Atomic<uint>		counter {0};
+		const uint			levels	 = 5;
+		const uint			required = (1u << (2 * (levels + 1))) / 3;	// 1 + 4 + 16 + ...
+
+		scheduler->AddThread( MakeShared<WorkerThread>() );
+		scheduler->AddThread( MakeShared<WorkerThread>() );
+
+		AsyncTask	root	= scheduler->Run<WS_Task>( Tuple{std::ref(counter), levels} );
+		AsyncTask	task2	= scheduler->Run<WS_Task>( Tuple{std::ref(counter), 0u}, Tuple{root} );
+		TEST( root and task2 );
+
+		TEST( scheduler->Wait({ root, task2 }));
+		TEST( task2->Status() == IAsyncTask::EStatus::Completed );
+
+		for (; counter.load() < required + 1;) {
+			std::this_thread::yield();
+		}
+		TEST( counter.load() == required + 1 );
+	}
+
+
+	static void  WorkStealing_Test2 ()
+	{
+		const auto&	cpu = CPUInfo::Get();
+		TEST( cpu.logicalCoreCount > 0 and cpu.logicalCoreCount <= CPUInfo::MaxLogicalCores );
+		TEST( cpu.physicalCoreCount > 0 and cpu.physicalCoreCount <= cpu.logicalCoreCount );
+		TEST( cpu.numaNodeCount > 0 );
+
+		for (uint i = 0; i < cpu.logicalCoreCount; ++i)
+		{
+			TEST( cpu.logicalCores[i].physicalCore < cpu.physicalCoreCount );
+			TEST( cpu.logicalCores[i].numaNode < cpu.numaNodeCount );
+		}
+
+		TaskScheduler::Settings	settings;
+		settings.maxWorkerThreads	= 3;
+		settings.workStealing		= true;
+		settings.topologyAware		= true;
+
+		LocalTaskScheduler	scheduler {settings};
+		Atomic<uint>		counter {0};
+		const uint			levels	 = 5;
+		const uint			required = (1u << (2 * (levels + 1))) / 3;
+
+		// physical cores are used first
+		for (uint i = 0; i < settings.maxWorkerThreads; ++i)
+		{
+			uint	core = UMax, node = UMax;
+			TEST( scheduler->GetThreadPlacement( i, OUT core, OUT node ));
+			TEST( node < cpu.numaNodeCount );
+
+			for (uint j = 0; j < i and i < cpu.physicalCoreCount; ++j)
+			{
+				uint	core2, node2;
+				TEST( scheduler->GetThreadPlacement( j, OUT core2, OUT node2 ));
+				TEST( core != core2 );
+			}
+		}
+
+		for (uint i = 0; i < settings.maxWorkerThreads; ++i) {
+			scheduler->AddThread( MakeShared<WorkerThread>() );
+		}
+
+		AsyncTask	root = scheduler->Run<WS_Task>( Tuple{std::ref(counter), levels} );
+		TEST( root );
+		TEST( scheduler->Wait({ root }));
+
+		for (; counter.load() < required;) {
+			std::this_thread::yield();
+		}
+		TEST( counter.load() == required );
+	}
+}
+
+
+extern void UnitTest_WorkStealing ()
+{
+	WorkStealingDeque_Test1();
+	WorkStealingDeque_Test2();
+	WorkStealing_Test1();
+	WorkStealing_Test2();
+
+	AE_LOGI( "UnitTest_WorkStealing - passed" );
+}
@@ -3,14 +3,33 @@
 #include "stl/Common.h"
 
 extern void UnitTest_Promise ();
+extern void UnitTest_TaskAllocator ();
 extern void UnitTest_TaskDeps ();
+extern void UnitTest_WorkStealing ();
+extern void UnitTest_TaskPriority ();
+extern void UnitTest_ParallelFor ();
+extern void UnitTest_TaskWait ();
+extern void UnitTest_TaskGraph ();
+extern void UnitTest_Coroutine ();
+extern void UnitTest_TaskTracer ();
+extern void UnitTest_TaskThrottle ();
+extern void UnitTest_MessageQueue ();
 extern void PerfTest_Threading ();
+extern void PerfTest_TaskLatency ();
+extern void PerfTest_ParallelFor ();
+extern void PerfTest_MessageQueue ();
+extern void PerfTest_CachedIndexedPool ();
+extern void PerfTest_LfIndexedPool2 ();
 
+extern void UnitTest_SpinLock ();
 extern void UnitTest_IndexedPool ();
 extern void UnitTest_LfLinearAllocator ();
 extern void UnitTest_LfIndexedPool ();
 extern void UnitTest_LfIndexedPool2 ();
 extern void UnitTest_LfStaticPool ();
+extern void UnitTest_LfCachedIndexedPool ();
+extern void UnitTest_ShardedCachedIndexedPool ();
+extern void UnitTest_EpochReclamation ();
 
 
 #ifdef PLATFORM_ANDROID
@@ -19,17 +38,36 @@ extern int Test_Threading ()
 int main ()
 #endif
 {
+	UnitTest_SpinLock();
 	UnitTest_IndexedPool();
 	UnitTest_LfLinearAllocator();
 	UnitTest_LfIndexedPool();
 	UnitTest_LfIndexedPool2();
 	UnitTest_LfStaticPool();
+	UnitTest_LfCachedIndexedPool();
+	UnitTest_ShardedCachedIndexedPool();
+	UnitTest_EpochReclamation();
 
+	UnitTest_TaskAllocator();
 	UnitTest_TaskDeps();
+	UnitTest_WorkStealing();
+	UnitTest_TaskPriority();
+	UnitTest_ParallelFor();
+	UnitTest_TaskWait();
+	UnitTest_TaskGraph();
+	UnitTest_Coroutine();
+	UnitTest_TaskTracer();
+	UnitTest_TaskThrottle();
+	UnitTest_MessageQueue();
 	UnitTest_Promise();
 
 #if (not defined(AE_CI_BUILD)) and (not defined(PLATFORM_ANDROID))
 	PerfTest_Threading();
+	PerfTest_TaskLatency();
+	PerfTest_ParallelFor();
+	PerfTest_MessageQueue();
+	PerfTest_CachedIndexedPool();
+	PerfTest_LfIndexedPool2();
 #endif
 
 	AE_LOGI( "Tests.Threading finished" );